@@ -279,7 +279,10 @@ class BMessage {
 		status_t		_InitHeader();
 		status_t		_Clear();
 
+		status_t		_CopyForWrite();
 		status_t		_ValidateMessage();
+		status_t		_UnflattenInPlace(void* buffer, size_t size);
+		status_t		_Reserve(uint32 fieldCount, size_t dataSize);
 
 		status_t		_ResizeData(uint32 offset, int32 change);
 
@@ -305,7 +308,11 @@ class BMessage {
 		BMessage*		fQueueLink;
 			// fQueueLink is used by BMessageQueue to build a linked list
 
-		uint32			fReserved[9];
+		bool			fInPlace;
+			// fFields and fData point into the buffer fHeader was
+			// allocated with, see _UnflattenInPlace()
+		uint8			_reserved[3];
+		uint32			fReserved[8];
 
 						// deprecated
 						BMessage(BMessage *message);
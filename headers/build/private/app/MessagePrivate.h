@@ -9,6 +9,8 @@
 #define _MESSAGE_PRIVATE_H_
 
 
+#include <string.h>
+
 #include <Message.h>
 #include <Messenger.h>
 #include <MessengerPrivate.h>
@@ -82,6 +84,20 @@ struct BMessage::message_header {
 } _PACKED;
 
 
+/*!	Describes a field that is about to be added to a message, so that the
+	message can allocate all of its space at once, see
+	BMessage::Private::Reserve().
+*/
+struct message_field_schema {
+	const char*	name;
+	int32		count;
+	size_t		itemSize;
+		// the size of a single item, or the expected maximum size for fields
+		// that are not fixed size
+	bool		fixedSize;
+};
+
+
 class BMessage::Private {
 	public:
 		Private(BMessage *msg)
@@ -170,6 +186,34 @@ class BMessage::Private {
 			return fMessage->fData;
 		}
 
+		status_t
+		UnflattenInPlace(void* buffer, size_t size)
+		{
+			return fMessage->_UnflattenInPlace(buffer, size);
+		}
+
+		status_t
+		Reserve(uint32 fieldCount, size_t dataSize)
+		{
+			return fMessage->_Reserve(fieldCount, dataSize);
+		}
+
+		status_t
+		Reserve(const message_field_schema* schema, int32 count)
+		{
+			size_t dataSize = 0;
+			for (int32 i = 0; i < count; i++) {
+				size_t itemSize = schema[i].itemSize;
+				if (!schema[i].fixedSize)
+					itemSize += sizeof(uint32);
+
+				dataSize += strlen(schema[i].name) + 1
+					+ schema[i].count * itemSize;
+			}
+
+			return fMessage->_Reserve(count, dataSize);
+		}
+
 	private:
 		BMessage* fMessage;
 };
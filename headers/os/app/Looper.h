@@ -144,6 +144,8 @@ private:
 
 			void*			ReadRawFromPort(int32* code,
 								bigtime_t timeout = B_INFINITE_TIMEOUT);
+			void*			_ReadRawFromPort(int32* code, ssize_t* _size,
+								bigtime_t timeout);
 			BMessage*		ReadMessageFromPort(
 								bigtime_t timeout = B_INFINITE_TIMEOUT);
 	virtual	BMessage*		ConvertToMessage(void* raw, int32 code);
@@ -174,7 +176,13 @@ private:
 			bool			fTerminating;
 			bool			fRunCalled;
 			bool			fOwnsPort;
-			uint32			_reserved[11];
+			void*			fPortBuffer;
+			ssize_t			fPortBufferSize;
+#ifdef B_HAIKU_64_BIT
+			uint32			_reserved[5];
+#else
+			uint32			_reserved[9];
+#endif
 };
 
 #endif	// _LOOPER_H
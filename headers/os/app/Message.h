@@ -543,6 +543,8 @@ private:
 			status_t			_Dereference();
 
 			status_t			_ValidateMessage();
+			status_t			_UnflattenInPlace(void* buffer, size_t size);
+			status_t			_Reserve(uint32 fieldCount, size_t dataSize);
 
 			void				_UpdateOffsets(uint32 offset, int32 change);
 			status_t			_ResizeData(uint32 offset, int32 change);
@@ -597,7 +599,11 @@ private:
 
 			void*				fArchivingPointer;
 
-			uint32				fReserved[8];
+			bool				fInPlace;
+				// fFields and fData point into the buffer fHeader was
+				// allocated with, see _UnflattenInPlace()
+			uint8				_reserved[3];
+			uint32				fReserved[7];
 
 			enum				{ sNumReplyPorts = 3 };
 	static	port_id				sReplyPorts[sNumReplyPorts];
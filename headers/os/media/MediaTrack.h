@@ -85,6 +85,12 @@ public:
 			status_t			DecodedFormat(media_format* _format,
 									uint32 flags = 0);
 
+	// SetDecodingThreadCount sets the number of threads the codec may use
+	// to decode the track, 0 lets it choose one based on the number of CPUs.
+	// It takes effect with the next call to DecodedFormat().
+
+			status_t			SetDecodingThreadCount(int32 count);
+
 	// CountFrames and Duration return the total number of frame and the
 	// total duration (expressed in microseconds) of a track.
 
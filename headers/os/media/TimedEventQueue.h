@@ -99,6 +99,9 @@ public:
 			status_t			RemoveEvent(const media_timed_event* event);
 			status_t  			RemoveFirstEvent(
 									media_timed_event* _event = NULL);
+			status_t			RemoveFirstEvents(bigtime_t eventTime,
+									media_timed_event* events, int32* _count,
+									bool inclusive = true);
 
 			bool				HasEvents() const;
 			int32				EventCount() const;
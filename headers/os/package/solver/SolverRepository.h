@@ -70,15 +70,25 @@ public:
 
 			uint64				ChangeCount() const;
 
+			const BString&		CachePath() const;
+									// path of the repository cache the
+									// packages were read from, empty if the
+									// repository wasn't set up from one or
+									// has been changed since
+
 private:
 			typedef BObjectList<BSolverPackage, true> PackageList;
 
+private:
+			void				_SetCachePath(const BRepositoryCache& cache);
+
 private:
 			BString				fName;
 			int32				fPriority;
 			bool				fIsInstalled;
 			PackageList			fPackages;
 			uint64				fChangeCount;
+			BString				fCachePath;
 };
 
 
@@ -23,6 +23,10 @@ enum {
 	B_UPDATE_MIME_INFO_NO_FORCE			= 0,
 	B_UPDATE_MIME_INFO_FORCE_KEEP_TYPE	= 1,
 	B_UPDATE_MIME_INFO_FORCE_UPDATE_ALL	= 2,
+
+	/* can be ORed with the above: walk, sniff and write the attributes in
+	   a pipeline of several threads */
+	B_UPDATE_MIME_INFO_PARALLEL			= 0x100,
 };
 
 
@@ -24,7 +24,10 @@ enum {
 
 	B_WATCH_MOUNT			= 0x0010,
 	B_WATCH_INTERIM_STAT	= 0x0020,
-	B_WATCH_CHILDREN		= 0x0040
+	B_WATCH_CHILDREN		= 0x0040,
+
+	B_WATCH_BATCHED			= 0x0080
+		// Haiku only: deliver the events in B_BATCHED_EVENTS messages
 };
 
 
@@ -40,6 +43,13 @@ enum {
 #define B_ATTR_CHANGED	 	5
 #define B_DEVICE_MOUNTED	6
 #define B_DEVICE_UNMOUNTED	7
+#define B_BATCHED_EVENTS	8
+
+
+// A B_BATCHED_EVENTS notification message (Haiku only) contains the events
+// that occurred within a short time, in order, as "event" messages. Changes
+// to the same node are coalesced. If its "overflow" field is true, events
+// have been lost, and the target should rescan the nodes it watches.
 
 
 // More specific info in the "cause" field of B_ATTR_CHANGED notification
@@ -79,8 +89,9 @@ enum {
 #include <Node.h>
 #include <Messenger.h>
 
-class BLooper;
 class BHandler;
+class BLooper;
+class BMessage;
 
 
 extern status_t watch_volume(dev_t volume, uint32 flags, BMessenger target);
@@ -95,6 +106,11 @@ extern status_t watch_node(const node_ref* node, uint32 flags,
 extern status_t stop_watching(BMessenger target);
 extern status_t stop_watching(const BHandler* handler, const BLooper* looper = NULL);
 
+extern int32 count_node_monitor_events(const BMessage* message);
+extern status_t get_node_monitor_event(const BMessage* message, int32 index,
+	BMessage* event);
+extern bool node_monitor_rescan_needed(const BMessage* message);
+
 #endif	// __cplusplus && !_KERNEL_MODE
 
 
@@ -33,6 +33,13 @@ struct translation_format {
 	char		name[251];
 };
 
+struct translation_signature {
+	uint32		type;				// type_code of the input format
+	int32		offset;				// of the bytes in the stream
+	int32		length;				// at most 16
+	uint8		bytes[16];
+};
+
 struct translator_info {
 	uint32			type;
 	translator_id	translator;
@@ -73,5 +73,11 @@ private:
 extern "C" BTranslator* make_nth_translator(int32 n, image_id you,
 	uint32 flags, ...);
 
+// An add-on may also export the signatures of its input formats, terminated
+// by an entry with a zero type. If they cover all input formats of one of its
+// translators, the roster will only ask that translator to identify data that
+// matches one of them.
+extern "C" const translation_signature input_signatures[];
+
 
 #endif	// _TRANSLATOR_H
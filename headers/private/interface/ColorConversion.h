@@ -21,6 +21,8 @@ status_t ConvertBits(const void *srcBits, void *dstBits, int32 srcBitsLength,
 	color_space srcColorSpace, color_space dstColorSpace, BPoint srcOffset,
 	BPoint dstOffset, int32 width, int32 height);
 
+void SetFastColorConversionEnabled(bool enabled);
+
 
 /*!	\brief Helper class for conversion between RGB and palette colors.
 */
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _LIBROOT_MALLOC_PRIVATE_H
+#define _LIBROOT_MALLOC_PRIVATE_H
+
+#include <OS.h>
+
+#include <sys/cdefs.h>
+
+
+struct malloc_size_class_info {
+	size_t	size;			// size of the chunks in this class
+	size_t	pages;			// pages split into chunks of this size
+	size_t	chunks;			// chunks on these pages
+	size_t	used;			// chunks not free in their pool
+	size_t	cached;			// of those, chunks held by thread caches
+	uint64	cache_hits;		// allocations served by a thread cache
+	uint64	cache_refills;	// batches a thread cache got from a pool
+	uint64	cache_drains;	// batches a thread cache returned to a pool
+};
+
+
+__BEGIN_DECLS
+
+status_t get_malloc_size_class_info(struct malloc_size_class_info* infos,
+	size_t* _count);
+
+__END_DECLS
+
+
+#endif	// _LIBROOT_MALLOC_PRIVATE_H
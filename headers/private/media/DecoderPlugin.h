@@ -47,8 +47,11 @@ public:
 
 	virtual status_t			Perform(perform_code code, void* data);
 
+	// Sets the number of threads the decoder may use, 0 lets it choose.
+	// Takes effect with the next NegotiateOutputFormat().
+	virtual	status_t			SetThreadCount(int32 count);
+
 private:
-	virtual void				_ReservedDecoder1();
 	virtual void				_ReservedDecoder2();
 	virtual void				_ReservedDecoder3();
 	virtual void				_ReservedDecoder4();
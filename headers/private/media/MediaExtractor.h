@@ -19,6 +19,7 @@ namespace media {
 
 
 class ChunkCache;
+class SeekIndex;
 struct chunk_buffer;
 
 
@@ -31,6 +32,7 @@ struct stream_info {
 	ChunkCache*		chunkCache;
 	chunk_buffer*	lastChunk;
 	media_format	encodedFormat;
+	SeekIndex*		seekIndex;
 };
 
 
@@ -77,6 +79,14 @@ private:
 			void				_Init(BDataIO* source, int32 flags);
 
 			void				_RecycleLastChunk(stream_info& info);
+			void				_UpdateSeekIndex(stream_info& info,
+									status_t status,
+									const media_header& header);
+			bool				_FindIndexedKeyFrame(const stream_info& info,
+									uint32 seekTo, int64* _frame,
+									bigtime_t* _time) const;
+			void				_LoadSeekIndex();
+			void				_SaveSeekIndex();
 	static	int32				_ExtractorEntry(void* arg);
 			void				_ExtractorThread();
 			size_t				_CalculateChunkBuffer(int32 stream);
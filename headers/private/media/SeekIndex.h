@@ -0,0 +1,64 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _SEEK_INDEX_H
+#define _SEEK_INDEX_H
+
+
+#include <SupportDefs.h>
+
+#include <vector>
+
+
+namespace BPrivate {
+namespace media {
+
+
+class SeekIndex {
+public:
+	static	const int32			kMaxEntries = 16384;
+
+								SeekIndex();
+								~SeekIndex();
+
+			void				AddKeyFrame(bigtime_t time);
+			void				SetEndOfStream();
+			void				Interrupt();
+
+			bool				FindKeyFrame(uint32 flags,
+									bigtime_t* _time) const;
+
+			int32				CountEntries() const
+									{ return fEntries.size(); }
+			bool				IsModified() const
+									{ return fModified; }
+
+			size_t				FlattenedSize() const;
+			void				Flatten(int64* buffer) const;
+			status_t			Unflatten(const int64* buffer, int32 count);
+
+private:
+			struct entry {
+				bigtime_t		time;
+				bool			followed;
+					// the next key frame of the stream is the next entry,
+					// or, for the last entry, the stream ends after it
+			};
+
+			int32				_LowerBound(bigtime_t time) const;
+
+private:
+			std::vector<entry>	fEntries;
+			bigtime_t			fLastKeyFrame;
+			bool				fContinuous;
+			bool				fModified;
+};
+
+
+}	// namespace media
+}	// namespace BPrivate
+
+using namespace BPrivate::media;
+
+#endif	// _SEEK_INDEX_H
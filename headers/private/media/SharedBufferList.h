@@ -24,6 +24,8 @@ public:
 			void 						DeleteGroupAndPut(
 											sem_id groupReclaimSem);
 
+			// The lock is only needed to add or remove buffers; requesting
+			// and recycling them works without it.
 			status_t					Lock();
 			status_t					Unlock();
 
@@ -53,19 +55,37 @@ private:
 	struct _shared_buffer_info {
 		media_buffer_id			id;
 		BBuffer*				buffer;
-		bool 					reclaimed;
+		// Only changed atomically: the entry's generation, which is
+		// bumped whenever it is added or removed, and whether it is used
+		// and its buffer is available (see kEntryUsed and kEntryAvailable)
+		int32					state;
 		// The reclaim_sem belonging to the BBufferGroup of this BBuffer
-		// is also used as a unique identifier of the group
+		// is also used as a unique identifier of the group; -1 for unused
+		// entries
 		sem_id					reclaim_sem;
 	};
 
+	enum {
+		kEntryAvailable			= 0x01,
+		kEntryUsed				= 0x02,
+		kGenerationIncrement	= 0x04
+	};
+
 	// 16 bytes per buffer, 8 pages in total (one entry less for the list)
 	enum { kMaxBuffers = 2047 };
 
 			status_t					_Init();
+			BBuffer*					_ClaimBuffer(sem_id groupReclaimSem,
+											size_t size,
+											media_buffer_id wantID,
+											BBuffer* wantBuffer);
 			void 						_RequestBufferInOtherGroups(
 											sem_id groupReclaimSem,
 											media_buffer_id id);
+	static	int32						_NextGeneration(int32 state);
+			bool						_RemoveEntry(
+											_shared_buffer_info& info,
+											bool force);
 
 private:
 			sem_id						fSemaphore;
@@ -73,6 +93,7 @@ private:
 
 			_shared_buffer_info			fInfos[kMaxBuffers];
 			int32						fCount;
+			int32						fClaimCount;
 };
 
 
@@ -27,7 +27,14 @@ public:
 	static	void				Parse(BDataIO* data,
 									BJsonEventListener* listener);
 
+	static	status_t			ParseInSitu(char* JSON, size_t length,
+									BMessage& message);
+	static	void				ParseInSitu(char* JSON, size_t length,
+									BJsonEventListener* listener);
+
 private:
+	static	void				Parse(JsonParseContext& jsonParseContext);
+
 	static	bool				NextChar(JsonParseContext& jsonParseContext,
 									char* c);
 	static	bool				NextNonWhitespaceChar(
@@ -10,12 +10,16 @@
 
 
 #include <stdarg.h>
+#include <sys/stat.h>
 
 #include <EntryOperationEngineBase.h>
+#include <Locker.h>
+#include <OS.h>
 
 
 class BFile;
 class BNode;
+struct attr_info;
 
 
 namespace BPrivate {
@@ -43,18 +47,76 @@ public:
 			BCopyEngine&		AddFlags(uint32 flags);
 			BCopyEngine&		RemoveFlags(uint32 flags);
 
+			int32				ThreadCount() const;
+			BCopyEngine&		SetThreadCount(int32 count);
+
 			status_t			CopyEntry(const Entry& sourceEntry,
 									const Entry& destEntry);
 
+private:
+			struct Directory;
+			struct FileJob;
+			struct PendingAttribute;
+			struct Worker;
+			class JobQueue;
+
 private:
 			status_t			_CopyEntry(const char* sourcePath,
-									const char* destPath);
+									const char* destPath,
+									Directory* parent);
+			status_t			_QueueFile(const char* sourcePath,
+									const struct stat& sourceStat,
+									const char* destPath, Directory* parent);
+			status_t			_CopyFile(const char* sourcePath,
+									const struct stat& sourceStat,
+									const char* destPath, char* buffer,
+									size_t bufferSize);
 			status_t			_CopyFileData(const char* sourcePath,
 									BFile& source, const char* destPath,
-									BFile& destination);
+									BFile& destination, char* buffer,
+									size_t bufferSize);
+			status_t			_CopyMetaData(const char* sourcePath,
+									BNode& source,
+									const struct stat& sourceStat,
+									const char* destPath, BNode& destination,
+									char* buffer, size_t bufferSize);
 			status_t			_CopyAttributes(const char* sourcePath,
 									BNode& source, const char* destPath,
-									BNode& destination);
+									BNode& destination, char* buffer,
+									size_t bufferSize);
+			status_t			_CopyAttribute(const char* sourcePath,
+									BNode& source, const char* destPath,
+									BNode& destination, const char* attribute,
+									const struct attr_info& info, char* buffer,
+									size_t bufferSize);
+			status_t			_WriteAttributes(const char* sourcePath,
+									const char* destPath, BNode& destination,
+									const char* buffer,
+									const PendingAttribute* attributes,
+									int32 count);
+
+			status_t			_StartWorkers();
+			void				_StopWorkers();
+			void				_DeleteWorkers();
+	static	status_t			_WorkerThread(void* data);
+
+			void				_AcquireDirectory(Directory* directory);
+			void				_ReleaseDirectory(Directory* directory);
+			void				_SetDirectoryError(Directory* directory,
+									status_t error);
+			bool				_IsCanceled(Directory* directory);
+
+			bool				_EntryStarted(const char* path);
+			bool				_EntryFinished(const char* path,
+									status_t error);
+			bool				_AttributeStarted(const char* path,
+									const char* attribute,
+									uint32 attributeType);
+			bool				_AttributeFinished(const char* path,
+									const char* attribute,
+									uint32 attributeType, status_t error);
+			void				_BytesCopied(size_t bytes);
+			void				_ReportProgress(bigtime_t now);
 
 			void				_NotifyError(status_t error, const char* format,
 									...);
@@ -71,6 +133,18 @@ private:
 			uint32				fFlags;
 			char*				fBuffer;
 			size_t				fBufferSize;
+
+			int32				fThreadCount;
+			Worker*				fWorkers;
+			int32				fWorkerCount;
+			JobQueue*			fJobQueue;
+			status_t			fError;
+
+			BLocker				fLock;
+				// guards the directories and the controller
+			off_t				fBytesCopied;
+			bigtime_t			fStartTime;
+			bigtime_t			fLastProgressTime;
 };
 
 
@@ -91,6 +165,9 @@ public:
 
 	virtual	void				ErrorOccurred(const char* message,
 									status_t error);
+
+	virtual	void				ProgressChanged(off_t bytesCopied,
+									off_t bytesPerSecond);
 };
 
 
@@ -12,6 +12,10 @@
 #include <mime/MimeEntryProcessor.h>
 
 
+class BNode;
+class BString;
+
+
 namespace BPrivate {
 namespace Storage {
 namespace Mime {
@@ -25,6 +29,13 @@ public:
 	virtual						~MimeInfoUpdater();
 
 	virtual	status_t			Do(const entry_ref& entry, bool* _entryIsDir);
+
+			void				GetUpdatesNeeded(BNode& node,
+									bool* _updateType,
+									bool* _updateAppInfo) const;
+			status_t			UpdateAttributes(const entry_ref& entry,
+									BNode& node, const BString& type,
+									bool updateType, bool updateAppInfo);
 };
 
 
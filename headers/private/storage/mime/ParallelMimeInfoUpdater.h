@@ -0,0 +1,112 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _MIME_PARALLEL_MIME_INFO_UPDATER_H
+#define _MIME_PARALLEL_MIME_INFO_UPDATER_H
+
+
+#include <list>
+#include <utility>
+
+#include <mime/MimeInfoUpdater.h>
+
+
+namespace BPrivate {
+namespace Storage {
+namespace Mime {
+
+
+class ParallelMimeInfoUpdater {
+public:
+			struct Progress;
+			class ProgressListener;
+
+public:
+								ParallelMimeInfoUpdater(Database* database,
+									MimeEntryProcessor::DatabaseLocker*
+										databaseLocker,
+									int32 force, int32 threadCount = 0);
+								~ParallelMimeInfoUpdater();
+
+			void				SetProgressListener(
+									ProgressListener* listener,
+									bigtime_t interval = 1000000);
+
+			status_t			Update(const entry_ref& root, bool recursive);
+
+private:
+			class DefaultDatabaseLocker;
+			struct SniffItem;
+			struct WriteItem;
+			template<typename Item> class Queue;
+
+			typedef Queue<SniffItem> SniffQueue;
+			typedef Queue<WriteItem> WriteQueue;
+
+private:
+	static	status_t			_SnifferThread(void* data);
+	static	status_t			_WriterThread(void* data);
+
+			status_t			_Walk(const entry_ref& ref, bool recursive);
+			bool				_DeviceSupportsAttributes(dev_t device);
+			void				_Sniff(const SniffItem& item, void* buffer);
+			status_t			_GuessMimeType(const entry_ref& ref,
+									BNode& node, void* buffer, BString& type);
+			void				_Write(WriteItem* items, int32 count);
+			void				_ReportProgress(bool done);
+
+private:
+			Database*			fDatabase;
+			MimeEntryProcessor::DatabaseLocker* fDatabaseLocker;
+			DefaultDatabaseLocker* fDefaultDatabaseLocker;
+			MimeInfoUpdater		fUpdater;
+			int32				fThreadCount;
+			ssize_t				fSniffBufferSize;
+
+			SniffQueue*			fSniffQueue;
+			WriteQueue*			fWriteQueue;
+
+			ProgressListener*	fProgressListener;
+			bigtime_t			fProgressInterval;
+			bigtime_t			fLastProgress;
+			int64				fEntries;
+			int64				fSniffed;
+			int64				fUpdated;
+			int64				fSkipped;
+			int64				fFailed;
+			int32				fCanceled;
+
+			std::list<std::pair<dev_t, bool> > fAttributeSupport;
+};
+
+
+struct ParallelMimeInfoUpdater::Progress {
+			int64				entries;
+				// found by the directory walk so far
+			int64				sniffed;
+			int64				updated;
+			int64				skipped;
+				// were up to date already, or on a volume without attributes
+			int64				failed;
+			bool				done;
+};
+
+
+class ParallelMimeInfoUpdater::ProgressListener {
+public:
+	virtual						~ProgressListener();
+
+	/*!	Called from the thread that called Update() in the given interval,
+		and once more when done. Returning \c false cancels the update.
+	*/
+	virtual	bool				UpdateProgress(const Progress& progress) = 0;
+};
+
+
+} // namespace Mime
+} // namespace Storage
+} // namespace BPrivate
+
+
+#endif	// _MIME_PARALLEL_MIME_INFO_UPDATER_H
@@ -7,6 +7,7 @@
 
 
 #include <SupportDefs.h>
+#include <sniffer/PatternMatcher.h>
 
 #include <list>
 #include <string>
@@ -37,12 +38,17 @@ public:
 	
 	status_t GuessMimeType(const entry_ref *ref, BString *type);
 	status_t GuessMimeType(const void *buffer, int32 length, BString *type);
+	status_t GuessMimeType(BFile* file, const void *buffer, int32 length,
+		BString *type);
+	ssize_t MaxBytesNeeded();
 	
 	status_t SetSnifferRule(const char *type, const char *rule);
 	status_t DeleteSnifferRule(const char *type);
 	
 	void PrintToStream() const;
 
+	void SetCompiledMatching(bool enabled);
+
 	struct sniffer_rule {
 		std::string type;							// The mime type that own the rule
 		std::string rule_string;					// The unparsed string version of the rule
@@ -53,10 +59,8 @@ public:
 	};		
 private:
 	status_t BuildRuleList();
-	status_t GuessMimeType(BFile* file, const void *buffer, int32 length,
-		BString *type);
-	ssize_t MaxBytesNeeded();
 	status_t ProcessType(const char *type, ssize_t *bytesNeeded);
+	status_t CompileRules();
 
 	std::list<sniffer_rule> fRuleList;
 
@@ -65,6 +69,10 @@ private:
 	MimeSniffer*		fMimeSniffer;
 	ssize_t				fMaxBytesNeeded;
 	bool				fHaveDoneFullBuild;
+
+	Sniffer::PatternMatcher	fPatternMatcher;
+	bool				fRulesCompiled;
+	bool				fUseCompiledRules;
 };
 
 } // namespace Mime
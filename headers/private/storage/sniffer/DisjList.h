@@ -9,7 +9,10 @@
 #ifndef _SNIFFER_DISJ_LIST_H
 #define _SNIFFER_DISJ_LIST_H
 
+#include <SupportDefs.h>
+
 #include <sys/types.h>
+#include <vector>
 
 class BPositionIO;
 
@@ -17,6 +20,8 @@ namespace BPrivate {
 namespace Storage {
 namespace Sniffer {
 
+class PatternMatcher;
+
 //! Abstract class defining methods acting on a list of ORed patterns
 class DisjList {
 public:
@@ -25,6 +30,8 @@ public:
 
 	virtual bool Sniff(BPositionIO *data) const = 0;
 	virtual ssize_t BytesNeeded() const = 0;
+	virtual status_t AddPatterns(PatternMatcher &matcher,
+		std::vector<int32> &indices) const = 0;
 	
 	void SetCaseInsensitive(bool how);
 	bool IsCaseInsensitive();
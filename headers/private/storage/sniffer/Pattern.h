@@ -37,7 +37,10 @@ public:
 	
 	status_t SetTo(const std::string &string, const std::string &mask);
 private:
+	friend class PatternMatcher;
+
 	bool Sniff(off_t start, off_t size, BPositionIO *data, bool caseInsensitive) const;
+	bool Matches(const char *data, bool caseInsensitive) const;
 	
 	void SetStatus(status_t status, const char *msg = NULL);
 	void SetErrorMessage(const char *msg);
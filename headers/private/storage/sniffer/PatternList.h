@@ -35,6 +35,8 @@ public:
 	
 	virtual bool Sniff(BPositionIO *data) const;
 	virtual ssize_t BytesNeeded() const;
+	virtual status_t AddPatterns(PatternMatcher &matcher,
+		std::vector<int32> &indices) const;
 	
 	void Add(Pattern *pattern);
 private:
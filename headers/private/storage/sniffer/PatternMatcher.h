@@ -0,0 +1,91 @@
+//----------------------------------------------------------------------
+//  This software is part of the Haiku distribution and is covered
+//  by the MIT License.
+//---------------------------------------------------------------------
+/*!
+	\file sniffer/PatternMatcher.h
+	MIME sniffer multi-pattern matcher declarations
+*/
+#ifndef _SNIFFER_PATTERN_MATCHER_H
+#define _SNIFFER_PATTERN_MATCHER_H
+
+#include <SupportDefs.h>
+#include <sniffer/Range.h>
+#include <sys/types.h>
+#include <vector>
+
+namespace BPrivate {
+namespace Storage {
+namespace Sniffer {
+
+class Pattern;
+
+/*! \brief Finds all patterns of a set of rules that match a data buffer in a
+	single pass over it.
+
+	Every pattern is added together with the range it is to be searched over.
+	Compile() then builds an Aho-Corasick automaton over the longest fully
+	masked part of each pattern; every hit of the automaton that falls into
+	the pattern's range is verified against the complete pattern and mask.
+	Patterns without any fully masked byte are checked one by one.
+*/
+class PatternMatcher {
+public:
+	//! One entry per added pattern, non-zero if it matched
+	typedef std::vector<uint8> MatchList;
+
+	PatternMatcher();
+	~PatternMatcher();
+
+	void MakeEmpty();
+	int32 AddPattern(const Pattern *pattern, Range range, bool caseInsensitive);
+	status_t Compile();
+
+	int32 CountPatterns() const;
+	void Match(const void *data, size_t length, MatchList &matches) const;
+private:
+	struct entry {
+		const Pattern	*pattern;
+		int32			rangeStart;
+		int32			rangeEnd;
+		bool			caseInsensitive;
+		int32			keyOffset;	// of the automaton key within the pattern
+		int32			keyLength;	// 0 if the pattern has no key
+	};
+
+	struct node {
+		int32	failure;
+		int32	outputLink;	// next node on the failure path with outputs
+		int32	firstEdge;
+		int32	edgeCount;
+		int32	firstOutput;
+		int32	outputCount;
+	};
+
+	struct edge {
+		uint8	byte;
+		int32	target;
+	};
+
+	int32 Step(int32 state, uint8 byte) const;
+	bool MatchAt(const entry &candidate, const char *data, size_t length,
+		off_t start) const;
+	bool MatchAny(const entry &candidate, const char *data,
+		size_t length) const;
+
+	std::vector<entry> fEntries;
+	std::vector<node> fNodes;
+	std::vector<edge> fEdges;
+	std::vector<int32> fOutputs;
+	std::vector<int32> fUnanchored;
+	int32 fRootTable[256];
+	off_t fScanLength;
+	bool fCompiled;
+};
+
+};	// namespace Sniffer
+};	// namespace Storage
+};	// namespace BPrivate
+
+#endif	// _SNIFFER_PATTERN_MATCHER_H
+
@@ -19,6 +19,7 @@ namespace Sniffer {
 
 class Err;
 class Pattern;
+class PatternMatcher;
 
 //! A Pattern and a Range, bundled into one.
 class RPattern {
@@ -31,6 +32,7 @@ public:
 	
 	bool Sniff(BPositionIO *data, bool caseInsensitive) const;
 	ssize_t BytesNeeded() const;
+	int32 AddPattern(PatternMatcher &matcher, bool caseInsensitive) const;
 private:
 	Range fRange;
 	Pattern *fPattern;
@@ -32,6 +32,8 @@ public:
 	
 	virtual bool Sniff(BPositionIO *data) const;
 	virtual ssize_t BytesNeeded() const;
+	virtual status_t AddPatterns(PatternMatcher &matcher,
+		std::vector<int32> &indices) const;
 	void Add(RPattern *rpattern);
 private:
 	std::vector<RPattern*> fList;
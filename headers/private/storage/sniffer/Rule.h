@@ -10,6 +10,7 @@
 #define _SNIFFER_RULE_H
 
 #include <SupportDefs.h>
+#include <sniffer/PatternMatcher.h>
 
 #include <sys/types.h>
 #include <vector>
@@ -34,6 +35,9 @@ public:
 	double Priority() const;	
 	bool Sniff(BPositionIO *data) const;	
 	ssize_t BytesNeeded() const;
+
+	status_t Compile(PatternMatcher &matcher);
+	bool Sniff(const PatternMatcher::MatchList &matches) const;
 private:
 	friend class Parser;
 
@@ -42,6 +46,8 @@ private:
 
 	double fPriority;
 	std::vector<DisjList*> *fConjList;	// A list of DisjLists to be ANDed
+	std::vector<std::vector<int32> > fCompiledConjList;
+		// The matcher indices of the patterns of each DisjList
 };
 
 };	// namespace Sniffer
@@ -22,6 +22,7 @@ enum {
 	TLS_USER_THREAD_SLOT,
 	TLS_DYNAMIC_THREAD_VECTOR,
 	TLS_MALLOC_SLOT,
+	TLS_MALLOC_CACHE_SLOT,
 	TLS_LOCALE_SLOT,
 
 	// Note: these entries can safely be changed between
@@ -15,6 +15,8 @@
 
 #include <new>
 
+#include <algorithm>
+
 #include <AppDefs.h>
 #include <driver_settings.h>
 #include <KernelExport.h>
@@ -26,6 +28,7 @@
 #include <AutoDeleterDrivers.h>
 #include <PackagesDirectoryDefs.h>
 
+#include <smp.h>
 #include <vfs.h>
 
 #include "AttributeIndex.h"
@@ -63,6 +66,9 @@ const size_t kMaxActivationRequestSize = 10 * 1024 * 1024;
 // sanity limit for activation file size
 const size_t kMaxActivationFileSize = 10 * 1024 * 1024;
 
+// maximum number of threads loading the initial packages
+static const int32 kMaxPackageLoaderThreads = 8;
+
 static const char* const kAdministrativeDirectoryName
 	= PACKAGES_DIRECTORY_ADMIN_DIRECTORY;
 static const char* const kActivationFileName
@@ -161,6 +167,139 @@ private:
 };
 
 
+// #pragma mark - InitialPackageLoader
+
+
+/*!	Loads the packages to be added when mounting the volume. Reading and
+	parsing the package files is independent for each package, so it is
+	distributed over several threads. Adding the packages and their contents
+	to the volume is left to the caller, which must do that in order.
+*/
+struct Volume::InitialPackageLoader {
+public:
+	InitialPackageLoader(Volume* volume, PackagesDirectory* packagesDirectory)
+		:
+		fVolume(volume),
+		fPackagesDirectory(packagesDirectory),
+		fItems(NULL),
+		fCount(0),
+		fCapacity(0),
+		fNextItem(0)
+	{
+	}
+
+	~InitialPackageLoader()
+	{
+		for (int32 i = 0; i < fCount; i++) {
+			free(fItems[i].name);
+			if (fItems[i].package != NULL)
+				fItems[i].package->ReleaseReference();
+		}
+		free(fItems);
+	}
+
+	status_t AddPackage(const char* name)
+	{
+		if (fCount == fCapacity) {
+			int32 capacity = std::max(fCapacity * 2, (int32)64);
+			Item* items = (Item*)realloc(fItems, capacity * sizeof(Item));
+			if (items == NULL)
+				RETURN_ERROR(B_NO_MEMORY);
+			fItems = items;
+			fCapacity = capacity;
+		}
+
+		Item& item = fItems[fCount];
+		item.name = strdup(name);
+		if (item.name == NULL)
+			RETURN_ERROR(B_NO_MEMORY);
+		item.package = NULL;
+		item.error = B_OK;
+		fCount++;
+
+		return B_OK;
+	}
+
+	void Load()
+	{
+		int32 threadCount = std::min(
+			std::min(smp_get_num_cpus(), kMaxPackageLoaderThreads),
+			fCount);
+
+		// this thread does its share of the work as well
+		thread_id threads[kMaxPackageLoaderThreads];
+		int32 spawnedCount = 0;
+		for (; spawnedCount < threadCount - 1; spawnedCount++) {
+			thread_id thread = spawn_kernel_thread(&_LoaderThreadEntry,
+				"packagefs package loader", B_NORMAL_PRIORITY, this);
+			if (thread < 0)
+				break;
+			threads[spawnedCount] = thread;
+			resume_thread(thread);
+		}
+
+		_LoadPackages();
+
+		for (int32 i = 0; i < spawnedCount; i++)
+			wait_for_thread(threads[i], NULL);
+	}
+
+	int32 CountPackages() const
+	{
+		return fCount;
+	}
+
+	const char* NameAt(int32 index) const
+	{
+		return fItems[index].name;
+	}
+
+	Package* PackageAt(int32 index) const
+	{
+		return fItems[index].package;
+	}
+
+	status_t ErrorAt(int32 index) const
+	{
+		return fItems[index].error;
+	}
+
+private:
+	struct Item {
+		char*		name;
+		Package*	package;
+		status_t	error;
+	};
+
+	static status_t _LoaderThreadEntry(void* data)
+	{
+		((InitialPackageLoader*)data)->_LoadPackages();
+		return B_OK;
+	}
+
+	void _LoadPackages()
+	{
+		for (;;) {
+			int32 index = atomic_add(&fNextItem, 1);
+			if (index >= fCount)
+				break;
+
+			Item& item = fItems[index];
+			item.error = fVolume->_LoadPackage(fPackagesDirectory, item.name,
+				item.package);
+		}
+	}
+
+private:
+	Volume*				fVolume;
+	PackagesDirectory*	fPackagesDirectory;
+	Item*				fItems;
+	int32				fCount;
+	int32				fCapacity;
+	int32				fNextItem;
+};
+
+
 // #pragma mark - Volume
 
 
@@ -424,10 +563,14 @@ Volume::Mount(const char* parameterString)
 		RETURN_ERROR(error);
 
 	// add initial packages
+	bigtime_t startTime = system_time();
 	error = _AddInitialPackages();
 	if (error != B_OK)
 		RETURN_ERROR(error);
 
+	INFORM("Added %" B_PRIuSIZE " packages in %" B_PRId64 " ms\n",
+		fPackages.CountElements(), (system_time() - startTime) / 1000);
+
 	// publish the root node
 	fRootDirectory->AcquireReference();
 	error = PublishVNode(fRootDirectory);
@@ -864,7 +1007,8 @@ Volume::_AddInitialPackagesFromActivationFile(
 	// null-terminate to simplify parsing
 	fileContent[st.st_size] = '\0';
 
-	// parse the file and add the respective packages
+	// parse the file and load the respective packages
+	InitialPackageLoader loader(this, packagesDirectory);
 	const char* packageName = fileContent;
 	char* const fileContentEnd = fileContent + st.st_size;
 	while (packageName < fileContentEnd) {
@@ -884,15 +1028,14 @@ Volume::_AddInitialPackagesFromActivationFile(
 			RETURN_ERROR(B_BAD_DATA);
 		}
 
-		status_t error = _LoadAndAddInitialPackage(packagesDirectory,
-			packageName);
+		status_t error = loader.AddPackage(packageName);
 		if (error != B_OK)
 			RETURN_ERROR(error);
 
 		packageName = packageNameEnd + 1;
 	}
 
-	return B_OK;
+	return _LoadAndAddInitialPackages(loader, false);
 }
 
 
@@ -913,6 +1056,7 @@ Volume::_AddInitialPackagesFromDirectory()
 		RETURN_ERROR(errno);
 	}
 
+	InitialPackageLoader loader(this, fPackagesDirectory);
 	while (dirent* entry = readdir(dir.Get())) {
 		// skip "." and ".."
 		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
@@ -925,28 +1069,37 @@ Volume::_AddInitialPackagesFromDirectory()
 			continue;
 		}
 
-		_LoadAndAddInitialPackage(fPackagesDirectory, entry->d_name);
+		status_t error = loader.AddPackage(entry->d_name);
+		if (error != B_OK)
+			RETURN_ERROR(error);
 	}
 
-	return B_OK;
+	return _LoadAndAddInitialPackages(loader, true);
 }
 
 
 status_t
-Volume::_LoadAndAddInitialPackage(PackagesDirectory* packagesDirectory,
-	const char* name)
+Volume::_LoadAndAddInitialPackages(InitialPackageLoader& loader,
+	bool ignoreErrors)
 {
-	Package* package;
-	status_t error = _LoadPackage(packagesDirectory, name, package);
-	if (error != B_OK) {
-		ERROR("Failed to load package \"%s\": %s\n", name, strerror(error));
-		RETURN_ERROR(error);
-	}
-	BReference<Package> packageReference(package, true);
+	loader.Load();
 
 	VolumeWriteLocker systemVolumeLocker(_SystemVolumeIfNotSelf());
 	VolumeWriteLocker volumeLocker(this);
-	_AddPackage(package);
+
+	int32 count = loader.CountPackages();
+	for (int32 i = 0; i < count; i++) {
+		status_t error = loader.ErrorAt(i);
+		if (error != B_OK) {
+			ERROR("Failed to load package \"%s\": %s\n", loader.NameAt(i),
+				strerror(error));
+			if (ignoreErrors)
+				continue;
+			RETURN_ERROR(error);
+		}
+
+		_AddPackage(loader.PackageAt(i));
+	}
 
 	return B_OK;
 }
@@ -109,6 +109,7 @@ private:
 private:
 			struct ShineThroughDirectory;
 			struct ActivationChangeRequest;
+			struct InitialPackageLoader;
 
 private:
 			status_t			_LoadOldPackagesStates(
@@ -118,9 +119,9 @@ private:
 			status_t			_AddInitialPackagesFromActivationFile(
 									PackagesDirectory* packagesDirectory);
 			status_t			_AddInitialPackagesFromDirectory();
-			status_t			_LoadAndAddInitialPackage(
-									PackagesDirectory* packagesDirectory,
-									const char* name);
+			status_t			_LoadAndAddInitialPackages(
+									InitialPackageLoader& loader,
+									bool ignoreErrors);
 
 	inline	void				_AddPackage(Package* package);
 	inline	void				_RemovePackage(Package* package);
@@ -252,6 +252,49 @@ DataContainer::WriteAt(off_t offset, const void *_buffer, size_t size,
 }
 
 
+/*!	Moves \a offset to the start of the next data (or hole) at or after it.
+	Pages that have never been written to aren't in the cache and form the
+	holes; the end of the data counts as a hole, too.
+*/
+status_t
+DataContainer::SeekDataOrHole(off_t *offset, bool hole)
+{
+	if (*offset < 0)
+		return B_BAD_VALUE;
+	if (*offset >= fSize)
+		return ENXIO;
+
+	if (!_IsCacheMode()) {
+		// the small buffer has no holes
+		if (hole)
+			*offset = fSize;
+		return B_OK;
+	}
+
+	AutoLocker<VMCache> _(fCache);
+
+	page_num_t pageIndex = *offset / B_PAGE_SIZE;
+	VMCachePagesTree::Iterator it = fCache->pages.GetIterator(pageIndex, true,
+		true);
+	vm_page* page = it.Next();
+
+	if (!hole) {
+		if (page == NULL || (off_t)page->cache_offset * B_PAGE_SIZE >= fSize)
+			return ENXIO;
+		*offset = max_c(*offset, (off_t)page->cache_offset * B_PAGE_SIZE);
+		return B_OK;
+	}
+
+	while (page != NULL && page->cache_offset == pageIndex) {
+		pageIndex++;
+		page = it.Next();
+	}
+
+	*offset = min_c(max_c(*offset, (off_t)pageIndex * B_PAGE_SIZE), fSize);
+	return B_OK;
+}
+
+
 void
 DataContainer::GetAllocationInfo(AllocationInfo &info)
 {
@@ -35,6 +35,8 @@ public:
 	virtual status_t WriteAt(off_t offset, const void *buffer, size_t size,
 							 size_t *bytesWritten);
 
+	status_t SeekDataOrHole(off_t *offset, bool hole);
+
 	// debugging
 	void GetAllocationInfo(AllocationInfo &info);
 
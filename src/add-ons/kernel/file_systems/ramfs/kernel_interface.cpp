@@ -29,6 +29,7 @@
 #include <time.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 
 #include <fs_index.h>
@@ -290,7 +291,7 @@ ramfs_remove_vnode(fs_volume* _volume, fs_vnode* _node, bool /*reenter*/)
 
 
 static status_t
-ramfs_ioctl(fs_volume* _volume, fs_vnode* /*node*/, void* /*cookie*/,
+ramfs_ioctl(fs_volume* _volume, fs_vnode* _node, void* /*cookie*/,
 	uint32 cmd, void *buffer, size_t /*length*/)
 {
 	FUNCTION_START();
@@ -298,6 +299,20 @@ ramfs_ioctl(fs_volume* _volume, fs_vnode* /*node*/, void* /*cookie*/,
 
 	status_t error = B_OK;
 	switch (cmd) {
+		case FIOSEEKDATA:
+		case FIOSEEKHOLE:
+		{
+			VolumeReadLocker locker(volume);
+			if (!locker.IsLocked())
+				RETURN_ERROR(B_ERROR);
+
+			File* file = dynamic_cast<File*>((Node*)_node->private_node);
+			if (file == NULL)
+				RETURN_ERROR(B_BAD_VALUE);
+
+			error = file->SeekDataOrHole((off_t*)buffer, cmd == FIOSEEKHOLE);
+			break;
+		}
 		case RAMFS_IOCTL_GET_ALLOCATION_INFO:
 		{
 			if (buffer) {
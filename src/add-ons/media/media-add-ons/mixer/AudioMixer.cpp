@@ -1867,15 +1867,12 @@ AudioMixer::UpdateParameterWeb()
 
 	dp = group->MakeDiscreteParameter(PARAM_ETC(70), B_MEDIA_RAW_AUDIO,
 		B_TRANSLATE("Resampling algorithm:"), B_INPUT_MUX);
-	dp->AddItem(0, B_TRANSLATE("Low quality (drop/repeat samples)"));
-	dp->AddItem(2, B_TRANSLATE("High quality (linear interpolation)"));
-
-	// Note: The following code is outcommented on purpose
-	// and is about to be modified at a later point
-	/*
-	dp->AddItem(1, B_TRANSLATE("Drop/repeat samples (template based)"));
-	dp->AddItem(3, B_TRANSLATE("17th order filtering"));
-	*/
+	dp->AddItem(RESAMPLING_DROP_REPEAT,
+		B_TRANSLATE("Low quality (drop/repeat samples)"));
+	dp->AddItem(RESAMPLING_INTERPOLATE,
+		B_TRANSLATE("High quality (linear interpolation)"));
+	dp->AddItem(RESAMPLING_POLYPHASE_SINC,
+		B_TRANSLATE("Best quality (windowed sinc filter)"));
 
 	/* Remove those option from the GUI, but keep them in the settings
 	group->MakeDiscreteParameter(PARAM_ETC(80), B_MEDIA_RAW_AUDIO,
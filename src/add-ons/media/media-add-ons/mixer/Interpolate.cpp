@@ -13,6 +13,7 @@
 #include <MediaDefs.h>
 
 #include "MixerDebug.h"
+#include "MixerKernels.h"
 
 
 /*! Resampling class doing linear interpolation.
@@ -32,17 +33,8 @@ kernel(Resampler* object, const void *_src, int32 srcSampleOffset,
 
 	if (srcSampleCount == destSampleCount) {
 		// optimized case for no resampling
-		while (count--) {
-			float tmp = ((*(const inType*)src) - inMiddle) * gain + outMiddle;
-			if (tmp <= min)
-				*(outType *)dest = min;
-			else if (tmp >= max)
-				*(outType *)dest = max;
-			else
-				*(outType *)dest = (outType)tmp;
-			src += srcSampleOffset;
-			dest += destSampleOffset;
-		}
+		convert_samples<inType, outType, gnum, gden, inMiddle, outMiddle, min,
+			max>(src, srcSampleOffset, dest, destSampleOffset, count, gain);
 		return;
 	}
 
@@ -24,8 +24,10 @@
 #include "AudioMixer.h"
 #include "Interpolate.h"
 #include "MixerInput.h"
+#include "MixerKernels.h"
 #include "MixerOutput.h"
 #include "MixerUtils.h"
+#include "Polyphase.h"
 #include "Resampler.h"
 #include "RtList.h"
 
@@ -44,6 +46,8 @@
 
 	The mixer buffer uses either the same frame rate and same count of frames as
 	the output buffer, or the double frame rate and frame count.
+	Like the input ring buffers, it is planar: the frames of each channel
+	are stored one after the other.
 
 	All mixer input ring buffers must be an exact multiple of the mixer buffer
 	size, so that we do not get any buffer wrap around during reading from the
@@ -406,10 +410,14 @@ MixerCore::_UpdateResamplers(const media_multi_audio_format& format)
 	fResampler = new Resampler*[fMixBufferChannelCount];
 	for (int i = 0; i < fMixBufferChannelCount; i++) {
 		switch (Settings()->ResamplingAlgorithm()) {
-			case 2:
+			case RESAMPLING_INTERPOLATE:
 				fResampler[i] = new Interpolate(
 					media_raw_audio_format::B_AUDIO_FLOAT, format.format);
 				break;
+			case RESAMPLING_POLYPHASE_SINC:
+				fResampler[i] = new Polyphase(
+					media_raw_audio_format::B_AUDIO_FLOAT, format.format);
+				break;
 			default:
 				fResampler[i] = new Resampler(
 					media_raw_audio_format::B_AUDIO_FLOAT, format.format);
@@ -652,19 +660,21 @@ MixerCore::_MixThread()
 				chan_info* info = mixChanInfos[channel].ItemAt(i);
 				PRINT(5, "_MixThread:   base %p, sample-offset %2d, gain %.3f\n",
 					info->base, info->sample_offset, info->gain);
-				// This looks slightly ugly, but the current GCC will generate
-				// the fastest code this way.
-				// fMixBufferFrameCount is always > 0.
-				uint32 dstSampleOffset
-					= fMixBufferChannelCount * sizeof(float);
-				uint32 srcSampleOffset = info->sample_offset;
-				char* dst = (char*)&fMixBuffer[channel];
-				char* src = (char*)info->base;
+				// The mix buffers are planar, so we can use the vectorized
+				// kernel unless an input hands us interleaved samples.
+				float* dst = &fMixBuffer[channel * fMixBufferFrameCount];
 				float gain = info->gain;
+				if (info->sample_offset == sizeof(float)) {
+					mix_samples(dst, (const float*)info->base, gain,
+						fMixBufferFrameCount);
+					continue;
+				}
+
+				uint32 srcSampleOffset = info->sample_offset;
+				const char* src = info->base;
 				int j = fMixBufferFrameCount;
 				do {
-					*(float*)dst += *(const float*)src * gain;
-					dst += dstSampleOffset;
+					*dst++ += *(const float*)src * gain;
 					src += srcSampleOffset;
 				 } while (--j);
 			}
@@ -679,8 +689,7 @@ MixerCore::_MixThread()
 			// copy data from mix buffer into output buffer
 			for (int i = 0; i < fMixBufferChannelCount; i++) {
 				fResampler[i]->Resample(
-					reinterpret_cast<char*>(fMixBuffer) + i * sizeof(float),
-					fMixBufferChannelCount * sizeof(float),
+					&fMixBuffer[i * fMixBufferFrameCount], sizeof(float),
 					fMixBufferFrameCount,
 					reinterpret_cast<char*>(buffer->Data())
 						+ (i * bytes_per_sample(
@@ -17,6 +17,7 @@
 #include "Interpolate.h"
 #include "MixerInput.h"
 #include "MixerUtils.h"
+#include "Polyphase.h"
 #include "Resampler.h"
 
 
@@ -257,7 +258,7 @@ MixerInput::BufferReceived(BBuffer* buffer)
 		fLastDataFrameWritten = out_frames2 - 1;
 
 		// convert offset from frames into bytes
-		offset *= sizeof(float) * fInputChannelCount;
+		offset *= sizeof(float);
 
 		for (int i = 0; i < fInputChannelCount; i++) {
 			fResampler[i]->Resample(
@@ -265,7 +266,7 @@ MixerInput::BufferReceived(BBuffer* buffer)
 					+ i * bytes_per_sample(fInput.format.u.raw_audio),
 				bytes_per_frame(fInput.format.u.raw_audio), in_frames1,
 				reinterpret_cast<char*>(fInputChannelInfo[i].buffer_base)
-					+ offset, fInputChannelCount * sizeof(float), out_frames1,
+					+ offset, sizeof(float), out_frames1,
 				fInputChannelInfo[i].gain);
 
 			fResampler[i]->Resample(
@@ -274,7 +275,7 @@ MixerInput::BufferReceived(BBuffer* buffer)
 					+ in_frames1 * bytes_per_frame(fInput.format.u.raw_audio),
 				bytes_per_frame(fInput.format.u.raw_audio), in_frames2,
 				reinterpret_cast<char*>(fInputChannelInfo[i].buffer_base),
-				fInputChannelCount * sizeof(float), out_frames2,
+				sizeof(float), out_frames2,
 				fInputChannelInfo[i].gain);
 
 		}
@@ -293,15 +294,15 @@ MixerInput::BufferReceived(BBuffer* buffer)
 
 		fLastDataFrameWritten = offset + out_frames - 1;
 		// convert offset from frames into bytes
-		offset *= sizeof(float) * fInputChannelCount;
+		offset *= sizeof(float);
 		for (int i = 0; i < fInputChannelCount; i++) {
 			fResampler[i]->Resample(
 				reinterpret_cast<char*>(data)
 					+ i * bytes_per_sample(fInput.format.u.raw_audio),
 				bytes_per_frame(fInput.format.u.raw_audio), in_frames,
 				reinterpret_cast<char*>(fInputChannelInfo[i].buffer_base)
-					+ offset, fInputChannelCount * sizeof(float),
-				out_frames, fInputChannelInfo[i].gain);
+					+ offset, sizeof(float), out_frames,
+				fInputChannelInfo[i].gain);
 		}
 	}
 	fLastDataAvailableTime = start + buffer_duration;
@@ -320,11 +321,16 @@ MixerInput::UpdateResamplingAlgorithm()
 	fResampler = new Resampler*[fInputChannelCount];
 	for (int i = 0; i < fInputChannelCount; i++) {
 		switch (fCore->Settings()->ResamplingAlgorithm()) {
-			case 2:
+			case RESAMPLING_INTERPOLATE:
 				fResampler[i] = new Interpolate(
 					fInput.format.u.raw_audio.format,
 					media_raw_audio_format::B_AUDIO_FLOAT);
 				break;
+			case RESAMPLING_POLYPHASE_SINC:
+				fResampler[i] = new Polyphase(
+					fInput.format.u.raw_audio.format,
+					media_raw_audio_format::B_AUDIO_FLOAT);
+				break;
 			default:
 				fResampler[i] = new Resampler(
 					fInput.format.u.raw_audio.format,
@@ -557,8 +563,8 @@ MixerInput::_UpdateInputChannelDestinations()
 			if (fInputChannelInfo[j].destination_mask
 					& ChannelTypeToChannelMask(
 						fMixerChannelInfo[i].destination_type)) {
-				fMixerChannelInfo[i].buffer_base = fMixBuffer ? &fMixBuffer[j]
-					: 0;
+				fMixerChannelInfo[i].buffer_base
+					= fInputChannelInfo[j].buffer_base;
 				break;
 			}
 		}
@@ -726,8 +732,11 @@ MixerInput::SetMixBufferFormat(int32 framerate, int32 frames)
 
 	memset(fMixBuffer, 0, size);
 
-	for (int i = 0; i < fInputChannelCount; i++)
-		fInputChannelInfo[i].buffer_base = &fMixBuffer[i];
+	// the mix buffer is planar, one channel after the other
+	for (int i = 0; i < fInputChannelCount; i++) {
+		fInputChannelInfo[i].buffer_base
+			= &fMixBuffer[i * fMixBufferFrameCount];
+	}
 
 	_UpdateInputChannelDestinationMask();
 	_UpdateInputChannelDestinations();
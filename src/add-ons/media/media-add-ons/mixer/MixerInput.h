@@ -158,10 +158,8 @@ MixerInput::GetMixerChannelInfo(int mixerChannel, int64 framepos,
 		PRINT(3, "GetMixerChannelInfo: frames %ld to %ld\n", offset,
 			offset + fDebugMixBufferFrames - 1);
 	}
-	*buffer = reinterpret_cast<float*>(reinterpret_cast<char*>(
-		fMixerChannelInfo[mixerChannel].buffer_base)
-		+ (offset * sizeof(float) * fInputChannelCount));
-	*sampleOffset = sizeof(float) * fInputChannelCount;
+	*buffer = fMixerChannelInfo[mixerChannel].buffer_base + offset;
+	*sampleOffset = sizeof(float);
 	*type = fMixerChannelInfo[mixerChannel].destination_type;
 	*gain = fMixerChannelInfo[mixerChannel].destination_gain;
 	return true;
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2026 Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "MixerKernels.h"
+
+
+/*!	Adds \a count samples from \a source, multiplied by \a gain, to \a dest.
+*/
+void
+mix_samples(float* dest, const float* source, float gain, int32 count)
+{
+#ifdef __SSE2__
+	const __m128 gainVector = _mm_set1_ps(gain);
+
+	for (; count >= 8; count -= 8) {
+		__m128 first = _mm_add_ps(_mm_loadu_ps(dest),
+			_mm_mul_ps(_mm_loadu_ps(source), gainVector));
+		__m128 second = _mm_add_ps(_mm_loadu_ps(dest + 4),
+			_mm_mul_ps(_mm_loadu_ps(source + 4), gainVector));
+		_mm_storeu_ps(dest, first);
+		_mm_storeu_ps(dest + 4, second);
+
+		dest += 8;
+		source += 8;
+	}
+#endif
+
+	while (count-- > 0)
+		*dest++ += *source++ * gain;
+}
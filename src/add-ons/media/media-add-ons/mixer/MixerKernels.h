@@ -0,0 +1,172 @@
+/*
+ * Copyright 2026 Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _MIXER_KERNELS_H
+#define _MIXER_KERNELS_H
+
+
+#include <SupportDefs.h>
+
+#ifdef __SSE2__
+#	include <emmintrin.h>
+#endif
+
+
+/*!	The inner loops of the mixer.
+	The mix buffers of MixerCore and MixerInput are planar, so mixing only
+	ever sees contiguous samples. The format conversions still have to cope
+	with interleaved media buffers on one side; they work on four samples at
+	a time, gathering or scattering them when they are not contiguous.
+	The vector versions are used when the compiler targets SSE2 (which is
+	always the case on x86_64), everything else uses the scalar loops.
+*/
+
+
+void mix_samples(float* dest, const float* source, float gain, int32 count);
+
+
+#ifdef __SSE2__
+
+template<typename inType>
+static inline __m128
+load_samples(const char* src, int32 srcSampleOffset)
+{
+	return _mm_cvtepi32_ps(_mm_setr_epi32(*(const inType*)src,
+		*(const inType*)(src + srcSampleOffset),
+		*(const inType*)(src + 2 * srcSampleOffset),
+		*(const inType*)(src + 3 * srcSampleOffset)));
+}
+
+
+template<>
+inline __m128
+load_samples<float>(const char* src, int32 srcSampleOffset)
+{
+	if (srcSampleOffset == sizeof(float))
+		return _mm_loadu_ps((const float*)src);
+
+	return _mm_setr_ps(*(const float*)src,
+		*(const float*)(src + srcSampleOffset),
+		*(const float*)(src + 2 * srcSampleOffset),
+		*(const float*)(src + 3 * srcSampleOffset));
+}
+
+
+template<typename outType, int32 min, int32 max>
+static inline void
+store_samples(char* dest, int32 destSampleOffset, __m128 samples)
+{
+	// INT32_MAX can't be represented as a float, so the samples that reach
+	// the upper limit are patched in after the conversion
+	const __m128 maxValue = _mm_set1_ps(max);
+	__m128i clipped = _mm_castps_si128(_mm_cmpge_ps(samples, maxValue));
+	samples = _mm_min_ps(_mm_max_ps(samples, _mm_set1_ps(min)), maxValue);
+
+	__m128i converted = _mm_cvttps_epi32(samples);
+	converted = _mm_or_si128(_mm_andnot_si128(clipped, converted),
+		_mm_and_si128(clipped, _mm_set1_epi32(max)));
+
+	int32 values[4];
+	_mm_storeu_si128((__m128i*)values, converted);
+	for (int i = 0; i < 4; i++) {
+		*(outType*)dest = (outType)values[i];
+		dest += destSampleOffset;
+	}
+}
+
+
+template<>
+inline void
+store_samples<float, -1, 1>(char* dest, int32 destSampleOffset,
+	__m128 samples)
+{
+	samples = _mm_min_ps(_mm_max_ps(samples, _mm_set1_ps(-1.0f)),
+		_mm_set1_ps(1.0f));
+
+	if (destSampleOffset == sizeof(float)) {
+		_mm_storeu_ps((float*)dest, samples);
+		return;
+	}
+
+	float values[4];
+	_mm_storeu_ps(values, samples);
+	for (int i = 0; i < 4; i++) {
+		*(float*)dest = values[i];
+		dest += destSampleOffset;
+	}
+}
+
+#endif	// __SSE2__
+
+
+/*!	Converts \a count samples from \a inType to \a outType, applying \a gain
+	(which already includes the gnum/gden scale of the conversion), and
+	clipping the result to [min, max].
+	The template parameters are the same as for the resampler kernels.
+*/
+template<typename inType, typename outType, int gnum, int gden,
+	int inMiddle, int outMiddle, int32 min, int32 max>
+static inline void
+convert_samples(const char* src, int32 srcSampleOffset, char* dest,
+	int32 destSampleOffset, int32 count, float gain)
+{
+#ifdef __SSE2__
+	const __m128 gainVector = _mm_set1_ps(gain);
+	const __m128 inMiddleVector = _mm_set1_ps(inMiddle);
+	const __m128 outMiddleVector = _mm_set1_ps(outMiddle);
+
+	for (; count >= 4; count -= 4) {
+		__m128 samples = load_samples<inType>(src, srcSampleOffset);
+		samples = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(samples, inMiddleVector),
+			gainVector), outMiddleVector);
+		store_samples<outType, min, max>(dest, destSampleOffset, samples);
+
+		src += 4 * srcSampleOffset;
+		dest += 4 * destSampleOffset;
+	}
+#endif
+
+	while (count--) {
+		float tmp = ((*(const inType*)src) - inMiddle) * gain + outMiddle;
+		if (tmp <= min)
+			*(outType*)dest = min;
+		else if (tmp >= max)
+			*(outType*)dest = max;
+		else
+			*(outType*)dest = (outType)tmp;
+		src += srcSampleOffset;
+		dest += destSampleOffset;
+	}
+}
+
+
+/*!	Returns the dot product of two arrays of \a count floats, \a count being
+	a multiple of four.
+*/
+static inline float
+dot_product(const float* a, const float* b, int32 count)
+{
+#ifdef __SSE2__
+	__m128 sum = _mm_setzero_ps();
+	for (int32 i = 0; i < count; i += 4)
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i),
+			_mm_loadu_ps(b + i)));
+
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum);
+#else
+	float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+	for (int32 i = 0; i < count; i += 4) {
+		sum0 += a[i] * b[i];
+		sum1 += a[i + 1] * b[i + 1];
+		sum2 += a[i + 2] * b[i + 2];
+		sum3 += a[i + 3] * b[i + 3];
+	}
+	return (sum0 + sum1) + (sum2 + sum3);
+#endif
+}
+
+
+#endif	// _MIXER_KERNELS_H
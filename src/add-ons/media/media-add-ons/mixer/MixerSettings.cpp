@@ -401,7 +401,7 @@ MixerSettings::Load()
 	fSettings.AllowOutputChannelRemapping = false;
 	fSettings.AllowInputChannelRemapping = false;
 	fSettings.InputGainControls = 0;
-	fSettings.ResamplingAlgorithm = 2;
+	fSettings.ResamplingAlgorithm = RESAMPLING_INTERPOLATE;
 	fSettings.RefuseOutputFormatChange = false;
 	fSettings.RefuseInputFormatChange = true;
 
@@ -16,6 +16,13 @@ class MixerOutput;
 
 #define MAX_INPUT_SETTINGS	50
 
+// values of the ResamplingAlgorithm setting
+enum {
+	RESAMPLING_DROP_REPEAT		= 0,
+	RESAMPLING_INTERPOLATE		= 2,
+	RESAMPLING_POLYPHASE_SINC	= 3
+};
+
 class MixerSettings {
 	public:
 										MixerSettings();
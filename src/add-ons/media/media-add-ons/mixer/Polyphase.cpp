@@ -0,0 +1,304 @@
+/*
+ * Copyright 2026 Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "Polyphase.h"
+
+#include <math.h>
+#include <new>
+#include <string.h>
+
+#include <Autolock.h>
+#include <Locker.h>
+#include <MediaDefs.h>
+
+#include "MixerDebug.h"
+#include "MixerKernels.h"
+
+
+/*!	Resampling class using a windowed sinc filter.
+	The filter is stored as a polyphase table: kPhases + 1 rows of kTaps
+	coefficients, one row for each fractional position between two input
+	samples. The output is linearly interpolated between the two rows
+	nearest to its position.
+	When downsampling, the cut off frequency of the filter follows the
+	output rate. The tables only depend on the (quantized) cut off, so they
+	are computed once and shared by all resamplers of the mixer.
+	The last kTaps input samples are kept between calls, so the output is
+	delayed by kHalfTaps input samples.
+*/
+
+
+static const int32 kCutoffSteps = 64;
+static const double kKaiserBeta = 8.0;
+
+
+class TableCache {
+public:
+								TableCache();
+								~TableCache();
+
+			const float*		TableFor(int32 cutoff);
+
+private:
+			BLocker				fLock;
+			float*				fTables[kCutoffSteps + 1];
+};
+
+
+static TableCache sTableCache;
+
+
+static double
+bessel_i0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+
+TableCache::TableCache()
+	:
+	fLock("mixer polyphase tables")
+{
+	memset(fTables, 0, sizeof(fTables));
+}
+
+
+TableCache::~TableCache()
+{
+	for (int32 i = 0; i <= kCutoffSteps; i++)
+		delete[] fTables[i];
+}
+
+
+const float*
+TableCache::TableFor(int32 cutoffStep)
+{
+	BAutolock _(fLock);
+
+	if (fTables[cutoffStep] != NULL)
+		return fTables[cutoffStep];
+
+	float* table = new(std::nothrow) float[(Polyphase::kPhases + 1)
+		* Polyphase::kTaps];
+	if (table == NULL)
+		return NULL;
+
+	const double cutoff = double(cutoffStep) / kCutoffSteps;
+	const double windowScale = 1.0 / bessel_i0(kKaiserBeta);
+
+	for (int32 phase = 0; phase <= Polyphase::kPhases; phase++) {
+		float* row = table + phase * Polyphase::kTaps;
+		double sum = 0;
+		for (int32 tap = 0; tap < Polyphase::kTaps; tap++) {
+			// distance between the input sample and the output position
+			double x = tap - Polyphase::kHalfTaps + 1
+				- double(phase) / Polyphase::kPhases;
+			double relative = x / Polyphase::kHalfTaps;
+			double value = 0;
+			if (relative > -1.0 && relative < 1.0) {
+				double sinc = x == 0 ? 1.0
+					: sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+				value = sinc * bessel_i0(kKaiserBeta
+					* sqrt(1.0 - relative * relative)) * windowScale;
+			}
+			row[tap] = value;
+			sum += value;
+		}
+
+		// normalize every phase to unity gain
+		for (int32 tap = 0; tap < Polyphase::kTaps; tap++)
+			row[tap] /= sum;
+	}
+
+	TRACE("Polyphase: created table for cut off %.3f\n", cutoff);
+
+	fTables[cutoffStep] = table;
+	return table;
+}
+
+
+// #pragma mark -
+
+
+template<typename inType, typename outType, int gnum, int gden,
+	int inMiddle, int outMiddle, int32 min, int32 max> static void
+kernel(Resampler* object, const void *_src, int32 srcSampleOffset,
+	int32 srcSampleCount, void *_dest, int32 destSampleOffset,
+	int32 destSampleCount, float _gain)
+{
+	Polyphase* polyphase = (Polyphase*)object;
+	const char * src = (const char *)_src;
+	char * dest = (char *)_dest;
+	float gain = _gain * gnum / gden;
+
+	if (srcSampleCount == destSampleCount && !polyphase->fFiltering) {
+		// optimized case for no resampling; once we started filtering,
+		// we have to continue to do so to keep the delay constant
+		convert_samples<inType, outType, gnum, gden, inMiddle, outMiddle, min,
+			max>(src, srcSampleOffset, dest, destSampleOffset,
+			destSampleCount, gain);
+		return;
+	}
+
+	if (srcSampleCount <= 0 || destSampleCount <= 0)
+		return;
+
+	const float* table = polyphase->Table(srcSampleCount, destSampleCount);
+	if (table == NULL)
+		return;
+
+	polyphase->fFiltering = true;
+
+	float* buffer = polyphase->fBuffer;
+	float* block = buffer + Polyphase::kTaps;
+	int32 loaded = 0;
+	int32 count = 0;
+
+	while (count < destSampleCount) {
+		// append the next block of input samples to the history
+		int32 first = loaded;
+		int32 samples = srcSampleCount - loaded;
+		if (samples > Polyphase::kBlockSize)
+			samples = Polyphase::kBlockSize;
+
+		for (int32 i = 0; i < samples; i++) {
+			block[i] = *(const inType*)src - inMiddle;
+			src += srcSampleOffset;
+		}
+		loaded += samples;
+
+		// compute all output samples whose filter ends within this block
+		for (; count < destSampleCount; count++) {
+			int64 position = (int64)count * srcSampleCount;
+			int32 index = position / destSampleCount;
+			if (index >= loaded)
+				break;
+
+			float fraction = float(position % destSampleCount)
+				* Polyphase::kPhases / destSampleCount;
+			int32 phase = (int32)fraction;
+			fraction -= phase;
+
+			const float* window = buffer + index - first + 1;
+			const float* row = table + phase * Polyphase::kTaps;
+			float sample = dot_product(window, row, Polyphase::kTaps);
+			float next = dot_product(window, row + Polyphase::kTaps,
+				Polyphase::kTaps);
+
+			float tmp = (sample + (next - sample) * fraction) * gain
+				+ outMiddle;
+			if (tmp <= min)
+				*(outType *)dest = min;
+			else if (tmp >= max)
+				*(outType *)dest = max;
+			else
+				*(outType *)dest = (outType)tmp;
+
+			dest += destSampleOffset;
+		}
+
+		// keep the last kTaps samples as history
+		memmove(buffer, buffer + samples, Polyphase::kTaps * sizeof(float));
+	}
+}
+
+
+Polyphase::Polyphase(uint32 src_format, uint32 dst_format)
+	:
+	Resampler(),
+	fFiltering(false),
+	fTable(NULL),
+	fTableCutoff(-1)
+{
+	memset(fBuffer, 0, sizeof(fBuffer));
+
+	if (dst_format == media_raw_audio_format::B_AUDIO_FLOAT) {
+		switch (src_format) {
+			case media_raw_audio_format::B_AUDIO_FLOAT:
+				fFunc = &kernel<float, float, 1, 1, 0, 0, -1, 1>;
+				return;
+			case media_raw_audio_format::B_AUDIO_INT:
+				fFunc = &kernel<int32, float, 1, INT32_MAX, 0, 0, -1, 1>;
+				return;
+			case media_raw_audio_format::B_AUDIO_SHORT:
+				fFunc = &kernel<int16, float, 1, INT16_MAX, 0, 0, -1, 1>;
+				return;
+			case media_raw_audio_format::B_AUDIO_CHAR:
+				fFunc = &kernel<int8, float, 1, INT8_MAX, 0, 0, -1, 1>;
+				return;
+			case media_raw_audio_format::B_AUDIO_UCHAR:
+				fFunc = &kernel<uint8, float, 2, UINT8_MAX, 128, 0, -1, 1>;
+				return;
+			default:
+				ERROR("Polyphase::Polyphase: unknown source format 0x%x\n",
+					src_format);
+				return;
+		}
+	}
+
+	if (src_format == media_raw_audio_format::B_AUDIO_FLOAT) {
+		switch (dst_format) {
+			// float=>float already handled above
+			case media_raw_audio_format::B_AUDIO_INT:
+				fFunc = &kernel<float, int32, INT32_MAX, 1, 0, 0,
+					INT32_MIN, INT32_MAX>;
+				return;
+			case media_raw_audio_format::B_AUDIO_SHORT:
+				fFunc = &kernel<float, int16, INT16_MAX, 1, 0, 0,
+					INT16_MIN, INT16_MAX>;
+				return;
+			case media_raw_audio_format::B_AUDIO_CHAR:
+				fFunc = &kernel<float, int8, INT8_MAX, 1, 0, 0,
+					INT8_MIN, INT8_MAX>;
+				return;
+			case media_raw_audio_format::B_AUDIO_UCHAR:
+				fFunc = &kernel<float, uint8, UINT8_MAX, 2, 0, 128,
+					0, UINT8_MAX>;
+				return;
+			default:
+				ERROR("Polyphase::Polyphase: unknown destination format "
+					"0x%x\n", dst_format);
+				return;
+		}
+	}
+
+	ERROR("Polyphase::Polyphase: source or destination format must be "
+		"B_AUDIO_FLOAT\n");
+}
+
+
+/*!	Returns the filter table to use for the given conversion ratio.
+	The table is only looked up again when the cut off frequency changes,
+	which usually only happens once per stream.
+*/
+const float*
+Polyphase::Table(int32 srcSampleCount, int32 destSampleCount)
+{
+	int32 cutoff = kCutoffSteps;
+	if (destSampleCount < srcSampleCount) {
+		// leave some room for the transition band below the output's
+		// Nyquist frequency
+		cutoff = int32(0.95 * kCutoffSteps * destSampleCount
+			/ srcSampleCount);
+		if (cutoff < 1)
+			cutoff = 1;
+	}
+
+	if (cutoff != fTableCutoff) {
+		fTable = sTableCache.TableFor(cutoff);
+		fTableCutoff = fTable != NULL ? cutoff : -1;
+	}
+
+	return fTable;
+}
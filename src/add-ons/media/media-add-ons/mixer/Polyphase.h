@@ -0,0 +1,37 @@
+/*
+ * Copyright 2026 Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _POLYPHASE_H
+#define _POLYPHASE_H
+
+
+#include "Resampler.h"
+
+
+class Polyphase: public Resampler {
+public:
+	// half the number of taps of the filter
+	static	const int32		kHalfTaps = 16;
+	static	const int32		kTaps = 2 * kHalfTaps;
+	static	const int32		kPhases = 256;
+	static	const int32		kBlockSize = 512;
+
+							Polyphase(uint32 sourceFormat,
+								uint32 destFormat);
+
+			const float*	Table(int32 srcSampleCount,
+								int32 destSampleCount);
+
+			// the last kTaps input samples, followed by the ones that are
+			// still being worked on
+			float			fBuffer[kTaps + kBlockSize];
+			bool			fFiltering;
+
+private:
+			const float*	fTable;
+			int32			fTableCutoff;
+};
+
+
+#endif	// _POLYPHASE_H
@@ -71,6 +71,11 @@ struct avformat_codec_context {
 };
 
 
+// An open GOP rarely has more than a handful of leading frames; if the
+// timestamps don't tell when we are past them, we give up after this many.
+static const int32 kMaxLeadingFramesAfterSeek = 16;
+
+
 // profiling related globals
 #define DO_PROFILING 0
 #if DO_PROFILING
@@ -96,6 +101,10 @@ AVCodecDecoder::AVCodecDecoder()
 	fRawDecodedAudio(av_frame_alloc()),
 
 	fCodecInitDone(false),
+	fThreadCount(0),
+	fSeekTime(-1),
+	fSeekPacketPts(AV_NOPTS_VALUE),
+	fLeadingFramesDropped(0),
 
 #if USE_SWS_FOR_COLOR_SPACE_CONVERSION
 	fSwsContext(NULL),
@@ -270,8 +279,16 @@ AVCodecDecoder::SeekedTo(int64 frame, bigtime_t time)
 	if (fCodecInitDone) {
 		avcodec_flush_buffers(fCodecContext);
 		_ResetTempPacket();
+		av_frame_unref(fRawDecodedPicture);
 	}
 
+	// Decoders may still return the leading frames of an open GOP that
+	// precede the key frame we seeked to; they reference frames from before
+	// the seek and are dropped.
+	fSeekTime = fIsAudio ? -1 : time;
+	fSeekPacketPts = AV_NOPTS_VALUE;
+	fLeadingFramesDropped = 0;
+
 	// Flush internal buffers as well.
 	free(fChunkBuffer);
 	fChunkBuffer = NULL;
@@ -286,6 +303,14 @@ AVCodecDecoder::SeekedTo(int64 frame, bigtime_t time)
 }
 
 
+status_t
+AVCodecDecoder::SetThreadCount(int32 count)
+{
+	fThreadCount = count;
+	return B_OK;
+}
+
+
 status_t
 AVCodecDecoder::NegotiateOutputFormat(media_format* inOutFormat)
 {
@@ -307,12 +332,25 @@ AVCodecDecoder::NegotiateOutputFormat(media_format* inOutFormat)
 	fCodecContext = avcodec_alloc_context3(fCodec);
 	fCodecInitDone = false;
 
-	system_info info;
-	get_system_info(&info);
+	int32 threadCount = fThreadCount;
+	if (threadCount == 0) {
+		system_info info;
+		get_system_info(&info);
+		threadCount = min_c(info.cpu_count, 16);
+	}
 
 	fCodecContext->err_recognition = AV_EF_CAREFUL;
 	fCodecContext->error_concealment = 3;
-	fCodecContext->thread_count = info.cpu_count;
+	fCodecContext->thread_count = threadCount;
+	if (!fIsAudio) {
+		// Frame threading decodes several frames in parallel, at the cost
+		// of a delay of one frame per thread; slice threading is used for
+		// codecs that don't support it.
+		fCodecContext->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+	}
+	fSeekTime = -1;
+	fSeekPacketPts = AV_NOPTS_VALUE;
+	fLeadingFramesDropped = 0;
 
 	if (fIsAudio)
 		return _NegotiateAudioOutputFormat(inOutFormat);
@@ -1254,13 +1292,13 @@ AVCodecDecoder::_DecodeNextVideoFrame()
 	bigtime_t startTime = system_time();
 #endif
 
-	error = avcodec_receive_frame(fCodecContext, fRawDecodedPicture);
+	do {
+		error = avcodec_receive_frame(fCodecContext, fRawDecodedPicture);
 
-	if (error == AVERROR_EOF)
-		return B_LAST_BUFFER_ERROR;
+		if (error == AVERROR_EOF)
+			return B_LAST_BUFFER_ERROR;
 
-	if (error == AVERROR(EAGAIN)) {
-		do {
+		while (error != 0) {
 			status_t loadingChunkStatus
 				= _LoadNextChunkIfNeededAndAssignStartTime();
 			if (loadingChunkStatus == B_LAST_BUFFER_ERROR)
@@ -1278,23 +1316,31 @@ AVCodecDecoder::_DecodeNextVideoFrame()
 				timestamp);
 
 			send_error = avcodec_send_packet(fCodecContext, fTempPacket);
-			if (send_error < 0 && send_error != AVERROR(EAGAIN)) {
-				TRACE("[v] AVCodecDecoder: ignoring error in decoding frame %" B_PRId64 ": %d\n",
-					fFrame, error);
+			if (send_error != AVERROR(EAGAIN)) {
+				if (send_error < 0) {
+					TRACE("[v] AVCodecDecoder: ignoring error in decoding "
+						"frame %" B_PRId64 ": %d\n", fFrame, send_error);
+				} else if (fSeekTime >= 0 && fSeekPacketPts == AV_NOPTS_VALUE) {
+					// the key frame we seeked to; frames presented before it
+					// are the leading ones
+					fSeekPacketPts = fTempPacket->pts;
+				}
+
+				// Packet is consumed, clear it
+				fTempPacket->data = NULL;
+				fTempPacket->size = 0;
 			}
-
-			// Packet is consumed, clear it
-			fTempPacket->data = NULL;
-			fTempPacket->size = 0;
+				// Otherwise the decoder wants us to take out a frame first,
+				// which happens all the time with frame threading. The
+				// packet is kept and sent again in the next round.
 
 			error = avcodec_receive_frame(fCodecContext, fRawDecodedPicture);
 			if (error != 0 && error != AVERROR(EAGAIN)) {
 				TRACE("[v] frame %" B_PRId64 " decoding error: error code: %d, chunk size: %ld\n",
 					fFrame, error, fChunkBufferSize);
 			}
-
-		} while (error != 0);
-	}
+		}
+	} while (_DiscardLeadingVideoFrameAfterSeek());
 
 #if DO_PROFILING
 	bigtime_t formatConversionStart = system_time();
@@ -1538,18 +1584,69 @@ AVCodecDecoder::_FlushOneVideoFrameFromDecoderBuffer()
 	avcodec_send_packet(fCodecContext, NULL);
 
 	// Get any remaining frame
-	int error = avcodec_receive_frame(fCodecContext, fRawDecodedPicture);
+	int error;
+	do {
+		error = avcodec_receive_frame(fCodecContext, fRawDecodedPicture);
 
-	if (error != 0 && error != AVERROR(EAGAIN)) {
-		// video buffer is flushed successfully
-		// (or there is an error, not much we can do about it)
-		return B_LAST_BUFFER_ERROR;
-	}
+		if (error != 0 && error != AVERROR(EAGAIN)) {
+			// video buffer is flushed successfully
+			// (or there is an error, not much we can do about it)
+			return B_LAST_BUFFER_ERROR;
+		}
+	} while (error == 0 && _DiscardLeadingVideoFrameAfterSeek());
 
 	return _HandleNewVideoFrameAndUpdateSystemState();
 }
 
 
+/*! \brief Drops the frame in fRawDecodedPicture if it is one of the leading
+		frames of an open GOP that the decoder returns after a seek.
+
+	Those frames are presented before the key frame we seeked to, but
+	reference frames from before it, so they can't be decoded correctly.
+	They are recognized by a best effort timestamp earlier than the pts of
+	the first packet sent after the seek, which is in the same time base.
+	Without timestamps, frames are dropped until one is flagged as a key
+	frame. Either way, no more than kMaxLeadingFramesAfterSeek frames are
+	dropped.
+
+	\returns \c true if the frame was dropped, and the caller should get the
+		next one from the decoder.
+*/
+bool
+AVCodecDecoder::_DiscardLeadingVideoFrameAfterSeek()
+{
+	if (fSeekTime < 0)
+		return false;
+
+	int64 timestamp = fRawDecodedPicture->best_effort_timestamp;
+	bool leading;
+	if (fSeekPacketPts != AV_NOPTS_VALUE && timestamp != AV_NOPTS_VALUE)
+		leading = timestamp < fSeekPacketPts;
+	else {
+#if LIBAVCODEC_VERSION_MAJOR >= 60
+		leading = (fRawDecodedPicture->flags & AV_FRAME_FLAG_KEY) == 0;
+#else
+		leading = fRawDecodedPicture->key_frame == 0;
+#endif
+	}
+
+	if (!leading || fLeadingFramesDropped >= kMaxLeadingFramesAfterSeek) {
+		fSeekTime = -1;
+		return false;
+	}
+
+	fLeadingFramesDropped++;
+
+	TRACE("[v] dropping leading frame at %" B_PRId64 " after seeking to "
+		"%" B_PRIdBIGTIME "\n", fRawDecodedPicture->best_effort_timestamp,
+		fSeekTime);
+
+	av_frame_unref(fRawDecodedPicture);
+	return true;
+}
+
+
 /*! \brief Updates relevant fields of the class member fHeader with the
 		properties of the most recently decoded video frame.
 
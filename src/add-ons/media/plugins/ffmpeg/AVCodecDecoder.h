@@ -65,6 +65,8 @@ public:
 
 	virtual	status_t	SeekedTo(int64 trame, bigtime_t time);
 
+	virtual	status_t	SetThreadCount(int32 count);
+
 
 private:
 			void		_ResetTempPacket();
@@ -97,6 +99,7 @@ private:
 							size_t chunkSize);
 			status_t	_HandleNewVideoFrameAndUpdateSystemState();
 			status_t	_FlushOneVideoFrameFromDecoderBuffer();
+			bool		_DiscardLeadingVideoFrameAfterSeek();
 			void		_UpdateMediaHeaderForVideoFrame();
 			status_t	_DeinterlaceAndColorConvertVideoFrame();
 
@@ -127,6 +130,15 @@ private:
 			AVFrame*			fRawDecodedAudio;
 
 			bool 				fCodecInitDone;
+			int32				fThreadCount;
+									// 0 means one thread per CPU
+			bigtime_t			fSeekTime;
+									// start time of the key frame we seeked
+									// to, or -1 once we are past it
+			int64				fSeekPacketPts;
+									// pts of the first packet sent after the
+									// seek, AV_NOPTS_VALUE until then
+			int32				fLeadingFramesDropped;
 
 			gfx_convert_func	fFormatConversionFunc;
 #if USE_SWS_FOR_COLOR_SPACE_CONVERSION
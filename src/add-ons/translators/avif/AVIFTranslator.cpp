@@ -15,6 +15,7 @@
 #include <TranslatorRoster.h>
 
 #include <assert.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -67,6 +68,13 @@ static const translation_format sInputFormats[] = {
 	},
 };
 
+// The signatures of the input formats, so that the roster can skip this
+// translator for other data; the brands are checked by Identify()
+const translation_signature input_signatures[] = {
+	{ AVIF_IMAGE_FORMAT, 4, 4, { 'f', 't', 'y', 'p' } },
+	{ 0 }
+};
+
 
 // The output formats that this translator knows how to write
 static const translation_format sOutputFormats[] = {
@@ -438,6 +446,21 @@ AVIFTranslator::_TranslateFromAVIF(BPositionIO* stream, BMessage* ioExtension,
 		return B_ILLEGAL_DATA;
 
 	avifImage* image = decoder->image;
+
+	// AV1 cannot be decoded at a reduced size, but when the caller only needs
+	// a smaller image, scaling the planes down first still makes the color
+	// conversion and the returned bitmap that much cheaper.
+	float scale = bitmap_target_scale(ioExtension, image->width,
+		image->height);
+	if (scale < 1.0f) {
+		uint32 scaledWidth = max_c(1, (uint32)ceilf(image->width * scale));
+		uint32 scaledHeight = max_c(1, (uint32)ceilf(image->height * scale));
+		if (avifImageScale(image, scaledWidth, scaledHeight, &decoder->diag)
+				!= AVIF_RESULT_OK) {
+			return B_ILLEGAL_DATA;
+		}
+	}
+
 	int width = image->width;
 	int height = image->height;
 	avifRGBFormat format;
@@ -72,6 +72,13 @@ static const translation_format sInputFormats[] = {
 	}
 };
 
+// The signatures of the input formats, so that the roster can skip this
+// translator for other data
+const translation_signature input_signatures[] = {
+	{ GIF_TYPE, 0, 4, { 'G', 'I', 'F', '8' } },
+	{ 0 }
+};
+
 static const translation_format sOutputFormats[] = {
 	{
 		GIF_TYPE,
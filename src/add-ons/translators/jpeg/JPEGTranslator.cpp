@@ -84,6 +84,13 @@ static const translation_format sInputFormats[] = {
 		B_TRANSLATOR_BITMAP_MIME_STRING, B_TRANSLATOR_BITMAP_DESCRIPTION }
 };
 
+// Define the signatures of the formats we read, so that the roster can skip
+// us for other data
+const translation_signature input_signatures[] = {
+	{ JPEG_FORMAT, 0, 3, { 0xff, 0xd8, 0xff } },
+	{ 0 }
+};
+
 // Define the formats we know how to write
 static const translation_format sOutputFormats[] = {
 	{ JPEG_FORMAT, B_TRANSLATOR_BITMAP, 0.5, 0.5,
@@ -1133,9 +1140,6 @@ JPEGTranslator::Decompress(BPositionIO* in, BPositionIO* out,
 		}
 	}
 
-	// Initialize decompression
-	jpeg_start_decompress(&cinfo);
-
 	// retrieve orientation from settings/EXIF
 	int32 orientation;
 	if (ioExtension == NULL
@@ -1144,6 +1148,21 @@ JPEGTranslator::Decompress(BPositionIO* in, BPositionIO* out,
 			orientation = 1;
 	}
 
+	// If the caller only needs a smaller image, let the IDCT produce it
+	// directly; libjpeg can scale by 1/2, 1/4, and 1/8 almost for free.
+	float scale = orientation > 4
+		? bitmap_target_scale(ioExtension, cinfo.image_height,
+			cinfo.image_width)
+		: bitmap_target_scale(ioExtension, cinfo.image_width,
+			cinfo.image_height);
+	cinfo.scale_num = 1;
+	cinfo.scale_denom = 1;
+	while (cinfo.scale_denom < 8 && scale * cinfo.scale_denom * 2 <= 1.0f)
+		cinfo.scale_denom *= 2;
+
+	// Initialize decompression
+	jpeg_start_decompress(&cinfo);
+
 	if (orientation != 1 && converter == NULL)
 		converter = translate_8;
 
@@ -74,6 +74,13 @@ static const translation_format sInputFormats[] = {
 	}
 };
 
+// The signatures of the input formats, so that the roster can skip this
+// translator for other data
+const translation_signature input_signatures[] = {
+	{ B_PNG_FORMAT, 0, 8, { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' } },
+	{ 0 }
+};
+
 // The output formats that this translator supports.
 static const translation_format sOutputFormats[] = {
 	{
@@ -304,9 +311,40 @@ void alert_warning(png_structp ppng, png_const_charp error_msg)
 	// so the warnings are just ignored.
 }
 
+// Adds a row of width 4 byte pixels to the sums of the blocks of factor
+// pixels they fall into
+static void
+add_to_block_sums(const uint8 *row, uint32 *sums, png_uint_32 width,
+	uint32 factor)
+{
+	for (png_uint_32 x = 0; x < width; x++) {
+		uint32 *sum = sums + x / factor * 4;
+		sum[0] += row[0];
+		sum[1] += row[1];
+		sum[2] += row[2];
+		sum[3] += row[3];
+		row += 4;
+	}
+}
+
+// Writes the averages of the block sums of rows rows of width pixels to row,
+// and resets the sums
+static void
+average_block_sums(uint32 *sums, uint8 *row, png_uint_32 width, uint32 factor,
+	uint32 rows)
+{
+	for (png_uint_32 x = 0; x < width; x += factor) {
+		uint32 count = min_c(factor, width - x) * rows;
+		for (int32 i = 0; i < 4; i++) {
+			*row++ = (*sums + count / 2) / count;
+			*sums++ = 0;
+		}
+	}
+}
+
 status_t
 PNGTranslator::translate_from_png_to_bits(BPositionIO *inSource,
-	BPositionIO *outDestination)
+	BMessage *ioExtension, BPositionIO *outDestination)
 {
 	if (identify_png_header(inSource, NULL) != B_OK)
 		return B_NO_TRANSLATOR;
@@ -322,6 +360,10 @@ PNGTranslator::translate_from_png_to_bits(BPositionIO *inSource,
 	uint8 **prows = NULL, *prow = NULL;
 	png_uint_32 nalloc = 0;
 
+	// for decoding at a reduced size
+	uint32 *psums = NULL;
+	uint8 *pimage = NULL;
+
 	png_structp ppng = NULL;
 	png_infop pinfo = NULL;
 	while (ppng == NULL) {
@@ -404,6 +446,33 @@ PNGTranslator::translate_from_png_to_bits(BPositionIO *inSource,
 			if (rowbytes < kbytes * width)
 				rowbytes = kbytes * width;
 
+			// If the caller needs a smaller image only, reduce it by an
+			// integer factor while decoding. Sequential images are reduced
+			// by averaging blocks of pixels, of interlaced images only the
+			// first passes, which form a coarser grid already, are read.
+			uint32 factor = 1;
+			float scale = bitmap_target_scale(ioExtension, width, height);
+			if (scale < 1.0f)
+				factor = (uint32)(1.0f / scale);
+
+			int passes = 7;
+			if (interlace_type != PNG_INTERLACE_NONE) {
+				if (factor >= 8) {
+					factor = 8;
+					passes = 1;
+				} else if (factor >= 4) {
+					factor = 4;
+					passes = 3;
+				} else if (factor >= 2) {
+					factor = 2;
+					passes = 5;
+				} else
+					factor = 1;
+			}
+
+			png_uint_32 outWidth = (width + factor - 1) / factor;
+			png_uint_32 outHeight = (height + factor - 1) / factor;
+
 			if (!bdataonly) {
 				// Write out the data to outDestination
 				// Construct and write Be bitmap header
@@ -411,14 +480,14 @@ PNGTranslator::translate_from_png_to_bits(BPositionIO *inSource,
 				bitsHeader.magic = B_TRANSLATOR_BITMAP;
 				bitsHeader.bounds.left = 0;
 				bitsHeader.bounds.top = 0;
-				bitsHeader.bounds.right = width - 1;
-				bitsHeader.bounds.bottom = height - 1;
-				bitsHeader.rowBytes = 4 * width;
+				bitsHeader.bounds.right = outWidth - 1;
+				bitsHeader.bounds.bottom = outHeight - 1;
+				bitsHeader.rowBytes = 4 * outWidth;
 				if (balpha)
 					bitsHeader.colors = B_RGBA32;
 				else
 					bitsHeader.colors = B_RGB32;
-				bitsHeader.dataSize = bitsHeader.rowBytes * height;
+				bitsHeader.dataSize = bitsHeader.rowBytes * outHeight;
 				if (swap_data(B_UINT32_TYPE, &bitsHeader,
 					sizeof(TranslatorBitmap), B_SWAP_HOST_TO_BENDIAN) != B_OK) {
 					result = B_ERROR;
@@ -439,9 +508,30 @@ PNGTranslator::translate_from_png_to_bits(BPositionIO *inSource,
 					result = B_NO_MEMORY;
 					break;
 				}
-				for (png_uint_32 i = 0; i < height; i++) {
-					png_read_row(ppng, prow, NULL);
-					outDestination->Write(prow, width * kbytes);
+				if (factor == 1) {
+					for (png_uint_32 i = 0; i < height; i++) {
+						png_read_row(ppng, prow, NULL);
+						outDestination->Write(prow, width * kbytes);
+					}
+				} else {
+					psums = new(std::nothrow) uint32[outWidth * kbytes];
+					if (!psums) {
+						result = B_NO_MEMORY;
+						break;
+					}
+					memset(psums, 0, outWidth * kbytes * sizeof(uint32));
+
+					for (png_uint_32 i = 0; i < height; i++) {
+						png_read_row(ppng, prow, NULL);
+						add_to_block_sums(prow, psums, width, factor);
+						if ((i + 1) % factor != 0 && i + 1 < height)
+							continue;
+
+						// the averages fit into the row just read
+						average_block_sums(psums, prow, width, factor,
+							i % factor + 1);
+						outDestination->Write(prow, outWidth * kbytes);
+					}
 				}
 
 				// finish reading, pass NULL for info because I
@@ -451,6 +541,40 @@ PNGTranslator::translate_from_png_to_bits(BPositionIO *inSource,
 
 				break;
 
+			} else if (factor > 1) {
+				// interlaced PNG image, of which only the first passes are
+				// read; their pixels are exactly the ones on the grid
+				prow = new(std::nothrow) uint8[rowbytes];
+				pimage = new(std::nothrow) uint8[outWidth * outHeight * kbytes];
+				if (!prow || !pimage) {
+					result = B_NO_MEMORY;
+					break;
+				}
+
+				for (int pass = 0; pass < passes; pass++) {
+					png_uint_32 columns = PNG_PASS_COLS(width, pass);
+					png_uint_32 rows = PNG_PASS_ROWS(height, pass);
+					if (columns == 0 || rows == 0)
+						continue;
+
+					for (png_uint_32 i = 0; i < rows; i++) {
+						png_read_row(ppng, prow, NULL);
+
+						uint8 *dest = pimage + PNG_ROW_FROM_PASS_ROW(i, pass)
+							/ factor * outWidth * kbytes;
+						for (png_uint_32 j = 0; j < columns; j++) {
+							memcpy(dest + PNG_COL_FROM_PASS_COL(j, pass)
+								/ factor * kbytes, prow + j * kbytes, kbytes);
+						}
+					}
+				}
+
+				outDestination->Write(pimage, outWidth * outHeight * kbytes);
+				result = B_OK;
+					// the remaining passes are not needed, so the image is
+					// not read to its end
+				break;
+
 			} else {
 				// interlaced PNG image
 				prows = new(std::nothrow) uint8 *[height];
@@ -490,6 +614,8 @@ PNGTranslator::translate_from_png_to_bits(BPositionIO *inSource,
 	if (ppng) {
 		delete[] prow;
 		prow = NULL;
+		delete[] psums;
+		delete[] pimage;
 
 		// delete row pointers and array of pointers to rows
 		while (nalloc) {
@@ -510,11 +636,11 @@ PNGTranslator::translate_from_png_to_bits(BPositionIO *inSource,
 }
 
 status_t
-PNGTranslator::translate_from_png(BPositionIO *inSource, uint32 outType,
-	BPositionIO *outDestination)
+PNGTranslator::translate_from_png(BPositionIO *inSource, BMessage *ioExtension,
+	uint32 outType, BPositionIO *outDestination)
 {
 	if (outType == B_TRANSLATOR_BITMAP)
-		return translate_from_png_to_bits(inSource, outDestination);
+		return translate_from_png_to_bits(inSource, ioExtension, outDestination);
 	else {
 		// Translate from PNG to PNG
 		translate_direct_copy(inSource, outDestination);
@@ -995,7 +1121,8 @@ PNGTranslator::DerivedTranslate(BPositionIO *inSource,
 		return translate_from_bits_to_png(inSource, outDestination);
 	else if (baseType == 0)
 		// if inSource is NOT in bits format
-		return translate_from_png(inSource, outType, outDestination);
+		return translate_from_png(inSource, ioExtension, outType,
+			outDestination);
 	else
 		return B_NO_TRANSLATOR;
 }
@@ -81,10 +81,10 @@ protected:
 		
 private:
 	status_t translate_from_png_to_bits(BPositionIO *inSource,
-		BPositionIO *outDestination);
+		BMessage *ioExtension, BPositionIO *outDestination);
 		
-	status_t translate_from_png(BPositionIO *inSource, uint32 outType,
-		BPositionIO *outDestination);
+	status_t translate_from_png(BPositionIO *inSource, BMessage *ioExtension,
+		uint32 outType, BPositionIO *outDestination);
 		
 	status_t translate_from_bits_to_png(BPositionIO *inSource,
 		BPositionIO *outDestination);
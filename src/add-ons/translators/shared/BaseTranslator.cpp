@@ -739,3 +739,32 @@ translate_direct_copy(BPositionIO *inSource, BPositionIO *outDestination)
 		ret = inSource->Read(buffer, kbufsize);
 	}
 }
+
+
+float
+bitmap_target_scale(BMessage *ioExtension, uint32 width, uint32 height)
+{
+	if (ioExtension == NULL || width == 0 || height == 0)
+		return 1.0f;
+
+	BSize targetSize;
+	if (ioExtension->FindSize(B_TRANSLATOR_EXT_BITMAP_TARGET_SIZE,
+			&targetSize) != B_OK) {
+		return 1.0f;
+	}
+
+	// the size follows the BRect convention, like the bitmap bounds do
+	ioExtension->SetSize(B_TRANSLATOR_EXT_BITMAP_FULL_SIZE,
+		BSize(width - 1, height - 1));
+
+	if (!targetSize.IsWidthSet() || !targetSize.IsHeightSet()
+		|| targetSize.width < 0 || targetSize.height < 0) {
+		return 1.0f;
+	}
+
+	// the image is going to be scaled to fit into the target size, so it only
+	// needs to be as large as that on both axes
+	float scale = std::min((targetSize.width + 1) / width,
+		(targetSize.height + 1) / height);
+	return std::min(scale, 1.0f);
+}
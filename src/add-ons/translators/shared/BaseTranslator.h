@@ -147,5 +147,11 @@ private:
 
 void translate_direct_copy(BPositionIO *inSource, BPositionIO *outDestination);
 
+float bitmap_target_scale(BMessage *ioExtension, uint32 width, uint32 height);
+	// returns the factor (at most 1.0) by which an image of the given size
+	// can be shrunk when it is going to be scaled to fit the
+	// B_TRANSLATOR_EXT_BITMAP_TARGET_SIZE requested in ioExtension anyway;
+	// also reports the full size back in B_TRANSLATOR_EXT_BITMAP_FULL_SIZE
+
 #endif // #ifndef BASE_TRANSLATOR_H
 
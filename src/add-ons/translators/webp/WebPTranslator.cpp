@@ -14,6 +14,7 @@
 #include <Messenger.h>
 #include <TranslatorRoster.h>
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,21 +30,21 @@
 #define B_TRANSLATION_CONTEXT "WebPTranslator"
 
 
-class FreeAllocation {
+class FreeDecBuffer {
 	public:
-		FreeAllocation(void* buffer)
+		FreeDecBuffer(WebPDecBuffer* buffer)
 			:
 			fBuffer(buffer)
 		{
 		}
 
-		~FreeAllocation()
+		~FreeDecBuffer()
 		{
-			free(fBuffer);
+			WebPFreeDecBuffer(fBuffer);
 		}
 
 	private:
-		void*	fBuffer;
+		WebPDecBuffer*	fBuffer;
 };
 
 
@@ -68,6 +69,16 @@ static const translation_format sInputFormats[] = {
 	},
 };
 
+// The signatures of the input formats, so that the roster can skip this
+// translator for other data: the RIFF container, and the bare VP8L and VP8
+// bitstreams libwebp accepts as well
+const translation_signature input_signatures[] = {
+	{ WEBP_IMAGE_FORMAT, 8, 4, { 'W', 'E', 'B', 'P' } },
+	{ WEBP_IMAGE_FORMAT, 0, 1, { 0x2f } },
+	{ WEBP_IMAGE_FORMAT, 3, 3, { 0x9d, 0x01, 0x2a } },
+	{ 0 }
+};
+
 // The output formats that this translator knows how to write
 static const translation_format sOutputFormats[] = {
 	{
@@ -330,17 +341,38 @@ WebPTranslator::_TranslateFromWebP(BPositionIO* stream, BMessage* ioExtension,
 		return B_IO_ERROR;
 	}
 
-	int width, height;
-	uint8* out = WebPDecodeBGRA((const uint8*)streamData, streamSize, &width,
-		&height);
+	WebPDecoderConfig config;
+	if (!WebPInitDecoderConfig(&config)
+		|| WebPGetFeatures((const uint8*)streamData, streamSize,
+			&config.input) != VP8_STATUS_OK) {
+		free(streamData);
+		return B_ILLEGAL_DATA;
+	}
+
+	int width = config.input.width;
+	int height = config.input.height;
+
+	// If the caller only needs a smaller image, have the decoder scale it
+	// down while converting it, which also saves most of the memory.
+	float scale = bitmap_target_scale(ioExtension, width, height);
+	if (scale < 1.0f) {
+		width = max_c(1, (int)ceilf(width * scale));
+		height = max_c(1, (int)ceilf(height * scale));
+		config.options.use_scaling = 1;
+		config.options.scaled_width = width;
+		config.options.scaled_height = height;
+	}
+
+	config.output.colorspace = MODE_BGRA;
+	VP8StatusCode status = WebPDecode((const uint8*)streamData, streamSize,
+		&config);
 	free(streamData);
 
-	if (out == NULL)
+	if (status != VP8_STATUS_OK)
 		return B_ILLEGAL_DATA;
 
-	FreeAllocation _(out);
-
-	uint32 dataSize = width * 4 * height;
+	FreeDecBuffer _(&config.output);
+	uint8* out = config.output.u.RGBA.rgba;
 
 	TranslatorBitmap bitmapHeader;
 	bitmapHeader.magic = B_TRANSLATOR_BITMAP;
@@ -367,18 +399,15 @@ WebPTranslator::_TranslateFromWebP(BPositionIO* stream, BMessage* ioExtension,
 	if (headerOnly)
 		return B_OK;
 
-	uint32 dataLeft = dataSize;
-	uint8* p = out;
-	while (dataLeft) {
-		bytesWritten = target->Write(p, 4);
+	size_t rowBytes = width * 4;
+	for (int y = 0; y < height; y++) {
+		bytesWritten = target->Write(out + y * config.output.u.RGBA.stride,
+			rowBytes);
 		if (bytesWritten < B_OK)
 			return bytesWritten;
 
-		if (bytesWritten != 4)
+		if ((size_t)bytesWritten != rowBytes)
 			return B_IO_ERROR;
-
-		p += 4;
-		dataLeft -= 4;
 	}
 
 	return B_OK;
@@ -11,6 +11,7 @@
 #include "BasicTerminalBuffer.h"
 
 #include <alloca.h>
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <fcntl.h>
@@ -571,11 +572,39 @@ BasicTerminalBuffer::Find(const char* _pattern, const TermPos& start,
 			std::swap(pattern[i], pattern[patternLen - i - 1]);
 	}
 
+	// Determine the bytes a match can start with, so that blocks of the
+	// history that contain none of them can be skipped.
+	CharacterByteSet startBytes;
+	uchar firstByte = pattern[0].bytes[0];
+	bool skipHistoryBlocks = fHistory != NULL && firstByte != '\n';
+	if (!caseSensitive && (isalpha(firstByte) || firstByte >= 0x80)) {
+		startBytes.Add(toupper(firstByte));
+		// some non-ASCII characters are lower case variants of others with
+		// different first bytes, or even of ASCII letters
+		startBytes.AddNonASCII();
+	}
+	startBytes.Add(firstByte);
+	int32 checkedRow = 0;
+
 	// search loop
 	int32 matchIndex = 0;
 	TermPos matchStart;
 	while (true) {
 //debug_printf("    (%ld, %ld): matchIndex: %ld\n", pos.x, pos.y, matchIndex);
+		if (skipHistoryBlocks && matchIndex == 0 && pos.y < 0
+			&& pos.y != checkedRow) {
+			checkedRow = pos.y;
+			int32 firstIndex;
+			int32 lastIndex;
+			if (!fHistory->MayContain(-pos.y - 1, startBytes, firstIndex,
+					lastIndex)) {
+				if (forward)
+					pos = TermPos(0, -firstIndex);
+				else
+					pos = TermPos(0, checkedRow = -lastIndex - 1);
+			}
+		}
+
 		TermPos previousPos(pos);
 		UTF8Char c;
 		if (!(forward ? _NextChar(pos, c) : _PreviousChar(pos, c)))
@@ -664,6 +693,65 @@ BasicTerminalBuffer::InsertChar(UTF8Char c)
 }
 
 
+/*!	Inserts a run of printable UTF-8 characters. The result is the same as
+	calling InsertChar() for each of them, but in overwrite mode the cells of
+	a line are filled in one go, and the line is invalidated only once.
+	\a text must consist of complete characters only.
+*/
+void
+BasicTerminalBuffer::InsertChars(const char* text, int32 length)
+{
+	const char* end = text + length;
+
+	while (text < end) {
+		UTF8Char c(text);
+		int32 byteCount = c.ByteCount();
+		if (!fOverwriteMode || (byteCount > 1 && c.IsFullWidth())) {
+			InsertChar(c);
+			text += byteCount;
+			continue;
+		}
+
+		if (fSoftWrappedCursor || fCursor.x + HALF_WIDTH > fWidth)
+			_SoftBreakLine();
+		else
+			_PadLineToCursor();
+
+		fSoftWrappedCursor = false;
+
+		// fill the line up to its end, or up to the next full-width char
+		TerminalLine* line = _LineAt(fCursor.y);
+		int32 x = fCursor.x;
+		while (true) {
+			line->cells[x].character = c;
+			line->cells[x].attributes = fAttributes;
+			fLast = c;
+			x++;
+			text += byteCount;
+
+			if (x == fWidth || text >= end)
+				break;
+
+			c.SetTo(text, UTF8Char::ByteCount(*text));
+			byteCount = c.ByteCount();
+			if (byteCount > 1 && c.IsFullWidth())
+				break;
+		}
+
+		if (line->length < x)
+			line->length = x;
+
+		_Invalidate(fCursor.y, fCursor.y);
+
+		fCursor.x = x;
+		if (fCursor.x == fWidth) {
+			fCursor.x -= HALF_WIDTH;
+			fSoftWrappedCursor = true;
+		}
+	}
+}
+
+
 void
 BasicTerminalBuffer::FillScreen(UTF8Char c, Attributes &attributes)
 {
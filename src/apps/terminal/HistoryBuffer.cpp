@@ -1,5 +1,5 @@
 /*
- * Copyright 2013, Haiku, Inc. All rights reserved.
+ * Copyright 2013-2026, Haiku, Inc. All rights reserved.
  * Copyright 2008, Ingo Weinhold, ingo_weinhold@gmx.de.
  * Distributed under the terms of the MIT License.
  *
@@ -10,31 +10,129 @@
 
 #include "HistoryBuffer.h"
 
+#include <stdlib.h>
+
 #include <new>
 
 #include <OS.h>
 
+#include <ZlibCompressionAlgorithm.h>
+
 #include "TermConst.h"
 
 
+/*!	The history lines are stored in blocks of kLinesPerBlock lines. New lines
+	are added to the open block, which is kept uncompressed. When it is full,
+	it is compressed and appended to the ring of blocks, and the oldest blocks
+	are freed as lines are dropped. The blocks needed to access lines are
+	decompressed on demand into a small cache.
+*/
+
+
+static const int32 kLinesPerBlock = 128;
+static const int32 kCachedBlocks = 4;
+static const int32 kMinBlockBufferSize = 4096;
+
+
+struct HistoryBuffer::Block {
+	uint32				serial;
+	int32				size;				// uncompressed size of the lines
+	int32				dataSize;
+	bool				compressed;
+	CharacterByteSet	characters;
+	uint8				data[0];
+};
+
+
+struct HistoryBuffer::BlockBuffer {
+	uint32				serial;				// of the block cached
+	uint32				lastUsed;
+	uint8*				data;
+	int32				size;
+	int32				capacity;
+	int32				lineCount;
+	int32				lineOffsets[kLinesPerBlock];
+
+	BlockBuffer()
+		:
+		serial(0),
+		lastUsed(0),
+		data(NULL),
+		size(0),
+		capacity(0),
+		lineCount(0)
+	{
+	}
+
+	~BlockBuffer()
+	{
+		free(data);
+	}
+
+	bool Reserve(int32 neededSize)
+	{
+		if (neededSize <= capacity)
+			return true;
+
+		int32 newCapacity = max_c(max_c(capacity * 2, neededSize),
+			kMinBlockBufferSize);
+		uint8* newData = (uint8*)realloc(data, newCapacity);
+		if (newData == NULL)
+			return false;
+
+		data = newData;
+		capacity = newCapacity;
+		return true;
+	}
+
+	HistoryLine* LineAt(int32 index) const
+	{
+		return (HistoryLine*)(data + lineOffsets[index]);
+	}
+};
+
+
+static inline int32
+line_buffer_size(int32 attributesRuns, int32 byteLength)
+{
+	// keep the following line aligned
+	return (sizeof(HistoryLine) + attributesRuns * sizeof(AttributesRun)
+		+ byteLength + 3) & ~3;
+}
+
+
+// #pragma mark -
+
+
 HistoryBuffer::HistoryBuffer()
 	:
-	fLines(NULL),
 	fWidth(0),
 	fCapacity(0),
-	fNextLine(0),
 	fSize(0),
-	fBuffer(NULL),
-	fBufferSize(0),
-	fBufferAllocationOffset(0)
+	fDroppedLines(0),
+	fBlocks(NULL),
+	fMaxBlocks(0),
+	fFirstBlock(0),
+	fBlockCount(0),
+	fNextBlockSerial(1),
+	fOpenBlock(NULL),
+	fCache(NULL),
+	fCacheUseCounter(0)
 {
 }
 
 
 HistoryBuffer::~HistoryBuffer()
 {
-	delete[] fLines;
-	delete[] fBuffer;
+	_FreeBlocks();
+	delete[] fBlocks;
+	delete fOpenBlock;
+
+	if (fCache != NULL) {
+		for (int32 i = 0; i < kCachedBlocks; i++)
+			delete fCache[i];
+		delete[] fCache;
+	}
 }
 
 
@@ -44,22 +142,30 @@ HistoryBuffer::Init(int32 width, int32 capacity)
 	if (width <= 0 || capacity <= 0)
 		return B_BAD_VALUE;
 
-	int32 bufferSize = (width + 4) * capacity;
+	// Every block in the ring but the oldest is full, and the oldest one has
+	// less than kLinesPerBlock dropped lines.
+	int32 maxBlocks = capacity / kLinesPerBlock + 2;
 
-	if (capacity > 0) {
-		fLines = new(std::nothrow) HistoryLine[capacity];
-		fBuffer = new(std::nothrow) uint8[bufferSize];
+	fBlocks = new(std::nothrow) Block*[maxBlocks];
+	fOpenBlock = new(std::nothrow) BlockBuffer;
+	fCache = new(std::nothrow) BlockBuffer*[kCachedBlocks];
+	if (fBlocks == NULL || fOpenBlock == NULL || fCache == NULL)
+		return B_NO_MEMORY;
 
-		if (fLines == NULL || fBuffer == NULL)
+	for (int32 i = 0; i < kCachedBlocks; i++)
+		fCache[i] = new(std::nothrow) BlockBuffer;
+	for (int32 i = 0; i < kCachedBlocks; i++) {
+		if (fCache[i] == NULL)
 			return B_NO_MEMORY;
 	}
 
 	fWidth = width;
 	fCapacity = capacity;
-	fNextLine = 0;
 	fSize = 0;
-	fBufferSize = bufferSize;
-	fBufferAllocationOffset = 0;
+	fDroppedLines = 0;
+	fMaxBlocks = maxBlocks;
+	fFirstBlock = 0;
+	fBlockCount = 0;
 
 	return B_OK;
 }
@@ -68,16 +174,23 @@ HistoryBuffer::Init(int32 width, int32 capacity)
 void
 HistoryBuffer::Clear()
 {
-	fNextLine = 0;
+	_FreeBlocks();
+
+	if (fOpenBlock != NULL) {
+		fOpenBlock->size = 0;
+		fOpenBlock->lineCount = 0;
+	}
+	fOpenBlockCharacters.Clear();
+
 	fSize = 0;
-	fBufferAllocationOffset = 0;
+	fDroppedLines = 0;
 }
 
 
 TerminalLine*
 HistoryBuffer::GetTerminalLineAt(int32 index, TerminalLine* buffer) const
 {
-	HistoryLine* line = LineAt(index);
+	const HistoryLine* line = _LineAt(index);
 	if (line == NULL)
 		return NULL;
 
@@ -135,6 +248,40 @@ HistoryBuffer::GetTerminalLineAt(int32 index, TerminalLine* buffer) const
 }
 
 
+/*!	Returns whether the block of lines the line at \a index belongs to may
+	contain a character starting with one of the bytes in \a characters.
+	\a _firstIndex and \a _lastIndex are set to the range of lines of that
+	block, so that a search can skip all of them if it doesn't.
+*/
+bool
+HistoryBuffer::MayContain(int32 index, const CharacterByteSet& characters,
+	int32& _firstIndex, int32& _lastIndex) const
+{
+	if (index < 0 || index >= fSize) {
+		_firstIndex = _lastIndex = index;
+		return true;
+	}
+
+	const CharacterByteSet* blockCharacters;
+	int32 openLines = fOpenBlock->lineCount;
+	if (index < openLines) {
+		blockCharacters = &fOpenBlockCharacters;
+		_firstIndex = 0;
+		_lastIndex = openLines - 1;
+	} else {
+		int32 blockIndex = (index - openLines) / kLinesPerBlock;
+		blockCharacters = &_BlockAt(blockIndex)->characters;
+		_firstIndex = openLines + blockIndex * kLinesPerBlock;
+		_lastIndex = _firstIndex + kLinesPerBlock - 1;
+	}
+
+	if (_lastIndex >= fSize)
+		_lastIndex = fSize - 1;
+
+	return blockCharacters->Intersects(characters);
+}
+
+
 void
 HistoryBuffer::AddLine(const TerminalLine* line)
 {
@@ -161,6 +308,8 @@ HistoryBuffer::AddLine(const TerminalLine* line)
 
 	// allocate and translate the line
 	HistoryLine* historyLine = _AllocateLine(attributesRuns, byteLength);
+	if (historyLine == NULL)
+		return;
 
 	attributes.Reset();
 	AttributesRun* attributesRun = historyLine->AttributesRuns();
@@ -173,6 +322,7 @@ HistoryBuffer::AddLine(const TerminalLine* line)
 		int32 charLength = cell.character.ByteCount();
 		memcpy(chars, cell.character.bytes, charLength);
 		chars += charLength;
+		fOpenBlockCharacters.Add(cell.character.bytes[0]);
 
 		// deal with attributes
 		if (cell != attributes) {
@@ -216,23 +366,10 @@ HistoryBuffer::AddEmptyLines(int32 count)
 	if (count > fCapacity)
 		count = fCapacity;
 
-	if (count + fSize > fCapacity)
-		DropLines(count + fSize - fCapacity);
-
-	// All lines use the same buffer address, since they don't use any memory.
-	AttributesRun* attributesRun
-		= (AttributesRun*)(fBuffer + fBufferAllocationOffset);
-
 	for (int32 i = 0; i < count; i++) {
-		HistoryLine* line = &fLines[fNextLine];
-		fNextLine = (fNextLine + 1) % fCapacity;
-		line->attributesRuns = attributesRun;
-		line->attributesRunCount = 0;
-		line->byteLength = 0;
-		line->softBreak = false;
+		if (_AllocateLine(0, 0) == NULL)
+			break;
 	}
-
-	fSize += count;
 }
 
 
@@ -242,12 +379,20 @@ HistoryBuffer::DropLines(int32 count)
 	if (count <= 0)
 		return;
 
-	if (count < fSize) {
-		fSize -= count;
-	} else {
-		fSize = 0;
-		fNextLine = 0;
-		fBufferAllocationOffset = 0;
+	if (count >= fSize) {
+		Clear();
+		return;
+	}
+
+	fSize -= count;
+	fDroppedLines += count;
+
+	// free the blocks that no longer contain any lines
+	while (fBlockCount > 0 && fDroppedLines >= kLinesPerBlock) {
+		free(fBlocks[fFirstBlock]);
+		fFirstBlock = (fFirstBlock + 1) % fMaxBlocks;
+		fBlockCount--;
+		fDroppedLines -= kLinesPerBlock;
 	}
 }
 
@@ -256,48 +401,180 @@ HistoryLine*
 HistoryBuffer::_AllocateLine(int32 attributesRuns, int32 byteLength)
 {
 	// we need at least one spare line slot
-	int32 toDrop = 0;
 	if (fSize == fCapacity)
-		toDrop = 1;
+		DropLines(1);
 
-	int32 bytesNeeded = attributesRuns * sizeof(AttributesRun) + byteLength;
+	if (fOpenBlock->lineCount == kLinesPerBlock)
+		_SealOpenBlock();
 
-	if (fBufferAllocationOffset + bytesNeeded > fBufferSize) {
-		// drop all lines after the allocation index
-		for (; toDrop < fSize; toDrop++) {
-			HistoryLine* line = _LineAt(fSize - toDrop - 1);
-			int32 offset = (uint8*)line->AttributesRuns() - fBuffer;
-			if (offset < fBufferAllocationOffset)
-				break;
-		}
+	int32 size = line_buffer_size(attributesRuns, byteLength);
+	if (!fOpenBlock->Reserve(fOpenBlock->size + size))
+		return NULL;
+
+	// init the line
+	HistoryLine* line = (HistoryLine*)(fOpenBlock->data + fOpenBlock->size);
+	fOpenBlock->lineOffsets[fOpenBlock->lineCount++] = fOpenBlock->size;
+	fOpenBlock->size += size;
+	fSize++;
+
+	line->attributesRunCount = attributesRuns;
+	line->byteLength = byteLength;
+	line->softBreak = false;
+	line->attributes.Reset();
+
+	return line;
+}
+
+
+const HistoryLine*
+HistoryBuffer::_LineAt(int32 index) const
+{
+	if (index < 0 || index >= fSize)
+		return NULL;
+
+	int32 openLines = fOpenBlock->lineCount;
+	if (index < openLines)
+		return fOpenBlock->LineAt(openLines - index - 1);
+
+	index -= openLines;
+	BlockBuffer* buffer = _CachedBlock(_BlockAt(index / kLinesPerBlock));
+	if (buffer == NULL)
+		return NULL;
+
+	return buffer->LineAt(kLinesPerBlock - index % kLinesPerBlock - 1);
+}
+
+
+/*!	Returns the block at \a index, counted from the newest one.
+*/
+HistoryBuffer::Block*
+HistoryBuffer::_BlockAt(int32 index) const
+{
+	return fBlocks[(fFirstBlock + fBlockCount - index - 1) % fMaxBlocks];
+}
 
-		fBufferAllocationOffset = 0;
+
+HistoryBuffer::BlockBuffer*
+HistoryBuffer::_CachedBlock(const Block* block) const
+{
+	for (int32 i = 0; i < kCachedBlocks; i++) {
+		if (fCache[i]->serial == block->serial) {
+			fCache[i]->lastUsed = ++fCacheUseCounter;
+			return fCache[i];
+		}
 	}
 
-	// drop all lines interfering
-	int32 nextOffset = (fBufferAllocationOffset + bytesNeeded + 1) & ~1;
-	for (; toDrop < fSize; toDrop++) {
-		HistoryLine* line = _LineAt(fSize - toDrop - 1);
-		int32 offset = (uint8*)line->AttributesRuns() - fBuffer;
-		if (offset + line->BufferSize() <= fBufferAllocationOffset
-				|| offset >= nextOffset) {
-			break;
+	BlockBuffer* buffer = fCache[_LeastRecentlyUsedCacheIndex()];
+	buffer->serial = 0;
+	if (!buffer->Reserve(block->size))
+		return NULL;
+
+	if (block->compressed) {
+		iovec input = { (void*)block->data, (size_t)block->dataSize };
+		iovec output = { buffer->data, (size_t)block->size };
+		BZlibCompressionAlgorithm algorithm;
+		if (algorithm.DecompressBuffer(input, output) != B_OK
+			|| output.iov_len != (size_t)block->size) {
+			return NULL;
 		}
+	} else
+		memcpy(buffer->data, block->data, block->size);
+
+	// recreate the line offsets
+	int32 offset = 0;
+	for (int32 i = 0; i < kLinesPerBlock; i++) {
+		buffer->lineOffsets[i] = offset;
+		const HistoryLine* line = buffer->LineAt(i);
+		offset += line_buffer_size(line->attributesRunCount,
+			line->byteLength);
 	}
 
-	DropLines(toDrop);
+	buffer->size = block->size;
+	buffer->lineCount = kLinesPerBlock;
+	buffer->serial = block->serial;
+	buffer->lastUsed = ++fCacheUseCounter;
 
-	// init the line
-	HistoryLine* line = &fLines[fNextLine];
-	fNextLine = (fNextLine + 1) % fCapacity;
-	fSize++;
-	line->attributesRuns = (AttributesRun*)(fBuffer + fBufferAllocationOffset);
-	line->attributesRunCount = attributesRuns;
-	line->byteLength = byteLength;
+	return buffer;
+}
 
-	fBufferAllocationOffset = (fBufferAllocationOffset + bytesNeeded + 1) & ~1;
-		// DropLines() may have changed fBufferAllocationOffset, so don't use
-		// nextOffset.
 
-	return line;
+int32
+HistoryBuffer::_LeastRecentlyUsedCacheIndex() const
+{
+	int32 index = 0;
+	for (int32 i = 1; i < kCachedBlocks; i++) {
+		if (fCache[i]->lastUsed < fCache[index]->lastUsed)
+			index = i;
+	}
+
+	return index;
+}
+
+
+/*!	Compresses the full open block and appends it to the ring of blocks.
+*/
+void
+HistoryBuffer::_SealOpenBlock()
+{
+	BlockBuffer* openBlock = fOpenBlock;
+
+	Block* block = (Block*)malloc(sizeof(Block) + openBlock->size);
+	if (block == NULL) {
+		// we can't keep the lines
+		Clear();
+		return;
+	}
+
+	block->serial = fNextBlockSerial++;
+	block->size = openBlock->size;
+	block->characters = fOpenBlockCharacters;
+
+	iovec input = { openBlock->data, (size_t)openBlock->size };
+	iovec output = { block->data, (size_t)openBlock->size };
+	BZlibCompressionParameters parameters(B_ZLIB_COMPRESSION_FASTEST);
+	BZlibCompressionAlgorithm algorithm;
+	if (algorithm.CompressBuffer(input, output, &parameters) == B_OK
+		&& (int32)output.iov_len < openBlock->size) {
+		block->compressed = true;
+		block->dataSize = output.iov_len;
+
+		Block* shrunkBlock = (Block*)realloc(block,
+			sizeof(Block) + block->dataSize);
+		if (shrunkBlock != NULL)
+			block = shrunkBlock;
+	} else {
+		block->compressed = false;
+		block->dataSize = openBlock->size;
+		memcpy(block->data, openBlock->data, openBlock->size);
+	}
+
+	fBlocks[(fFirstBlock + fBlockCount) % fMaxBlocks] = block;
+	fBlockCount++;
+
+	// The lines have just been added, so they are likely to be looked at
+	// again soon. Instead of decompressing them later, the open block takes
+	// the place of the least recently used cached block, whose buffer is
+	// reused for the new open block.
+	int32 cacheIndex = _LeastRecentlyUsedCacheIndex();
+	fOpenBlock = fCache[cacheIndex];
+	fCache[cacheIndex] = openBlock;
+
+	openBlock->serial = block->serial;
+	openBlock->lastUsed = ++fCacheUseCounter;
+
+	fOpenBlock->serial = 0;
+	fOpenBlock->size = 0;
+	fOpenBlock->lineCount = 0;
+	fOpenBlockCharacters.Clear();
+}
+
+
+void
+HistoryBuffer::_FreeBlocks()
+{
+	for (int32 i = 0; i < fBlockCount; i++)
+		free(fBlocks[(fFirstBlock + i) % fMaxBlocks]);
+
+	fFirstBlock = 0;
+	fBlockCount = 0;
 }
@@ -5,6 +5,8 @@
 #ifndef HISTORY_BUFFER_H
 #define HISTORY_BUFFER_H
 
+#include <string.h>
+
 #include <SupportDefs.h>
 
 #include "TerminalLine.h"
@@ -14,6 +16,26 @@ struct HistoryLine;
 struct TerminalLine;
 
 
+/*!	A set of bytes UTF-8 characters may start with. The history keeps one for
+	each block of lines, so that searches can skip the blocks that don't
+	contain the beginning of a match.
+*/
+class CharacterByteSet {
+public:
+	inline						CharacterByteSet();
+
+	inline	void				Clear();
+	inline	void				Add(uchar byte);
+	inline	void				AddNonASCII();
+
+	inline	bool				Intersects(
+									const CharacterByteSet& other) const;
+
+private:
+			uint32				fBits[8];
+};
+
+
 class HistoryBuffer {
 public:
 								HistoryBuffer();
@@ -27,42 +49,92 @@ public:
 			int32				Capacity() const	{ return fCapacity; }
 			int32				Size() const		{ return fSize; }
 
-	inline	HistoryLine*		LineAt(int32 index) const;
 			TerminalLine*		GetTerminalLineAt(int32 index,
 									TerminalLine* buffer) const;
+			bool				MayContain(int32 index,
+									const CharacterByteSet& characters,
+									int32& _firstIndex,
+									int32& _lastIndex) const;
 
 			void				AddLine(const TerminalLine* line);
 			void				AddEmptyLines(int32 count);
 			void				DropLines(int32 count);
 
 private:
+			struct Block;
+			struct BlockBuffer;
+
 			HistoryLine*		_AllocateLine(int32 attributesRuns,
 									int32 byteLength);
-	inline	HistoryLine*		_LineAt(int32 index) const;
+			const HistoryLine*	_LineAt(int32 index) const;
+			Block*				_BlockAt(int32 index) const;
+			BlockBuffer*		_CachedBlock(const Block* block) const;
+			int32				_LeastRecentlyUsedCacheIndex() const;
+			void				_SealOpenBlock();
+			void				_FreeBlocks();
 
 private:
-			HistoryLine*		fLines;
 			int32				fWidth;
 			int32				fCapacity;
-			int32				fNextLine;
 			int32				fSize;
-			uint8*				fBuffer;
-			int32				fBufferSize;
-			int32				fBufferAllocationOffset;
+			int32				fDroppedLines;
+				// lines of the oldest block that are no longer part of the
+				// history
+
+			// the ring of full, compressed blocks
+			Block**				fBlocks;
+			int32				fMaxBlocks;
+			int32				fFirstBlock;
+			int32				fBlockCount;
+			uint32				fNextBlockSerial;
+
+			// the block new lines are added to
+			BlockBuffer*		fOpenBlock;
+			CharacterByteSet	fOpenBlockCharacters;
+
+			// recently used blocks, uncompressed
+			BlockBuffer**		fCache;
+	mutable	uint32				fCacheUseCounter;
 };
 
 
-inline HistoryLine*
-HistoryBuffer::_LineAt(int32 index) const
+inline
+CharacterByteSet::CharacterByteSet()
 {
-	return &fLines[(fCapacity + fNextLine - index - 1) % fCapacity];
+	Clear();
 }
 
 
-inline HistoryLine*
-HistoryBuffer::LineAt(int32 index) const
+inline void
+CharacterByteSet::Clear()
 {
-	return index >= 0 && index < fSize ? _LineAt(index) : NULL;
+	memset(fBits, 0, sizeof(fBits));
+}
+
+
+inline void
+CharacterByteSet::Add(uchar byte)
+{
+	fBits[byte / 32] |= 1U << (byte % 32);
+}
+
+
+inline void
+CharacterByteSet::AddNonASCII()
+{
+	memset(fBits + 4, 0xff, sizeof(fBits) / 2);
+}
+
+
+inline bool
+CharacterByteSet::Intersects(const CharacterByteSet& other) const
+{
+	for (int32 i = 0; i < 8; i++) {
+		if ((fBits[i] & other.fBits[i]) != 0)
+			return true;
+	}
+
+	return false;
 }
 
 
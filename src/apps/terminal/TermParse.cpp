@@ -421,6 +421,21 @@ TermParse::EscParse()
 							break;
 						}
 					}
+					if (curGraphSet == NULL && c < 128
+						&& parsestate == groundtable) {
+						// insert the whole run of plain printable characters
+						// that is already in the parser buffer at once
+						int32 start = fParserBufferOffset - 1;
+						int32 length = 1 + _PrintableRunLength(groundtable);
+						fBuffer->InsertChars(
+							(const char*)fParserBuffer + start, length);
+#ifdef USE_DEBUG_SNAPSHOTS
+						for (int32 i = 1; i < length; i++)
+							fBuffer->CaptureChar(fParserBuffer[start + i]);
+#endif
+						fParserBufferOffset = start + length;
+						break;
+					}
 					fBuffer->InsertChar((char)c);
 					break;
 				}
@@ -1327,12 +1342,13 @@ TermParse::_ReadParserBuffer()
 	if (toRead > ESC_PARSER_BUFFER_SIZE)
 		toRead = ESC_PARSER_BUFFER_SIZE;
 
-	for (int32 i = 0; i < toRead; i++) {
-		// TODO: This could be optimized using memcpy instead and
-		// calculating space left as in the PtyReader().
-		fParserBuffer[i] = fReadBuffer[fBufferPosition];
-		fBufferPosition = (fBufferPosition + 1) % READ_BUF_SIZE;
-	}
+	int32 left = READ_BUF_SIZE - fBufferPosition;
+	if (toRead > left) {
+		memcpy(fParserBuffer, fReadBuffer + fBufferPosition, left);
+		memcpy(fParserBuffer + left, fReadBuffer, toRead - left);
+	} else
+		memcpy(fParserBuffer, fReadBuffer + fBufferPosition, toRead);
+	fBufferPosition = (fBufferPosition + toRead) % READ_BUF_SIZE;
 
 	int32 bufferSize = atomic_add(&fReadBufferSize, -toRead);
 
@@ -1351,6 +1367,47 @@ TermParse::_ReadParserBuffer()
 }
 
 
+/*!	Returns the number of bytes following the current parser buffer offset
+	that form a run of plain printable characters, i.e. ASCII characters and
+	complete UTF-8 sequences, which don't need any further parsing.
+*/
+int32
+TermParse::_PrintableRunLength(const int* groundtable) const
+{
+	int32 offset = fParserBufferOffset;
+	while (offset < fParserBufferSize) {
+		uchar c = fParserBuffer[offset];
+		int32 length;
+		switch (groundtable[c]) {
+			case CASE_PRINT:
+				length = c < 128 ? 1 : 0;
+				break;
+			case CASE_UTF8_2BYTE:
+				length = 2;
+				break;
+			case CASE_UTF8_3BYTE:
+				length = 3;
+				break;
+			default:
+				length = 0;
+				break;
+		}
+
+		if (length == 0 || offset + length > fParserBufferSize)
+			break;
+
+		for (int32 i = 1; i < length; i++) {
+			if (groundtable[fParserBuffer[offset + i]] != CASE_UTF8_INSTRING)
+				return offset - fParserBufferOffset;
+		}
+
+		offset += length;
+	}
+
+	return offset - fParserBufferOffset;
+}
+
+
 void
 TermParse::_DeviceStatusReport(int n)
 {
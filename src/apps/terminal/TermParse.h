@@ -19,11 +19,11 @@
 #include <OS.h>
 
 
-#define READ_BUF_SIZE 2048
+#define READ_BUF_SIZE 8192
 	// pty read buffer size
 #define MIN_PTY_BUFFER_SPACE	16
 	// minimal space left before the reader tries to read more
-#define ESC_PARSER_BUFFER_SIZE	64
+#define ESC_PARSER_BUFFER_SIZE	1024
 	// size of the parser buffer
 
 
@@ -56,6 +56,7 @@ private:
 	static int32 _escparse_thread(void *);
 
 	status_t _ReadParserBuffer();
+	int32 _PrintableRunLength(const int* groundtable) const;
 
 	void _DeviceStatusReport(int n);
 	void _DecReqTermParms(int value);
@@ -47,6 +47,7 @@
 #include <Region.h>
 #include <Roster.h>
 #include <ScrollBar.h>
+#include <Screen.h>
 #include <ScrollView.h>
 #include <String.h>
 #include <StringView.h>
@@ -93,8 +94,10 @@ static property_info sPropList[] = {
 
 static const uint32 kUpdateSigWinch = 'Rwin';
 static const uint32 kBlinkCursor = 'BlCr';
+static const uint32 kFrameSync = 'FrSy';
 
 static const bigtime_t kSyncUpdateGranularity = 100000;	// 0.1 s
+static const bigtime_t kDefaultFrameInterval = 1000000 / 60;
 
 static const int32 kCursorBlinkIntervals = 3;
 static const int32 kCursorVisibleIntervals = 2;
@@ -310,6 +313,9 @@ TermView::_InitObject(const ShellParameters& shellParameters)
 	fScrolledSinceLastSync = 0;
 	fSyncRunner = NULL;
 	fConsiderClockedSync = false;
+	fFrameInterval = kDefaultFrameInterval;
+	fLastFrameTime = 0;
+	fFrameSyncPending = false;
 	fSelection.SetHighlighter(this);
 	fSelection.SetRange(TermPos(0, 0), TermPos(0, 0));
 	fPrevPos = TermPos(-1, - 1);
@@ -1321,6 +1327,8 @@ TermView::AttachedToWindow()
 		_UpdateScrollBarRange();
 	}
 
+	UpdateFrameInterval();
+
 	BMessenger thisMessenger(this);
 
 	BMessage message(kUpdateSigWinch);
@@ -1847,8 +1855,29 @@ TermView::MessageReceived(BMessage *message)
 		case kSecondaryMouseDropAction:
 			_DoSecondaryMouseDropAction(message);
 			break;
+		case kFrameSync:
+			fFrameSyncPending = false;
+			// fall through
 		case MSG_TERMINAL_BUFFER_CHANGED:
 		{
+			// Don't synchronize more often than the screen is refreshed.
+			// The buffer won't notify us again before we have synchronized,
+			// so we just delay the update until the next frame is due.
+			if (fFrameSyncPending)
+				break;
+
+			bigtime_t now = system_time();
+			if (now - fLastFrameTime < fFrameInterval) {
+				BMessage frameMessage(kFrameSync);
+				if (BMessageRunner::StartSending(BMessenger(this),
+						&frameMessage, fLastFrameTime + fFrameInterval - now,
+						1) == B_OK) {
+					fFrameSyncPending = true;
+					break;
+				}
+			}
+			fLastFrameTime = now;
+
 			TextBufferSyncLocker _(this);
 			_SynchronizeWithTextBuffer(0, -1);
 			break;
@@ -2253,6 +2282,28 @@ TermView::_DoFileDrop(entry_ref& ref)
 }
 
 
+/*!	Determines the refresh rate of the screen the view is shown on, and
+	uses it to limit how often the view is synchronized with the text buffer.
+	The window calls it again whenever the screen mode may have changed.
+*/
+void
+TermView::UpdateFrameInterval()
+{
+	fFrameInterval = kDefaultFrameInterval;
+
+	display_mode mode;
+	if (BScreen(Window()).GetMode(&mode) != B_OK)
+		return;
+
+	uint32 pixels = (uint32)mode.timing.h_total * mode.timing.v_total;
+	if (pixels == 0 || mode.timing.pixel_clock == 0)
+		return;
+
+	// the pixel clock is given in kHz
+	fFrameInterval = (bigtime_t)pixels * 1000 / mode.timing.pixel_clock;
+}
+
+
 /*!	Text buffer must already be locked.
 */
 void
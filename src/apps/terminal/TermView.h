@@ -114,6 +114,8 @@ public:
 
 			void				SwitchCursorBlinking(bool blinkingOn);
 
+			void				UpdateFrameInterval();
+
 			// edit functions
 			void				Copy(BClipboard* clipboard);
 			void				Paste(BClipboard* clipboard);
@@ -336,6 +338,9 @@ private:
 			int32				fScrolledSinceLastSync;
 			BMessageRunner*		fSyncRunner;
 			bool				fConsiderClockedSync;
+			bigtime_t			fFrameInterval;
+			bigtime_t			fLastFrameTime;
+			bool				fFrameSyncPending;
 
 			// selection
 			Highlight			fSelection;
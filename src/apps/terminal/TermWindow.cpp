@@ -1601,6 +1601,18 @@ void
 TermWindow::WorkspaceActivated(int32 workspace, bool state)
 {
 	fTerminalRoster.SetWindowInfo(IsMinimized(), Workspaces());
+
+	// each workspace may use a different screen mode
+	if (state)
+		_UpdateFrameIntervals();
+}
+
+
+void
+TermWindow::ScreenChanged(BRect screenFrame, color_space mode)
+{
+	BWindow::ScreenChanged(screenFrame, mode);
+	_UpdateFrameIntervals();
 }
 
 
@@ -1793,6 +1805,14 @@ TermWindow::_ResizeView(TermView *view)
 }
 
 
+void
+TermWindow::_UpdateFrameIntervals()
+{
+	for (int32 i = 0; i < fTabView->CountTabs(); i++)
+		_TermViewAt(i)->UpdateFrameInterval();
+}
+
+
 /* static */ void
 TermWindow::MakeWindowSizeMenu(BMenu* menu)
 {
@@ -78,6 +78,8 @@ protected:
 									uint32 newWorkspaces);
 	virtual void				WorkspaceActivated(int32 workspace,
 									bool state);
+	virtual void				ScreenChanged(BRect screenFrame,
+									color_space mode);
 	virtual void				Minimize(bool minimize);
 
 private:
@@ -174,6 +176,7 @@ private:
 
 			void				_CheckChildren();
 			void				_ResizeView(TermView* view);
+			void				_UpdateFrameIntervals();
 
 			void				_TitleSettingsChanged();
 			void				_UpdateTitles();
@@ -241,8 +241,10 @@ struct AttributesRun {
 };
 
 
+/*!	A line as stored in the history. The attributes runs and the characters
+	of the line directly follow the structure.
+*/
 struct HistoryLine {
-	AttributesRun*	attributesRuns;
 	uint16			attributesRunCount;	// number of attribute runs
 	uint16			byteLength : 15;	// number of bytes in the line
 	bool			softBreak : 1;		// soft line break;
@@ -250,17 +252,18 @@ struct HistoryLine {
 
 	AttributesRun* AttributesRuns() const
 	{
-		return attributesRuns;
+		return (AttributesRun*)(this + 1);
 	}
 
 	char* Chars() const
 	{
-		return (char*)(attributesRuns + attributesRunCount);
+		return (char*)(AttributesRuns() + attributesRunCount);
 	}
 
 	int32 BufferSize() const
 	{
-		return attributesRunCount * sizeof(AttributesRun) + byteLength;
+		return sizeof(HistoryLine) + attributesRunCount * sizeof(AttributesRun)
+			+ byteLength;
 	}
 };
 
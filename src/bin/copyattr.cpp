@@ -4,6 +4,7 @@
  */
 
 #include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -260,9 +261,44 @@ copy_file_data(const char *sourcePath, BFile &source, const char *destPath,
 {
 	char buffer[kCopyBufferSize];
 	off_t offset = 0;
+	off_t dataEnd = -1;
 	while (true) {
+		if (offset >= dataEnd) {
+			dataEnd = LLONG_MAX;
+#if defined(SEEK_DATA) && defined(HAIKU_TARGET_PLATFORM_HAIKU)
+			// Skip holes, so that they remain holes in the destination.
+			// Only on Haiku, as Seek() must return errors as negative values
+			// to tell them apart from offsets: the <build>copyattr version
+			// gets the host's positive errno values instead.
+			off_t dataStart = source.Seek(offset, SEEK_DATA);
+			if (dataStart == ENXIO) {
+				off_t size;
+				if (source.GetSize(&size) == B_OK && size > offset) {
+					status_t error = destination.SetSize(size);
+					if (error != B_OK) {
+						fprintf(stderr, "Error: Failed to set size of file "
+							"\"%s\": %s\n", destPath, strerror(error));
+						exit(1);
+					}
+				}
+				return;
+			}
+
+			if (dataStart >= offset) {
+				offset = dataStart;
+				dataEnd = source.Seek(offset, SEEK_HOLE);
+				if (dataEnd <= offset)
+					dataEnd = LLONG_MAX;
+			}
+#endif
+		}
+
 		// read
-		ssize_t bytesRead = source.ReadAt(offset, buffer, sizeof(buffer));
+		size_t toRead = sizeof(buffer);
+		if ((off_t)toRead > dataEnd - offset)
+			toRead = dataEnd - offset;
+
+		ssize_t bytesRead = source.ReadAt(offset, buffer, toRead);
 		if (bytesRead < 0) {
 			fprintf(stderr, "Error: Failed to read from file \"%s\": %s\n",
 				sourcePath, strerror(bytesRead));
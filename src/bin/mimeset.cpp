@@ -18,6 +18,9 @@
 #include <mime/DatabaseLocation.h>
 #include <mime/MimeInfoUpdater.h>
 #include <mime/MimeSnifferAddonManager.h>
+#ifdef HAIKU_TARGET_PLATFORM_HAIKU
+#	include <mime/ParallelMimeInfoUpdater.h>
+#endif
 #include <mime/TextSnifferAddon.h>
 
 
@@ -31,6 +34,8 @@ static const char* sProgramName = __progname;
 bool gFiles = true;
 bool gApps = false;
 int gForce = B_UPDATE_MIME_INFO_NO_FORCE;
+bool gParallel = false;
+bool gProgress = false;
 
 static Database* sDatabase = NULL;
 
@@ -58,11 +63,17 @@ usage(int status)
 		"    type of a file.\n"
 		"  -h, --help\n"
 		"    Display this help information.\n"
+		"  -j, --parallel\n"
+		"    Update the files' MIME information using several threads. Meant\n"
+		"    for large directory trees.\n"
 		"  -m, --mimedb <directory>\n"
 		"    Instead of the system MIME DB use the given directory\n"
 		"    <directory>. The option can occur multiple times to specify a\n"
 		"    list of directories. MIME DB changes are written to the first\n"
 		"    specified directory.\n"
+		"  -p, --progress\n"
+		"    Together with --parallel and --mimedb, print the progress of the\n"
+		"    update.\n"
 		"\n"
 		"Obsolete options:\n"
 		"  -all  (synonymous with --all)\n"
@@ -74,6 +85,36 @@ usage(int status)
 }
 
 
+#ifdef HAIKU_TARGET_PLATFORM_HAIKU
+
+class ProgressPrinter : public ParallelMimeInfoUpdater::ProgressListener {
+public:
+	virtual bool UpdateProgress(
+		const ParallelMimeInfoUpdater::Progress& progress)
+	{
+		fprintf(stderr, "\r%" B_PRId64 " entries, %" B_PRId64 " updated, %"
+			B_PRId64 " skipped, %" B_PRId64 " failed%s", progress.entries,
+			progress.updated, progress.skipped, progress.failed,
+			progress.done ? "\n" : "");
+		return true;
+	}
+};
+
+
+static status_t
+update_files_in_parallel(const entry_ref& ref)
+{
+	ProgressPrinter progressPrinter;
+	ParallelMimeInfoUpdater updater(sDatabase, NULL, gForce);
+	if (gProgress)
+		updater.SetProgressListener(&progressPrinter, 500000);
+
+	return updater.Update(ref, true);
+}
+
+#endif	// HAIKU_TARGET_PLATFORM_HAIKU
+
+
 static status_t
 process_file_with_custom_mime_db(const BEntry& entry)
 {
@@ -83,8 +124,14 @@ process_file_with_custom_mime_db(const BEntry& entry)
 	entry_ref ref;
 	status_t error = entry.GetRef(&ref);
 
-	if (gFiles && error == B_OK)
-		error = mimeInfoUpdater.DoRecursively(ref);
+	if (gFiles && error == B_OK) {
+#ifdef HAIKU_TARGET_PLATFORM_HAIKU
+		if (gParallel)
+			error = update_files_in_parallel(ref);
+		else
+#endif
+			error = mimeInfoUpdater.DoRecursively(ref);
+	}
 	if (gApps && error == B_OK) {
 		error = appMetaMimeCreator.DoRecursively(ref);
 		if (error == B_BAD_TYPE) {
@@ -119,8 +166,10 @@ process_file(const char* path)
 	if (sDatabase != NULL)
 		return process_file_with_custom_mime_db(entry);
 
-	if (gFiles && status == B_OK)
-		status = update_mime_info(path, true, true, gForce);
+	if (gFiles && status == B_OK) {
+		status = update_mime_info(path, true, true,
+			gForce | (gParallel ? B_UPDATE_MIME_INFO_PARALLEL : 0));
+	}
 	if (gApps && status == B_OK)
 		status = create_app_meta_mime(path, true, true, gForce);
 
@@ -156,11 +205,13 @@ main(int argc, const char** argv)
 			{ "apps", no_argument, 0, 'a' },
 			{ "help", no_argument, 0, 'h' },
 			{ "mimedb", required_argument, 0, 'm' },
+			{ "parallel", no_argument, 0, 'j' },
+			{ "progress", no_argument, 0, 'p' },
 			{ 0, 0, 0, 0 }
 		};
 
 		opterr = 0; // don't print errors
-		int c = getopt_long(argc, (char**)argv, "aAfFhm:", sLongOptions,
+		int c = getopt_long(argc, (char**)argv, "aAfFhjm:p", sLongOptions,
 			NULL);
 		if (c == -1)
 			break;
@@ -183,9 +234,15 @@ main(int argc, const char** argv)
 			case 'h':
 				usage(0);
 				break;
+			case 'j':
+				gParallel = true;
+				break;
 			case 'm':
 				databaseDirectories.Add(optarg);
 				break;
+			case 'p':
+				gProgress = true;
+				break;
 			default:
 				usage(1);
 				break;
@@ -285,6 +285,7 @@ BMessage::_InitCommon(bool initHeader)
 
 	fOriginal = NULL;
 	fQueueLink = NULL;
+	fInPlace = false;
 
 	if (initHeader)
 		return _InitHeader();
@@ -329,6 +330,13 @@ BMessage::_Clear()
 {
 	DEBUG_FUNCTION_ENTER;
 	if (fHeader != NULL) {
+		if (fInPlace) {
+			// fFields and fData are part of the header buffer
+			fFields = NULL;
+			fData = NULL;
+			fInPlace = false;
+		}
+
 		free(fHeader);
 		fHeader = NULL;
 	}
@@ -648,6 +656,12 @@ BMessage::Rename(const char *oldEntry, const char *newEntry)
 	if (oldEntry == NULL || newEntry == NULL)
 		return B_BAD_VALUE;
 
+	if (fInPlace) {
+		status_t result = _CopyForWrite();
+		if (result != B_OK)
+			return result;
+	}
+
 	uint32 hash = _HashName(oldEntry) % fHeader->hash_table_size;
 	int32 *nextField = &fHeader->hash_table[hash];
 
@@ -832,6 +846,59 @@ BMessage::Flatten(BDataIO *stream, ssize_t *size) const
 }
 
 
+status_t
+BMessage::_CopyForWrite()
+{
+	DEBUG_FUNCTION_ENTER;
+	if (fHeader == NULL)
+		return B_NO_INIT;
+
+	message_header *newHeader
+		= (message_header *)malloc(sizeof(message_header));
+	if (newHeader == NULL)
+		return B_NO_MEMORY;
+
+	memcpy(newHeader, fHeader, sizeof(message_header));
+
+	field_header *newFields = NULL;
+	uint8 *newData = NULL;
+
+	if (fHeader->field_count > 0) {
+		size_t fieldsSize = fHeader->field_count * sizeof(field_header);
+		newFields = (field_header *)malloc(fieldsSize);
+		if (newFields == NULL) {
+			free(newHeader);
+			return B_NO_MEMORY;
+		}
+
+		memcpy(newFields, fFields, fieldsSize);
+	}
+
+	if (fHeader->data_size > 0) {
+		newData = (uint8 *)malloc(fHeader->data_size);
+		if (newData == NULL) {
+			free(newHeader);
+			free(newFields);
+			return B_NO_MEMORY;
+		}
+
+		memcpy(newData, fData, fHeader->data_size);
+	}
+
+	// the fields and data are part of the header buffer
+	free(fHeader);
+	fInPlace = false;
+
+	fFieldsAvailable = 0;
+	fDataAvailable = 0;
+
+	fHeader = newHeader;
+	fFields = newFields;
+	fData = newData;
+	return B_OK;
+}
+
+
 status_t
 BMessage::_ValidateMessage()
 {
@@ -989,6 +1056,97 @@ BMessage::Unflatten(BDataIO *stream)
 }
 
 
+/*!	Unflattens the message from \a buffer without copying it: the message
+	takes over the buffer, which must have been allocated with malloc(), and
+	uses its header, fields and data where they are. The buffer is freed with
+	the message, or as soon as the message is modified.
+	Messages in a foreign format are unflattened the usual way. In any case,
+	the buffer belongs to the message after this call, even if an error is
+	returned.
+*/
+status_t
+BMessage::_UnflattenInPlace(void *buffer, size_t size)
+{
+	DEBUG_FUNCTION_ENTER;
+	if (buffer == NULL)
+		return B_BAD_VALUE;
+
+	message_header *header = (message_header *)buffer;
+	if (size < sizeof(message_header)
+		|| header->format != MESSAGE_FORMAT_HAIKU) {
+		status_t result = size >= sizeof(uint32)
+			? Unflatten((const char *)buffer) : B_BAD_VALUE;
+		free(buffer);
+		return result;
+	}
+
+	_Clear();
+
+	uint64 fieldsSize = (uint64)header->field_count * sizeof(field_header);
+	if ((header->flags & MESSAGE_FLAG_VALID) == 0
+		|| sizeof(message_header) + fieldsSize + header->data_size > size) {
+		free(buffer);
+		_InitHeader();
+		return B_BAD_VALUE;
+	}
+
+	fHeader = header;
+	fInPlace = true;
+
+	what = header->what;
+	header->message_area = -1;
+
+	uint8 *body = (uint8 *)buffer + sizeof(message_header);
+	if (header->field_count > 0)
+		fFields = (field_header *)body;
+	if (header->data_size > 0)
+		fData = body + fieldsSize;
+
+	return _ValidateMessage();
+}
+
+
+/*!	Makes sure that \a fieldCount more fields and \a dataSize more bytes of
+	data can be added without having to grow the buffers again.
+*/
+status_t
+BMessage::_Reserve(uint32 fieldCount, size_t dataSize)
+{
+	DEBUG_FUNCTION_ENTER;
+	if (fHeader == NULL)
+		return B_NO_INIT;
+
+	if (fInPlace) {
+		status_t result = _CopyForWrite();
+		if (result != B_OK)
+			return result;
+	}
+
+	if (fFieldsAvailable < fieldCount) {
+		uint32 count = fHeader->field_count + fieldCount;
+		field_header *newFields = (field_header *)realloc(fFields,
+			count * sizeof(field_header));
+		if (newFields == NULL)
+			return B_NO_MEMORY;
+
+		fFields = newFields;
+		fFieldsAvailable = fieldCount;
+	}
+
+	if (fDataAvailable < dataSize) {
+		size_t size = fHeader->data_size + dataSize;
+		uint8 *newData = (uint8 *)realloc(fData, size);
+		if (newData == NULL)
+			return B_NO_MEMORY;
+
+		fData = newData;
+		fDataAvailable = dataSize;
+	}
+
+	return B_OK;
+}
+
+
 status_t
 BMessage::AddSpecifier(const char *property)
 {
@@ -1379,6 +1537,12 @@ BMessage::AddData(const char *name, type_code type, const void *data,
 	if (numBytes <= 0 || data == NULL)
 		return B_BAD_VALUE;
 
+	if (fInPlace) {
+		status_t result = _CopyForWrite();
+		if (result != B_OK)
+			return result;
+	}
+
 	field_header *field = NULL;
 	status_t result = _FindField(name, type, &field);
 	if (result == B_NAME_NOT_FOUND)
@@ -1434,6 +1598,12 @@ BMessage::RemoveData(const char *name, int32 index)
 	if (index < 0)
 		return B_BAD_INDEX;
 
+	if (fInPlace) {
+		status_t result = _CopyForWrite();
+		if (result != B_OK)
+			return result;
+	}
+
 	field_header *field = NULL;
 	status_t result = _FindField(name, B_ANY_TYPE, &field);
 
@@ -1481,6 +1651,12 @@ status_t
 BMessage::RemoveName(const char *name)
 {
 	DEBUG_FUNCTION_ENTER;
+	if (fInPlace) {
+		status_t result = _CopyForWrite();
+		if (result != B_OK)
+			return result;
+	}
+
 	field_header *field = NULL;
 	status_t result = _FindField(name, B_ANY_TYPE, &field);
 
@@ -1552,6 +1728,12 @@ BMessage::ReplaceData(const char *name, type_code type, int32 index,
 	if (numBytes <= 0 || data == NULL)
 		return B_BAD_VALUE;
 
+	if (fInPlace) {
+		status_t result = _CopyForWrite();
+		if (result != B_OK)
+			return result;
+	}
+
 	field_header *field = NULL;
 	status_t result = _FindField(name, type, &field);
 
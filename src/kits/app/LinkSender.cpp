@@ -170,7 +170,7 @@ LinkSender::Attach(const void *passedData, size_t passedSize)
 			fTargetTeam = info.team;
 		}
 		void* address = NULL;
-		off_t alignedSize = (passedSize + B_PAGE_SIZE) & ~(B_PAGE_SIZE - 1);
+		off_t alignedSize = (passedSize + B_PAGE_SIZE - 1) & ~(B_PAGE_SIZE - 1);
 		senderArea = create_area("LinkSenderArea", &address, B_ANY_ADDRESS,
 			alignedSize, B_NO_LOCK, B_READ_AREA | B_WRITE_AREA);
 
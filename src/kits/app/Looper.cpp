@@ -1018,6 +1018,8 @@ BLooper::_InitData(const char* name, int32 priority, port_id port,
 	fThread = B_ERROR;
 	fTerminating = false;
 	fOwnsPort = true;
+	fPortBuffer = NULL;
+	fPortBufferSize = 0;
 	fMsgPort = -1;
 	fAtomicCount = 0;
 
@@ -1095,6 +1097,13 @@ BLooper::_task0_(void* arg)
 
 void*
 BLooper::ReadRawFromPort(int32* msgCode, bigtime_t timeout)
+{
+	return _ReadRawFromPort(msgCode, NULL, timeout);
+}
+
+
+void*
+BLooper::_ReadRawFromPort(int32* msgCode, ssize_t* _size, bigtime_t timeout)
 {
 	PRINT(("BLooper::ReadRawFromPort()\n"));
 	uint8* buffer = NULL;
@@ -1127,6 +1136,8 @@ BLooper::ReadRawFromPort(int32* msgCode, bigtime_t timeout)
 	PRINT(("BLooper::ReadRawFromPort() read: %.4s, %p (%d bytes)\n",
 		(char*)msgCode, buffer, bufferSize));
 
+	if (_size != NULL)
+		*_size = bufferSize;
 	return buffer;
 }
 
@@ -1138,12 +1149,23 @@ BLooper::ReadMessageFromPort(bigtime_t timeout)
 	int32 msgCode;
 	BMessage* message = NULL;
 
-	void* buffer = ReadRawFromPort(&msgCode, timeout);
+	ssize_t size;
+	void* buffer = _ReadRawFromPort(&msgCode, &size, timeout);
 	if (buffer == NULL)
 		return NULL;
 
+	// Our ConvertToMessage() takes the buffer over, and uses it in place
+	// instead of copying the fields and data out of it once more; if it has
+	// been overridden and does not call us, we still own the buffer.
+	fPortBuffer = buffer;
+	fPortBufferSize = size;
+
 	message = ConvertToMessage(buffer, msgCode);
-	free(buffer);
+
+	if (fPortBuffer != NULL) {
+		fPortBuffer = NULL;
+		free(buffer);
+	}
 
 	PRINT(("BLooper::ReadMessageFromPort() done: %p\n", message));
 	return message;
@@ -1158,7 +1180,16 @@ BLooper::ConvertToMessage(void* buffer, int32 code)
 		return NULL;
 
 	BMessage* message = new BMessage();
-	if (message->Unflatten((const char*)buffer) != B_OK) {
+	status_t status;
+	if (buffer == fPortBuffer) {
+		// the buffer has just been read from our port, and is ours now
+		fPortBuffer = NULL;
+		status = BMessage::Private(message).UnflattenInPlace(buffer,
+			fPortBufferSize);
+	} else
+		status = message->Unflatten((const char*)buffer);
+
+	if (status != B_OK) {
 		PRINT(("BLooper::ConvertToMessage(): unflattening message failed\n"));
 		delete message;
 		message = NULL;
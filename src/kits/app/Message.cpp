@@ -357,6 +357,7 @@ BMessage::_InitCommon(bool initHeader)
 	fQueueLink = NULL;
 
 	fArchivingPointer = NULL;
+	fInPlace = false;
 
 	if (initHeader)
 		return _InitHeader();
@@ -409,6 +410,13 @@ BMessage::_Clear()
 		if (fHeader->message_area >= 0)
 			_Dereference();
 
+		if (fInPlace) {
+			// fFields and fData are part of the header buffer
+			fFields = NULL;
+			fData = NULL;
+			fInPlace = false;
+		}
+
 		free(fHeader);
 		fHeader = NULL;
 	}
@@ -777,7 +785,7 @@ BMessage::Rename(const char* oldEntry, const char* newEntry)
 		return B_NO_INIT;
 
 	status_t result;
-	if (fHeader->message_area >= 0) {
+	if (fHeader->message_area >= 0 || fInPlace) {
 		result = _CopyForWrite();
 		if (result != B_OK)
 			return result;
@@ -1152,7 +1160,7 @@ BMessage::_FlattenToArea(message_header** _header) const
 	char* address = NULL;
 	size_t fieldsSize = header->field_count * sizeof(field_header);
 	size_t size = fieldsSize + header->data_size;
-	size = (size + B_PAGE_SIZE) & ~(B_PAGE_SIZE - 1);
+	size = (size + B_PAGE_SIZE - 1) & ~(B_PAGE_SIZE - 1);
 	area_id area = create_area("BMessage data", (void**)&address,
 		B_ANY_ADDRESS, size, B_NO_LOCK, B_READ_AREA | B_WRITE_AREA);
 
@@ -1245,7 +1253,23 @@ BMessage::_CopyForWrite()
 		memcpy(newData, fData, fHeader->data_size);
 	}
 
-	_Dereference();
+	if (fInPlace) {
+		// the header shares its buffer with the fields and data, so it
+		// needs to be copied, too
+		message_header* newHeader
+			= (message_header*)malloc(sizeof(message_header));
+		if (newHeader == NULL) {
+			free(newFields);
+			free(newData);
+			return B_NO_MEMORY;
+		}
+
+		memcpy(newHeader, fHeader, sizeof(message_header));
+		free(fHeader);
+		fHeader = newHeader;
+		fInPlace = false;
+	} else
+		_Dereference();
 
 	fFieldsAvailable = 0;
 	fDataAvailable = 0;
@@ -1381,6 +1405,98 @@ BMessage::Unflatten(BDataIO* stream)
 }
 
 
+/*!	Unflattens the message from \a buffer without copying it: the message
+	takes over the buffer, which must have been allocated with malloc(), and
+	its header, fields and data are used where they are. The buffer is freed
+	with the message, or as soon as the message is modified, as the fields and
+	data are then copied like for messages passed by area.
+	Messages in a foreign format or passed by area are unflattened the usual
+	way. In any case, the buffer belongs to the message after this call, even
+	if an error is returned.
+*/
+status_t
+BMessage::_UnflattenInPlace(void* buffer, size_t size)
+{
+	DEBUG_FUNCTION_ENTER;
+	if (buffer == NULL)
+		return B_BAD_VALUE;
+
+	message_header* header = (message_header*)buffer;
+	if (size < sizeof(message_header) || header->format != MESSAGE_FORMAT_HAIKU
+		|| (header->flags & MESSAGE_FLAG_PASS_BY_AREA) != 0) {
+		status_t result = size >= sizeof(uint32)
+			? Unflatten((const char*)buffer) : B_BAD_VALUE;
+		free(buffer);
+		return result;
+	}
+
+	_Clear();
+
+	uint64 fieldsSize = (uint64)header->field_count * sizeof(field_header);
+	if ((header->flags & MESSAGE_FLAG_VALID) == 0
+		|| sizeof(message_header) + fieldsSize + header->data_size > size) {
+		free(buffer);
+		_InitHeader();
+		return B_BAD_VALUE;
+	}
+
+	fHeader = header;
+	fInPlace = true;
+
+	what = header->what;
+	header->message_area = -1;
+
+	uint8* body = (uint8*)buffer + sizeof(message_header);
+	if (header->field_count > 0)
+		fFields = (field_header*)body;
+	if (header->data_size > 0)
+		fData = body + fieldsSize;
+
+	return _ValidateMessage();
+}
+
+
+/*!	Makes sure that \a fieldCount more fields and \a dataSize more bytes of
+	data can be added without having to grow the buffers again.
+*/
+status_t
+BMessage::_Reserve(uint32 fieldCount, size_t dataSize)
+{
+	DEBUG_FUNCTION_ENTER;
+	if (fHeader == NULL)
+		return B_NO_INIT;
+
+	if (fHeader->message_area >= 0 || fInPlace) {
+		status_t result = _CopyForWrite();
+		if (result != B_OK)
+			return result;
+	}
+
+	if (fFieldsAvailable < fieldCount) {
+		uint32 count = fHeader->field_count + fieldCount;
+		field_header* newFields = (field_header*)realloc(fFields,
+			count * sizeof(field_header));
+		if (newFields == NULL)
+			return B_NO_MEMORY;
+
+		fFields = newFields;
+		fFieldsAvailable = fieldCount;
+	}
+
+	if (fDataAvailable < dataSize) {
+		size_t size = fHeader->data_size + dataSize;
+		uint8* newData = (uint8*)realloc(fData, size);
+		if (newData == NULL)
+			return B_NO_MEMORY;
+
+		fData = newData;
+		fDataAvailable = dataSize;
+	}
+
+	return B_OK;
+}
+
+
 status_t
 BMessage::AddSpecifier(const char* property)
 {
@@ -1802,7 +1918,7 @@ BMessage::AddData(const char* name, type_code type, const void* data,
 		return B_NO_INIT;
 
 	status_t result;
-	if (fHeader->message_area >= 0) {
+	if (fHeader->message_area >= 0 || fInPlace) {
 		result = _CopyForWrite();
 		if (result != B_OK)
 			return result;
@@ -1867,7 +1983,7 @@ BMessage::RemoveData(const char* name, int32 index)
 		return B_NO_INIT;
 
 	status_t result;
-	if (fHeader->message_area >= 0) {
+	if (fHeader->message_area >= 0 || fInPlace) {
 		result = _CopyForWrite();
 		if (result != B_OK)
 			return result;
@@ -1920,7 +2036,7 @@ BMessage::RemoveName(const char* name)
 		return B_NO_INIT;
 
 	status_t result;
-	if (fHeader->message_area >= 0) {
+	if (fHeader->message_area >= 0 || fInPlace) {
 		result = _CopyForWrite();
 		if (result != B_OK)
 			return result;
@@ -1989,7 +2105,7 @@ BMessage::ReplaceData(const char* name, type_code type, int32 index,
 		return B_BAD_VALUE;
 
 	status_t result;
-	if (fHeader->message_area >= 0) {
+	if (fHeader->message_area >= 0 || fInPlace) {
 		result = _CopyForWrite();
 		if (result != B_OK)
 			return result;
@@ -15,6 +15,7 @@
 
 #include <InterfaceDefs.h>
 #include <Locker.h>
+#include <OS.h>
 #include <Point.h>
 
 #include <Palette.h>
@@ -23,6 +24,11 @@
 #include <string.h>
 #include <pthread.h>
 
+#if defined(__x86_64__)
+#	include <emmintrin.h>
+#	include <tmmintrin.h>
+#endif
+
 
 using std::nothrow;
 
@@ -1080,6 +1086,499 @@ ConvertBits(const srcByte *srcBits, void *dstBits, int32 srcBitsLength,
 }
 
 
+// #pragma mark - fast paths
+
+
+/*!	The generic conversion above handles every pair of color spaces, but it
+	goes through a function pointer and a set of bounds and shift checks for
+	every single pixel. The most common conversions have dedicated row
+	converters below, which compute exactly the same values.
+*/
+
+
+typedef void (convertRowFunc)(const uint8 *source, uint8 *dest, int32 width,
+	const uint32 *table);
+
+
+enum {
+	ALPHA_NONE = 0,
+	ALPHA_OPAQUE,
+	ALPHA_FROM_SOURCE
+};
+
+
+struct RGB32ToRGB16 {
+	static inline uint32 Convert(uint32 pixel)
+	{
+		return ((pixel >> 8) & 0xf800) | ((pixel >> 5) & 0x07e0)
+			| ((pixel >> 3) & 0x001f);
+	}
+
+#if defined(__x86_64__)
+	static inline __m128i Convert(__m128i pixel)
+	{
+		return _mm_or_si128(_mm_or_si128(
+			_mm_and_si128(_mm_srli_epi32(pixel, 8), _mm_set1_epi32(0xf800)),
+			_mm_and_si128(_mm_srli_epi32(pixel, 5), _mm_set1_epi32(0x07e0))),
+			_mm_and_si128(_mm_srli_epi32(pixel, 3), _mm_set1_epi32(0x001f)));
+	}
+#endif
+};
+
+
+template<int alphaMode>
+struct RGB32ToRGB15 {
+	static inline uint32 Convert(uint32 pixel)
+	{
+		uint32 result = ((pixel >> 9) & 0x7c00) | ((pixel >> 6) & 0x03e0)
+			| ((pixel >> 3) & 0x001f);
+		if (alphaMode == ALPHA_OPAQUE)
+			result |= 0x8000;
+		else if (alphaMode == ALPHA_FROM_SOURCE)
+			result |= (pixel >> 16) & 0x8000;
+		return result;
+	}
+
+#if defined(__x86_64__)
+	static inline __m128i Convert(__m128i pixel)
+	{
+		__m128i result = _mm_or_si128(_mm_or_si128(
+			_mm_and_si128(_mm_srli_epi32(pixel, 9), _mm_set1_epi32(0x7c00)),
+			_mm_and_si128(_mm_srli_epi32(pixel, 6), _mm_set1_epi32(0x03e0))),
+			_mm_and_si128(_mm_srli_epi32(pixel, 3), _mm_set1_epi32(0x001f)));
+		if (alphaMode == ALPHA_OPAQUE)
+			result = _mm_or_si128(result, _mm_set1_epi32(0x8000));
+		else if (alphaMode == ALPHA_FROM_SOURCE) {
+			result = _mm_or_si128(result, _mm_and_si128(
+				_mm_srli_epi32(pixel, 16), _mm_set1_epi32(0x8000)));
+		}
+		return result;
+	}
+#endif
+};
+
+
+struct RGB16ToRGB32 {
+	static inline uint32 Convert(uint32 pixel)
+	{
+		return ((pixel << 8) & 0xff0000) | ((pixel << 5) & 0x00ff00)
+			| ((pixel << 3) & 0x0000ff) | 0xff000000;
+	}
+
+#if defined(__x86_64__)
+	static inline __m128i Convert(__m128i pixel)
+	{
+		return _mm_or_si128(_mm_or_si128(
+			_mm_and_si128(_mm_slli_epi32(pixel, 8), _mm_set1_epi32(0xff0000)),
+			_mm_and_si128(_mm_slli_epi32(pixel, 5), _mm_set1_epi32(0x00ff00))),
+			_mm_or_si128(
+				_mm_and_si128(_mm_slli_epi32(pixel, 3), _mm_set1_epi32(0xff)),
+				_mm_set1_epi32(0xff000000)));
+	}
+#endif
+};
+
+
+template<int alphaMode>
+struct RGB15ToRGB32 {
+	static inline uint32 Convert(uint32 pixel)
+	{
+		uint32 result = ((pixel << 9) & 0xff0000) | ((pixel << 6) & 0x00ff00)
+			| ((pixel << 3) & 0x0000ff);
+		// The generic code shifts the whole upper byte into the alpha
+		// channel, and then makes it opaque if any bit of it is set.
+		if (alphaMode == ALPHA_OPAQUE)
+			result |= 0xff000000;
+		else if (alphaMode == ALPHA_FROM_SOURCE && (pixel & 0xff00) != 0)
+			result |= 0xff000000;
+		return result;
+	}
+
+#if defined(__x86_64__)
+	static inline __m128i Convert(__m128i pixel)
+	{
+		__m128i result = _mm_or_si128(_mm_or_si128(
+			_mm_and_si128(_mm_slli_epi32(pixel, 9), _mm_set1_epi32(0xff0000)),
+			_mm_and_si128(_mm_slli_epi32(pixel, 6), _mm_set1_epi32(0x00ff00))),
+			_mm_and_si128(_mm_slli_epi32(pixel, 3), _mm_set1_epi32(0xff)));
+		if (alphaMode == ALPHA_OPAQUE)
+			result = _mm_or_si128(result, _mm_set1_epi32(0xff000000));
+		else if (alphaMode == ALPHA_FROM_SOURCE) {
+			__m128i transparent = _mm_cmpeq_epi32(
+				_mm_and_si128(pixel, _mm_set1_epi32(0xff00)),
+				_mm_setzero_si128());
+			result = _mm_or_si128(result,
+				_mm_andnot_si128(transparent, _mm_set1_epi32(0xff000000)));
+		}
+		return result;
+	}
+#endif
+};
+
+
+struct RGB32ToOpaqueRGB32 {
+	static inline uint32 Convert(uint32 pixel)
+	{
+		return pixel | 0xff000000;
+	}
+
+#if defined(__x86_64__)
+	static inline __m128i Convert(__m128i pixel)
+	{
+		return _mm_or_si128(pixel, _mm_set1_epi32(0xff000000));
+	}
+#endif
+};
+
+
+template<typename Converter>
+static void
+ConvertRow32To16(const uint8 *source, uint8 *dest, int32 width,
+	const uint32 *table)
+{
+	const uint32 *src = (const uint32 *)source;
+	uint16 *dst = (uint16 *)dest;
+	for (int32 i = 0; i < width; i++)
+		dst[i] = Converter::Convert(src[i]);
+}
+
+
+template<typename Converter>
+static void
+ConvertRow16To32(const uint8 *source, uint8 *dest, int32 width,
+	const uint32 *table)
+{
+	const uint16 *src = (const uint16 *)source;
+	uint32 *dst = (uint32 *)dest;
+	for (int32 i = 0; i < width; i++)
+		dst[i] = Converter::Convert(src[i]);
+}
+
+
+template<typename Converter>
+static void
+ConvertRow32To32(const uint8 *source, uint8 *dest, int32 width,
+	const uint32 *table)
+{
+	const uint32 *src = (const uint32 *)source;
+	uint32 *dst = (uint32 *)dest;
+	for (int32 i = 0; i < width; i++)
+		dst[i] = Converter::Convert(src[i]);
+}
+
+
+static void
+ConvertRowRGB24ToRGB32(const uint8 *source, uint8 *dest, int32 width,
+	const uint32 *table)
+{
+	uint32 *dst = (uint32 *)dest;
+	for (int32 i = 0; i < width; i++) {
+		dst[i] = source[0] | (source[1] << 8) | (source[2] << 16) | 0xff000000;
+		source += 3;
+	}
+}
+
+
+static void
+ConvertRowRGB32ToRGB24(const uint8 *source, uint8 *dest, int32 width,
+	const uint32 *table)
+{
+	for (int32 i = 0; i < width; i++) {
+		dest[0] = source[0];
+		dest[1] = source[1];
+		dest[2] = source[2];
+		source += 4;
+		dest += 3;
+	}
+}
+
+
+static void
+ConvertRowCMAP8ToRGB32(const uint8 *source, uint8 *dest, int32 width,
+	const uint32 *table)
+{
+	uint32 *dst = (uint32 *)dest;
+	for (int32 i = 0; i < width; i++)
+		dst[i] = table[source[i]];
+}
+
+
+#if defined(__x86_64__)
+
+
+template<typename Converter>
+static void
+ConvertRow32To16SSE2(const uint8 *source, uint8 *dest, int32 width,
+	const uint32 *table)
+{
+	int32 i = 0;
+	for (; i + 8 <= width; i += 8) {
+		__m128i low = Converter::Convert(
+			_mm_loadu_si128((const __m128i *)(source + i * 4)));
+		__m128i high = Converter::Convert(
+			_mm_loadu_si128((const __m128i *)(source + i * 4 + 16)));
+
+		// sign extend the 16 bit results, so that the saturating pack
+		// leaves them alone
+		low = _mm_srai_epi32(_mm_slli_epi32(low, 16), 16);
+		high = _mm_srai_epi32(_mm_slli_epi32(high, 16), 16);
+		_mm_storeu_si128((__m128i *)(dest + i * 2),
+			_mm_packs_epi32(low, high));
+	}
+
+	ConvertRow32To16<Converter>(source + i * 4, dest + i * 2, width - i,
+		table);
+}
+
+
+template<typename Converter>
+static void
+ConvertRow16To32SSE2(const uint8 *source, uint8 *dest, int32 width,
+	const uint32 *table)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	int32 i = 0;
+	for (; i + 8 <= width; i += 8) {
+		__m128i pixels = _mm_loadu_si128((const __m128i *)(source + i * 2));
+		_mm_storeu_si128((__m128i *)(dest + i * 4),
+			Converter::Convert(_mm_unpacklo_epi16(pixels, zero)));
+		_mm_storeu_si128((__m128i *)(dest + i * 4 + 16),
+			Converter::Convert(_mm_unpackhi_epi16(pixels, zero)));
+	}
+
+	ConvertRow16To32<Converter>(source + i * 2, dest + i * 4, width - i,
+		table);
+}
+
+
+template<typename Converter>
+static void
+ConvertRow32To32SSE2(const uint8 *source, uint8 *dest, int32 width,
+	const uint32 *table)
+{
+	int32 i = 0;
+	for (; i + 4 <= width; i += 4) {
+		_mm_storeu_si128((__m128i *)(dest + i * 4), Converter::Convert(
+			_mm_loadu_si128((const __m128i *)(source + i * 4))));
+	}
+
+	ConvertRow32To32<Converter>(source + i * 4, dest + i * 4, width - i,
+		table);
+}
+
+
+__attribute__((target("ssse3")))
+static void
+ConvertRowRGB24ToRGB32SSSE3(const uint8 *source, uint8 *dest, int32 width,
+	const uint32 *table)
+{
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1,
+		6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+	// Every load reads 16 bytes of which only 12 are used, so we have to
+	// stop while the row still has those extra bytes.
+	int32 i = 0;
+	for (; i + 6 <= width; i += 4) {
+		__m128i pixels = _mm_loadu_si128((const __m128i *)(source + i * 3));
+		_mm_storeu_si128((__m128i *)(dest + i * 4),
+			_mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+	}
+
+	ConvertRowRGB24ToRGB32(source + i * 3, dest + i * 4, width - i, table);
+}
+
+
+__attribute__((target("ssse3")))
+static void
+ConvertRowRGB32ToRGB24SSSE3(const uint8 *source, uint8 *dest, int32 width,
+	const uint32 *table)
+{
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10,
+		12, 13, 14, -1, -1, -1, -1);
+
+	// Every store writes 16 bytes of which only 12 are valid, the rest is
+	// overwritten by the next iteration, so it must still be inside the row.
+	int32 i = 0;
+	for (; i + 6 <= width; i += 4) {
+		__m128i pixels = _mm_loadu_si128((const __m128i *)(source + i * 4));
+		_mm_storeu_si128((__m128i *)(dest + i * 3),
+			_mm_shuffle_epi8(pixels, shuffle));
+	}
+
+	ConvertRowRGB32ToRGB24(source + i * 4, dest + i * 3, width - i, table);
+}
+
+
+#endif	// __x86_64__
+
+
+#if defined(__x86_64__)
+#	define SELECT_SSE2(function) function##SSE2
+#else
+#	define SELECT_SSE2(function) function
+#endif
+
+static convertRowFunc *sConvertRGB24ToRGB32 = ConvertRowRGB24ToRGB32;
+static convertRowFunc *sConvertRGB32ToRGB24 = ConvertRowRGB32ToRGB24;
+static convertRowFunc *sConvertRGB32ToRGB16
+	= SELECT_SSE2(ConvertRow32To16)<RGB32ToRGB16>;
+static convertRowFunc *sConvertRGB32ToRGB15
+	= SELECT_SSE2(ConvertRow32To16)<RGB32ToRGB15<ALPHA_NONE> >;
+static convertRowFunc *sConvertRGB32ToRGBA15
+	= SELECT_SSE2(ConvertRow32To16)<RGB32ToRGB15<ALPHA_OPAQUE> >;
+static convertRowFunc *sConvertRGBA32ToRGBA15
+	= SELECT_SSE2(ConvertRow32To16)<RGB32ToRGB15<ALPHA_FROM_SOURCE> >;
+static convertRowFunc *sConvertRGB16ToRGB32
+	= SELECT_SSE2(ConvertRow16To32)<RGB16ToRGB32>;
+static convertRowFunc *sConvertRGB15ToRGB32
+	= SELECT_SSE2(ConvertRow16To32)<RGB15ToRGB32<ALPHA_OPAQUE> >;
+static convertRowFunc *sConvertRGBA15ToRGBA32
+	= SELECT_SSE2(ConvertRow16To32)<RGB15ToRGB32<ALPHA_FROM_SOURCE> >;
+static convertRowFunc *sConvertRGB32ToOpaqueRGB32
+	= SELECT_SSE2(ConvertRow32To32)<RGB32ToOpaqueRGB32>;
+static convertRowFunc *sConvertCMAP8ToRGB32 = ConvertRowCMAP8ToRGB32;
+
+#undef SELECT_SSE2
+
+
+struct fast_conversion {
+	color_space		source;
+	color_space		dest;
+	int32			sourceBytesPerPixel;
+	int32			destBytesPerPixel;
+	convertRowFunc	**convert;
+};
+
+
+static const fast_conversion kFastConversions[] = {
+	{ B_RGB24, B_RGB32, 3, 4, &sConvertRGB24ToRGB32 },
+	{ B_RGB24, B_RGBA32, 3, 4, &sConvertRGB24ToRGB32 },
+	{ B_RGB32, B_RGB24, 4, 3, &sConvertRGB32ToRGB24 },
+	{ B_RGBA32, B_RGB24, 4, 3, &sConvertRGB32ToRGB24 },
+	{ B_RGB32, B_RGBA32, 4, 4, &sConvertRGB32ToOpaqueRGB32 },
+	{ B_RGBA32, B_RGB32, 4, 4, &sConvertRGB32ToOpaqueRGB32 },
+	{ B_RGB32, B_RGB16, 4, 2, &sConvertRGB32ToRGB16 },
+	{ B_RGBA32, B_RGB16, 4, 2, &sConvertRGB32ToRGB16 },
+	{ B_RGB32, B_RGB15, 4, 2, &sConvertRGB32ToRGB15 },
+	{ B_RGBA32, B_RGB15, 4, 2, &sConvertRGB32ToRGB15 },
+	{ B_RGB32, B_RGBA15, 4, 2, &sConvertRGB32ToRGBA15 },
+	{ B_RGBA32, B_RGBA15, 4, 2, &sConvertRGBA32ToRGBA15 },
+	{ B_RGB16, B_RGB32, 2, 4, &sConvertRGB16ToRGB32 },
+	{ B_RGB16, B_RGBA32, 2, 4, &sConvertRGB16ToRGB32 },
+	{ B_RGB15, B_RGB32, 2, 4, &sConvertRGB15ToRGB32 },
+	{ B_RGB15, B_RGBA32, 2, 4, &sConvertRGB15ToRGB32 },
+	{ B_RGBA15, B_RGB32, 2, 4, &sConvertRGB15ToRGB32 },
+	{ B_RGBA15, B_RGBA32, 2, 4, &sConvertRGBA15ToRGBA32 },
+	{ B_CMAP8, B_RGB32, 1, 4, &sConvertCMAP8ToRGB32 },
+	{ B_CMAP8, B_RGBA32, 1, 4, &sConvertCMAP8ToRGB32 },
+};
+
+
+static pthread_once_t sFastConversionInitOnce = PTHREAD_ONCE_INIT;
+static bool sFastConversionEnabled = true;
+
+
+static void
+InitializeFastConversions()
+{
+#if defined(__x86_64__)
+	cpuid_info info;
+	if (get_cpuid(&info, 1, 0) == B_OK && (info.regs.ecx & (1 << 9)) != 0) {
+		sConvertRGB24ToRGB32 = ConvertRowRGB24ToRGB32SSSE3;
+		sConvertRGB32ToRGB24 = ConvertRowRGB32ToRGB24SSSE3;
+	}
+#endif
+}
+
+
+/*!	Converts whole rows using the dedicated row converters, if there is one
+	for the given pair of color spaces. To stay identical to the generic
+	code, this only handles conversions without offsets where all rows fit
+	completely into both buffers.
+	Returns \c false if the generic conversion has to be used instead.
+*/
+static bool
+ConvertBitsFast(const void *srcBits, void *dstBits, int32 srcBitsLength,
+	int32 dstBitsLength, int32 srcBytesPerRow, int32 dstBytesPerRow,
+	color_space srcColorSpace, color_space dstColorSpace, BPoint srcOffset,
+	BPoint dstOffset, int32 width, int32 height)
+{
+	if (!sFastConversionEnabled || srcOffset != B_ORIGIN
+		|| dstOffset != B_ORIGIN) {
+		return false;
+	}
+
+	const fast_conversion *conversion = NULL;
+	for (size_t i = 0; i < B_COUNT_OF(kFastConversions); i++) {
+		if (kFastConversions[i].source == srcColorSpace
+			&& kFastConversions[i].dest == dstColorSpace) {
+			conversion = &kFastConversions[i];
+			break;
+		}
+	}
+	if (conversion == NULL)
+		return false;
+
+	int32 srcWidth = srcBytesPerRow / conversion->sourceBytesPerPixel;
+	if (srcWidth < width)
+		width = srcWidth;
+	int32 dstWidth = dstBytesPerRow / conversion->destBytesPerPixel;
+	if (dstWidth < width)
+		width = dstWidth;
+
+	if (width <= 0 || height <= 0)
+		return true;
+
+	if ((int64)(height - 1) * srcBytesPerRow
+			+ (int64)width * conversion->sourceBytesPerPixel > srcBitsLength
+		|| (int64)(height - 1) * dstBytesPerRow
+			+ (int64)width * conversion->destBytesPerPixel > dstBitsLength) {
+		return false;
+	}
+
+	pthread_once(&sFastConversionInitOnce, &InitializeFastConversions);
+
+	uint32 table[256];
+	if (srcColorSpace == B_CMAP8) {
+		PaletteConverter::InitializeDefault();
+		for (int32 i = 0; i < 256; i++) {
+			uint32 color = sPaletteConverter.RGBA32ColorForIndex(i);
+			table[i] = dstColorSpace == B_RGBA32
+				? color : (color | 0xff000000);
+		}
+	}
+
+	convertRowFunc *convert = *conversion->convert;
+	const uint8 *source = (const uint8 *)srcBits;
+	uint8 *dest = (uint8 *)dstBits;
+	for (int32 y = 0; y < height; y++) {
+		convert(source, dest, width, table);
+		source += srcBytesPerRow;
+		dest += dstBytesPerRow;
+	}
+
+	return true;
+}
+
+
+/*!	\brief Enables or disables the dedicated converters for the most common
+		   color space pairs.
+
+	They are enabled by default, disabling them is only useful to compare
+	against the generic conversion in tests and benchmarks.
+*/
+void
+SetFastColorConversionEnabled(bool enabled)
+{
+	sFastConversionEnabled = enabled;
+}
+
+
+// #pragma mark -
+
+
 /*!	\brief Converts a source buffer in one colorspace into a destination
 		   buffer of another colorspace.
 
@@ -1134,6 +1633,12 @@ ConvertBits(const void *srcBits, void *dstBits, int32 srcBitsLength,
 		|| width < 0 || height < 0 || srcBytesPerRow < 0 || dstBytesPerRow < 0)
 		return B_BAD_VALUE;
 
+	if (ConvertBitsFast(srcBits, dstBits, srcBitsLength, dstBitsLength,
+			srcBytesPerRow, dstBytesPerRow, srcColorSpace, dstColorSpace,
+			srcOffset, dstOffset, width, height)) {
+		return B_OK;
+	}
+
 	switch (srcColorSpace) {
 		case B_RGBA64:
 		case B_RGBA64_BIG:
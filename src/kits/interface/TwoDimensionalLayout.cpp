@@ -82,6 +82,7 @@ protected:
 	virtual	void				DoLayout(float size,
 									LocalLayouter* localLayouter,
 									BLayoutContext* context);
+	virtual	bool				DependsOnLayoutContext();
 
 			Layouter*			fLayouter;
 			LayoutInfo*			fLayoutInfo;
@@ -122,6 +123,7 @@ protected:
 	virtual	void				DoLayout(float size,
 									LocalLayouter* localLayouter,
 									BLayoutContext* context);
+	virtual	bool				DependsOnLayoutContext();
 
 private:
 			Layouter*			fHeightForWidthLayouter;
@@ -765,7 +767,11 @@ BTwoDimensionalLayout::CompoundLayouter::Layout(float size,
 {
 	ValidateMinMax();
 
-	if (context != fLayoutContext || fLastLayoutSize != size) {
+	// The layouter is only recreated when the constraints change, so unless
+	// the result depends on the context, we can reuse it for the same size,
+	// e.g. for the direction that doesn't change while a window is resized.
+	if (fLastLayoutSize != size
+		|| (context != fLayoutContext && DependsOnLayoutContext())) {
 		DoLayout(size, localLayouter, context);
 		fLayoutContext = context;
 		fLastLayoutSize = size;
@@ -781,6 +787,13 @@ BTwoDimensionalLayout::CompoundLayouter::DoLayout(float size,
 }
 
 
+bool
+BTwoDimensionalLayout::CompoundLayouter::DependsOnLayoutContext()
+{
+	return false;
+}
+
+
 void
 BTwoDimensionalLayout::CompoundLayouter::_PrepareItems()
 {
@@ -966,6 +979,14 @@ BTwoDimensionalLayout::VerticalCompoundLayouter::DoLayout(float size,
 }
 
 
+bool
+BTwoDimensionalLayout::VerticalCompoundLayouter::DependsOnLayoutContext()
+{
+	// the height for width layouter is recreated for every context
+	return _HasHeightForWidth();
+}
+
+
 bool
 BTwoDimensionalLayout::VerticalCompoundLayouter::_HasHeightForWidth()
 {
@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <new>
 
 #include <OS.h>
@@ -127,7 +128,7 @@ struct ComplexLayouter::Constraint {
 
 	bool IsSatisfied(int32* sumValues) const
 	{
-		int32 value = sumValues[end] - sumValues[start - 1];
+		int32 value = sumValues[end + 1] - sumValues[start];
 		return (value >= min && value <= max);
 	}
 
@@ -168,6 +169,10 @@ ComplexLayouter::ComplexLayouter(int32 elementCount, float spacing)
 	  fSums(new(nothrow) SumItem[elementCount + 1]),
 	  fSumBackups(new(nothrow) SumItemBackup[elementCount + 1]),
 	  fOptimizer(new(nothrow) LayoutOptimizer(elementCount)),
+	  fLastValues(new(nothrow) double[elementCount]),
+	  fPreviousValues(new(nothrow) double[elementCount]),
+	  fLastSize(-1),
+	  fPreviousSize(-1),
 	  fUnlimited((int32)B_SIZE_UNLIMITED / (elementCount == 0 ? 1 : elementCount)),
 	  fMinMaxValid(false),
 	  fOptimizerConstraintsAdded(false)
@@ -200,6 +205,8 @@ ComplexLayouter::~ComplexLayouter()
 	delete[] fSums;
 	delete[] fSumBackups;
   	delete fOptimizer;
+	delete[] fLastValues;
+	delete[] fPreviousValues;
 }
 
 
@@ -207,8 +214,10 @@ ComplexLayouter::~ComplexLayouter()
 status_t
 ComplexLayouter::InitCheck() const
 {
-	if (!fConstraints || !fWeights || !fSums || !fSumBackups || !fOptimizer)
+	if (!fConstraints || !fWeights || !fSums || !fSumBackups || !fOptimizer
+		|| !fLastValues || !fPreviousValues) {
 		return B_NO_MEMORY;
+	}
 	return fOptimizer->InitCheck();
 }
 
@@ -416,10 +425,14 @@ ComplexLayouter::_Layout(int32 size, SumItem* sums, int32* sizes)
 		return false;
 
 
-	// prepare a feasible solution (the minimum)
+	// prepare a feasible solution -- preferably one derived from the previous
+	// solutions, which is usually the optimum already when resizing, else the
+	// minimum
 	double values[fElementCount];
-	for (int32 i = 0; i < fElementCount; i++)
-		values[i] = sums[i + 1].min - sums[i].min;
+	if (!_PrepareWarmStart(size, values)) {
+		for (int32 i = 0; i < fElementCount; i++)
+			values[i] = sums[i + 1].min - sums[i].min;
+	}
 
 #if TRACE_COMPLEX_LAYOUTER
 	TRACE("feasible solution vs. desired solution:\n");
@@ -429,10 +442,20 @@ ComplexLayouter::_Layout(int32 size, SumItem* sums, int32* sizes)
 
 	// solve
 	TRACE_ONLY(bigtime_t time = system_time();)
-	if (!fOptimizer->Solve(realSizes, size, values))
+	if (!fOptimizer->Solve(realSizes, size, values)) {
+		fLastSize = -1;
+		fPreviousSize = -1;
 		return false;
+	}
 	TRACE_ONLY(time = system_time() - time;)
 
+	if (size != fLastSize) {
+		std::swap(fLastValues, fPreviousValues);
+		fPreviousSize = fLastSize;
+		fLastSize = size;
+	}
+	memcpy(fLastValues, values, fElementCount * sizeof(double));
+
 	// compute integer solution
 	// The basic strategy is to floor() the sums. This guarantees that the
 	// difference between two rounded sums remains in the range of floor()
@@ -547,6 +570,36 @@ ComplexLayouter::_SatisfiesConstraintsSums(int32* sumValues) const
 }
 
 
+// _PrepareWarmStart
+/*!	Computes a feasible solution for the given \a size from the solutions of
+	the previous layouts. As long as the same constraints are active, the
+	optimal solution depends linearly on the size, so extrapolating from the
+	last two solutions usually yields the optimum right away -- at least
+	while resizing continuously -- and the optimizer only has to confirm it.
+*/
+bool
+ComplexLayouter::_PrepareWarmStart(int32 size, double* values) const
+{
+	if (fLastSize < 0)
+		return false;
+
+	double factor = 0;
+	if (size != fLastSize) {
+		if (fPreviousSize < 0)
+			return false;
+		factor = double(size - fLastSize) / (fLastSize - fPreviousSize);
+	}
+
+	for (int32 i = 0; i < fElementCount; i++) {
+		values[i] = fLastValues[i]
+			+ factor * (fLastValues[i] - fPreviousValues[i]);
+	}
+
+	// the optimizer requires a feasible solution to start with
+	return fOptimizer->IsFeasible(values, size);
+}
+
+
 // _ValidateLayout
 void
 ComplexLayouter::_ValidateLayout()
@@ -585,6 +638,10 @@ ComplexLayouter::_ValidateLayout()
 	if (fMinMaxValid)
 		return;
 
+	// the previous solutions might not be feasible anymore
+	fLastSize = -1;
+	fPreviousSize = -1;
+
 	fSums[0].min = 0;
 	fSums[0].max = 0;
 
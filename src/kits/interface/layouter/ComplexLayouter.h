@@ -50,6 +50,8 @@ private:
 			bool				_AddOptimizerConstraints();
 			bool				_SatisfiesConstraints(int32* sizes) const;
 			bool				_SatisfiesConstraintsSums(int32* sums) const;
+			bool				_PrepareWarmStart(int32 size,
+									double* values) const;
 
 			void				_ValidateLayout();
 			void				_ApplyMaxConstraint(
@@ -71,6 +73,10 @@ private:
 			SumItem*			fSums;
 			SumItemBackup*		fSumBackups;
 			LayoutOptimizer*	fOptimizer;
+			double*				fLastValues;
+			double*				fPreviousValues;
+			int32				fLastSize;
+			int32				fPreviousSize;
 			float				fMin;
 			float				fMax;
 			int32				fUnlimited;
@@ -680,6 +680,37 @@ LayoutOptimizer::Solve(const double* desired, double size, double* values)
 }
 
 
+// IsFeasible
+/*!	Returns whether the given \a values satisfy the constraints added via
+	AddConstraint() and sum up to \a size, i.e. whether they can be passed to
+	Solve() as initial solution.
+*/
+bool
+LayoutOptimizer::IsFeasible(const double* values, double size) const
+{
+	double x[fVariableCount];
+	x[0] = values[0];
+	for (int i = 1; i < fVariableCount; i++)
+		x[i] = values[i] + x[i - 1];
+
+	if (!fuzzy_equals(x[fVariableCount - 1], size))
+		return false;
+
+	int32 constraintCount = fConstraints.CountItems();
+	for (int32 i = 0; i < constraintCount; i++) {
+		Constraint* constraint = (Constraint*)fConstraints.ItemAt(i);
+		double actualValue = constraint->ActualValue(x);
+		if (constraint->equality
+			? !fuzzy_equals(actualValue, constraint->value)
+			: actualValue < constraint->value - kEqualsEpsilon) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
 // _Solve
 bool
 LayoutOptimizer::_Solve(const double* desired, double* values)
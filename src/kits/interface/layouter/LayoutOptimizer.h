@@ -31,6 +31,8 @@ public:
 
 			bool				Solve(const double* desired, double size,
 									double* values);
+			bool				IsFeasible(const double* values,
+									double size) const;
 
 private:
 			bool				_Solve(const double* desired, double* values);
@@ -47,7 +47,13 @@ Decoder::Perform(perform_code code, void* _data)
 	return B_OK;
 }
 
-void Decoder::_ReservedDecoder1() {}
+
+status_t
+Decoder::SetThreadCount(int32 count)
+{
+	return B_NOT_SUPPORTED;
+}
+
 void Decoder::_ReservedDecoder2() {}
 void Decoder::_ReservedDecoder3() {}
 void Decoder::_ReservedDecoder4() {}
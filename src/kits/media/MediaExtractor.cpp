@@ -14,18 +14,38 @@
 #include <string.h>
 
 #include <Autolock.h>
+#include <fs_attr.h>
 #include <InterfacePrivate.h>
+#include <MediaTrack.h>
+#include <Node.h>
 
 #include "ChunkCache.h"
 #include "MediaDebug.h"
 #include "MediaMisc.h"
 #include "PluginManager.h"
+#include "SeekIndex.h"
 
 
 // should be 0, to disable the chunk cache set it to 1
 #define DISABLE_CHUNK_CACHE 0
 
 
+static const char* kSeekIndexAttribute = "Media:SeekIndex";
+static const uint32 kSeekIndexMagic = 'sidx';
+static const uint32 kSeekIndexVersion = 1;
+
+struct seek_index_header {
+	uint32	magic;
+	uint32	version;
+	int64	size;
+	int64	modification_time;
+	int32	modification_nano_time;
+	int32	stream_count;
+	// followed by stream_count times an int64 entry count, and that many
+	// flattened SeekIndex entries
+};
+
+
 class MediaExtractorChunkProvider : public ChunkProvider {
 public:
 	MediaExtractorChunkProvider(MediaExtractor* extractor, int32 stream)
@@ -95,6 +115,7 @@ MediaExtractor::_Init(BDataIO* source, int32 flags)
 		fStreamInfo[i].lastChunk = NULL;
 		fStreamInfo[i].chunkCache = NULL;
 		fStreamInfo[i].encodedFormat.Clear();
+		fStreamInfo[i].seekIndex = NULL;
 	}
 
 	// create all stream cookies
@@ -125,6 +146,13 @@ MediaExtractor::_Init(BDataIO* source, int32 flags)
 				"stream %" B_PRId32 " failed\n", i);
 		}
 
+		// Finding key frames can be expensive for the reader, so we
+		// remember where they are in video streams
+		if (fStreamInfo[i].status == B_OK
+			&& fStreamInfo[i].encodedFormat.IsVideo()) {
+			fStreamInfo[i].seekIndex = new(std::nothrow) SeekIndex;
+		}
+
 #if !DISABLE_CHUNK_CACHE
 		// Allocate our ChunkCache
 		size_t chunkCacheMaxBytes = _CalculateChunkBuffer(i);
@@ -137,6 +165,8 @@ MediaExtractor::_Init(BDataIO* source, int32 flags)
 #endif
 	}
 
+	_LoadSeekIndex();
+
 #if !DISABLE_CHUNK_CACHE
 	// start extractor thread
 	fExtractorThread = spawn_thread(_ExtractorEntry, "media extractor thread",
@@ -153,6 +183,9 @@ MediaExtractor::~MediaExtractor()
 	// stop the extractor thread, if still running
 	StopProcessing();
 
+	if (fInitStatus == B_OK)
+		_SaveSeekIndex();
+
 	// free all stream cookies
 	// and chunk caches
 	for (int32 i = 0; i < fStreamCount; i++) {
@@ -160,6 +193,7 @@ MediaExtractor::~MediaExtractor()
 			fReader->FreeCookie(fStreamInfo[i].cookie);
 
 		delete fStreamInfo[i].chunkCache;
+		delete fStreamInfo[i].seekIndex;
 	}
 
 	gPluginManager.DestroyReader(fReader);
@@ -270,6 +304,13 @@ MediaExtractor::Seek(int32 stream, uint32 seekTo, int64* _frame,
 	BAutolock _(info.chunkCache);
 #endif
 
+	// If we already know where the key frame is, let the reader go there
+	// directly
+	if (info.seekIndex != NULL) {
+		_FindIndexedKeyFrame(info, seekTo, _frame, _time);
+		info.seekIndex->Interrupt();
+	}
+
 	status_t status = fReader->Seek(info.cookie, seekTo, _frame, _time);
 	if (status != B_OK)
 		return status;
@@ -293,6 +334,14 @@ MediaExtractor::FindKeyFrame(int32 stream, uint32 seekTo, int64* _frame,
 	if (info.status != B_OK)
 		return info.status;
 
+	if (info.seekIndex != NULL) {
+#if !DISABLE_CHUNK_CACHE
+		BAutolock _(info.chunkCache);
+#endif
+		if (_FindIndexedKeyFrame(info, seekTo, _frame, _time))
+			return B_OK;
+	}
+
 	return fReader->FindKeyFrame(info.cookie, seekTo, _frame, _time);
 }
 
@@ -307,8 +356,12 @@ MediaExtractor::GetNextChunk(int32 stream, const void** _chunkBuffer,
 		return info.status;
 
 #if DISABLE_CHUNK_CACHE
-	return fReader->GetNextChunk(fStreamInfo[stream].cookie, _chunkBuffer,
-		_chunkSize, mediaHeader);
+	status_t status = fReader->GetNextChunk(fStreamInfo[stream].cookie,
+		_chunkBuffer, _chunkSize, mediaHeader);
+	if (info.seekIndex != NULL)
+		_UpdateSeekIndex(info, status, *mediaHeader);
+
+	return status;
 #else
 	BAutolock _(info.chunkCache);
 
@@ -322,6 +375,9 @@ MediaExtractor::GetNextChunk(int32 stream, const void** _chunkBuffer,
 
 	info.lastChunk = chunk;
 
+	if (info.seekIndex != NULL)
+		_UpdateSeekIndex(info, chunk->status, chunk->header);
+
 	*_chunkBuffer = chunk->buffer;
 	*_chunkSize = chunk->size;
 	*mediaHeader = chunk->header;
@@ -433,6 +489,172 @@ MediaExtractor::_RecycleLastChunk(stream_info& info)
 }
 
 
+/*!	Adds the chunks that are passed on to the decoder to the seek index.
+	Since the decoder gets them in stream order, the index learns which key
+	frames follow each other.
+*/
+void
+MediaExtractor::_UpdateSeekIndex(stream_info& info, status_t status,
+	const media_header& header)
+{
+	if (status == B_LAST_BUFFER_ERROR)
+		info.seekIndex->SetEndOfStream();
+	else if (status != B_OK)
+		info.seekIndex->Interrupt();
+	else if ((header.u.encoded_video.field_flags & B_MEDIA_KEY_FRAME) != 0)
+		info.seekIndex->AddKeyFrame(header.start_time);
+}
+
+
+/*!	Looks up the key frame for the given seek request in the stream's seek
+	index. Frames are converted using the frame rate of the stream, just like
+	the readers do it.
+	Returns \c false, and leaves \a _frame and \a _time alone, if the index
+	does not know the answer.
+*/
+bool
+MediaExtractor::_FindIndexedKeyFrame(const stream_info& info, uint32 seekTo,
+	int64* _frame, bigtime_t* _time) const
+{
+	double frameRate = info.encodedFormat.u.encoded_video.output.field_rate;
+
+	bigtime_t time = *_time;
+	if ((seekTo & B_MEDIA_SEEK_TO_FRAME) != 0) {
+		if (frameRate <= 0)
+			return false;
+		time = (bigtime_t)(*_frame * 1000000.0 / frameRate + 0.5);
+	}
+
+	if (!info.seekIndex->FindKeyFrame(seekTo, &time))
+		return false;
+
+	TRACE("MediaExtractor::_FindIndexedKeyFrame: found key frame at %"
+		B_PRIdBIGTIME "\n", time);
+
+	*_time = time;
+	if (frameRate > 0)
+		*_frame = (int64)(time * frameRate / 1000000.0 + 0.5);
+
+	return true;
+}
+
+
+/*!	Restores the seek indices from the attribute of the source file, if it
+	has been written for the current contents of the file.
+*/
+void
+MediaExtractor::_LoadSeekIndex()
+{
+	BNode* node = dynamic_cast<BNode*>(fSource);
+	if (node == NULL)
+		return;
+
+	struct stat stat;
+	attr_info attrInfo;
+	if (node->GetStat(&stat) != B_OK
+		|| node->GetAttrInfo(kSeekIndexAttribute, &attrInfo) != B_OK
+		|| attrInfo.size < (off_t)sizeof(seek_index_header)
+		|| attrInfo.size > (off_t)(sizeof(seek_index_header)
+			+ fStreamCount * (SeekIndex::kMaxEntries + 1) * sizeof(int64))) {
+		return;
+	}
+
+	uint8* buffer = new(std::nothrow) uint8[attrInfo.size];
+	if (buffer == NULL)
+		return;
+
+	ssize_t bytesRead = node->ReadAttr(kSeekIndexAttribute, B_RAW_TYPE, 0,
+		buffer, attrInfo.size);
+
+	const seek_index_header* header = (const seek_index_header*)buffer;
+	if (bytesRead != attrInfo.size
+		|| header->magic != kSeekIndexMagic
+		|| header->version != kSeekIndexVersion
+		|| header->size != stat.st_size
+		|| header->modification_time != stat.st_mtim.tv_sec
+		|| header->modification_nano_time != stat.st_mtim.tv_nsec
+		|| header->stream_count != fStreamCount) {
+		// the file has changed since the index was written
+		delete[] buffer;
+		return;
+	}
+
+	const int64* data = (const int64*)(header + 1);
+	const int64* end = (const int64*)(buffer + attrInfo.size);
+
+	for (int32 i = 0; i < fStreamCount && data < end; i++) {
+		int64 count = *data++;
+		if (count < 0 || count > end - data)
+			break;
+
+		if (fStreamInfo[i].seekIndex != NULL)
+			fStreamInfo[i].seekIndex->Unflatten(data, count);
+		data += count;
+	}
+
+	delete[] buffer;
+}
+
+
+/*!	Writes the seek indices to an attribute of the source file, if they have
+	learned something new. The modification time and size of the file are
+	stored with them, so that they are ignored once the file changes.
+*/
+void
+MediaExtractor::_SaveSeekIndex()
+{
+	BNode* node = dynamic_cast<BNode*>(fSource);
+	if (node == NULL)
+		return;
+
+	size_t size = sizeof(seek_index_header);
+	bool modified = false;
+	for (int32 i = 0; i < fStreamCount; i++) {
+		size += sizeof(int64);
+		if (fStreamInfo[i].seekIndex != NULL) {
+			size += fStreamInfo[i].seekIndex->FlattenedSize();
+			modified |= fStreamInfo[i].seekIndex->IsModified();
+		}
+	}
+
+	struct stat stat;
+	if (!modified || node->GetStat(&stat) != B_OK)
+		return;
+
+	uint8* buffer = new(std::nothrow) uint8[size];
+	if (buffer == NULL)
+		return;
+
+	seek_index_header* header = (seek_index_header*)buffer;
+	header->magic = kSeekIndexMagic;
+	header->version = kSeekIndexVersion;
+	header->size = stat.st_size;
+	header->modification_time = stat.st_mtim.tv_sec;
+	header->modification_nano_time = stat.st_mtim.tv_nsec;
+	header->stream_count = fStreamCount;
+
+	int64* data = (int64*)(header + 1);
+	for (int32 i = 0; i < fStreamCount; i++) {
+		SeekIndex* index = fStreamInfo[i].seekIndex;
+		*data++ = index != NULL ? index->CountEntries() : 0;
+		if (index != NULL) {
+			index->Flatten(data);
+			data += index->CountEntries();
+		}
+	}
+
+	// this may fail on read-only volumes, which is fine
+	ssize_t bytesWritten = node->WriteAttr(kSeekIndexAttribute, B_RAW_TYPE,
+		0, buffer, size);
+	if (bytesWritten != (ssize_t)size) {
+		TRACE("MediaExtractor::_SaveSeekIndex: could not write index: %s\n",
+			strerror(bytesWritten < 0 ? bytesWritten : B_ERROR));
+	}
+
+	delete[] buffer;
+}
+
+
 status_t
 MediaExtractor::_ExtractorEntry(void* extractor)
 {
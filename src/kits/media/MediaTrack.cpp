@@ -288,6 +288,21 @@ BMediaTrack::DecodedFormat(media_format* _format, uint32 flags)
 }
 
 
+status_t
+BMediaTrack::SetDecodingThreadCount(int32 count)
+{
+	CALLED();
+
+	if (count < 0)
+		return B_BAD_VALUE;
+
+	if (fDecoder == NULL)
+		return B_NO_INIT;
+
+	return fDecoder->SetThreadCount(count);
+}
+
+
 status_t
 BMediaTrack::GetMetaData(BMessage* _data) const
 {
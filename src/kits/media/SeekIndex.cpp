@@ -0,0 +1,197 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "SeekIndex.h"
+
+#include <new>
+
+#include <MediaTrack.h>
+
+
+/*!	Keeps the times of the key frames of a stream in sorted order, as they
+	have been seen while reading the stream.
+	An entry is "followed" if the stream has been read from it on up to the
+	next key frame, or up to its end, without a seek in between. Only then is
+	it known that there is no other key frame between two entries, and only
+	then can a key frame be looked up without asking the reader.
+*/
+
+
+SeekIndex::SeekIndex()
+	:
+	fLastKeyFrame(0),
+	fContinuous(false),
+	fModified(false)
+{
+}
+
+
+SeekIndex::~SeekIndex()
+{
+}
+
+
+/*!	Adds a key frame that has been read from the stream. Unless Interrupt()
+	has been called since the previous key frame, the two are linked.
+*/
+void
+SeekIndex::AddKeyFrame(bigtime_t time)
+{
+	if (fContinuous && time <= fLastKeyFrame) {
+		if (time == fLastKeyFrame)
+			return;
+
+		// the reader is not delivering key frames in order; don't trust it
+		fContinuous = false;
+	}
+
+	int32 index = _LowerBound(time);
+	if (index == (int32)fEntries.size() || fEntries[index].time != time) {
+		if ((int32)fEntries.size() >= kMaxEntries) {
+			fContinuous = false;
+			return;
+		}
+
+		if (index > 0 && fEntries[index - 1].followed) {
+			// contradicts what we have seen before, better forget about it
+			fEntries[index - 1].followed = false;
+		}
+
+		entry newEntry = { time, false };
+		try {
+			fEntries.insert(fEntries.begin() + index, newEntry);
+		} catch (std::bad_alloc&) {
+			fContinuous = false;
+			return;
+		}
+		fModified = true;
+	}
+
+	if (fContinuous && index > 0 && fEntries[index - 1].time == fLastKeyFrame
+		&& !fEntries[index - 1].followed) {
+		fEntries[index - 1].followed = true;
+		fModified = true;
+	}
+
+	fLastKeyFrame = time;
+	fContinuous = true;
+}
+
+
+/*!	The stream has been read up to its end since the last key frame.
+*/
+void
+SeekIndex::SetEndOfStream()
+{
+	if (!fContinuous || fEntries.empty())
+		return;
+
+	entry& last = fEntries.back();
+	if (last.time == fLastKeyFrame && !last.followed) {
+		last.followed = true;
+		fModified = true;
+	}
+	fContinuous = false;
+}
+
+
+/*!	The stream is no longer read sequentially, ie. after a seek.
+*/
+void
+SeekIndex::Interrupt()
+{
+	fContinuous = false;
+}
+
+
+/*!	Looks up the key frame closest to \a _time in the direction specified by
+	\a flags. Returns \c false if the index cannot answer this for sure, and
+	the reader needs to be asked instead.
+*/
+bool
+SeekIndex::FindKeyFrame(uint32 flags, bigtime_t* _time) const
+{
+	bigtime_t time = *_time;
+	int32 index = _LowerBound(time);
+	int32 count = fEntries.size();
+
+	if (index < count && fEntries[index].time == time)
+		return true;
+
+	if ((flags & B_MEDIA_SEEK_CLOSEST_FORWARD) != 0) {
+		// the first key frame after time
+		if (index == 0 || index == count || !fEntries[index - 1].followed)
+			return false;
+
+		*_time = fEntries[index].time;
+		return true;
+	}
+
+	// the last key frame before time
+	if (index == 0 || !fEntries[index - 1].followed)
+		return false;
+
+	*_time = fEntries[index - 1].time;
+	return true;
+}
+
+
+size_t
+SeekIndex::FlattenedSize() const
+{
+	return fEntries.size() * sizeof(int64);
+}
+
+
+void
+SeekIndex::Flatten(int64* buffer) const
+{
+	for (size_t i = 0; i < fEntries.size(); i++)
+		buffer[i] = fEntries[i].time * 2 + (fEntries[i].followed ? 1 : 0);
+}
+
+
+status_t
+SeekIndex::Unflatten(const int64* buffer, int32 count)
+{
+	if (count < 0 || count > kMaxEntries)
+		return B_BAD_DATA;
+
+	std::vector<entry> entries;
+	try {
+		entries.resize(count);
+	} catch (std::bad_alloc&) {
+		return B_NO_MEMORY;
+	}
+
+	for (int32 i = 0; i < count; i++) {
+		entries[i].time = buffer[i] >> 1;
+		entries[i].followed = (buffer[i] & 1) != 0;
+		if (i > 0 && entries[i].time <= entries[i - 1].time)
+			return B_BAD_DATA;
+	}
+
+	fEntries.swap(entries);
+	fContinuous = false;
+	fModified = false;
+	return B_OK;
+}
+
+
+int32
+SeekIndex::_LowerBound(bigtime_t time) const
+{
+	int32 lower = 0;
+	int32 upper = fEntries.size();
+	while (lower < upper) {
+		int32 middle = (lower + upper) / 2;
+		if (fEntries[middle].time < time)
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+	return lower;
+}
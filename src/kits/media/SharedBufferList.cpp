@@ -8,9 +8,18 @@
 /*!	Used for BBufferGroup and BBuffer management across teams.
 	Created in the media server, cloned into each BBufferGroup (visible in
 	all address spaces).
-*/
 
-// TODO: don't use a simple list!
+	Requesting and recycling buffers happens for every buffer that travels
+	through the media nodes, so it must not wait for a lock that might be
+	held by a thread of any other team. Instead, every entry is claimed
+	and released with a compare-and-swap on its "state" field. Entries
+	never move in the list; they are only added and removed with the list
+	locked. Both bump the generation kept in the state, so that a thread
+	that looked at an entry before it was removed or reused cannot claim
+	or release it anymore.
+	The reclaim semaphore of each group counts its available buffers, so
+	a thread only waits when the group has no buffer left.
+*/
 
 
 #include <SharedBufferList.h>
@@ -30,6 +39,8 @@ static area_id sArea = -1;
 static int32 sRefCount = 0;
 static BLocker sLocker("shared buffer list");
 
+static const int32 kMaxClaimTries = 8;
+
 
 namespace BPrivate {
 
@@ -121,16 +132,19 @@ SharedBufferList::DeleteGroupAndPut(sem_id groupReclaimSem)
 		for (int32 i = 0; i < fCount; i++) {
 			if (fInfos[i].reclaim_sem == groupReclaimSem) {
 				// delete the associated buffer
-				delete fInfos[i].buffer;
-
-				// Decrement buffer count by one, and fill the gap
-				// in the list with its last entry
-				fCount--;
-				if (fCount > 0)
-					fInfos[i--] = fInfos[fCount];
+				BBuffer* buffer = fInfos[i].buffer;
+				_RemoveEntry(fInfos[i], true);
+				delete buffer;
 			}
 		}
 
+		// Shrink the list as far as possible; entries cannot be moved,
+		// as the list might be walked at the same time
+		int32 count = fCount;
+		while (count > 0 && fInfos[count - 1].reclaim_sem < 0)
+			count--;
+		atomic_set(&fCount, count);
+
 		Unlock();
 	}
 
@@ -211,15 +225,24 @@ SharedBufferList::AddBuffer(sem_id groupReclaimSem, BBuffer* buffer)
 	if (buffer == NULL)
 		return B_BAD_VALUE;
 
-	if (fCount == kMaxBuffers) {
+	// reuse the first unused entry
+	int32 index = 0;
+	while (index < fCount && (fInfos[index].state & kEntryUsed) != 0)
+		index++;
+
+	if (index == kMaxBuffers) {
 		return B_MEDIA_TOO_MANY_BUFFERS;
 	}
 
-	fInfos[fCount].id = buffer->ID();
-	fInfos[fCount].buffer = buffer;
-	fInfos[fCount].reclaim_sem = groupReclaimSem;
-	fInfos[fCount].reclaimed = true;
-	fCount++;
+	// Fill in the entry before it is published by its new state
+	_shared_buffer_info& info = fInfos[index];
+	info.id = buffer->ID();
+	info.buffer = buffer;
+	atomic_set(&info.reclaim_sem, groupReclaimSem);
+	atomic_set(&info.state, _NextGeneration(atomic_get(&info.state))
+		| kEntryUsed | kEntryAvailable);
+	if (index == fCount)
+		atomic_set(&fCount, fCount + 1);
 
 	return release_sem_etc(groupReclaimSem, 1, B_DO_NOT_RESCHEDULE);
 }
@@ -286,49 +309,21 @@ SharedBufferList::RequestBuffer(sem_id groupReclaimSem, int32 buffersInGroup,
 		if (status != B_OK)
 			return status;
 
-		// try to exit savely if the lock fails
-		status = Lock();
-		if (status != B_OK) {
-			ERROR("SharedBufferList:: RequestBuffer: Lock failed: %s\n",
-				strerror(status));
-			release_sem_etc(groupReclaimSem, count, 0);
-			return B_ERROR;
-		}
+		BBuffer* buffer = _ClaimBuffer(groupReclaimSem, size, wantID,
+			*_buffer);
+		if (buffer != NULL) {
+			*_buffer = buffer;
 
-		for (int32 i = 0; i < fCount; i++) {
-			// We need a BBuffer from the group, and it must be marked as
-			// reclaimed
-			if (fInfos[i].reclaim_sem == groupReclaimSem
-				&& fInfos[i].reclaimed) {
-				if ((size != 0 && size <= fInfos[i].buffer->SizeAvailable())
-					|| (*_buffer != 0 && fInfos[i].buffer == *_buffer)
-					|| (wantID != 0 && fInfos[i].id == wantID)) {
-				   	// we found a buffer
-					fInfos[i].reclaimed = false;
-					*_buffer = fInfos[i].buffer;
-
-					// if we requested more than one buffer, release the rest
-					if (count > 1) {
-						release_sem_etc(groupReclaimSem, count - 1,
-							B_DO_NOT_RESCHEDULE);
-					}
-
-					// And mark all buffers with the same ID as requested in
-					// all other buffer groups
-					_RequestBufferInOtherGroups(groupReclaimSem,
-						fInfos[i].buffer->ID());
-
-					Unlock();
-					return B_OK;
-				}
+			// if we requested more than one buffer, release the rest
+			if (count > 1) {
+				release_sem_etc(groupReclaimSem, count - 1,
+					B_DO_NOT_RESCHEDULE);
 			}
+			return B_OK;
 		}
 
 		release_sem_etc(groupReclaimSem, count, B_DO_NOT_RESCHEDULE);
-		if (Unlock() != B_OK) {
-			ERROR("SharedBufferList:: RequestBuffer: unlock failed\n");
-			return B_ERROR;
-		}
+
 		// prepare to request one more buffer next time
 		count++;
 	} while (count <= buffersInGroup);
@@ -344,30 +339,35 @@ SharedBufferList::RecycleBuffer(BBuffer* buffer)
 	CALLED();
 
 	media_buffer_id id = buffer->ID();
-
-	if (Lock() != B_OK)
-		return B_ERROR;
-
 	int32 reclaimedCount = 0;
+	int32 count = atomic_get(&fCount);
 
-	for (int32 i = 0; i < fCount; i++) {
+	for (int32 i = 0; i < count; i++) {
 		// find the buffer id, and reclaim it in all groups it belongs to
-		if (fInfos[i].id == id) {
-			reclaimedCount++;
-			if (fInfos[i].reclaimed) {
-				ERROR("SharedBufferList::RecycleBuffer, BBuffer %p, id = %"
-					B_PRId32 " already reclaimed\n", buffer, id);
-				DEBUG_ONLY(debugger("buffer already reclaimed"));
+		_shared_buffer_info& info = fInfos[i];
+		int32 state = atomic_get(&info.state);
+		if ((state & kEntryUsed) == 0 || info.id != id)
+			continue;
+
+		sem_id reclaimSem = atomic_get(&info.reclaim_sem);
+		if ((state & kEntryAvailable) != 0
+			|| atomic_test_and_set(&info.state, state | kEntryAvailable, state)
+				!= state) {
+			if ((atomic_get(&info.state) & ~kEntryAvailable)
+					!= (state & ~kEntryAvailable)) {
+				// the entry has been removed or reused meanwhile
 				continue;
 			}
-			fInfos[i].reclaimed = true;
-			release_sem_etc(fInfos[i].reclaim_sem, 1, B_DO_NOT_RESCHEDULE);
+			reclaimedCount++;
+			ERROR("SharedBufferList::RecycleBuffer, BBuffer %p, id = %"
+				B_PRId32 " already reclaimed\n", buffer, id);
+			DEBUG_ONLY(debugger("buffer already reclaimed"));
+			continue;
 		}
+		reclaimedCount++;
+		release_sem_etc(reclaimSem, 1, B_DO_NOT_RESCHEDULE);
 	}
 
-	if (Unlock() != B_OK)
-		return B_ERROR;
-
 	if (reclaimedCount == 0) {
 		ERROR("shared_buffer_list::RecycleBuffer, BBuffer %p, id = %" B_PRId32
 			" NOT reclaimed\n", buffer, id);
@@ -392,17 +392,13 @@ SharedBufferList::RemoveBuffer(BBuffer* buffer)
 
 	for (int32 i = 0; i < fCount; i++) {
 		// find the buffer id, and remove it in all groups it belongs to
-		if (fInfos[i].id == id) {
-			if (!fInfos[i].reclaimed) {
+		if ((fInfos[i].state & kEntryUsed) != 0 && fInfos[i].id == id) {
+			if (!_RemoveEntry(fInfos[i], false)) {
 				notRemovedCount++;
 				ERROR("SharedBufferList::RequestBuffer, BBuffer %p, id = %"
 					B_PRId32 " not reclaimed\n", buffer, id);
 				DEBUG_ONLY(debugger("buffer not reclaimed"));
-				continue;
 			}
-			fInfos[i].buffer = NULL;
-			fInfos[i].id = -1;
-			fInfos[i].reclaim_sem = -1;
 		}
 	}
 
@@ -461,46 +457,161 @@ SharedBufferList::_Init()
 
 	for (int32 i = 0; i < kMaxBuffers; i++) {
 		fInfos[i].id = -1;
+		fInfos[i].buffer = NULL;
+		fInfos[i].state = 0;
+		fInfos[i].reclaim_sem = -1;
 	}
 	fCount = 0;
+	fClaimCount = 0;
 
 	return B_OK;
 }
 
 
-/*!	Used by RequestBuffer, call this one with the list locked!
+/*!	Looks for an available buffer of the group that matches the request,
+	and marks it as requested. The caller must have acquired the group's
+	reclaim semaphore for it.
+	This does not need the list to be locked.
+*/
+BBuffer*
+SharedBufferList::_ClaimBuffer(sem_id groupReclaimSem, size_t size,
+	media_buffer_id wantID, BBuffer* wantBuffer)
+{
+	// Another thread of the group might claim the buffer we are entitled
+	// to, while one we already looked at gets recycled; fClaimCount tells
+	// us when it's worth to look again.
+	for (int32 tries = 0; tries < kMaxClaimTries; tries++) {
+		int32 claimCount = atomic_get(&fClaimCount);
+		int32 count = atomic_get(&fCount);
+
+		for (int32 i = 0; i < count; i++) {
+			// We need a BBuffer from the group, and it must be marked as
+			// reclaimed
+			_shared_buffer_info& info = fInfos[i];
+			int32 state = atomic_get(&info.state);
+			if ((state & (kEntryUsed | kEntryAvailable))
+					!= (kEntryUsed | kEntryAvailable)
+				|| atomic_get(&info.reclaim_sem) != groupReclaimSem)
+				continue;
+
+			// The entry might be removed or reused while we copy it; then its
+			// generation changes. Only trust the copy if the state is still
+			// the one we started with, before touching the buffer.
+			BBuffer* buffer = info.buffer;
+			media_buffer_id id = info.id;
+			if (buffer == NULL || atomic_get(&info.state) != state)
+				continue;
+
+			if ((size != 0 && size <= buffer->SizeAvailable())
+				|| (wantBuffer != NULL && buffer == wantBuffer)
+				|| (wantID != 0 && id == wantID)) {
+				if (atomic_test_and_set(&info.state, state & ~kEntryAvailable,
+						state) != state) {
+					// someone else was faster
+					continue;
+				}
+				atomic_add(&fClaimCount, 1);
+
+				// And mark all buffers with the same ID as requested in
+				// all other buffer groups
+				_RequestBufferInOtherGroups(groupReclaimSem, id);
+				return buffer;
+			}
+		}
+
+		if (atomic_get(&fClaimCount) == claimCount)
+			break;
+	}
+
+	return NULL;
+}
+
+
+/*!	Used by RequestBuffer.
 */
 void
 SharedBufferList::_RequestBufferInOtherGroups(sem_id groupReclaimSem,
 	media_buffer_id id)
 {
-	for (int32 i = 0; i < fCount; i++) {
+	int32 count = atomic_get(&fCount);
+
+	for (int32 i = 0; i < count; i++) {
 		// find buffers with same id, but belonging to other groups
-		if (fInfos[i].id == id && fInfos[i].reclaim_sem != groupReclaimSem) {
+		_shared_buffer_info& info = fInfos[i];
+		int32 state = atomic_get(&info.state);
+		if ((state & kEntryUsed) == 0)
+			continue;
+
+		sem_id reclaimSem = atomic_get(&info.reclaim_sem);
+		if (reclaimSem >= 0 && reclaimSem != groupReclaimSem
+			&& info.id == id) {
 			// and mark them as requested
 			// TODO: this can deadlock if BBuffers with same media_buffer_id
 			// exist in more than one BBufferGroup, and RequestBuffer()
 			// is called on both groups (which should not be done).
 			status_t status;
 			do {
-				status = acquire_sem(fInfos[i].reclaim_sem);
+				status = acquire_sem(reclaimSem);
 			} while (status == B_INTERRUPTED);
 
 			// try to skip entries that belong to crashed teams
 			if (status != B_OK)
 				continue;
 
-			if (fInfos[i].reclaimed == false) {
+			int32 current = atomic_get(&info.state);
+			if ((current & ~kEntryAvailable) != (state & ~kEntryAvailable)) {
+				// the entry has been removed or reused meanwhile
+				release_sem_etc(reclaimSem, 1, B_DO_NOT_RESCHEDULE);
+				continue;
+			}
+
+			if ((current & kEntryAvailable) == 0
+				|| atomic_test_and_set(&info.state,
+					current & ~kEntryAvailable, current) != current) {
 				ERROR("SharedBufferList:: RequestBufferInOtherGroups BBuffer "
 					"%p, id = %" B_PRId32 " not reclaimed while requesting\n",
-					fInfos[i].buffer, id);
+					info.buffer, id);
 				continue;
 			}
-
-			fInfos[i].reclaimed = false;
 		}
 	}
 }
 
 
+/*!	Returns the state of an unused entry, in the generation following the
+	one of \a state.
+*/
+/*static*/ int32
+SharedBufferList::_NextGeneration(int32 state)
+{
+	return (int32)(((uint32)state & ~(uint32)(kEntryUsed | kEntryAvailable))
+		+ kGenerationIncrement);
+}
+
+
+/*!	Call this one with the list locked. Unless \a force is \c true, the
+	entry is only removed if its buffer is available; returns whether it
+	has been removed.
+	The entry is unpublished first, and moved to the next generation at the
+	same time, so that threads that are walking the list concurrently can
+	neither claim nor release it anymore.
+*/
+bool
+SharedBufferList::_RemoveEntry(_shared_buffer_info& info, bool force)
+{
+	int32 state;
+	do {
+		state = atomic_get(&info.state);
+		if (!force && (state & kEntryAvailable) == 0)
+			return false;
+	} while (atomic_test_and_set(&info.state, _NextGeneration(state), state)
+		!= state);
+
+	atomic_set(&info.reclaim_sem, -1);
+	info.id = -1;
+	info.buffer = NULL;
+	return true;
+}
+
+
 }	// namespace BPrivate
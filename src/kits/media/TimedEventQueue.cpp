@@ -10,7 +10,8 @@
 #include <MediaDebug.h>
 #include <InterfaceDefs.h>
 #include <util/DoublyLinkedList.h>
-#include <locks.h>
+
+#include <algorithm>
 
 
 //	#pragma mark - media_timed_event
@@ -124,13 +125,33 @@ operator>(const media_timed_event& a, const media_timed_event& b)
 //	#pragma mark - BTimedEventQueue
 
 
+/*!	The events are kept in a binary min-heap, ordered by their time, and by
+	the order they were added in for events with the same time. Adding and
+	removing an event is therefore O(log n); only the functions that have to
+	walk the events in order need to sort a copy of the heap first.
+	The entries come from a pool that is protected by the same lock as the
+	heap, so that every operation only needs to take a single lock.
+*/
+
+
 namespace {
 
 struct queue_entry : public DoublyLinkedListLinkImpl<queue_entry> {
 	media_timed_event	event;
+	uint64				order;
+	int32				index;
 };
 typedef DoublyLinkedList<queue_entry> QueueEntryList;
 
+
+static inline bool
+comes_before(const queue_entry* a, const queue_entry* b)
+{
+	if (a->event.event_time != b->event.event_time)
+		return a->event.event_time < b->event.event_time;
+	return a->order < b->order;
+}
+
 } // namespace
 
 
@@ -140,12 +161,14 @@ public:
 		:
 		fLock("BTimedEventQueue")
 	{
-		mutex_init(&fEntryAllocationLock, "BTimedEventQueue entry allocation");
-
 		fEventCount = 0;
 		fCleanupHook = NULL;
 		fCleanupHookContext = NULL;
 
+		fHeap = NULL;
+		fHeapCapacity = 0;
+		fNextOrder = 0;
+
 		for (size_t i = 0; i < B_COUNT_OF(fInlineEntries); i++)
 			fFreeEntries.Add(&fInlineEntries[i]);
 	}
@@ -153,17 +176,22 @@ public:
 	{
 		while (queue_entry* chunk = fChunkHeads.RemoveHead())
 			free(chunk);
+		free(fHeap);
 	}
 
 	queue_entry* AllocateEntry()
 	{
-		MutexLocker locker(fEntryAllocationLock);
+		ASSERT(fLock.IsLocked());
+
 		if (fFreeEntries.Head() != NULL)
 			return fFreeEntries.RemoveHead();
 
 		// We need a new chunk.
 		const size_t chunkSize = B_PAGE_SIZE;
 		queue_entry* newEntries = (queue_entry*)malloc(chunkSize);
+		if (newEntries == NULL)
+			return NULL;
+
 		fChunkHeads.Add(&newEntries[0]);
 		for (size_t i = 1; i < (chunkSize / sizeof(queue_entry)); i++)
 			fFreeEntries.Add(&newEntries[i]);
@@ -173,27 +201,50 @@ public:
 
 	void FreeEntry(queue_entry* entry)
 	{
-		MutexLocker locker(fEntryAllocationLock);
+		ASSERT(fLock.IsLocked());
 		fFreeEntries.Add(entry);
 
 		// TODO: Chunks are currently only freed in the destructor.
 		// (Is that a problem? They're probably rarely used, anyway.)
 	}
 
-	status_t	AddEntry(queue_entry* newEntry);
-	void		RemoveEntry(queue_entry* newEntry);
-	void		CleanupAndFree(queue_entry* entry);
+	queue_entry* First() const
+	{
+		return fEventCount > 0 ? fHeap[0] : NULL;
+	}
+
+	queue_entry* EntryAt(int32 index) const
+	{
+		return fHeap[index];
+	}
+
+	status_t		AddEntry(queue_entry* newEntry);
+	void			RemoveEntry(queue_entry* entry);
+	void			Cleanup(const media_timed_event& event);
+	void			CleanupAndFree(queue_entry* entry);
+
+	queue_entry*	Last() const;
+	queue_entry**	SortedEntries() const;
+	void			Rebuild(queue_entry** entries, int32 count);
+
+private:
+	void			_Set(int32 index, queue_entry* entry);
+	void			_SiftUp(int32 index);
+	void			_SiftDown(int32 index);
 
 public:
 	BLocker				fLock;
-	QueueEntryList		fEvents;
 	int32				fEventCount;
+		// may be read without holding the lock
 
 	BTimedEventQueue::cleanup_hook 	fCleanupHook;
 	void* 				fCleanupHookContext;
 
 private:
-	mutex				fEntryAllocationLock;
+	queue_entry**		fHeap;
+	int32				fHeapCapacity;
+	uint64				fNextOrder;
+
 	QueueEntryList		fFreeEntries;
 	QueueEntryList		fChunkHeads;
 	queue_entry			fInlineEntries[8];
@@ -226,14 +277,19 @@ BTimedEventQueue::AddEvent(const media_timed_event& event)
 	if (event.type < B_START)
 		return B_BAD_VALUE;
 
+	BAutolock locker(fData->fLock);
+
 	queue_entry* newEntry = fData->AllocateEntry();
 	if (newEntry == NULL)
 		return B_NO_MEMORY;
 
 	newEntry->event = event;
 
-	BAutolock locker(fData->fLock);
-	return fData->AddEntry(newEntry);
+	status_t status = fData->AddEntry(newEntry);
+	if (status != B_OK)
+		fData->FreeEntry(newEntry);
+
+	return status;
 }
 
 
@@ -243,15 +299,13 @@ BTimedEventQueue::RemoveEvent(const media_timed_event* event)
 	CALLED();
 	BAutolock locker(fData->fLock);
 
-	QueueEntryList::Iterator it = fData->fEvents.GetIterator();
-	while (queue_entry* entry = it.Next()) {
+	for (int32 i = 0; i < fData->fEventCount; i++) {
+		queue_entry* entry = fData->EntryAt(i);
 		if (entry->event != *event)
 			continue;
 
 		fData->RemoveEntry(entry);
 
-		locker.Unlock();
-
 		// No cleanup.
 		fData->FreeEntry(entry);
 		return B_OK;
@@ -270,18 +324,54 @@ BTimedEventQueue::RemoveFirstEvent(media_timed_event* _event)
 	if (fData->fEventCount == 0)
 		return B_ERROR;
 
-	queue_entry* entry = fData->fEvents.Head();
+	queue_entry* entry = fData->First();
 	fData->RemoveEntry(entry);
 
+	media_timed_event event = entry->event;
+	fData->FreeEntry(entry);
+
 	locker.Unlock();
 
 	if (_event != NULL) {
 		// No cleanup.
-		*_event = entry->event;
+		*_event = event;
+	} else
+		fData->Cleanup(event);
+
+	return B_OK;
+}
+
+
+/*!	Removes up to \a *_count events that are due before \a eventTime (or at
+	\a eventTime, if \a inclusive is \c true) from the queue, and copies them
+	in order into \a events. The number of events removed is returned in
+	\a _count.
+	Like RemoveFirstEvent(), this does not clean up the events.
+*/
+status_t
+BTimedEventQueue::RemoveFirstEvents(bigtime_t eventTime,
+	media_timed_event* events, int32* _count, bool inclusive)
+{
+	CALLED();
+
+	if (events == NULL || _count == NULL || *_count < 0)
+		return B_BAD_VALUE;
+
+	BAutolock locker(fData->fLock);
+
+	int32 count = 0;
+	while (count < *_count) {
+		queue_entry* entry = fData->First();
+		if (entry == NULL || entry->event.event_time > eventTime
+			|| (entry->event.event_time == eventTime && !inclusive))
+			break;
+
+		fData->RemoveEntry(entry);
+		events[count++] = entry->event;
 		fData->FreeEntry(entry);
-	} else {
-		fData->CleanupAndFree(entry);
 	}
+
+	*_count = count;
 	return B_OK;
 }
 
@@ -291,30 +381,22 @@ TimedEventQueueData::AddEntry(queue_entry* newEntry)
 {
 	ASSERT(fLock.IsLocked());
 
-	if (fEvents.IsEmpty()) {
-		fEvents.Add(newEntry);
-		fEventCount++;
-		return B_OK;
-	}
-	if (fEvents.First()->event.event_time > newEntry->event.event_time) {
-		fEvents.Add(newEntry, false);
-		fEventCount++;
-		return B_OK;
-	}
+	if (fEventCount == fHeapCapacity) {
+		int32 capacity = max_c(2 * fHeapCapacity, 16);
+		queue_entry** heap = (queue_entry**)realloc(fHeap,
+			capacity * sizeof(queue_entry*));
+		if (heap == NULL)
+			return B_NO_MEMORY;
 
-	QueueEntryList::ReverseIterator it = fEvents.GetReverseIterator();
-	while (queue_entry* entry = it.Next()) {
-		if (newEntry->event.event_time < entry->event.event_time)
-			continue;
-
-		// Insert the new event after this entry.
-		fEvents.InsertAfter(entry, newEntry);
-		fEventCount++;
-		return B_OK;
+		fHeap = heap;
+		fHeapCapacity = capacity;
 	}
 
-	debugger("BTimedEventQueue::AddEvent: Invalid queue!");
-	return B_ERROR;
+	newEntry->order = fNextOrder++;
+	_Set(fEventCount, newEntry);
+	atomic_add(&fEventCount, 1);
+	_SiftUp(newEntry->index);
+	return B_OK;
 }
 
 
@@ -323,15 +405,24 @@ TimedEventQueueData::RemoveEntry(queue_entry* entry)
 {
 	ASSERT(fLock.IsLocked());
 
-	fEvents.Remove(entry);
-	fEventCount--;
+	int32 index = entry->index;
+	int32 last = atomic_add(&fEventCount, -1) - 1;
+	if (index == last)
+		return;
+
+	// Move the last entry into the gap, and restore the heap order
+	_Set(index, fHeap[last]);
+	if (index > 0 && comes_before(fHeap[index], fHeap[(index - 1) / 2]))
+		_SiftUp(index);
+	else
+		_SiftDown(index);
 }
 
 
 void
-TimedEventQueueData::CleanupAndFree(queue_entry* entry)
+TimedEventQueueData::Cleanup(const media_timed_event& event)
 {
-	uint32 cleanup = entry->event.cleanup;
+	uint32 cleanup = event.cleanup;
 	if (cleanup == B_DELETE) {
 		// B_DELETE is a keyboard code, but the Be Book indicates it's a valid
 		// cleanup value. (Early sample code may have used it too.)
@@ -340,23 +431,134 @@ TimedEventQueueData::CleanupAndFree(queue_entry* entry)
 
 	if (cleanup == BTimedEventQueue::B_NO_CLEANUP) {
 		// Nothing to do.
-	} else if (entry->event.type == BTimedEventQueue::B_HANDLE_BUFFER
+	} else if (event.type == BTimedEventQueue::B_HANDLE_BUFFER
 			&& cleanup == BTimedEventQueue::B_RECYCLE_BUFFER) {
-		(reinterpret_cast<BBuffer*>(entry->event.pointer))->Recycle();
+		(reinterpret_cast<BBuffer*>(event.pointer))->Recycle();
 	} else if (cleanup == BTimedEventQueue::B_EXPIRE_TIMER) {
 		// TimerExpired() is invoked in BMediaEventLooper::DispatchEvent; nothing to do.
 	} else if (cleanup >= BTimedEventQueue::B_USER_CLEANUP) {
 		if (fCleanupHook != NULL)
-			(*fCleanupHook)(&entry->event, fCleanupHookContext);
+			(*fCleanupHook)(&event, fCleanupHookContext);
 	} else {
 		ERROR("BTimedEventQueue: Unhandled cleanup! (type %" B_PRId32 ", "
-			"cleanup %" B_PRId32 ")\n", entry->event.type, entry->event.cleanup);
+			"cleanup %" B_PRId32 ")\n", event.type, event.cleanup);
 	}
+}
 
+
+void
+TimedEventQueueData::CleanupAndFree(queue_entry* entry)
+{
+	Cleanup(entry->event);
 	FreeEntry(entry);
 }
 
 
+/*!	Returns the entry that would be removed last, ie. the latest one that
+	was added with the latest time. It has to be one of the leaves of the
+	heap.
+*/
+queue_entry*
+TimedEventQueueData::Last() const
+{
+	if (fEventCount == 0)
+		return NULL;
+
+	queue_entry* last = fHeap[fEventCount - 1];
+	for (int32 i = fEventCount / 2; i < fEventCount - 1; i++) {
+		if (comes_before(last, fHeap[i]))
+			last = fHeap[i];
+	}
+	return last;
+}
+
+
+/*!	Returns a copy of the heap in the order the entries would be removed
+	in, or \c NULL if there are no entries or not enough memory. The caller
+	needs to free() the array.
+*/
+queue_entry**
+TimedEventQueueData::SortedEntries() const
+{
+	if (fEventCount == 0)
+		return NULL;
+
+	queue_entry** entries = (queue_entry**)malloc(
+		fEventCount * sizeof(queue_entry*));
+	if (entries == NULL)
+		return NULL;
+
+	memcpy(entries, fHeap, fEventCount * sizeof(queue_entry*));
+	std::sort(entries, entries + fEventCount, comes_before);
+	return entries;
+}
+
+
+/*!	Restores the heap order after the times of the events have been
+	changed. \a entries are all remaining entries (and \c NULL for removed
+	ones) in their previous order; events that end up with the same time
+	keep that order.
+*/
+void
+TimedEventQueueData::Rebuild(queue_entry** entries, int32 count)
+{
+	ASSERT(fLock.IsLocked());
+
+	for (int32 i = 0; i < count; i++) {
+		if (entries[i] != NULL)
+			entries[i]->order = fNextOrder++;
+	}
+
+	for (int32 i = fEventCount / 2 - 1; i >= 0; i--)
+		_SiftDown(i);
+}
+
+
+void
+TimedEventQueueData::_Set(int32 index, queue_entry* entry)
+{
+	fHeap[index] = entry;
+	entry->index = index;
+}
+
+
+void
+TimedEventQueueData::_SiftUp(int32 index)
+{
+	queue_entry* entry = fHeap[index];
+	while (index > 0) {
+		int32 parent = (index - 1) / 2;
+		if (!comes_before(entry, fHeap[parent]))
+			break;
+
+		_Set(index, fHeap[parent]);
+		index = parent;
+	}
+	_Set(index, entry);
+}
+
+
+void
+TimedEventQueueData::_SiftDown(int32 index)
+{
+	queue_entry* entry = fHeap[index];
+	while (true) {
+		int32 child = 2 * index + 1;
+		if (child >= fEventCount)
+			break;
+		if (child + 1 < fEventCount
+			&& comes_before(fHeap[child + 1], fHeap[child]))
+			child++;
+		if (!comes_before(fHeap[child], entry))
+			break;
+
+		_Set(index, fHeap[child]);
+		index = child;
+	}
+	_Set(index, entry);
+}
+
+
 void
 BTimedEventQueue::SetCleanupHook(cleanup_hook hook, void* context)
 {
@@ -373,8 +575,7 @@ BTimedEventQueue::HasEvents() const
 {
 	CALLED();
 
-	BAutolock locker(fData->fLock);
-	return fData->fEventCount != 0;
+	return atomic_get(&fData->fEventCount) != 0;
 }
 
 
@@ -383,8 +584,7 @@ BTimedEventQueue::EventCount() const
 {
 	CALLED();
 
-	BAutolock locker(fData->fLock);
-	return fData->fEventCount;
+	return atomic_get(&fData->fEventCount);
 }
 
 
@@ -394,7 +594,7 @@ BTimedEventQueue::FirstEvent() const
 	CALLED();
 	BAutolock locker(fData->fLock);
 
-	queue_entry* entry = fData->fEvents.First();
+	queue_entry* entry = fData->First();
 	if (entry == NULL)
 		return NULL;
 	return &entry->event;
@@ -407,7 +607,7 @@ BTimedEventQueue::FirstEventTime() const
 	CALLED();
 	BAutolock locker(fData->fLock);
 
-	queue_entry* entry = fData->fEvents.First();
+	queue_entry* entry = fData->First();
 	if (entry == NULL)
 		return B_INFINITE_TIMEOUT;
 	return entry->event.event_time;
@@ -420,7 +620,7 @@ BTimedEventQueue::LastEvent() const
 	CALLED();
 	BAutolock locker(fData->fLock);
 
-	queue_entry* entry = fData->fEvents.Last();
+	queue_entry* entry = fData->Last();
 	if (entry == NULL)
 		return NULL;
 	return &entry->event;
@@ -433,7 +633,7 @@ BTimedEventQueue::LastEventTime() const
 	CALLED();
 	BAutolock locker(fData->fLock);
 
-	queue_entry* entry = fData->fEvents.Last();
+	queue_entry* entry = fData->Last();
 	if (entry == NULL)
 		return B_INFINITE_TIMEOUT;
 	return entry->event.event_time;
@@ -447,18 +647,22 @@ BTimedEventQueue::FindFirstMatch(bigtime_t eventTime,
 	CALLED();
 	BAutolock locker(fData->fLock);
 
-	QueueEntryList::Iterator it = fData->fEvents.GetIterator();
-	while (queue_entry* entry = it.Next()) {
-		int match = _Match(entry->event, eventTime, direction, inclusive, eventType);
-		if (match == B_DONE)
-			break;
-		if (match == B_NO_ACTION)
+	// No need to sort the events to find the earliest match
+	queue_entry* first = NULL;
+	for (int32 i = 0; i < fData->fEventCount; i++) {
+		queue_entry* entry = fData->EntryAt(i);
+		if (first != NULL && !comes_before(entry, first))
 			continue;
 
-		return &entry->event;
+		if (_Match(entry->event, eventTime, direction, inclusive, eventType)
+				> B_NO_ACTION) {
+			first = entry;
+		}
 	}
 
-	return NULL;
+	if (first == NULL)
+		return NULL;
+	return &first->event;
 }
 
 
@@ -470,10 +674,18 @@ BTimedEventQueue::DoForEach(for_each_hook hook, void* context,
 	CALLED();
 	BAutolock locker(fData->fLock);
 
+	int32 count = fData->fEventCount;
+	if (count == 0)
+		return B_OK;
+
+	queue_entry** entries = fData->SortedEntries();
+	if (entries == NULL)
+		return B_NO_MEMORY;
+
 	bool resort = false;
 
-	QueueEntryList::Iterator it = fData->fEvents.GetIterator();
-	while (queue_entry* entry = it.Next()) {
+	for (int32 i = 0; i < count; i++) {
+		queue_entry* entry = entries[i];
 		int match = _Match(entry->event, eventTime, direction, inclusive, eventType);
 		if (match == B_DONE)
 			break;
@@ -488,6 +700,7 @@ BTimedEventQueue::DoForEach(for_each_hook hook, void* context,
 			case B_REMOVE_EVENT:
 				fData->RemoveEntry(entry);
 				fData->CleanupAndFree(entry);
+				entries[i] = NULL;
 				break;
 
 			case B_RESORT_QUEUE:
@@ -500,15 +713,10 @@ BTimedEventQueue::DoForEach(for_each_hook hook, void* context,
 		}
 	}
 
-	if (resort) {
-		QueueEntryList entries;
-		entries.TakeFrom(&fData->fEvents);
-		fData->fEventCount = 0;
-
-		while (queue_entry* entry = entries.RemoveHead())
-			fData->AddEntry(entry);
-	}
+	if (resort)
+		fData->Rebuild(entries, count);
 
+	free(entries);
 	return B_OK;
 }
 
@@ -520,8 +728,29 @@ BTimedEventQueue::FlushEvents(bigtime_t eventTime, time_direction direction,
 	CALLED();
 	BAutolock locker(fData->fLock);
 
-	QueueEntryList::Iterator it = fData->fEvents.GetIterator();
-	while (queue_entry* entry = it.Next()) {
+	if (direction == B_BEFORE_TIME && eventType == B_ANY_EVENT) {
+		// The events are removed in order anyway
+		while (queue_entry* entry = fData->First()) {
+			if (_Match(entry->event, eventTime, direction, inclusive,
+					eventType) == B_DONE)
+				break;
+
+			fData->RemoveEntry(entry);
+			fData->CleanupAndFree(entry);
+		}
+		return B_OK;
+	}
+
+	int32 count = fData->fEventCount;
+	if (count == 0)
+		return B_OK;
+
+	queue_entry** entries = fData->SortedEntries();
+	if (entries == NULL)
+		return B_NO_MEMORY;
+
+	for (int32 i = 0; i < count; i++) {
+		queue_entry* entry = entries[i];
 		int match = _Match(entry->event, eventTime, direction, inclusive, eventType);
 		if (match == B_DONE)
 			break;
@@ -532,6 +761,7 @@ BTimedEventQueue::FlushEvents(bigtime_t eventTime, time_direction direction,
 		fData->CleanupAndFree(entry);
 	}
 
+	free(entries);
 	return B_OK;
 }
 
@@ -44,6 +44,13 @@ ActivateRepositoryCacheJob::Execute()
 	if (result != B_OK)
 		return result;
 
+	// The solver's image of the previous cache is stale now. It would be
+	// ignored anyway, since its checksum doesn't match, but there's no point
+	// in keeping it around until the solver replaces it.
+	BEntry solvImageEntry(&fTargetDirectory,
+		(BString(fRepositoryName) << ".solv").String());
+	solvImageEntry.Remove();
+
 	// TODO: propagate some repository attributes to file attributes
 
 	return B_OK;
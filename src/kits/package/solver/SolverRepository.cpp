@@ -9,6 +9,8 @@
 
 #include <package/solver/SolverRepository.h>
 
+#include <Path.h>
+
 #include <package/PackageDefs.h>
 #include <package/PackageRoster.h>
 #include <package/RepositoryCache.h>
@@ -28,7 +30,8 @@ BSolverRepository::BSolverRepository()
 	fPriority(0),
 	fIsInstalled(false),
 	fPackages(kInitialPackageListSize),
-	fChangeCount(0)
+	fChangeCount(0),
+	fCachePath()
 {
 }
 
@@ -39,7 +42,8 @@ BSolverRepository::BSolverRepository(const BString& name)
 	fPriority(0),
 	fIsInstalled(false),
 	fPackages(kInitialPackageListSize),
-	fChangeCount(0)
+	fChangeCount(0),
+	fCachePath()
 {
 	SetTo(name);
 }
@@ -51,7 +55,8 @@ BSolverRepository::BSolverRepository(BPackageInstallationLocation location)
 	fPriority(0),
 	fIsInstalled(false),
 	fPackages(kInitialPackageListSize),
-	fChangeCount(0)
+	fChangeCount(0),
+	fCachePath()
 {
 	SetTo(location);
 }
@@ -63,7 +68,8 @@ BSolverRepository::BSolverRepository(BAllInstallationLocations)
 	fPriority(0),
 	fIsInstalled(false),
 	fPackages(kInitialPackageListSize),
-	fChangeCount(0)
+	fChangeCount(0),
+	fCachePath()
 {
 	SetTo(B_ALL_INSTALLATION_LOCATIONS);
 }
@@ -75,7 +81,8 @@ BSolverRepository::BSolverRepository(const BRepositoryConfig& config)
 	fPriority(0),
 	fIsInstalled(false),
 	fPackages(kInitialPackageListSize),
-	fChangeCount(0)
+	fChangeCount(0),
+	fCachePath()
 {
 	SetTo(config);
 }
@@ -159,6 +166,7 @@ BSolverRepository::SetTo(const BRepositoryConfig& config)
 		}
 	}
 
+	_SetCachePath(cache);
 	return B_OK;
 }
 
@@ -184,6 +192,7 @@ BSolverRepository::SetTo(const BRepositoryCache& cache)
 		}
 	}
 
+	_SetCachePath(cache);
 	return B_OK;
 }
 
@@ -196,6 +205,7 @@ BSolverRepository::Unset()
 	fIsInstalled = false;
 	fPackages.MakeEmpty();
 	fChangeCount++;
+	fCachePath.Truncate(0);
 }
 
 
@@ -275,6 +285,7 @@ BSolverRepository::AddPackage(const BPackageInfo& info,
 	}
 
 	fChangeCount++;
+	fCachePath.Truncate(0);
 
 	if (_package != NULL)
 		*_package = package;
@@ -310,6 +321,7 @@ BSolverRepository::RemovePackage(BSolverPackage* package)
 		return false;
 
 	fChangeCount++;
+	fCachePath.Truncate(0);
 	return true;
 }
 
@@ -332,4 +344,20 @@ BSolverRepository::ChangeCount() const
 }
 
 
+const BString&
+BSolverRepository::CachePath() const
+{
+	return fCachePath;
+}
+
+
+void
+BSolverRepository::_SetCachePath(const BRepositoryCache& cache)
+{
+	BPath path;
+	if (cache.Entry().GetPath(&path) == B_OK)
+		fCachePath = path.Path();
+}
+
+
 }	// namespace BPackageKit
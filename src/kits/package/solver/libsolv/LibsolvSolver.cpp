@@ -10,7 +10,10 @@
 #include "LibsolvSolver.h"
 
 #include <errno.h>
+#include <stdio.h>
+#include <string.h>
 #include <sys/utsname.h>
+#include <unistd.h>
 
 #include <new>
 
@@ -18,6 +21,8 @@
 #include <solv/poolarch.h>
 #include <solv/repo.h>
 #include <solv/repo_haiku.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_write.h>
 #include <solv/selection.h>
 #include <solv/solverdebug.h>
 
@@ -31,13 +36,36 @@
 #include <package/solver/SolverResult.h>
 
 #include <AutoDeleter.h>
+#include <AutoDeleterPosix.h>
 #include <ObjectList.h>
+#include <package/ChecksumAccessors.h>
 
 
 // TODO: libsolv doesn't have any helpful out-of-memory handling. It just just
 // abort()s. Obviously that isn't good behavior for a library.
 
 
+// The libsolv data of a repository read from a repository cache is kept in a
+// "<cache>.solv" file next to the cache, so that the packages don't have to be
+// converted again every time a pool is created. The image is only used, if
+// the checksum of the cache it was created from still matches.
+static const char* const kSolvImageSuffix = ".solv";
+static const char kSolvImageMagic[4] = { 'h', 's', 'l', 'v' };
+static const uint32 kSolvImageVersion = 1;
+
+
+struct SolvImageHeader {
+	char	magic[4];
+	uint32	version;
+	uint32	packageCount;
+	char	checksum[64];
+		// SHA-256 of the repository cache, as hex string
+};
+
+
+using BPackageKit::BPrivate::GeneralFileChecksumAccessor;
+
+
 BSolver*
 BPackageKit::create_solver()
 {
@@ -748,21 +776,28 @@ LibsolvSolver::_AddRepositories()
 		repo->priority = -1 - repository->Priority();
 		repo->appdata = (void*)repositoryInfo;
 
-		int32 packageCount = repository->CountPackages();
-		for (int32 k = 0; k < packageCount; k++) {
-			BSolverPackage* package = repository->PackageAt(k);
-			Id solvableId = repo_add_haiku_package_info(repo, package->Info(),
-				REPO_REUSE_REPODATA | REPO_NO_INTERNALIZE);
-
-			try {
-				fSolvablePackages[solvableId] = package;
-				fPackageSolvables[package] = solvableId;
-			} catch (std::bad_alloc&) {
-				return B_NO_MEMORY;
+		// use the repository cache's solv image, if it is up to date
+		BString imagePath;
+		BString checksum;
+		if (!repository->CachePath().IsEmpty()) {
+			imagePath = repository->CachePath();
+			imagePath << kSolvImageSuffix;
+			if (GeneralFileChecksumAccessor(BEntry(repository->CachePath()))
+					.GetChecksum(checksum) != B_OK
+				|| checksum.Length() != sizeof(SolvImageHeader().checksum)) {
+				imagePath.Truncate(0);
 			}
 		}
 
-		repo_internalize(repo);
+		if (imagePath.IsEmpty()
+			|| !_LoadSolvImage(repository, repo, imagePath, checksum)) {
+			error = _AddRepositoryPackages(repository, repo);
+			if (error != B_OK)
+				return error;
+
+			if (!imagePath.IsEmpty())
+				_WriteSolvImage(repository, repo, imagePath, checksum);
+		}
 
 		if (repository->IsInstalled()) {
 			fInstalledRepository = repositoryInfo;
@@ -779,6 +814,138 @@ LibsolvSolver::_AddRepositories()
 }
 
 
+status_t
+LibsolvSolver::_AddRepositoryPackages(BSolverRepository* repository, Repo* repo)
+{
+	int32 packageCount = repository->CountPackages();
+	for (int32 i = 0; i < packageCount; i++) {
+		BSolverPackage* package = repository->PackageAt(i);
+		Id solvableId = repo_add_haiku_package_info(repo, package->Info(),
+			REPO_REUSE_REPODATA | REPO_NO_INTERNALIZE);
+
+		try {
+			fSolvablePackages[solvableId] = package;
+			fPackageSolvables[package] = solvableId;
+		} catch (std::bad_alloc&) {
+			return B_NO_MEMORY;
+		}
+	}
+
+	repo_internalize(repo);
+	return B_OK;
+}
+
+
+/*!	Adds the solvables of the repository from the solv image at \a path, if it
+	was created from a repository cache with the given checksum and matches
+	the repository's packages. Otherwise the repo is left empty.
+*/
+bool
+LibsolvSolver::_LoadSolvImage(BSolverRepository* repository, Repo* repo,
+	const BString& path, const BString& checksum)
+{
+	FILE* file = fopen(path.String(), "rb");
+	if (file == NULL)
+		return false;
+	FileCloser fileCloser(file);
+
+	SolvImageHeader header;
+	if (fread(&header, sizeof(header), 1, file) != 1
+		|| memcmp(header.magic, kSolvImageMagic, sizeof(header.magic)) != 0
+		|| header.version != kSolvImageVersion
+		|| header.packageCount != (uint32)repository->CountPackages()
+		|| memcmp(header.checksum, checksum.String(), sizeof(header.checksum))
+			!= 0) {
+		return false;
+	}
+
+	if (repo_add_solv(repo, file, 0) != 0) {
+		repo_empty(repo, 1);
+		return false;
+	}
+
+	// The solvables have been written in the order of the repository's
+	// packages, skipping the invalid ones, just like _AddRepositoryPackages()
+	// adds them. Map them to the packages again, and make sure they actually
+	// match.
+	int32 packageCount = repository->CountPackages();
+	int32 index = 0;
+	Id solvableId;
+	Solvable* solvable;
+	bool matches = true;
+	try {
+		FOR_REPO_SOLVABLES(repo, solvableId, solvable) {
+			BSolverPackage* package = NULL;
+			while (index < packageCount) {
+				package = repository->PackageAt(index++);
+				if (package->Info().InitCheck() == B_OK)
+					break;
+				package = NULL;
+			}
+
+			if (package == NULL
+				|| package->Info().Name() != pool_id2str(fPool, solvable->name)) {
+				matches = false;
+				break;
+			}
+
+			fSolvablePackages[solvableId] = package;
+			fPackageSolvables[package] = solvableId;
+		}
+	} catch (std::bad_alloc&) {
+		matches = false;
+	}
+
+	if (!matches) {
+		FOR_REPO_SOLVABLES(repo, solvableId, solvable) {
+			std::map<Id, BSolverPackage*>::iterator it
+				= fSolvablePackages.find(solvableId);
+			if (it != fSolvablePackages.end()) {
+				fPackageSolvables.erase(it->second);
+				fSolvablePackages.erase(it);
+			}
+		}
+		repo_empty(repo, 1);
+		return false;
+	}
+
+	return true;
+}
+
+
+/*!	Writes the solvables of the repo into a solv image at \a path. Errors are
+	ignored, the image is just an optimization.
+*/
+void
+LibsolvSolver::_WriteSolvImage(BSolverRepository* repository, Repo* repo,
+	const BString& path, const BString& checksum)
+{
+	// write to a temporary file first, so that concurrent solvers never see
+	// an incomplete image
+	BString tempPath(path);
+	tempPath << ".tmp-" << (int32)getpid();
+
+	FILE* file = fopen(tempPath.String(), "wb");
+	if (file == NULL)
+		return;
+
+	SolvImageHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kSolvImageMagic, sizeof(header.magic));
+	header.version = kSolvImageVersion;
+	header.packageCount = repository->CountPackages();
+	memcpy(header.checksum, checksum.String(), sizeof(header.checksum));
+
+	bool success = fwrite(&header, sizeof(header), 1, file) == 1
+		&& repo_write(repo, file) == 0;
+	if (fclose(file) != 0)
+		success = false;
+
+	if (!success || rename(tempPath.String(), path.String()) != 0)
+		unlink(tempPath.String());
+}
+
+
 LibsolvSolver::RepositoryInfo*
 LibsolvSolver::_InstalledRepository() const
 {
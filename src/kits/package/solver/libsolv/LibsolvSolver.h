@@ -19,6 +19,8 @@
 using namespace BPackageKit;
 
 
+class BString;
+
 namespace BPackageKit {
 	class BPackageResolvableExpression;
 	class BSolverPackage;
@@ -95,6 +97,14 @@ private:
 
 			bool				_HaveRepositoriesChanged() const;
 			status_t			_AddRepositories();
+			status_t			_AddRepositoryPackages(
+									BSolverRepository* repository, Repo* repo);
+			bool				_LoadSolvImage(BSolverRepository* repository,
+									Repo* repo, const BString& path,
+									const BString& checksum);
+			void				_WriteSolvImage(BSolverRepository* repository,
+									Repo* repo, const BString& path,
+									const BString& checksum);
 			RepositoryInfo*		_InstalledRepository() const;
 			RepositoryInfo*		_GetRepositoryInfo(
 									BSolverRepository* repository) const;
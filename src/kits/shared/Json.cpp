@@ -13,6 +13,10 @@
 #include <ctype.h>
 #include <cerrno>
 
+#if defined(__SSE2__)
+#	include <emmintrin.h>
+#endif
+
 #include <AutoDeleter.h>
 #include <DataIO.h>
 #include <UnicodeChar.h>
@@ -43,6 +47,118 @@ static const size_t kAssemblyBufferSizeIncrement = 256;
 
 static const size_t kMaximumUtf8SequenceLength = 7;
 
+/*!	Data read from a stream is read in blocks of this size, so that the
+	characters can be scanned without a call to the stream for each of them.
+*/
+
+static const size_t kReadBufferSize = 16 * 1024;
+
+
+/*!	Returns the first character between `position` and `end` that is either
+	the end of a string, the start of an escape sequence or a control
+	character, or `end` if there is no such character.
+*/
+
+static inline char*
+find_special_string_char(char* position, char* end)
+{
+#if defined(__SSE2__)
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i lastControl = _mm_set1_epi8(0x1f);
+
+	while (end - position >= 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)position);
+		__m128i special = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+				_mm_cmpeq_epi8(chunk, backslash)),
+			_mm_cmpeq_epi8(_mm_min_epu8(chunk, lastControl), chunk));
+
+		int mask = _mm_movemask_epi8(special);
+		if (mask != 0)
+			return position + __builtin_ctz(mask);
+
+		position += 16;
+	}
+#endif
+
+	while (position < end) {
+		uint8 c = static_cast<uint8>(*position);
+		if (c == '"' || c == '\\' || c < 0x20)
+			break;
+		position++;
+	}
+
+	return position;
+}
+
+
+/*!	Returns the first character between `position` and `end` that is not
+	whitespace, or `end` if there is no such character. The new lines that
+	were skipped are added to `lineNumber`.
+*/
+
+static inline char*
+skip_whitespace(char* position, char* end, uint32& lineNumber)
+{
+	// there is often no whitespace at all
+	if (position < end && *position != ' ' && *position != 0x0a
+		&& *position != 0x0d) {
+		return position;
+	}
+
+#if defined(__SSE2__)
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i newline = _mm_set1_epi8(0x0a);
+	const __m128i carriageReturn = _mm_set1_epi8(0x0d);
+
+	while (end - position >= 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)position);
+		__m128i lineBreak = _mm_or_si128(_mm_cmpeq_epi8(chunk, newline),
+			_mm_cmpeq_epi8(chunk, carriageReturn));
+
+		int lineBreakMask = _mm_movemask_epi8(lineBreak);
+		int otherMask = ~_mm_movemask_epi8(
+			_mm_or_si128(lineBreak, _mm_cmpeq_epi8(chunk, space))) & 0xffff;
+
+		if (otherMask != 0)
+			lineBreakMask &= (1 << __builtin_ctz(otherMask)) - 1;
+
+		for (; lineBreakMask != 0; lineBreakMask &= lineBreakMask - 1)
+			lineNumber++;
+
+		if (otherMask != 0)
+			return position + __builtin_ctz(otherMask);
+
+		position += 16;
+	}
+#endif
+
+	while (position < end) {
+		switch (*position) {
+			case 0x0a: // newline
+			case 0x0d: // cr
+				lineNumber++;
+			case ' ': // space
+				break;
+
+			default:
+				return position;
+		}
+		position++;
+	}
+
+	return position;
+}
+
+
+static inline bool
+is_number_char(char c)
+{
+	return isdigit(c) || c == '.' || c == '-' || c == 'e' || c == 'E'
+		|| c == '+';
+}
+
 
 class JsonParseAssemblyBuffer {
 public:
@@ -68,6 +184,11 @@ public:
 		return fAssemblyBuffer;
 	}
 
+	bool IsEmpty() const
+	{
+		return fAssemblyBufferUsedSize == 0;
+	}
+
 	/*! This method should be used each time that the assembly buffer has
 		been finished with by some section of logic.
 	*/
@@ -100,7 +221,7 @@ public:
 		return result;
 	}
 
-	status_t AppendCharacters(char* str, size_t len)
+	status_t AppendCharacters(const char* str, size_t len)
 	{
 		status_t result = _EnsureAssemblyBufferAllocatedSize(fAssemblyBufferUsedSize + len);
 
@@ -183,7 +304,14 @@ private:
 };
 
 
-/*! This class carries state around the parsing process. */
+/*! This class carries state around the parsing process.
+
+	The input is either read from a stream in blocks into a buffer owned by
+	the context, or it is taken directly from memory. In both cases the
+	parser can look at the buffered characters in spans. If the buffer may be
+	modified, strings that are entirely within the buffer are terminated in
+	place instead of being copied into the assembly buffer.
+*/
 
 class JsonParseContext {
 public:
@@ -192,8 +320,44 @@ public:
 		fListener(listener),
 		fData(data),
 		fLineNumber(1), // 1 is the first line
-		fPushbackChar(0),
-		fHasPushbackChar(false),
+		fBuffer((char*) malloc(kReadBufferSize)),
+		fPosition(fBuffer),
+		fEnd(fBuffer),
+		fOwnsBuffer(true),
+		fBufferWritable(true),
+		fAssemblyBuffer(new JsonParseAssemblyBuffer())
+	{
+	}
+
+
+	JsonParseContext(const char* data, size_t length,
+		BJsonEventListener* listener)
+		:
+		fListener(listener),
+		fData(NULL),
+		fLineNumber(1),
+		fBuffer(const_cast<char*>(data)),
+		fPosition(fBuffer),
+		fEnd(fBuffer + length),
+		fOwnsBuffer(false),
+		fBufferWritable(false),
+		fAssemblyBuffer(new JsonParseAssemblyBuffer())
+	{
+	}
+
+
+	/*!	The data will be modified while it is parsed. */
+
+	JsonParseContext(char* data, size_t length, BJsonEventListener* listener)
+		:
+		fListener(listener),
+		fData(NULL),
+		fLineNumber(1),
+		fBuffer(data),
+		fPosition(fBuffer),
+		fEnd(fBuffer + length),
+		fOwnsBuffer(false),
+		fBufferWritable(true),
 		fAssemblyBuffer(new JsonParseAssemblyBuffer())
 	{
 	}
@@ -201,10 +365,18 @@ public:
 
 	~JsonParseContext()
 	{
+		if (fOwnsBuffer)
+			free(fBuffer);
 		delete fAssemblyBuffer;
 	}
 
 
+	status_t InitCheck() const
+	{
+		return fBuffer != NULL || !fOwnsBuffer ? B_OK : B_NO_MEMORY;
+	}
+
+
 	BJsonEventListener* Listener() const
 	{
 		return fListener;
@@ -230,21 +402,65 @@ public:
 
 	status_t NextChar(char* buffer)
 	{
-		if (fHasPushbackChar) {
-			buffer[0] = fPushbackChar;
-			fHasPushbackChar = false;
-			return B_OK;
+		if (fPosition == fEnd) {
+			status_t result = _FillBuffer();
+			if (result != B_OK)
+				return result;
 		}
 
-		return Data()->ReadExactly(buffer, 1);
+		buffer[0] = *fPosition++;
+		return B_OK;
 	}
 
+	/*!	The character must be the last one returned by NextChar(). */
+
 	void PushbackChar(char c)
 	{
-		if (fHasPushbackChar)
-			debugger("illegal state - more than one character pushed back");
-		fPushbackChar = c;
-		fHasPushbackChar = true;
+		if (fPosition == fBuffer || fPosition[-1] != c)
+			debugger("illegal state - the character was not just read");
+		fPosition--;
+	}
+
+	/*!	Skips the whitespace that is already buffered. */
+
+	void SkipBufferedWhitespace()
+	{
+		fPosition = skip_whitespace(fPosition, fEnd, fLineNumber);
+	}
+
+	/*!	Consumes the buffered characters of a string up to its end, the next
+		escape sequence or the end of the buffer.
+	*/
+
+	size_t NextStringSpan(char** _span)
+	{
+		*_span = fPosition;
+		fPosition = find_special_string_char(fPosition, fEnd);
+		return fPosition - *_span;
+	}
+
+	/*!	If the string ends right at the current position, and the buffer may
+		be modified, the string span just returned by NextStringSpan() is
+		terminated in place and the end of the string is consumed.
+	*/
+
+	bool TerminateStringInPlace()
+	{
+		if (!fBufferWritable || fPosition == fEnd || *fPosition != '"')
+			return false;
+
+		*fPosition++ = '\0';
+		return true;
+	}
+
+	/*!	Consumes the buffered characters that may be part of a number. */
+
+	size_t NextNumberSpan(const char** _span)
+	{
+		*_span = fPosition;
+		while (fPosition < fEnd && is_number_char(*fPosition))
+			fPosition++;
+		return fPosition - *_span;
 	}
 
 
@@ -254,12 +470,33 @@ public:
 	}
 
 
+private:
+	status_t _FillBuffer()
+	{
+		if (fData == NULL)
+			return B_PARTIAL_READ;
+
+		ssize_t bytesRead = fData->Read(fBuffer, kReadBufferSize);
+		if (bytesRead < 0)
+			return bytesRead;
+		if (bytesRead == 0)
+			return B_PARTIAL_READ;
+
+		fPosition = fBuffer;
+		fEnd = fBuffer + bytesRead;
+		return B_OK;
+	}
+
+
 private:
 	BJsonEventListener*		fListener;
 	BDataIO*				fData;
 	uint32					fLineNumber;
-	char					fPushbackChar;
-	bool					fHasPushbackChar;
+	char*					fBuffer;
+	char*					fPosition;
+	char*					fEnd;
+	bool					fOwnsBuffer;
+	bool					fBufferWritable;
 	JsonParseAssemblyBuffer*
 							fAssemblyBuffer;
 };
@@ -275,12 +512,28 @@ BJson::Parse(const BString& JSON, BMessage& message)
 status_t
 BJson::Parse(const char* JSON, size_t length, BMessage& message)
 {
-	BMemoryIO* input = new BMemoryIO(JSON, length);
-	ObjectDeleter<BMemoryIO> inputDeleter(input);
 	BJsonMessageWriter* writer = new BJsonMessageWriter(message);
 	ObjectDeleter<BJsonMessageWriter> writerDeleter(writer);
 
-	Parse(input, writer);
+	JsonParseContext context(JSON, length, writer);
+	Parse(context);
+	status_t result = writer->ErrorStatus();
+
+	return result;
+}
+
+
+/*!	Parses the JSON data in place; it is modified in the process, so that
+	strings need not be copied. The data should not be used afterwards.
+*/
+
+status_t
+BJson::ParseInSitu(char* JSON, size_t length, BMessage& message)
+{
+	BJsonMessageWriter* writer = new BJsonMessageWriter(message);
+	ObjectDeleter<BJsonMessageWriter> writerDeleter(writer);
+
+	ParseInSitu(JSON, length, writer);
 	status_t result = writer->ErrorStatus();
 
 	return result;
@@ -302,14 +555,43 @@ BJson::Parse(const char* JSON, BMessage& message)
      - array start
      - object end
     Each event is sent to the listener to process as required.
+
+    The data is read in blocks, so more data than the JSON value itself may
+    be consumed from the stream.
 */
 
 void
 BJson::Parse(BDataIO* data, BJsonEventListener* listener)
 {
 	JsonParseContext context(data, listener);
-	ParseAny(context);
-	listener->Complete();
+	Parse(context);
+}
+
+
+/*! Like Parse(), but the JSON data is in memory and is modified in the
+    process, so that strings need not be copied. The content of the events
+    is only valid while they are handled, as usual.
+*/
+
+void
+BJson::ParseInSitu(char* JSON, size_t length, BJsonEventListener* listener)
+{
+	JsonParseContext context(JSON, length, listener);
+	Parse(context);
+}
+
+
+void
+BJson::Parse(JsonParseContext& jsonParseContext)
+{
+	if (jsonParseContext.InitCheck() == B_OK)
+		ParseAny(jsonParseContext);
+	else {
+		jsonParseContext.Listener()->HandleError(B_NO_MEMORY, -1,
+			"unable to allocate the read buffer");
+	}
+
+	jsonParseContext.Listener()->Complete();
 }
 
 
@@ -346,6 +628,8 @@ bool
 BJson::NextNonWhitespaceChar(JsonParseContext& jsonParseContext, char* c)
 {
 	while (true) {
+		jsonParseContext.SkipBufferedWhitespace();
+
 		if (!NextChar(jsonParseContext, c))
 			return false;
 
@@ -718,6 +1002,23 @@ BJson::ParseString(JsonParseContext& jsonParseContext,
 	JsonParseAssemblyBufferResetter assembleBufferResetter(assemblyBuffer);
 
 	while(true) {
+		// the characters that need no special treatment are taken in one go
+		char* span;
+		size_t spanLength = jsonParseContext.NextStringSpan(&span);
+
+		if (assemblyBuffer->IsEmpty()
+			&& jsonParseContext.TerminateStringInPlace()) {
+			jsonParseContext.Listener()->Handle(BJsonEvent(eventType, span));
+			return true;
+		}
+
+		if (spanLength > 0
+			&& assemblyBuffer->AppendCharacters(span, spanLength) != B_OK) {
+			jsonParseContext.Listener()->HandleError(B_NO_MEMORY,
+				jsonParseContext.LineNumber(), "unable to store string");
+			return false;
+		}
+
 		if (!NextChar(jsonParseContext, &c))
     		return false;
 
@@ -873,13 +1174,18 @@ BJson::ParseNumber(JsonParseContext& jsonParseContext)
 	JsonParseAssemblyBufferResetter assembleBufferResetter(assemblyBuffer);
 
 	while (true) {
+		const char* span;
+		size_t spanLength = jsonParseContext.NextNumberSpan(&span);
+		if (spanLength > 0)
+			assemblyBuffer->AppendCharacters(span, spanLength);
+
 		char c;
 		status_t result = jsonParseContext.NextChar(&c);
 
 		switch (result) {
 			case B_OK:
 			{
-				if (isdigit(c) || c == '.' || c == '-' || c == 'e' || c == 'E' || c == '+') {
+				if (is_number_char(c)) {
 					assemblyBuffer->AppendCharacter(c);
 					break;
 				}
@@ -10,11 +10,17 @@
 #include <CopyEngine.h>
 
 #include <errno.h>
+#include <limits.h>
+#include <malloc.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
+#include <deque>
+#include <new>
+
 #include <Directory.h>
 #include <Entry.h>
 #include <File.h>
@@ -23,6 +29,8 @@
 #include <SymLink.h>
 #include <TypeConstants.h>
 
+#include <AutoLocker.h>
+
 
 namespace BPrivate {
 
@@ -30,6 +38,162 @@ namespace BPrivate {
 static const size_t kDefaultBufferSize = 1024 * 1024;
 static const size_t kSmallBufferSize = 64 * 1024;
 
+static const int32 kDefaultThreadCount = 0;
+static const size_t kJobQueueCapacity = 256;
+static const int32 kMaxBatchedAttributes = 32;
+static const bigtime_t kProgressInterval = 250000;
+
+
+typedef AutoLocker<BLocker> Locker;
+
+
+static char*
+allocate_buffer(size_t& _size)
+{
+	char* buffer = (char*)memalign(B_PAGE_SIZE, kDefaultBufferSize);
+	if (buffer != NULL) {
+		_size = kDefaultBufferSize;
+		return buffer;
+	}
+
+	buffer = (char*)memalign(B_PAGE_SIZE, kSmallBufferSize);
+	if (buffer != NULL)
+		_size = kSmallBufferSize;
+	return buffer;
+}
+
+
+// #pragma mark - BCopyEngine::Directory
+
+
+/*!	A directory that is being copied recursively. It is referenced by the
+	thread scanning it, by its subdirectories, and by its files queued for
+	the workers. When the last reference is released, the directory is done,
+	and the controller is told about it. Errors of its entries that haven't
+	been handled by the controller are passed on to the parent directory.
+*/
+struct BCopyEngine::Directory {
+	Directory(Directory* parent, const char* path)
+		:
+		parent(parent),
+		path(path),
+		referenceCount(1),
+		error(B_OK)
+	{
+	}
+
+	Directory*	parent;
+	BString		path;
+	int32		referenceCount;
+	status_t	error;
+};
+
+
+struct BCopyEngine::FileJob {
+	BString		sourcePath;
+	BString		destPath;
+	struct stat	sourceStat;
+	Directory*	directory;
+};
+
+
+struct BCopyEngine::PendingAttribute {
+	char		name[B_ATTR_NAME_LENGTH];
+	uint32		type;
+	size_t		offset;
+	size_t		size;
+};
+
+
+struct BCopyEngine::Worker {
+	BCopyEngine*	engine;
+	thread_id		thread;
+	char*			buffer;
+	size_t			bufferSize;
+};
+
+
+// #pragma mark - BCopyEngine::JobQueue
+
+
+class BCopyEngine::JobQueue {
+public:
+	JobQueue(size_t capacity)
+		:
+		fCapacity(capacity),
+		fClosed(false)
+	{
+		pthread_mutex_init(&fLock, NULL);
+		pthread_cond_init(&fNotEmpty, NULL);
+		pthread_cond_init(&fNotFull, NULL);
+	}
+
+	~JobQueue()
+	{
+		pthread_cond_destroy(&fNotFull);
+		pthread_cond_destroy(&fNotEmpty);
+		pthread_mutex_destroy(&fLock);
+	}
+
+	bool Push(FileJob* job)
+	{
+		pthread_mutex_lock(&fLock);
+		while (fJobs.size() >= fCapacity && !fClosed)
+			pthread_cond_wait(&fNotFull, &fLock);
+
+		bool pushed = false;
+		if (!fClosed) {
+			try {
+				fJobs.push_back(job);
+				pushed = true;
+			} catch (std::bad_alloc&) {
+			}
+		}
+		pthread_mutex_unlock(&fLock);
+
+		if (pushed)
+			pthread_cond_signal(&fNotEmpty);
+		return pushed;
+	}
+
+	//!	Returns \c NULL once the queue has been closed and is empty.
+	FileJob* Pop()
+	{
+		pthread_mutex_lock(&fLock);
+		while (fJobs.empty() && !fClosed)
+			pthread_cond_wait(&fNotEmpty, &fLock);
+
+		FileJob* job = NULL;
+		if (!fJobs.empty()) {
+			job = fJobs.front();
+			fJobs.pop_front();
+		}
+		pthread_mutex_unlock(&fLock);
+
+		if (job != NULL)
+			pthread_cond_signal(&fNotFull);
+		return job;
+	}
+
+	void Close()
+	{
+		pthread_mutex_lock(&fLock);
+		fClosed = true;
+		pthread_mutex_unlock(&fLock);
+
+		pthread_cond_broadcast(&fNotEmpty);
+		pthread_cond_broadcast(&fNotFull);
+	}
+
+private:
+	pthread_mutex_t			fLock;
+	pthread_cond_t			fNotEmpty;
+	pthread_cond_t			fNotFull;
+	std::deque<FileJob*>	fJobs;
+	size_t					fCapacity;
+	bool					fClosed;
+};
+
 
 // #pragma mark - BCopyEngine
 
@@ -39,14 +203,24 @@ BCopyEngine::BCopyEngine(uint32 flags)
 	fController(NULL),
 	fFlags(flags),
 	fBuffer(NULL),
-	fBufferSize(0)
+	fBufferSize(0),
+	fThreadCount(kDefaultThreadCount),
+	fWorkers(NULL),
+	fWorkerCount(0),
+	fJobQueue(NULL),
+	fError(B_OK),
+	fLock("copy engine"),
+	fBytesCopied(0),
+	fStartTime(0),
+	fLastProgressTime(0)
 {
 }
 
 
 BCopyEngine::~BCopyEngine()
 {
-	delete[] fBuffer;
+	_DeleteWorkers();
+	free(fBuffer);
 }
 
 
@@ -95,20 +269,40 @@ BCopyEngine::RemoveFlags(uint32 flags)
 }
 
 
+int32
+BCopyEngine::ThreadCount() const
+{
+	return fThreadCount;
+}
+
+
+/*!	Sets the number of threads that copy the files of a directory tree
+	copied recursively, while the calling thread walks the tree and creates
+	the directories and symlinks in order. With a count of 0, the default,
+	everything is copied by the calling thread.
+
+	With worker threads, the controller may be invoked from any of them, but
+	never concurrently. A directory is only reported finished after all of
+	its entries are.
+*/
+BCopyEngine&
+BCopyEngine::SetThreadCount(int32 count)
+{
+	_DeleteWorkers();
+	fThreadCount = count > 0 ? count : 0;
+	return *this;
+}
+
+
 status_t
 BCopyEngine::CopyEntry(const Entry& sourceEntry, const Entry& destEntry)
 {
 	if (fBuffer == NULL) {
-		fBuffer = new(std::nothrow) char[kDefaultBufferSize];
+		fBuffer = allocate_buffer(fBufferSize);
 		if (fBuffer == NULL) {
-			fBuffer = new(std::nothrow) char[kSmallBufferSize];
-			if (fBuffer == NULL) {
-				_NotifyError(B_NO_MEMORY, "Failed to allocate buffer");
-				return B_NO_MEMORY;
-			}
-			fBufferSize = kSmallBufferSize;
-		} else
-			fBufferSize = kDefaultBufferSize;
+			_NotifyError(B_NO_MEMORY, "Failed to allocate buffer");
+			return B_NO_MEMORY;
+		}
 	}
 
 	BPath sourcePathBuffer;
@@ -123,15 +317,27 @@ BCopyEngine::CopyEntry(const Entry& sourceEntry, const Entry& destEntry)
 	if (error != B_OK)
 		return error;
 
-	return _CopyEntry(sourcePath, destPath);
+	fError = B_OK;
+	fBytesCopied = 0;
+	fStartTime = fLastProgressTime = system_time();
+
+	error = _CopyEntry(sourcePath, destPath, NULL);
+
+	_StopWorkers();
+
+	if (fController != NULL && fBytesCopied > 0)
+		_ReportProgress(system_time());
+
+	return error != B_OK ? error : fError;
 }
 
 
 status_t
-BCopyEngine::_CopyEntry(const char* sourcePath, const char* destPath)
+BCopyEngine::_CopyEntry(const char* sourcePath, const char* destPath,
+	Directory* parent)
 {
 	// apply entry filter
-	if (fController != NULL && !fController->EntryStarted(sourcePath))
+	if (!_EntryStarted(sourcePath))
 		return B_OK;
 
 	// stat source
@@ -177,9 +383,16 @@ BCopyEngine::_CopyEntry(const char* sourcePath, const char* destPath)
 		}
 	}
 
+	// Files in a directory are handed over to the workers, if there are any.
+	if (S_ISREG(sourceStat.st_mode)) {
+		if (parent != NULL && fJobQueue != NULL)
+			return _QueueFile(sourcePath, sourceStat, destPath, parent);
+		return _CopyFile(sourcePath, sourceStat, destPath, fBuffer,
+			fBufferSize);
+	}
+
 	// open source node
 	BNode _sourceNode;
-	BFile sourceFile;
 	BDirectory sourceDir;
 	BNode* sourceNode = NULL;
 	status_t error;
@@ -187,9 +400,6 @@ BCopyEngine::_CopyEntry(const char* sourcePath, const char* destPath)
 	if (S_ISDIR(sourceStat.st_mode)) {
 		error = sourceDir.SetTo(sourcePath);
 		sourceNode = &sourceDir;
-	} else if (S_ISREG(sourceStat.st_mode)) {
-		error = sourceFile.SetTo(sourcePath, B_READ_ONLY);
-		sourceNode = &sourceFile;
 	} else {
 		error = _sourceNode.SetTo(sourcePath);
 		sourceNode = &_sourceNode;
@@ -203,7 +413,6 @@ BCopyEngine::_CopyEntry(const char* sourcePath, const char* destPath)
 	// create the destination
 	BNode _destNode;
 	BDirectory destDir;
-	BFile destFile;
 	BSymLink destSymLink;
 	BNode* destNode = NULL;
 
@@ -218,26 +427,6 @@ BCopyEngine::_CopyEntry(const char* sourcePath, const char* destPath)
 			}
 
 			destNode = &destDir;
-		} else if (S_ISREG(sourceStat.st_mode)) {
-			// create file
-			error = BDirectory().CreateFile(destPath, &destFile);
-			if (error != B_OK) {
-				return _HandleEntryError(sourcePath, error,
-					"Failed to create file \"%s\": %s\n", destPath,
-					strerror(error));
-			}
-
-			destNode = &destFile;
-
-			// copy file contents
-			error = _CopyFileData(sourcePath, sourceFile, destPath, destFile);
-			if (error != B_OK) {
-				if (fController != NULL
-					&& fController->EntryFinished(sourcePath, error)) {
-					return B_OK;
-				}
-				return error;
-			}
 		} else if (S_ISLNK(sourceStat.st_mode)) {
 			// read symlink
 			char* linkTo = fBuffer;
@@ -266,24 +455,13 @@ BCopyEngine::_CopyEntry(const char* sourcePath, const char* destPath)
 				"Source file \"%s\" has unsupported type.\n", sourcePath);
 		}
 
-		// copy attributes (before setting the permissions!)
-		error = _CopyAttributes(sourcePath, *sourceNode, destPath, *destNode);
+		error = _CopyMetaData(sourcePath, *sourceNode, sourceStat, destPath,
+			*destNode, fBuffer, fBufferSize);
 		if (error != B_OK) {
-			if (fController != NULL
-				&& fController->EntryFinished(sourcePath, error)) {
+			if (_EntryFinished(sourcePath, error))
 				return B_OK;
-			}
 			return error;
 		}
-
-		// set file owner, group, permissions, times
-		destNode->SetOwner(sourceStat.st_uid);
-		destNode->SetGroup(sourceStat.st_gid);
-		destNode->SetPermissions(sourceStat.st_mode);
-		#ifdef HAIKU_TARGET_PLATFORM_HAIKU
-			destNode->SetCreationTime(sourceStat.st_crtime);
-		#endif
-		destNode->SetModificationTime(sourceStat.st_mtime);
 	}
 
 	// the destination node is no longer needed
@@ -291,9 +469,24 @@ BCopyEngine::_CopyEntry(const char* sourcePath, const char* destPath)
 
 	// recurse
 	if ((fFlags & COPY_RECURSIVELY) != 0 && S_ISDIR(sourceStat.st_mode)) {
+		Directory* directory = new(std::nothrow) Directory(parent, sourcePath);
+		if (directory == NULL) {
+			return _HandleEntryError(sourcePath, B_NO_MEMORY,
+				"Failed to copy directory \"%s\": %s\n", sourcePath,
+				strerror(B_NO_MEMORY));
+		}
+		if (parent != NULL)
+			_AcquireDirectory(parent);
+		else {
+			// Only a directory tree is worth the workers; if they cannot be
+			// started, the files are copied by this thread
+			_StartWorkers();
+		}
+
 		char buffer[offsetof(struct dirent, d_name) + B_FILE_NAME_LENGTH];
 		dirent *entry = (dirent*)buffer;
-		while (sourceDir.GetNextDirents(entry, sizeof(buffer), 1) == 1) {
+		while (!_IsCanceled(directory)
+			&& sourceDir.GetNextDirents(entry, sizeof(buffer), 1) == 1) {
 			if (strcmp(entry->d_name, ".") == 0
 				|| strcmp(entry->d_name, "..") == 0) {
 				continue;
@@ -303,45 +496,158 @@ BCopyEngine::_CopyEntry(const char* sourcePath, const char* destPath)
 			BPath sourceEntryPath;
 			error = sourceEntryPath.SetTo(sourcePath, entry->d_name);
 			if (error != B_OK) {
-				return _HandleEntryError(sourcePath, error,
-					"Failed to construct entry path from dir \"%s\" and name "
-					"\"%s\": %s\n", sourcePath, entry->d_name, strerror(error));
+				_NotifyError(error, "Failed to construct entry path from dir "
+					"\"%s\" and name \"%s\": %s\n", sourcePath, entry->d_name,
+					strerror(error));
+				_SetDirectoryError(directory, error);
+				break;
 			}
 
 			BPath destEntryPath;
 			error = destEntryPath.SetTo(destPath, entry->d_name);
 			if (error != B_OK) {
-				return _HandleEntryError(sourcePath, error,
-					"Failed to construct entry path from dir \"%s\" and name "
-					"\"%s\": %s\n", destPath, entry->d_name, strerror(error));
+				_NotifyError(error, "Failed to construct entry path from dir "
+					"\"%s\" and name \"%s\": %s\n", destPath, entry->d_name,
+					strerror(error));
+				_SetDirectoryError(directory, error);
+				break;
 			}
 
 			// copy the entry
-			error = _CopyEntry(sourceEntryPath.Path(), destEntryPath.Path());
+			error = _CopyEntry(sourceEntryPath.Path(), destEntryPath.Path(),
+				directory);
 			if (error != B_OK) {
-				if (fController != NULL
-					&& fController->EntryFinished(sourcePath, error)) {
-					return B_OK;
-				}
-				return error;
+				_SetDirectoryError(directory, error);
+				break;
 			}
 		}
+
+		// The directory is finished when its last queued file is.
+		_ReleaseDirectory(directory);
+		return B_OK;
+	}
+
+	_EntryFinished(sourcePath, B_OK);
+	return B_OK;
+}
+
+
+status_t
+BCopyEngine::_QueueFile(const char* sourcePath, const struct stat& sourceStat,
+	const char* destPath, Directory* parent)
+{
+	FileJob* job = new(std::nothrow) FileJob;
+	if (job != NULL) {
+		job->sourcePath = sourcePath;
+		job->destPath = destPath;
+		job->sourceStat = sourceStat;
+		job->directory = parent;
+	}
+
+	if (job == NULL || job->sourcePath.Length() == 0
+		|| job->destPath.Length() == 0) {
+		delete job;
+		return _HandleEntryError(sourcePath, B_NO_MEMORY,
+			"Failed to copy file \"%s\": %s\n", sourcePath,
+			strerror(B_NO_MEMORY));
+	}
+
+	_AcquireDirectory(parent);
+
+	if (!fJobQueue->Push(job)) {
+		delete job;
+		_ReleaseDirectory(parent);
+		return _HandleEntryError(sourcePath, B_NO_MEMORY,
+			"Failed to copy file \"%s\": %s\n", sourcePath,
+			strerror(B_NO_MEMORY));
 	}
 
-	if (fController != NULL)
-		fController->EntryFinished(sourcePath, B_OK);
 	return B_OK;
 }
 
 
+status_t
+BCopyEngine::_CopyFile(const char* sourcePath, const struct stat& sourceStat,
+	const char* destPath, char* buffer, size_t bufferSize)
+{
+	BFile sourceFile;
+	status_t error = sourceFile.SetTo(sourcePath, B_READ_ONLY);
+	if (error != B_OK) {
+		return _HandleEntryError(sourcePath, error,
+			"Failed to open \"%s\": %s\n", sourcePath, strerror(error));
+	}
+
+	BFile destFile;
+	error = BDirectory().CreateFile(destPath, &destFile);
+	if (error != B_OK) {
+		return _HandleEntryError(sourcePath, error,
+			"Failed to create file \"%s\": %s\n", destPath, strerror(error));
+	}
+
+	// copy file contents
+	error = _CopyFileData(sourcePath, sourceFile, destPath, destFile, buffer,
+		bufferSize);
+	if (error == B_OK) {
+		error = _CopyMetaData(sourcePath, sourceFile, sourceStat, destPath,
+			destFile, buffer, bufferSize);
+	}
+
+	if (error != B_OK) {
+		if (_EntryFinished(sourcePath, error))
+			return B_OK;
+		return error;
+	}
+
+	_EntryFinished(sourcePath, B_OK);
+	return B_OK;
+}
+
+
+/*!	Only the data ranges of the source are copied; holes are skipped, so
+	that they remain holes in the destination, if its file system supports
+	them.
+*/
 status_t
 BCopyEngine::_CopyFileData(const char* sourcePath, BFile& source,
-	const char* destPath, BFile& destination)
+	const char* destPath, BFile& destination, char* buffer, size_t bufferSize)
 {
 	off_t offset = 0;
+	off_t dataEnd = -1;
 	while (true) {
+		if (offset >= dataEnd) {
+			// Find the next data range. This relies on Seek() returning
+			// errors as negative values, as it does on Haiku, so that any
+			// failure other than ENXIO ends up in the "not supported" case.
+			off_t dataStart = source.Seek(offset, SEEK_DATA);
+			if (dataStart == ENXIO) {
+				// only a hole is left -- extend the destination over it
+				off_t size;
+				status_t error = source.GetSize(&size);
+				if (error == B_OK && size > offset)
+					error = destination.SetSize(size);
+				if (error != B_OK) {
+					_NotifyError(error, "Failed to set size of file \"%s\": "
+						"%s\n", destPath, strerror(error));
+				}
+				return error;
+			}
+
+			if (dataStart >= offset) {
+				offset = dataStart;
+				dataEnd = source.Seek(offset, SEEK_HOLE);
+			}
+			if (dataStart < offset || dataEnd <= offset) {
+				// not supported -- copy everything up to the end of the file
+				dataEnd = LLONG_MAX;
+			}
+		}
+
 		// read
-		ssize_t bytesRead = source.ReadAt(offset, fBuffer, fBufferSize);
+		size_t toRead = bufferSize;
+		if ((off_t)toRead > dataEnd - offset)
+			toRead = dataEnd - offset;
+
+		ssize_t bytesRead = source.ReadAt(offset, buffer, toRead);
 		if (bytesRead < 0) {
 			_NotifyError(bytesRead, "Failed to read from file \"%s\": %s\n",
 				sourcePath, strerror(bytesRead));
@@ -352,7 +658,7 @@ BCopyEngine::_CopyFileData(const char* sourcePath, BFile& source,
 			return B_OK;
 
 		// write
-		ssize_t bytesWritten = destination.WriteAt(offset, fBuffer, bytesRead);
+		ssize_t bytesWritten = destination.WriteAt(offset, buffer, bytesRead);
 		if (bytesWritten < 0) {
 			_NotifyError(bytesWritten, "Failed to write to file \"%s\": %s\n",
 				destPath, strerror(bytesWritten));
@@ -366,14 +672,47 @@ BCopyEngine::_CopyFileData(const char* sourcePath, BFile& source,
 		}
 
 		offset += bytesRead;
+		_BytesCopied(bytesWritten);
 	}
 }
 
 
+status_t
+BCopyEngine::_CopyMetaData(const char* sourcePath, BNode& source,
+	const struct stat& sourceStat, const char* destPath, BNode& destination,
+	char* buffer, size_t bufferSize)
+{
+	// copy attributes (before setting the permissions!)
+	status_t error = _CopyAttributes(sourcePath, source, destPath, destination,
+		buffer, bufferSize);
+	if (error != B_OK)
+		return error;
+
+	// set file owner, group, permissions, times
+	destination.SetOwner(sourceStat.st_uid);
+	destination.SetGroup(sourceStat.st_gid);
+	destination.SetPermissions(sourceStat.st_mode);
+	#ifdef HAIKU_TARGET_PLATFORM_HAIKU
+		destination.SetCreationTime(sourceStat.st_crtime);
+	#endif
+	destination.SetModificationTime(sourceStat.st_mtime);
+
+	return B_OK;
+}
+
+
+/*!	Attributes that fit are read into \a buffer one after the other, and
+	written in a batch when it is full or all attributes have been read, so
+	that the reads and writes don't alternate between the two nodes.
+*/
 status_t
 BCopyEngine::_CopyAttributes(const char* sourcePath, BNode& source,
-	const char* destPath, BNode& destination)
+	const char* destPath, BNode& destination, char* buffer, size_t bufferSize)
 {
+	PendingAttribute pending[kMaxBatchedAttributes];
+	int32 pendingCount = 0;
+	size_t bufferUsed = 0;
+
 	char attrName[B_ATTR_NAME_LENGTH];
 	while (source.GetNextAttrName(attrName) == B_OK) {
 		// get attr info
@@ -386,9 +725,7 @@ BCopyEngine::_CopyAttributes(const char* sourcePath, BNode& source,
 		}
 
 		// filter
-		if (fController != NULL
-			&& !fController->AttributeStarted(sourcePath, attrName,
-				attrInfo.type)) {
+		if (!_AttributeStarted(sourcePath, attrName, attrInfo.type)) {
 			if (error != B_OK) {
 				_NotifyError(error, "Failed to get info of attribute \"%s\" "
 					"of file \"%s\": %s\n", attrName, sourcePath,
@@ -397,6 +734,19 @@ BCopyEngine::_CopyAttributes(const char* sourcePath, BNode& source,
 			continue;
 		}
 
+		// write the batch, if this attribute doesn't fit into it anymore, or
+		// has to be handled by itself
+		if (pendingCount > 0
+			&& (error != B_OK || pendingCount == kMaxBatchedAttributes
+				|| attrInfo.size > (off_t)(bufferSize - bufferUsed))) {
+			status_t writeError = _WriteAttributes(sourcePath, destPath,
+				destination, buffer, pending, pendingCount);
+			if (writeError != B_OK)
+				return writeError;
+			pendingCount = 0;
+			bufferUsed = 0;
+		}
+
 		if (error != B_OK) {
 			error = _HandleAttributeError(sourcePath, attrName, attrInfo.type,
 				error, "Failed to get info of attribute \"%s\" of file \"%s\": "
@@ -406,59 +756,373 @@ BCopyEngine::_CopyAttributes(const char* sourcePath, BNode& source,
 			continue;
 		}
 
-		// copy the attribute
-		off_t offset = 0;
-		off_t bytesLeft = attrInfo.size;
-		// go at least once through the loop, so that an empty attribute will be
-		// created as well
-		do {
-			size_t toRead = fBufferSize;
-			if ((off_t)toRead > bytesLeft)
-				toRead = bytesLeft;
-
-			// read
-			ssize_t bytesRead = source.ReadAttr(attrName, attrInfo.type,
-				offset, fBuffer, toRead);
-			if (bytesRead < 0) {
-				error = _HandleAttributeError(sourcePath, attrName,
-					attrInfo.type, bytesRead, "Failed to read attribute \"%s\" "
-					"of file \"%s\": %s\n", attrName, sourcePath,
-					strerror(bytesRead));
-				if (error != B_OK)
-					return error;
-				break;
-			}
+		if (attrInfo.size > (off_t)bufferSize) {
+			error = _CopyAttribute(sourcePath, source, destPath, destination,
+				attrName, attrInfo, buffer, bufferSize);
+			if (error != B_OK)
+				return error;
+			continue;
+		}
 
-			if (bytesRead == 0 && offset > 0)
-				break;
+		// read the attribute into the batch
+		ssize_t bytesRead = 0;
+		if (attrInfo.size > 0) {
+			bytesRead = source.ReadAttr(attrName, attrInfo.type, 0,
+				buffer + bufferUsed, attrInfo.size);
+		}
+		if (bytesRead < 0) {
+			status_t writeError = _WriteAttributes(sourcePath, destPath,
+				destination, buffer, pending, pendingCount);
+			if (writeError != B_OK)
+				return writeError;
+			pendingCount = 0;
+			bufferUsed = 0;
+
+			error = _HandleAttributeError(sourcePath, attrName,
+				attrInfo.type, bytesRead, "Failed to read attribute \"%s\" "
+				"of file \"%s\": %s\n", attrName, sourcePath,
+				strerror(bytesRead));
+			if (error != B_OK)
+				return error;
+			continue;
+		}
+
+		PendingAttribute& attribute = pending[pendingCount++];
+		strlcpy(attribute.name, attrName, sizeof(attribute.name));
+		attribute.type = attrInfo.type;
+		attribute.offset = bufferUsed;
+		attribute.size = bytesRead;
+		bufferUsed += bytesRead;
+	}
+
+	return _WriteAttributes(sourcePath, destPath, destination, buffer, pending,
+		pendingCount);
+}
+
+
+status_t
+BCopyEngine::_CopyAttribute(const char* sourcePath, BNode& source,
+	const char* destPath, BNode& destination, const char* attrName,
+	const attr_info& attrInfo, char* buffer, size_t bufferSize)
+{
+	off_t offset = 0;
+	off_t bytesLeft = attrInfo.size;
+	// go at least once through the loop, so that an empty attribute will be
+	// created as well
+	do {
+		size_t toRead = bufferSize;
+		if ((off_t)toRead > bytesLeft)
+			toRead = bytesLeft;
+
+		// read
+		ssize_t bytesRead = source.ReadAttr(attrName, attrInfo.type,
+			offset, buffer, toRead);
+		if (bytesRead < 0) {
+			return _HandleAttributeError(sourcePath, attrName,
+				attrInfo.type, bytesRead, "Failed to read attribute \"%s\" "
+				"of file \"%s\": %s\n", attrName, sourcePath,
+				strerror(bytesRead));
+		}
+
+		if (bytesRead == 0 && offset > 0)
+			break;
+
+		// write
+		ssize_t bytesWritten = destination.WriteAttr(attrName,
+			attrInfo.type, offset, buffer, bytesRead);
+		if (bytesWritten < 0) {
+			return _HandleAttributeError(sourcePath, attrName,
+				attrInfo.type, bytesWritten, "Failed to write attribute "
+				"\"%s\" of file \"%s\": %s\n", attrName, destPath,
+				strerror(bytesWritten));
+		}
+
+		bytesLeft -= bytesRead;
+		offset += bytesRead;
+	} while (bytesLeft > 0);
+
+	_AttributeFinished(sourcePath, attrName, attrInfo.type, B_OK);
+	return B_OK;
+}
+
+
+status_t
+BCopyEngine::_WriteAttributes(const char* sourcePath, const char* destPath,
+	BNode& destination, const char* buffer, const PendingAttribute* attributes,
+	int32 count)
+{
+	for (int32 i = 0; i < count; i++) {
+		const PendingAttribute& attribute = attributes[i];
+		ssize_t bytesWritten = destination.WriteAttr(attribute.name,
+			attribute.type, 0, buffer + attribute.offset, attribute.size);
+		if (bytesWritten < 0) {
+			status_t error = _HandleAttributeError(sourcePath, attribute.name,
+				attribute.type, bytesWritten, "Failed to write attribute "
+				"\"%s\" of file \"%s\": %s\n", attribute.name, destPath,
+				strerror(bytesWritten));
+			if (error != B_OK)
+				return error;
+			continue;
+		}
+
+		_AttributeFinished(sourcePath, attribute.name, attribute.type, B_OK);
+	}
+
+	return B_OK;
+}
+
+
+// #pragma mark - workers
 
-			// write
-			ssize_t bytesWritten = destination.WriteAttr(attrName,
-				attrInfo.type, offset, fBuffer, bytesRead);
-			if (bytesWritten < 0) {
-				error = _HandleAttributeError(sourcePath, attrName,
-					attrInfo.type, bytesWritten, "Failed to write attribute "
-					"\"%s\" of file \"%s\": %s\n", attrName, destPath,
-					strerror(bytesWritten));
-				if (error != B_OK)
-					return error;
+
+status_t
+BCopyEngine::_StartWorkers()
+{
+	if (fThreadCount == 0)
+		return B_OK;
+
+	if (fWorkers == NULL) {
+		fWorkers = new(std::nothrow) Worker[fThreadCount];
+		if (fWorkers == NULL)
+			return B_NO_MEMORY;
+
+		for (int32 i = 0; i < fThreadCount; i++) {
+			Worker& worker = fWorkers[i];
+			worker.engine = this;
+			worker.thread = -1;
+			worker.buffer = allocate_buffer(worker.bufferSize);
+			if (worker.buffer == NULL)
 				break;
-			}
+			fWorkerCount++;
+		}
+	}
+
+	if (fWorkerCount == 0)
+		return B_NO_MEMORY;
+
+	fJobQueue = new(std::nothrow) JobQueue(kJobQueueCapacity);
+	if (fJobQueue == NULL)
+		return B_NO_MEMORY;
+
+	int32 started = 0;
+	for (int32 i = 0; i < fWorkerCount; i++) {
+		Worker& worker = fWorkers[i];
+		worker.thread = spawn_thread(&_WorkerThread, "copy engine worker",
+			B_NORMAL_PRIORITY, &worker);
+		if (worker.thread >= 0) {
+			resume_thread(worker.thread);
+			started++;
+		}
+	}
+
+	if (started == 0) {
+		delete fJobQueue;
+		fJobQueue = NULL;
+		return B_NO_MORE_THREADS;
+	}
+
+	return B_OK;
+}
+
+
+void
+BCopyEngine::_StopWorkers()
+{
+	if (fJobQueue == NULL)
+		return;
 
-			bytesLeft -= bytesRead;
-			offset += bytesRead;
-		} while (bytesLeft > 0);
+	fJobQueue->Close();
 
-		if (fController != NULL) {
-			fController->AttributeFinished(sourcePath, attrName, attrInfo.type,
-				B_OK);
+	for (int32 i = 0; i < fWorkerCount; i++) {
+		if (fWorkers[i].thread >= 0) {
+			wait_for_thread(fWorkers[i].thread, NULL);
+			fWorkers[i].thread = -1;
 		}
 	}
 
+	delete fJobQueue;
+	fJobQueue = NULL;
+}
+
+
+void
+BCopyEngine::_DeleteWorkers()
+{
+	_StopWorkers();
+
+	for (int32 i = 0; i < fWorkerCount; i++)
+		free(fWorkers[i].buffer);
+
+	delete[] fWorkers;
+	fWorkers = NULL;
+	fWorkerCount = 0;
+}
+
+
+/*static*/ status_t
+BCopyEngine::_WorkerThread(void* data)
+{
+	Worker* worker = (Worker*)data;
+	BCopyEngine* engine = worker->engine;
+
+	while (FileJob* job = engine->fJobQueue->Pop()) {
+		// Don't start copying files of a directory whose copy has failed
+		// already, just like the entries following the failed one wouldn't
+		// have been copied sequentially.
+		if (!engine->_IsCanceled(job->directory)) {
+			status_t error = engine->_CopyFile(job->sourcePath,
+				job->sourceStat, job->destPath, worker->buffer,
+				worker->bufferSize);
+			if (error != B_OK)
+				engine->_SetDirectoryError(job->directory, error);
+		}
+
+		engine->_ReleaseDirectory(job->directory);
+		delete job;
+	}
+
 	return B_OK;
 }
 
 
+// #pragma mark - directories
+
+
+void
+BCopyEngine::_AcquireDirectory(Directory* directory)
+{
+	Locker locker(fLock);
+	directory->referenceCount++;
+}
+
+
+void
+BCopyEngine::_ReleaseDirectory(Directory* directory)
+{
+	Locker locker(fLock);
+
+	while (directory != NULL && --directory->referenceCount == 0) {
+		status_t error = directory->error;
+		if (fController != NULL
+			&& fController->EntryFinished(directory->path, error)) {
+			error = B_OK;
+		}
+
+		Directory* parent = directory->parent;
+		if (error != B_OK) {
+			if (parent != NULL)
+				_SetDirectoryError(parent, error);
+			else if (fError == B_OK)
+				fError = error;
+		}
+
+		delete directory;
+		directory = parent;
+	}
+}
+
+
+void
+BCopyEngine::_SetDirectoryError(Directory* directory, status_t error)
+{
+	Locker locker(fLock);
+	if (directory->error == B_OK)
+		directory->error = error;
+}
+
+
+bool
+BCopyEngine::_IsCanceled(Directory* directory)
+{
+	Locker locker(fLock);
+	for (; directory != NULL; directory = directory->parent) {
+		if (directory->error != B_OK)
+			return true;
+	}
+
+	return fError != B_OK;
+}
+
+
+// #pragma mark - controller
+
+
+bool
+BCopyEngine::_EntryStarted(const char* path)
+{
+	if (fController == NULL)
+		return true;
+
+	Locker locker(fLock);
+	return fController->EntryStarted(path);
+}
+
+
+bool
+BCopyEngine::_EntryFinished(const char* path, status_t error)
+{
+	if (fController == NULL)
+		return false;
+
+	Locker locker(fLock);
+	return fController->EntryFinished(path, error);
+}
+
+
+bool
+BCopyEngine::_AttributeStarted(const char* path, const char* attribute,
+	uint32 attributeType)
+{
+	if (fController == NULL)
+		return true;
+
+	Locker locker(fLock);
+	return fController->AttributeStarted(path, attribute, attributeType);
+}
+
+
+bool
+BCopyEngine::_AttributeFinished(const char* path, const char* attribute,
+	uint32 attributeType, status_t error)
+{
+	if (fController == NULL)
+		return false;
+
+	Locker locker(fLock);
+	return fController->AttributeFinished(path, attribute, attributeType,
+		error);
+}
+
+
+void
+BCopyEngine::_BytesCopied(size_t bytes)
+{
+	if (fController == NULL)
+		return;
+
+	Locker locker(fLock);
+	fBytesCopied += bytes;
+
+	bigtime_t now = system_time();
+	if (now - fLastProgressTime >= kProgressInterval)
+		_ReportProgress(now);
+}
+
+
+void
+BCopyEngine::_ReportProgress(bigtime_t now)
+{
+	Locker locker(fLock);
+
+	bigtime_t elapsed = now - fStartTime;
+	off_t bytesPerSecond = elapsed > 0
+		? fBytesCopied * 1000000 / elapsed : 0;
+
+	fLastProgressTime = now;
+	fController->ProgressChanged(fBytesCopied, bytesPerSecond);
+}
+
+
 void
 BCopyEngine::_NotifyError(status_t error, const char* format, ...)
 {
@@ -478,6 +1142,8 @@ BCopyEngine::_NotifyErrorVarArgs(status_t error, const char* format,
 	if (fController != NULL) {
 		BString message;
 		message.SetToFormatVarArgs(format, args);
+
+		Locker locker(fLock);
 		fController->ErrorOccurred(message, error);
 	}
 }
@@ -490,6 +1156,8 @@ BCopyEngine::_HandleEntryError(const char* path, status_t error,
 	if (fController == NULL)
 		return error;
 
+	Locker locker(fLock);
+
 	va_list args;
 	va_start(args, format);
 	_NotifyErrorVarArgs(error, format, args);
@@ -508,6 +1176,8 @@ BCopyEngine::_HandleAttributeError(const char* path, const char* attribute,
 	if (fController == NULL)
 		return error;
 
+	Locker locker(fLock);
+
 	va_list args;
 	va_start(args, format);
 	_NotifyErrorVarArgs(error, format, args);
@@ -568,4 +1238,11 @@ BCopyEngine::BController::ErrorOccurred(const char* message, status_t error)
 }
 
 
+void
+BCopyEngine::BController::ProgressChanged(off_t bytesCopied,
+	off_t bytesPerSecond)
+{
+}
+
+
 } // namespace BPrivate
@@ -9,6 +9,7 @@
  */
 
 
+#include <Message.h>
 #include <Messenger.h>
 #include <NodeMonitor.h>
 
@@ -77,7 +78,7 @@ watch_node(const node_ref* node, uint32 flags, BMessenger target)
 	}
 
 	// node watching
-	if (flags != 0) {
+	if ((flags & ~B_WATCH_BATCHED) != 0) {
 		if (node == NULL)
 			return B_BAD_VALUE;
 
@@ -121,3 +122,63 @@ stop_watching(const BHandler* handler, const BLooper* looper)
 	return stop_watching(BMessenger(handler, looper));
 }
 
+
+// Returns the number of events in a node monitor message, taking
+// B_BATCHED_EVENTS messages into account.
+int32
+count_node_monitor_events(const BMessage* message)
+{
+	if (message == NULL || message->what != B_NODE_MONITOR)
+		return 0;
+
+	int32 opcode;
+	if (message->FindInt32("opcode", &opcode) != B_OK)
+		return 0;
+	if (opcode != B_BATCHED_EVENTS)
+		return 1;
+
+	type_code type;
+	int32 count;
+	if (message->GetInfo("event", &type, &count) != B_OK)
+		return 0;
+
+	return count;
+}
+
+
+// Retrieves an event of a node monitor message. For a message that is not
+// a B_BATCHED_EVENTS message, the only event is the message itself.
+status_t
+get_node_monitor_event(const BMessage* message, int32 index, BMessage* event)
+{
+	if (message == NULL || event == NULL || index < 0)
+		return B_BAD_VALUE;
+
+	int32 opcode;
+	if (message->what != B_NODE_MONITOR
+		|| message->FindInt32("opcode", &opcode) != B_OK) {
+		return B_BAD_VALUE;
+	}
+
+	if (opcode != B_BATCHED_EVENTS) {
+		if (index > 0)
+			return B_BAD_INDEX;
+
+		*event = *message;
+		return B_OK;
+	}
+
+	return message->FindMessage("event", index, event);
+}
+
+
+// Returns whether node monitor events have been lost, and the target needs
+// to rescan the nodes it watches.
+bool
+node_monitor_rescan_needed(const BMessage* message)
+{
+	if (message == NULL || message->what != B_NODE_MONITOR)
+		return false;
+
+	return message->GetBool("overflow", false);
+}
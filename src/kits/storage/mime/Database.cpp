@@ -874,6 +874,54 @@ Database::GuessMimeType(const char *filename, BString *result)
 	return status;
 }
 
+// GuessMimeType
+/*!	\brief Guesses a MIME type for a regular file, the beginning of which has
+	already been read.
+
+	Does the same as GuessMimeType(const entry_ref*, BString*) does for a
+	regular file, but sniffs the given data instead of reading it. This allows
+	callers to read the data without holding the database lock.
+
+	\param ref Pointer to the entry_ref referring to the file.
+	\param file The opened file. May be \c NULL.
+	\param buffer The data at the beginning of the file. It should be
+		   SniffBufferSize() bytes long, unless the file is shorter.
+	\param length Size of the buffer in bytes.
+	\param result Pointer to a pre-allocated BString which is set to the
+		   resulting MIME type.
+	\return
+	- \c B_OK: success (even if the guess returned is "application/octet-stream")
+	- other error code: failure
+*/
+status_t
+Database::GuessMimeType(const entry_ref *ref, BFile *file, const void *buffer,
+	int32 length, BString *result)
+{
+	if (ref == NULL || buffer == NULL || result == NULL)
+		return B_BAD_VALUE;
+
+	status_t status = fSnifferRules.GuessMimeType(file, buffer, length,
+		result);
+	if (status == kMimeGuessFailureError)
+		status = fAssociatedTypes.GuessMimeType(ref, result);
+	if (status == kMimeGuessFailureError) {
+		result->SetTo(kGenericFileType);
+		status = B_OK;
+	}
+
+	return status;
+}
+
+// SniffBufferSize
+/*!	\brief Returns how many bytes of a file are needed to sniff its type, or
+	an error code.
+*/
+ssize_t
+Database::SniffBufferSize()
+{
+	return fSnifferRules.MaxBytesNeeded();
+}
+
 
 /*!	\brief Subscribes the given BMessenger to the MIME monitor service
 
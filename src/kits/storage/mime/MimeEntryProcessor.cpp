@@ -11,6 +11,7 @@
 
 #include <Directory.h>
 #include <Entry.h>
+#include <Mime.h>
 
 
 namespace BPrivate {
@@ -34,7 +35,8 @@ MimeEntryProcessor::MimeEntryProcessor(Database* database,
 	:
 	fDatabase(database),
 	fDatabaseLocker(databaseLocker),
-	fForce(force)
+	fForce(force & ~B_UPDATE_MIME_INFO_PARALLEL)
+		// only the force level matters for the processing of single entries
 {
 }
 
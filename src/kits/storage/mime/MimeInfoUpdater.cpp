@@ -97,16 +97,8 @@ MimeInfoUpdater::Do(const entry_ref& entry, bool* _entryIsDir)
 	status_t err = node.SetTo(&entry);
 	if (!err && _entryIsDir)
 		*_entryIsDir = node.IsDirectory();
-	if (!err) {
-		// If not forced, only update if the entry has no file type attribute
-		attr_info info;
-		if (fForce == B_UPDATE_MIME_INFO_FORCE_UPDATE_ALL
-			|| node.GetAttrInfo(kFileTypeAttr, &info) == B_ENTRY_NOT_FOUND) {
-			updateType = true;
-		}
-		updateAppInfo = (updateType
-			|| fForce == B_UPDATE_MIME_INFO_FORCE_KEEP_TYPE);
-	}
+	if (!err)
+		GetUpdatesNeeded(node, &updateType, &updateAppInfo);
 
 	// guess the MIME type
 	BString type;
@@ -115,6 +107,39 @@ MimeInfoUpdater::Do(const entry_ref& entry, bool* _entryIsDir)
 		err = fDatabase->GuessMimeType(&entry, &type);
 	}
 
+	if (!err)
+		err = UpdateAttributes(entry, node, type, updateType, updateAppInfo);
+	return err;
+}
+
+
+/*!	Determines whether the type and the app file info attributes of the given
+	node need to be updated, according to the force mode.
+*/
+void
+MimeInfoUpdater::GetUpdatesNeeded(BNode& node, bool* _updateType,
+	bool* _updateAppInfo) const
+{
+	// If not forced, only update if the entry has no file type attribute
+	attr_info info;
+	bool updateType = fForce == B_UPDATE_MIME_INFO_FORCE_UPDATE_ALL
+		|| node.GetAttrInfo(kFileTypeAttr, &info) == B_ENTRY_NOT_FOUND;
+
+	*_updateType = updateType;
+	*_updateAppInfo = updateType
+		|| fForce == B_UPDATE_MIME_INFO_FORCE_KEEP_TYPE;
+}
+
+
+/*!	Writes the guessed \a type of the entry, and copies the app file info
+	from its resources to its attributes, if it is a shared object.
+*/
+status_t
+MimeInfoUpdater::UpdateAttributes(const entry_ref& entry, BNode& node,
+	const BString& type, bool updateType, bool updateAppInfo)
+{
+	status_t err = B_OK;
+
 	// update the MIME type
 	if (!err && updateType) {
 		ssize_t len = type.Length() + 1;
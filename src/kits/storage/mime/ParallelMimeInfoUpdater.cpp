@@ -0,0 +1,575 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Updates the MIME information of a whole directory tree in a pipeline of
+	three stages: the calling thread walks the tree, a number of sniffer
+	threads check each entry and guess its type, and a writer thread writes
+	the attributes of the sniffed entries in batches.
+
+	Only the rule matching itself has to be done with the database locked;
+	opening the nodes, checking their attributes and reading the data to
+	sniff happens in parallel.
+*/
+
+
+#include <mime/ParallelMimeInfoUpdater.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <deque>
+#include <new>
+
+#include <Directory.h>
+#include <Entry.h>
+#include <File.h>
+#include <fs_attr.h>
+#include <Locker.h>
+#include <Node.h>
+#include <OS.h>
+#include <String.h>
+#include <Volume.h>
+
+#include <AutoDeleter.h>
+#include <AutoLocker.h>
+#include <mime/Database.h>
+#include <mime/database_support.h>
+#include <storage_support.h>
+
+
+static const size_t kSniffQueueCapacity = 1024;
+static const size_t kWriteQueueCapacity = 1024;
+static const int32 kWriteBatchSize = 64;
+static const int32 kMaxThreadCount = 8;
+
+
+namespace BPrivate {
+namespace Storage {
+namespace Mime {
+
+
+struct ParallelMimeInfoUpdater::SniffItem {
+	entry_ref	ref;
+};
+
+
+struct ParallelMimeInfoUpdater::WriteItem {
+	entry_ref	ref;
+	BString		type;
+	bool		updateType;
+	bool		updateAppInfo;
+
+	bool operator<(const WriteItem& other) const
+	{
+		if (ref.device != other.ref.device)
+			return ref.device < other.ref.device;
+		return ref.directory < other.ref.directory;
+	}
+};
+
+
+//!	Serializes the database accesses if the caller does not.
+class ParallelMimeInfoUpdater::DefaultDatabaseLocker
+	: public MimeEntryProcessor::DatabaseLocker {
+public:
+	DefaultDatabaseLocker()
+		:
+		fLock("mime database")
+	{
+	}
+
+	virtual bool Lock()
+	{
+		return fLock.Lock();
+	}
+
+	virtual void Unlock()
+	{
+		fLock.Unlock();
+	}
+
+private:
+	BLocker	fLock;
+};
+
+
+/*!	A bounded queue between two stages. Pushing blocks while it is full,
+	popping blocks while it is empty, until it is closed.
+*/
+template<typename Item>
+class ParallelMimeInfoUpdater::Queue {
+public:
+	Queue(size_t capacity)
+		:
+		fCapacity(capacity),
+		fClosed(false)
+	{
+		pthread_mutex_init(&fLock, NULL);
+		pthread_cond_init(&fNotEmpty, NULL);
+		pthread_cond_init(&fNotFull, NULL);
+	}
+
+	~Queue()
+	{
+		pthread_cond_destroy(&fNotFull);
+		pthread_cond_destroy(&fNotEmpty);
+		pthread_mutex_destroy(&fLock);
+	}
+
+	bool Push(const Item& item)
+	{
+		pthread_mutex_lock(&fLock);
+		while (fItems.size() >= fCapacity && !fClosed)
+			pthread_cond_wait(&fNotFull, &fLock);
+
+		bool pushed = false;
+		if (!fClosed) {
+			try {
+				fItems.push_back(item);
+				pushed = true;
+			} catch (std::bad_alloc&) {
+			}
+		}
+		pthread_mutex_unlock(&fLock);
+
+		if (pushed)
+			pthread_cond_signal(&fNotEmpty);
+		return pushed;
+	}
+
+	//!	Returns the number of items popped, 0 if the queue has been closed.
+	int32 Pop(Item* items, int32 maxCount)
+	{
+		pthread_mutex_lock(&fLock);
+		while (fItems.empty() && !fClosed)
+			pthread_cond_wait(&fNotEmpty, &fLock);
+
+		int32 count = 0;
+		while (count < maxCount && !fItems.empty()) {
+			items[count++] = fItems.front();
+			fItems.pop_front();
+		}
+		pthread_mutex_unlock(&fLock);
+
+		if (count > 0)
+			pthread_cond_broadcast(&fNotFull);
+		return count;
+	}
+
+	//!	Lets Pop() fail once the queue is empty, and Push() right away.
+	void Close()
+	{
+		pthread_mutex_lock(&fLock);
+		fClosed = true;
+		pthread_mutex_unlock(&fLock);
+
+		pthread_cond_broadcast(&fNotEmpty);
+		pthread_cond_broadcast(&fNotFull);
+	}
+
+private:
+	pthread_mutex_t		fLock;
+	pthread_cond_t		fNotEmpty;
+	pthread_cond_t		fNotFull;
+	std::deque<Item>	fItems;
+	size_t				fCapacity;
+	bool				fClosed;
+};
+
+
+// #pragma mark - ProgressListener
+
+
+ParallelMimeInfoUpdater::ProgressListener::~ProgressListener()
+{
+}
+
+
+// #pragma mark - ParallelMimeInfoUpdater
+
+
+/*!	\a force is one of the \c B_UPDATE_MIME_INFO_* force levels, see
+	update_mime_info(). If \a threadCount is 0, one sniffer thread per CPU is
+	used.
+*/
+ParallelMimeInfoUpdater::ParallelMimeInfoUpdater(Database* database,
+	MimeEntryProcessor::DatabaseLocker* databaseLocker, int32 force,
+	int32 threadCount)
+	:
+	fDatabase(database),
+	fDatabaseLocker(databaseLocker),
+	fDefaultDatabaseLocker(NULL),
+	fUpdater(database, databaseLocker, force),
+	fThreadCount(threadCount),
+	fSniffBufferSize(0),
+	fSniffQueue(NULL),
+	fWriteQueue(NULL),
+	fProgressListener(NULL),
+	fProgressInterval(1000000),
+	fLastProgress(0),
+	fEntries(0),
+	fSniffed(0),
+	fUpdated(0),
+	fSkipped(0),
+	fFailed(0),
+	fCanceled(0)
+{
+	if (fThreadCount <= 0) {
+		system_info info;
+		fThreadCount = get_system_info(&info) == B_OK ? info.cpu_count : 1;
+	}
+	fThreadCount = std::max((int32)1, std::min(fThreadCount, kMaxThreadCount));
+}
+
+
+ParallelMimeInfoUpdater::~ParallelMimeInfoUpdater()
+{
+	delete fDefaultDatabaseLocker;
+}
+
+
+/*!	The \a listener is called every \a interval microseconds while Update()
+	is running.
+*/
+void
+ParallelMimeInfoUpdater::SetProgressListener(ProgressListener* listener,
+	bigtime_t interval)
+{
+	fProgressListener = listener;
+	fProgressInterval = interval;
+}
+
+
+/*!	Updates the MIME information of \a root, and if \a recursive, of all
+	entries below it, like MimeInfoUpdater::DoRecursively() does.
+
+	Entries on volumes that don't support attributes are skipped, together
+	with everything below them. Failing to update an entry does not stop the
+	update; the failures are only counted in the progress.
+
+	\return \c B_OK when all entries have been processed, \c B_CANCELED if
+		the progress listener canceled the update, or another error code if
+		\a root could not be processed at all.
+*/
+status_t
+ParallelMimeInfoUpdater::Update(const entry_ref& root, bool recursive)
+{
+	if (fDatabaseLocker == NULL) {
+		fDefaultDatabaseLocker = new(std::nothrow) DefaultDatabaseLocker;
+		if (fDefaultDatabaseLocker == NULL)
+			return B_NO_MEMORY;
+		fDatabaseLocker = fDefaultDatabaseLocker;
+	}
+
+	{
+		AutoLocker<MimeEntryProcessor::DatabaseLocker> locker(fDatabaseLocker);
+		fSniffBufferSize = fDatabase->SniffBufferSize();
+	}
+	if (fSniffBufferSize < 0)
+		return fSniffBufferSize;
+
+	fEntries = fSniffed = fUpdated = fSkipped = fFailed = 0;
+	fCanceled = 0;
+	fLastProgress = system_time();
+
+	SniffQueue sniffQueue(kSniffQueueCapacity);
+	WriteQueue writeQueue(kWriteQueueCapacity);
+	fSniffQueue = &sniffQueue;
+	fWriteQueue = &writeQueue;
+
+	thread_id writer = spawn_thread(&_WriterThread, "mime attribute writer",
+		B_NORMAL_PRIORITY, this);
+	if (writer < 0)
+		return writer;
+	resume_thread(writer);
+
+	thread_id* sniffers = new(std::nothrow) thread_id[fThreadCount];
+	ArrayDeleter<thread_id> sniffersDeleter(sniffers);
+	int32 snifferCount = 0;
+	for (int32 i = 0; sniffers != NULL && i < fThreadCount; i++) {
+		sniffers[i] = spawn_thread(&_SnifferThread, "mime sniffer",
+			B_NORMAL_PRIORITY, this);
+		if (sniffers[i] < 0)
+			break;
+		resume_thread(sniffers[i]);
+		snifferCount++;
+	}
+
+	status_t error = snifferCount > 0 ? _Walk(root, recursive) : B_NO_MEMORY;
+
+	// let the stages run dry one after the other, and keep reporting
+	sniffQueue.Close();
+	for (int32 i = 0; i < snifferCount; i++) {
+		status_t result;
+		while (wait_for_thread_etc(sniffers[i], B_RELATIVE_TIMEOUT,
+				fProgressInterval, &result) == B_TIMED_OUT) {
+			_ReportProgress(false);
+		}
+	}
+
+	writeQueue.Close();
+	status_t result;
+	while (wait_for_thread_etc(writer, B_RELATIVE_TIMEOUT, fProgressInterval,
+			&result) == B_TIMED_OUT) {
+		_ReportProgress(false);
+	}
+
+	_ReportProgress(true);
+
+	fSniffQueue = NULL;
+	fWriteQueue = NULL;
+
+	if (error == B_OK && atomic_get(&fCanceled) != 0)
+		error = B_CANCELED;
+	return error;
+}
+
+
+/*static*/ status_t
+ParallelMimeInfoUpdater::_SnifferThread(void* data)
+{
+	ParallelMimeInfoUpdater* self = (ParallelMimeInfoUpdater*)data;
+
+	void* buffer = malloc(std::max(self->fSniffBufferSize, (ssize_t)1));
+	if (buffer == NULL)
+		return B_NO_MEMORY;
+
+	SniffItem item;
+	while (self->fSniffQueue->Pop(&item, 1) > 0) {
+		if (atomic_get(&self->fCanceled) == 0)
+			self->_Sniff(item, buffer);
+	}
+
+	free(buffer);
+	return B_OK;
+}
+
+
+/*static*/ status_t
+ParallelMimeInfoUpdater::_WriterThread(void* data)
+{
+	ParallelMimeInfoUpdater* self = (ParallelMimeInfoUpdater*)data;
+
+	WriteItem* items = new(std::nothrow) WriteItem[kWriteBatchSize];
+	if (items == NULL) {
+		// don't let the sniffers block forever
+		self->fWriteQueue->Close();
+		return B_NO_MEMORY;
+	}
+
+	int32 count;
+	while ((count = self->fWriteQueue->Pop(items, kWriteBatchSize)) > 0) {
+		if (atomic_get(&self->fCanceled) == 0)
+			self->_Write(items, count);
+	}
+
+	delete[] items;
+	return B_OK;
+}
+
+
+status_t
+ParallelMimeInfoUpdater::_Walk(const entry_ref& ref, bool recursive)
+{
+	if (atomic_get(&fCanceled) != 0)
+		return B_CANCELED;
+
+	BEntry entry;
+	status_t error = entry.SetTo(&ref);
+	if (error != B_OK)
+		return error;
+
+	atomic_add64(&fEntries, 1);
+	_ReportProgress(false);
+
+	if (!device_is_root_device(ref.device)
+		&& !_DeviceSupportsAttributes(ref.device)) {
+		atomic_add64(&fSkipped, 1);
+		return B_OK;
+	}
+
+	SniffItem item;
+	item.ref = ref;
+	if (!fSniffQueue->Push(item))
+		return B_NO_MEMORY;
+
+	if (!recursive || !entry.IsDirectory())
+		return B_OK;
+
+	BDirectory directory;
+	error = directory.SetTo(&ref);
+	if (error != B_OK)
+		return error;
+
+	entry_ref childRef;
+	while (directory.GetNextRef(&childRef) == B_OK) {
+		if (_Walk(childRef, true) == B_CANCELED)
+			return B_CANCELED;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Returns whether the given device supports attributes. The answers are
+	cached, devices that do are checked first.
+*/
+bool
+ParallelMimeInfoUpdater::_DeviceSupportsAttributes(dev_t device)
+{
+	std::list<std::pair<dev_t, bool> >::iterator it;
+	for (it = fAttributeSupport.begin(); it != fAttributeSupport.end(); it++) {
+		if (it->first == device)
+			return it->second;
+	}
+
+	BVolume volume;
+	if (volume.SetTo(device) != B_OK)
+		return false;
+
+	bool result = volume.KnowsAttr();
+	try {
+		std::pair<dev_t, bool> support(device, result);
+		if (result)
+			fAttributeSupport.push_front(support);
+		else
+			fAttributeSupport.push_back(support);
+	} catch (std::bad_alloc&) {
+	}
+	return result;
+}
+
+
+void
+ParallelMimeInfoUpdater::_Sniff(const SniffItem& item, void* buffer)
+{
+	bool updateType = false;
+	bool updateAppInfo = false;
+
+	BNode node;
+	status_t error = node.SetTo(&item.ref);
+	if (error == B_OK) {
+		fUpdater.GetUpdatesNeeded(node, &updateType, &updateAppInfo);
+		if (!updateType && !updateAppInfo) {
+			atomic_add64(&fSkipped, 1);
+			return;
+		}
+	}
+
+	WriteItem writeItem;
+	writeItem.ref = item.ref;
+	writeItem.updateType = updateType;
+	writeItem.updateAppInfo = updateAppInfo;
+
+	if (error == B_OK)
+		error = _GuessMimeType(item.ref, node, buffer, writeItem.type);
+	if (error != B_OK) {
+		atomic_add64(&fFailed, 1);
+		return;
+	}
+
+	atomic_add64(&fSniffed, 1);
+	if (!fWriteQueue->Push(writeItem))
+		atomic_add64(&fFailed, 1);
+}
+
+
+/*!	Does the same as Database::GuessMimeType(const entry_ref*, BString*), but
+	only locks the database for sniffing the data it has read.
+*/
+status_t
+ParallelMimeInfoUpdater::_GuessMimeType(const entry_ref& ref, BNode& node,
+	void* buffer, BString& type)
+{
+	attr_info info;
+	if (node.GetAttrInfo(kTypeAttr, &info) == B_OK) {
+		type = kMetaMimeType;
+		return B_OK;
+	}
+
+	struct stat statData;
+	status_t error = node.GetStat(&statData);
+	if (error != B_OK)
+		return error;
+
+	if (S_ISDIR(statData.st_mode)) {
+		type = kDirectoryType;
+		return B_OK;
+	}
+	if (S_ISLNK(statData.st_mode)) {
+		type = kSymlinkType;
+		return B_OK;
+	}
+	if (!S_ISREG(statData.st_mode))
+		return B_BAD_TYPE;
+
+	BFile file;
+	error = file.SetTo(&ref, B_READ_ONLY);
+	if (error != B_OK)
+		return error;
+
+	ssize_t bytesRead = file.Read(buffer, fSniffBufferSize);
+	if (bytesRead < 0)
+		return bytesRead;
+
+	AutoLocker<MimeEntryProcessor::DatabaseLocker> locker(fDatabaseLocker);
+	return fDatabase->GuessMimeType(&ref, &file, buffer, bytesRead, &type);
+}
+
+
+/*!	Writes the attributes of a batch of entries. The sniffers complete them
+	out of order, so they are sorted by directory first, to write the entries
+	of each directory together.
+*/
+void
+ParallelMimeInfoUpdater::_Write(WriteItem* items, int32 count)
+{
+	std::stable_sort(items, items + count);
+
+	for (int32 i = 0; i < count; i++) {
+		const WriteItem& item = items[i];
+
+		BNode node;
+		status_t error = node.SetTo(&item.ref);
+		if (error == B_OK) {
+			error = fUpdater.UpdateAttributes(item.ref, node, item.type,
+				item.updateType, item.updateAppInfo);
+		}
+
+		atomic_add64(error == B_OK ? &fUpdated : &fFailed, 1);
+	}
+}
+
+
+void
+ParallelMimeInfoUpdater::_ReportProgress(bool done)
+{
+	if (fProgressListener == NULL)
+		return;
+
+	bigtime_t now = system_time();
+	if (!done && now - fLastProgress < fProgressInterval)
+		return;
+	fLastProgress = now;
+
+	Progress progress;
+	progress.entries = atomic_get64(&fEntries);
+	progress.sniffed = atomic_get64(&fSniffed);
+	progress.updated = atomic_get64(&fUpdated);
+	progress.skipped = atomic_get64(&fSkipped);
+	progress.failed = atomic_get64(&fFailed);
+	progress.done = done;
+
+	if (!fProgressListener->UpdateProgress(progress))
+		atomic_set(&fCanceled, 1);
+}
+
+
+} // namespace Mime
+} // namespace Storage
+} // namespace BPrivate
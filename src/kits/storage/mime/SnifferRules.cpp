@@ -17,6 +17,8 @@
 #include <stdio.h>
 #include <sys/stat.h>
 
+#include <new>
+
 #include <Directory.h>
 #include <Entry.h>
 #include <File.h>
@@ -119,7 +121,9 @@ SnifferRules::SnifferRules(DatabaseLocation* databaseLocation,
 	fDatabaseLocation(databaseLocation),
 	fMimeSniffer(mimeSniffer),
 	fMaxBytesNeeded(0),
-	fHaveDoneFullBuild(false)
+	fHaveDoneFullBuild(false),
+	fRulesCompiled(false),
+	fUseCompiledRules(true)
 {
 }
 
@@ -268,6 +272,7 @@ SnifferRules::SetSnifferRule(const char *type, const char *rule)
 		}
 		if (i == fRuleList.end())
 			fRuleList.push_back(item);
+		fRulesCompiled = false;
 	}
 
 	return err;
@@ -292,6 +297,7 @@ SnifferRules::DeleteSnifferRule(const char *type)
 		   i != fRuleList.end(); i++) {
 		if (i->type == type) {
 			fRuleList.erase(i);
+			fRulesCompiled = false;
 			break;
 		}
 	}
@@ -319,6 +325,19 @@ SnifferRules::PrintToStream() const
 	}
 }
 
+// SetCompiledMatching
+/*! \brief Sets whether GuessMimeType() matches all rules at once using a
+	compiled Sniffer::PatternMatcher, or sniffs each rule on its own.
+
+	Both give the same results; compiled matching is the default. This is
+	mostly useful to compare the two.
+*/
+void
+SnifferRules::SetCompiledMatching(bool enabled)
+{
+	fUseCompiledRules = enabled;
+}
+
 // BuildRuleList
 /*! \brief Crawls through the database, parses each sniffer rule it finds, adds
 	each parsed rule to the rule list, and sorts the list by priority, largest first.
@@ -329,6 +348,7 @@ status_t
 SnifferRules::BuildRuleList()
 {
 	fRuleList.clear();
+	fRulesCompiled = false;
 
 	ssize_t maxBytesNeeded = 0;
 	ssize_t bytesNeeded = 0;
@@ -423,6 +443,10 @@ SnifferRules::BuildRuleList()
 	"supertype/subtype" form rules are checked before "supertype-only" form
 	rules if their priorities happen to be identical).
 
+	Unless disabled via SetCompiledMatching(), the patterns of all rules are
+	first matched against the buffer in a single pass, and the rules are then
+	evaluated on the results in the same order.
+
 	\param file The file to sniff. May be \c NULL. \a buffer is always given.
 	\param buffer Pointer to a data buffer to sniff
 	\param length The length of the data buffer pointed to by \a buffer
@@ -455,6 +479,21 @@ SnifferRules::GuessMimeType(BFile* file, const void *buffer, int32 length,
 			&mimeType);
 	}
 
+	// find all matching patterns at once, if possible
+	bool compiled = false;
+	Sniffer::PatternMatcher::MatchList matches;
+	if (!err && fUseCompiledRules) {
+		if (!fRulesCompiled)
+			fRulesCompiled = CompileRules() == B_OK;
+		if (fRulesCompiled) {
+			try {
+				fPatternMatcher.Match(buffer, length, matches);
+				compiled = true;
+			} catch (std::bad_alloc&) {
+			}
+		}
+	}
+
 	if (!err) {
 		// Run through our rule list, which is sorted in order of
 		// descreasing priority, and see if one of the rules sniffs
@@ -470,7 +509,9 @@ SnifferRules::GuessMimeType(BFile* file, const void *buffer, int32 length,
 					return B_OK;
 				}
 
-				if (i->rule->Sniff(&data)) {
+				bool match = compiled
+					? i->rule->Sniff(matches) : i->rule->Sniff(&data);
+				if (match) {
 					type->SetTo(i->type.c_str());
 					return B_OK;
 				}
@@ -577,6 +618,34 @@ SnifferRules::ProcessType(const char *type, ssize_t *bytesNeeded)
 	return err;
 }
 
+// CompileRules
+/*! \brief Adds the patterns of all rules in the list to the pattern matcher
+	and compiles it.
+
+	\note To be called by GuessMimeType() *ONLY*, when the rule list has
+		changed.
+*/
+status_t
+SnifferRules::CompileRules()
+{
+	fPatternMatcher.MakeEmpty();
+
+	status_t err = B_OK;
+	for (std::list<sniffer_rule>::iterator i = fRuleList.begin();
+		   !err && i != fRuleList.end(); i++) {
+		if (i->rule)
+			err = i->rule->Compile(fPatternMatcher);
+	}
+	if (!err)
+		err = fPatternMatcher.Compile();
+	if (err) {
+		DBG(OUT("Mime::SnifferRules::CompileRules() failed, error code == 0x%"
+			B_PRIx32 "\n", err));
+		fPatternMatcher.MakeEmpty();
+	}
+	return err;
+}
+
 } // namespace Mime
 } // namespace Storage
 } // namespace BPrivate
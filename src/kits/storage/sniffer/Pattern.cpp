@@ -110,12 +110,10 @@ Pattern::BytesNeeded() const
 	return result;
 }
 
-//#define OPTIMIZATION_IS_FOR_CHUMPS
-#if OPTIMIZATION_IS_FOR_CHUMPS
 bool
 Pattern::Sniff(off_t start, off_t size, BPositionIO *data, bool caseInsensitive) const {
 	off_t len = fString.length();
-	char *buffer = new(nothrow) char[len+1];
+	char *buffer = new(std::nothrow) char[len+1];
 	if (buffer) {
 		ArrayDeleter<char> _(buffer);
 		ssize_t bytesRead = data->ReadAt(start, buffer, len);
@@ -126,84 +124,44 @@ Pattern::Sniff(off_t start, off_t size, BPositionIO *data, bool caseInsensitive)
 		// can and return true if those match?
 		if (bytesRead < len)
 			return false;
-		else {
-			bool result = true;
-			if (caseInsensitive) {
-				for (int i = 0; i < len; i++) {
-					char secondChar;
-					if ('A' <= fString[i] && fString[i] <= 'Z')
-						secondChar = 'a' + (fString[i] - 'A');	// Also check lowercase
-					else if ('a' <= fString[i] && fString[i] <= 'z')
-						secondChar = 'A' + (fString[i] - 'a');	// Also check uppercase
-					else
-						secondChar = fString[i]; // Check the same char twice as punishment for doing a case insensitive search ;-)
-					if (((fString[i] & fMask[i]) != (buffer[i] & fMask[i]))
-					     && ((secondChar & fMask[i]) != (buffer[i] & fMask[i])))
-					{
-						result = false;
-						break;
-					}
-				}
-			} else {
-				for (int i = 0; i < len; i++) {
-					if ((fString[i] & fMask[i]) != (buffer[i] & fMask[i])) {
-						result = false;
-						break;
-					}
-				}
-			}
-			return result;
-		}	
+		else
+			return Matches(buffer, caseInsensitive);
 	} else
 		return false;
 }
-#else
+
+/*! \brief Compares the pattern against the given data, which must be at least
+	as long as the pattern.
+
+	Also used by PatternMatcher to verify its candidates, so that both come
+	to the same conclusion.
+*/
 bool
-Pattern::Sniff(off_t start, off_t size, BPositionIO *data, bool caseInsensitive) const {
-	off_t len = fString.length();
-	char *buffer = new(std::nothrow) char[len+1];
-	if (buffer) {
-		ArrayDeleter<char> _(buffer);
-		ssize_t bytesRead = data->ReadAt(start, buffer, len);
-		// \todo If there are fewer bytes left in the data stream
-		// from the given position than the length of our data
-		// string, should we just return false (which is what we're
-		// doing now), or should we compare as many bytes as we
-		// can and return true if those match?
-		if (bytesRead < len)
-			return false;
-		else {
-			bool result = true;
-			if (caseInsensitive) {
-				for (int i = 0; i < len; i++) {
-					char secondChar;
-					if ('A' <= fString[i] && fString[i] <= 'Z')
-						secondChar = 'a' + (fString[i] - 'A');	// Also check lowercase
-					else if ('a' <= fString[i] && fString[i] <= 'z')
-						secondChar = 'A' + (fString[i] - 'a');	// Also check uppercase
-					else
-						secondChar = fString[i]; // Check the same char twice as punishment for doing a case insensitive search ;-)
-					if (((fString[i] & fMask[i]) != (buffer[i] & fMask[i]))
-					     && ((secondChar & fMask[i]) != (buffer[i] & fMask[i])))
-					{
-						result = false;
-						break;
-					}
-				}
-			} else {
-				for (int i = 0; i < len; i++) {
-					if ((fString[i] & fMask[i]) != (buffer[i] & fMask[i])) {
-						result = false;
-						break;
-					}
-				}
+Pattern::Matches(const char *data, bool caseInsensitive) const {
+	int len = fString.length();
+	if (caseInsensitive) {
+		for (int i = 0; i < len; i++) {
+			char secondChar;
+			if ('A' <= fString[i] && fString[i] <= 'Z')
+				secondChar = 'a' + (fString[i] - 'A');	// Also check lowercase
+			else if ('a' <= fString[i] && fString[i] <= 'z')
+				secondChar = 'A' + (fString[i] - 'a');	// Also check uppercase
+			else
+				secondChar = fString[i]; // Check the same char twice as punishment for doing a case insensitive search ;-)
+			if (((fString[i] & fMask[i]) != (data[i] & fMask[i]))
+			     && ((secondChar & fMask[i]) != (data[i] & fMask[i])))
+			{
+				return false;
 			}
-			return result;
-		}	
-	} else
-		return false;
+		}
+	} else {
+		for (int i = 0; i < len; i++) {
+			if ((fString[i] & fMask[i]) != (data[i] & fMask[i]))
+				return false;
+		}
+	}
+	return true;
 }
-#endif
 
 void
 Pattern::SetStatus(status_t status, const char *msg) {
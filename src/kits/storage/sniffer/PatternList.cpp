@@ -9,6 +9,7 @@
 
 #include <sniffer/Err.h>
 #include <sniffer/Pattern.h>
+#include <sniffer/PatternMatcher.h>
 #include <sniffer/PatternList.h>
 #include <DataIO.h>
 #include <stdio.h>
@@ -91,6 +92,30 @@ PatternList::BytesNeeded() const
 	return result;	
 }
 
+/*! \brief Adds the list's patterns to the given matcher, and the indices of
+	their matches to \a indices.
+
+	The list matches if any of those matches.
+*/
+status_t
+PatternList::AddPatterns(PatternMatcher &matcher,
+	std::vector<int32> &indices) const
+{
+	if (InitCheck() != B_OK)
+		return B_OK;	// never matches
+
+	std::vector<Pattern*>::const_iterator i;
+	for (i = fList.begin(); i != fList.end(); i++) {
+		if (*i) {
+			int32 index = matcher.AddPattern(*i, fRange, fCaseInsensitive);
+			if (index < 0)
+				return index;
+			indices.push_back(index);
+		}
+	}
+	return B_OK;
+}
+
 void
 PatternList::Add(Pattern *pattern) {
 	if (pattern)
@@ -0,0 +1,315 @@
+//----------------------------------------------------------------------
+//  This software is part of the Haiku distribution and is covered
+//  by the MIT License.
+//---------------------------------------------------------------------
+/*!
+	\file PatternMatcher.cpp
+	MIME sniffer multi-pattern matcher implementation
+*/
+
+#include <sniffer/Pattern.h>
+#include <sniffer/PatternMatcher.h>
+#include <algorithm>
+#include <new>
+#include <string.h>
+
+using namespace BPrivate::Storage::Sniffer;
+
+//! Longer runs of fully masked bytes are cut off for the automaton
+static const int32 kMaxKeyLength = 32;
+
+/*! \brief Folds ASCII upper case letters to lower case.
+
+	The automaton runs over folded bytes, so that case insensitive patterns
+	need only one key. For case sensitive patterns this just yields a few
+	more candidates, which are all verified against the pattern anyway.
+*/
+static inline uint8
+fold(uint8 byte) {
+	return 'A' <= byte && byte <= 'Z' ? byte - 'A' + 'a' : byte;
+}
+
+PatternMatcher::PatternMatcher()
+	: fScanLength(0)
+	, fCompiled(false)
+{
+	memset(fRootTable, 0, sizeof(fRootTable));
+}
+
+PatternMatcher::~PatternMatcher() {
+}
+
+//! Removes all patterns.
+void
+PatternMatcher::MakeEmpty() {
+	fEntries.clear();
+	fNodes.clear();
+	fEdges.clear();
+	fOutputs.clear();
+	fUnanchored.clear();
+	memset(fRootTable, 0, sizeof(fRootTable));
+	fScanLength = 0;
+	fCompiled = false;
+}
+
+/*! \brief Adds a pattern to be searched for over the given range.
+
+	The pattern is not copied and must stay valid as long as the matcher is
+	in use. The matcher has to be compiled again afterwards.
+
+	\return The index of the pattern's entry in the MatchList filled in by
+		Match(), or an error code.
+*/
+int32
+PatternMatcher::AddPattern(const Pattern *pattern, Range range,
+	bool caseInsensitive)
+{
+	if (!pattern)
+		return B_BAD_VALUE;
+
+	entry newEntry;
+	newEntry.pattern = pattern;
+	newEntry.rangeStart = range.Start();
+	newEntry.rangeEnd = range.End();
+	newEntry.caseInsensitive = caseInsensitive;
+	newEntry.keyOffset = 0;
+	newEntry.keyLength = 0;
+
+	try {
+		fEntries.push_back(newEntry);
+	} catch (std::bad_alloc&) {
+		return B_NO_MEMORY;
+	}
+
+	fCompiled = false;
+	return fEntries.size() - 1;
+}
+
+/*! \brief Builds the automaton over all patterns added so far.
+
+	Until it has been called successfully, Match() checks every pattern
+	separately.
+*/
+status_t
+PatternMatcher::Compile() {
+	fNodes.clear();
+	fEdges.clear();
+	fOutputs.clear();
+	fUnanchored.clear();
+	memset(fRootTable, 0, sizeof(fRootTable));
+	fScanLength = 0;
+	fCompiled = false;
+
+	try {
+		// the trie of all keys, node 0 being the root
+		std::vector<std::vector<edge> > children(1);
+		std::vector<std::vector<int32> > outputs(1);
+
+		for (size_t i = 0; i < fEntries.size(); i++) {
+			entry &current = fEntries[i];
+			const std::string &string = current.pattern->fString;
+			const std::string &mask = current.pattern->fMask;
+
+			// the key is the longest run of fully masked bytes
+			int32 length = std::min(string.length(), mask.length());
+			current.keyOffset = 0;
+			current.keyLength = 0;
+			for (int32 start = 0; start < length; ) {
+				int32 end = start;
+				while (end < length && (uint8)mask[end] == 0xff)
+					end++;
+				if (end - start > current.keyLength) {
+					current.keyOffset = start;
+					current.keyLength = end - start;
+				}
+				start = end + 1;
+			}
+			current.keyLength = std::min(current.keyLength, kMaxKeyLength);
+
+			if (current.rangeEnd < 0 || current.rangeStart > current.rangeEnd) {
+				// can never match
+				continue;
+			}
+			if (current.keyLength == 0) {
+				fUnanchored.push_back(i);
+				continue;
+			}
+
+			int32 state = 0;
+			for (int32 k = 0; k < current.keyLength; k++) {
+				uint8 byte = fold(string[current.keyOffset + k]);
+				std::vector<edge> &stateEdges = children[state];
+				std::vector<edge>::iterator it = stateEdges.begin();
+				while (it != stateEdges.end() && it->byte < byte)
+					it++;
+				if (it != stateEdges.end() && it->byte == byte) {
+					state = it->target;
+				} else {
+					edge newEdge;
+					newEdge.byte = byte;
+					newEdge.target = children.size();
+					stateEdges.insert(it, newEdge);
+					state = newEdge.target;
+					children.push_back(std::vector<edge>());
+					outputs.push_back(std::vector<int32>());
+				}
+			}
+			outputs[state].push_back(i);
+
+			off_t scanLength = (off_t)current.rangeEnd + current.keyOffset
+				+ current.keyLength;
+			if (scanLength > fScanLength)
+				fScanLength = scanLength;
+		}
+
+		// flatten the trie
+		fNodes.resize(children.size());
+		for (size_t i = 0; i < children.size(); i++) {
+			node &current = fNodes[i];
+			current.failure = 0;
+			current.outputLink = 0;
+			current.firstEdge = fEdges.size();
+			current.edgeCount = children[i].size();
+			fEdges.insert(fEdges.end(), children[i].begin(), children[i].end());
+			current.firstOutput = fOutputs.size();
+			current.outputCount = outputs[i].size();
+			fOutputs.insert(fOutputs.end(), outputs[i].begin(),
+				outputs[i].end());
+		}
+		for (int32 i = 0; i < fNodes[0].edgeCount; i++)
+			fRootTable[fEdges[i].byte] = fEdges[i].target;
+
+		// compute the failure and output links breadth first, so that those
+		// of all shallower nodes are known already
+		std::vector<int32> queue;
+		queue.push_back(0);
+		for (size_t head = 0; head < queue.size(); head++) {
+			const node &parent = fNodes[queue[head]];
+			for (int32 i = 0; i < parent.edgeCount; i++) {
+				const edge &current = fEdges[parent.firstEdge + i];
+				node &child = fNodes[current.target];
+				if (queue[head] != 0)
+					child.failure = Step(parent.failure, current.byte);
+
+				const node &failure = fNodes[child.failure];
+				child.outputLink = failure.outputCount > 0
+					? child.failure : failure.outputLink;
+				queue.push_back(current.target);
+			}
+		}
+	} catch (std::bad_alloc&) {
+		fNodes.clear();
+		fEdges.clear();
+		fOutputs.clear();
+		fUnanchored.clear();
+		memset(fRootTable, 0, sizeof(fRootTable));
+		fScanLength = 0;
+		return B_NO_MEMORY;
+	}
+
+	fCompiled = true;
+	return B_OK;
+}
+
+int32
+PatternMatcher::CountPatterns() const {
+	return fEntries.size();
+}
+
+/*! \brief Determines which of the patterns match the given data.
+
+	A pattern matches just like Pattern::Sniff() would match it over its
+	range in a stream of the given data.
+
+	\param matches Is resized to CountPatterns() entries, the ones of the
+		matching patterns are set to a non-zero value.
+*/
+void
+PatternMatcher::Match(const void *_data, size_t length,
+	MatchList &matches) const
+{
+	const char *data = (const char*)_data;
+	matches.assign(fEntries.size(), 0);
+
+	if (!fCompiled) {
+		for (size_t i = 0; i < fEntries.size(); i++)
+			matches[i] = MatchAny(fEntries[i], data, length);
+		return;
+	}
+
+	// every key ending in the data is a candidate for its patterns
+	off_t end = std::min((off_t)length, fScanLength);
+	int32 state = 0;
+	for (off_t position = 0; position < end; position++) {
+		state = Step(state, fold(data[position]));
+
+		int32 output = fNodes[state].outputCount > 0
+			? state : fNodes[state].outputLink;
+		while (output != 0) {
+			const node &current = fNodes[output];
+			for (int32 i = 0; i < current.outputCount; i++) {
+				int32 index = fOutputs[current.firstOutput + i];
+				if (matches[index])
+					continue;
+
+				const entry &candidate = fEntries[index];
+				off_t start = position + 1 - candidate.keyLength
+					- candidate.keyOffset;
+				if (start >= candidate.rangeStart
+					&& start <= candidate.rangeEnd
+					&& MatchAt(candidate, data, length, start)) {
+					matches[index] = 1;
+				}
+			}
+			output = current.outputLink;
+		}
+	}
+
+	// the patterns without a key have to be checked separately
+	for (size_t i = 0; i < fUnanchored.size(); i++) {
+		int32 index = fUnanchored[i];
+		matches[index] = MatchAny(fEntries[index], data, length);
+	}
+}
+
+//! Returns the state the automaton goes to from \a state on \a byte.
+int32
+PatternMatcher::Step(int32 state, uint8 byte) const {
+	while (state != 0) {
+		const node &current = fNodes[state];
+		const edge *edges = &fEdges[current.firstEdge];
+		for (int32 i = 0; i < current.edgeCount && edges[i].byte <= byte;
+				i++) {
+			if (edges[i].byte == byte)
+				return edges[i].target;
+		}
+		state = current.failure;
+	}
+	return fRootTable[byte];
+}
+
+//! Verifies a candidate the same way Pattern::Sniff() does.
+bool
+PatternMatcher::MatchAt(const entry &candidate, const char *data,
+	size_t length, off_t start) const
+{
+	if (start < 0 || start + (off_t)candidate.pattern->fString.length()
+			> (off_t)length) {
+		return false;
+	}
+	return candidate.pattern->Matches(data + start, candidate.caseInsensitive);
+}
+
+//! Checks every offset of the range, like Pattern::Sniff() does.
+bool
+PatternMatcher::MatchAny(const entry &candidate, const char *data,
+	size_t length) const
+{
+	off_t end = std::min((off_t)candidate.rangeEnd, (off_t)length - 1);
+	for (off_t start = std::max(candidate.rangeStart, (int32)0); start <= end;
+			start++) {
+		if (MatchAt(candidate, data, length, start))
+			return true;
+	}
+	return false;
+}
@@ -9,6 +9,7 @@
 
 #include <sniffer/Err.h>
 #include <sniffer/Pattern.h>
+#include <sniffer/PatternMatcher.h>
 #include <sniffer/Range.h>
 #include <sniffer/RPattern.h>
 #include <DataIO.h>
@@ -71,4 +72,15 @@ RPattern::BytesNeeded() const
 	return result;	
 }
 
+/*! \brief Adds the object's pattern and range to the given matcher.
 
+	\return The index of the pattern's match, or an error code. If the object
+		is not properly initialized, it would never match and \c B_BAD_VALUE
+		is returned.
+*/
+int32
+RPattern::AddPattern(PatternMatcher &matcher, bool caseInsensitive) const {
+	if (InitCheck() != B_OK)
+		return B_BAD_VALUE;
+	return matcher.AddPattern(fPattern, fRange, caseInsensitive);
+}
@@ -84,6 +84,29 @@ RPatternList::BytesNeeded() const
 	return result;
 }
 	
+/*! \brief Adds the list's patterns to the given matcher, and the indices of
+	their matches to \a indices.
+
+	The list matches if any of those matches.
+*/
+status_t
+RPatternList::AddPatterns(PatternMatcher &matcher,
+	std::vector<int32> &indices) const
+{
+	std::vector<RPattern*>::const_iterator i;
+	for (i = fList.begin(); i != fList.end(); i++) {
+		if (*i) {
+			int32 index = (*i)->AddPattern(matcher, fCaseInsensitive);
+			if (index == B_BAD_VALUE)
+				continue;	// never matches
+			if (index < 0)
+				return index;
+			indices.push_back(index);
+		}
+	}
+	return B_OK;
+}
+
 void
 RPatternList::Add(RPattern *rpattern) {
 	if (rpattern)
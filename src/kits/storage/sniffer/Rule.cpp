@@ -12,6 +12,7 @@
 #include <sniffer/Rule.h>
 #include <DataIO.h>
 #include <stdio.h>
+#include <new>
 
 using namespace BPrivate::Storage::Sniffer;
 
@@ -83,6 +84,63 @@ Rule::BytesNeeded() const
 	return result;
 }
 
+/*! \brief Adds the patterns of the rule to the given matcher, so that the rule
+	can be evaluated by Sniff(const PatternMatcher::MatchList&) afterwards.
+
+	Every call replaces the results of the previous one.
+*/
+status_t
+Rule::Compile(PatternMatcher &matcher) {
+	fCompiledConjList.clear();
+	if (InitCheck() != B_OK)
+		return B_OK;
+
+	try {
+		std::vector<DisjList*>::const_iterator i;
+		for (i = fConjList->begin(); i != fConjList->end(); i++) {
+			if (*i) {
+				fCompiledConjList.push_back(std::vector<int32>());
+				status_t err = (*i)->AddPatterns(matcher,
+					fCompiledConjList.back());
+				if (err != B_OK) {
+					fCompiledConjList.clear();
+					return err;
+				}
+			}
+		}
+	} catch (std::bad_alloc&) {
+		fCompiledConjList.clear();
+		return B_NO_MEMORY;
+	}
+	return B_OK;
+}
+
+/*! \brief Evaluates the rule on the results of the matcher it was compiled
+	for. Returns true if the rule matches, false if not.
+
+	The result is the same as that of Sniff(BPositionIO*) on the data the
+	matcher was run on.
+*/
+bool
+Rule::Sniff(const PatternMatcher::MatchList &matches) const {
+	if (InitCheck() != B_OK)
+		return false;
+
+	std::vector<std::vector<int32> >::const_iterator i;
+	for (i = fCompiledConjList.begin(); i != fCompiledConjList.end(); i++) {
+		bool result = false;
+		std::vector<int32>::const_iterator j;
+		for (j = i->begin(); j != i->end(); j++) {
+			if (matches[*j]) {
+				result = true;
+				break;
+			}
+		}
+		if (!result)
+			return false;
+	}
+	return true;
+}
 
 void
 Rule::Unset() {
@@ -90,6 +148,7 @@ Rule::Unset() {
 		delete fConjList;
 		fConjList = NULL;
 	}
+	fCompiledConjList.clear();
 }
 
 //! Called by Parser::Parse() after successfully parsing a sniffer rule.
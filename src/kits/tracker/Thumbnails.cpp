@@ -8,6 +8,7 @@
  */
 #include "Thumbnails.h"
 
+#include <algorithm>
 #include <list>
 #include <fs_attr.h>
 
@@ -165,9 +166,16 @@ private:
 status_t
 GenerateThumbnailJob::Execute()
 {
+	// the image is only going to be scaled down to the requested size and
+	// the thumbnail attribute size, so it may be decoded at a reduced size
+	BMessage ioExtension;
+	ioExtension.AddSize(B_TRANSLATOR_EXT_BITMAP_TARGET_SIZE,
+		BSize(std::max(fRequestedSize.width, (float)B_XXL_ICON - 1),
+			std::max(fRequestedSize.height, (float)B_XXL_ICON - 1)));
+
 	BBitmapStream imageStream;
-	status_t status = BTranslatorRoster::Default()->Translate(fFile, NULL, NULL,
-		&imageStream, B_TRANSLATOR_BITMAP, 0, fMimeType);
+	status_t status = BTranslatorRoster::Default()->Translate(fFile, NULL,
+		&ioExtension, &imageStream, B_TRANSLATOR_BITMAP, 0, fMimeType);
 	if (status != B_OK)
 		return status;
 
@@ -198,14 +206,17 @@ GenerateThumbnailJob::Execute()
 	entry->SetIcon(cacheThumb, kNormalIcon, fRequestedSize);
 	cacheLocker.Unlock();
 
-	// write values to attributes
+	// write values to attributes, the image may have been decoded at a
+	// reduced size
+	BSize fullSize = ioExtension.GetSize(B_TRANSLATOR_EXT_BITMAP_FULL_SIZE,
+		image->Bounds().Size());
 	bool thumbnailWritten = false;
-	const int32 width = image->Bounds().IntegerWidth() + 1;
+	const int32 width = (int32)fullSize.width + 1;
 	const size_t written = fFile->WriteAttr("Media:Width", B_INT32_TYPE,
 		0, &width, sizeof(int32));
 	if (written == sizeof(int32)) {
 		// first attribute succeeded, write the rest
-		const int32 height = image->Bounds().IntegerHeight() + 1;
+		const int32 height = (int32)fullSize.height + 1;
 		fFile->WriteAttr("Media:Height", B_INT32_TYPE, 0, &height, sizeof(int32));
 
 		// convert image into a 128x128 WebP image and stash it
@@ -17,6 +17,7 @@
 #include <TranslatorRoster.h>
 
 #include <new>
+#include <string.h>
 #include <strings.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -28,6 +29,7 @@
 #include <NodeMonitor.h>
 #include <Path.h>
 #include <String.h>
+#include <TranslatorFormats.h>
 
 #include <driver_settings.h>
 #include <image.h>
@@ -55,6 +57,37 @@ private:
 			bool				fRemove;
 };
 
+
+class HeaderCacheIO : public BPositionIO {
+public:
+								HeaderCacheIO(BPositionIO* source);
+
+			status_t			InitCheck() const { return fStatus; }
+
+			const uint8*		Header() const { return fHeader; }
+			size_t				HeaderSize() const { return fHeaderSize; }
+
+	virtual	ssize_t				ReadAt(off_t position, void* buffer,
+									size_t size);
+	virtual	ssize_t				WriteAt(off_t position, const void* buffer,
+									size_t size);
+
+	virtual	off_t				Seek(off_t position, uint32 seekMode);
+	virtual	off_t				Position() const;
+
+	virtual	status_t			SetSize(off_t size);
+	virtual	status_t			GetSize(off_t* size) const;
+
+private:
+	static	const size_t		kHeaderSize = 4096;
+
+			BPositionIO*		fSource;
+			off_t				fPosition;
+			status_t			fStatus;
+			size_t				fHeaderSize;
+			uint8				fHeader[kHeaderSize];
+};
+
 }	// namespace BPrivate
 
 // Extensions used in the extension BMessage, defined in TranslatorFormats.h
@@ -66,6 +99,8 @@ char B_TRANSLATOR_EXT_FRAME[]				= "/frame";
 char B_TRANSLATOR_EXT_BITMAP_RECT[]			= "bits/Rect";
 char B_TRANSLATOR_EXT_BITMAP_COLOR_SPACE[]	= "bits/space";
 char B_TRANSLATOR_EXT_BITMAP_PALETTE[]		= "bits/palette";
+char B_TRANSLATOR_EXT_BITMAP_TARGET_SIZE[]	= "bits/targetSize";
+char B_TRANSLATOR_EXT_BITMAP_FULL_SIZE[]	= "bits/fullSize";
 char B_TRANSLATOR_EXT_SOUND_CHANNEL[]		= "nois/channel";
 char B_TRANSLATOR_EXT_SOUND_MONO[]			= "nois/mono";
 char B_TRANSLATOR_EXT_SOUND_MARKER[]		= "nois/marker";
@@ -73,6 +108,39 @@ char B_TRANSLATOR_EXT_SOUND_LOOP[]			= "nois/loop";
 
 BTranslatorRoster* BTranslatorRoster::sDefaultRoster = NULL;
 
+// Signatures of the formats the Translation Kit itself defines
+static const translation_signature kKitSignatures[] = {
+	{ B_TRANSLATOR_BITMAP, 0, 4, { 'b', 'i', 't', 's' } },
+	{ 0 }
+};
+
+
+/*!	Adds all valid signatures of the given \a type to the \a list, and
+	returns whether there were any.
+*/
+static bool
+add_signatures(SignatureList& list, const translation_signature* signatures,
+	uint32 type)
+{
+	if (signatures == NULL)
+		return false;
+
+	bool found = false;
+	for (int32 i = 0; signatures[i].type != 0; i++) {
+		const translation_signature& signature = signatures[i];
+		if (signature.type != type || signature.offset < 0
+			|| signature.length <= 0
+			|| signature.length > (int32)sizeof(signature.bytes)) {
+			continue;
+		}
+
+		list.push_back(&signature);
+		found = true;
+	}
+
+	return found;
+}
+
 
 namespace BPrivate {
 
@@ -117,6 +185,113 @@ QuarantineTranslatorImage::Remove()
 	fRemove = true;
 }
 
+
+//	#pragma mark -
+
+
+/*!
+	Reads the beginning of a stream once, and serves it from memory to all
+	translators that are asked to identify the stream; everything beyond is
+	read from the stream itself.
+*/
+HeaderCacheIO::HeaderCacheIO(BPositionIO* source)
+	:
+	fSource(source),
+	fPosition(0),
+	fHeaderSize(0)
+{
+	fStatus = source->ReadAtExactly(0, fHeader, kHeaderSize, &fHeaderSize);
+	if (fStatus == B_PARTIAL_READ) {
+		// the stream is just shorter than the header
+		fStatus = B_OK;
+	}
+}
+
+
+ssize_t
+HeaderCacheIO::ReadAt(off_t position, void* buffer, size_t size)
+{
+	if (position < 0)
+		return B_BAD_VALUE;
+
+	size_t cached = 0;
+	if (position < (off_t)fHeaderSize) {
+		cached = min_c(size, fHeaderSize - (size_t)position);
+		memcpy(buffer, fHeader + position, cached);
+
+		if (cached == size || fHeaderSize < kHeaderSize) {
+			// we either have all of it, or the stream ends here
+			return cached;
+		}
+	}
+
+	ssize_t bytesRead = fSource->ReadAt(position + cached,
+		(uint8*)buffer + cached, size - cached);
+	if (bytesRead < 0)
+		return cached > 0 ? (ssize_t)cached : bytesRead;
+
+	return cached + bytesRead;
+}
+
+
+ssize_t
+HeaderCacheIO::WriteAt(off_t position, const void* buffer, size_t size)
+{
+	return B_NOT_ALLOWED;
+}
+
+
+off_t
+HeaderCacheIO::Seek(off_t position, uint32 seekMode)
+{
+	switch (seekMode) {
+		case SEEK_SET:
+			break;
+		case SEEK_CUR:
+			position += fPosition;
+			break;
+		case SEEK_END:
+		{
+			off_t size;
+			status_t status = GetSize(&size);
+			if (status != B_OK)
+				return status;
+
+			position += size;
+			break;
+		}
+		default:
+			return B_BAD_VALUE;
+	}
+
+	if (position < 0)
+		return B_BAD_VALUE;
+
+	fPosition = position;
+	return fPosition;
+}
+
+
+off_t
+HeaderCacheIO::Position() const
+{
+	return fPosition;
+}
+
+
+status_t
+HeaderCacheIO::SetSize(off_t size)
+{
+	return B_NOT_ALLOWED;
+}
+
+
+status_t
+HeaderCacheIO::GetSize(off_t* size) const
+{
+	return fSource->GetSize(size);
+}
+
 }	// namespace BPrivate
 
 
@@ -482,7 +657,14 @@ BTranslatorRoster::Private::AddTranslator(BTranslator* translator,
 	if (ref != NULL)
 		item.ref = *ref;
 
+	const translation_signature* signatures;
+	if (image < 0 || get_image_symbol(image, "input_signatures",
+			B_SYMBOL_TYPE_DATA, (void**)&signatures) != B_OK) {
+		signatures = NULL;
+	}
+
 	try {
+		_CollectSignatures(item, signatures);
 		fTranslators[fNextID] = item;
 	} catch (...) {
 		return B_NO_MEMORY;
@@ -722,42 +904,55 @@ BTranslatorRoster::Private::Identify(BPositionIO* source,
 
 	_RescanChanged();
 
-	TranslatorMap::const_iterator iterator = fTranslators.begin();
+	BPrivate::HeaderCacheIO headerSource(source);
+	if (headerSource.InitCheck() != B_OK)
+		return headerSource.InitCheck();
+
 	BMessage baseExtension;
 	if (ioExtension != NULL)
 		baseExtension = *ioExtension;
 
 	float bestWeight = 0.0f;
 
-	while (iterator != fTranslators.end()) {
-		BTranslator& translator = *iterator->second.translator;
-
-		off_t pos = source->Seek(0, SEEK_SET);
-		if (pos != 0)
-			return pos < 0 ? (status_t)pos : B_IO_ERROR;
+	// Only ask the translators whose signatures match the data first, and
+	// the others only if none of those understood it.
+	for (int32 pass = 0; pass < 2 && bestWeight == 0.0f; pass++) {
+		TranslatorMap::const_iterator iterator = fTranslators.begin();
 
-		int32 formatsCount = 0;
-		const translation_format* formats = translator.InputFormats(
-			&formatsCount);
-		const translation_format* format = _CheckHints(formats, formatsCount,
-			hintType, hintMIME);
+		for (; iterator != fTranslators.end(); iterator++) {
+			const translator_item& item = iterator->second;
+			if (_IsCandidate(item, headerSource.Header(),
+					headerSource.HeaderSize()) != (pass == 0)) {
+				continue;
+			}
 
-		BMessage extension(baseExtension);
-		translator_info info;
-		if (translator.Identify(source, format, &extension, &info, wantType)
-				== B_OK) {
-			float weight = info.quality * info.capability;
-			if (weight > bestWeight) {
-				if (ioExtension != NULL)
-					*ioExtension = extension;
-				bestWeight = weight;
+			BTranslator& translator = *item.translator;
 
-				info.translator = iterator->first;
-				memcpy(_info, &info, sizeof(translator_info));
+			off_t pos = headerSource.Seek(0, SEEK_SET);
+			if (pos != 0)
+				return pos < 0 ? (status_t)pos : B_IO_ERROR;
+
+			int32 formatsCount = 0;
+			const translation_format* formats = translator.InputFormats(
+				&formatsCount);
+			const translation_format* format = _CheckHints(formats,
+				formatsCount, hintType, hintMIME);
+
+			BMessage extension(baseExtension);
+			translator_info info;
+			if (translator.Identify(&headerSource, format, &extension, &info,
+					wantType) == B_OK) {
+				float weight = info.quality * info.capability;
+				if (weight > bestWeight) {
+					if (ioExtension != NULL)
+						*ioExtension = extension;
+					bestWeight = weight;
+
+					info.translator = iterator->first;
+					memcpy(_info, &info, sizeof(translator_info));
+				}
 			}
 		}
-
-		iterator++;
 	}
 
 	if (bestWeight > 0.0f)
@@ -776,37 +971,50 @@ BTranslatorRoster::Private::GetTranslators(BPositionIO* source,
 
 	_RescanChanged();
 
+	BPrivate::HeaderCacheIO headerSource(source);
+	if (headerSource.InitCheck() != B_OK)
+		return headerSource.InitCheck();
+
 	int32 arraySize = fTranslators.size();
 	translator_info* array = new (std::nothrow) translator_info[arraySize];
 	if (array == NULL)
 		return B_NO_MEMORY;
 
-	TranslatorMap::const_iterator iterator = fTranslators.begin();
 	int32 count = 0;
 
-	while (iterator != fTranslators.end()) {
-		BTranslator& translator = *iterator->second.translator;
+	// Like Identify(), only fall back to the translators whose signatures
+	// don't match when none of the others understood the data.
+	for (int32 pass = 0; pass < 2 && count == 0; pass++) {
+		TranslatorMap::const_iterator iterator = fTranslators.begin();
 
-		off_t pos = source->Seek(0, SEEK_SET);
-		if (pos != 0) {
-			delete[] array;
-			return pos < 0 ? status_t(pos) : B_IO_ERROR;
-		}
+		for (; iterator != fTranslators.end(); iterator++) {
+			const translator_item& item = iterator->second;
+			if (_IsCandidate(item, headerSource.Header(),
+					headerSource.HeaderSize()) != (pass == 0)) {
+				continue;
+			}
 
-		int32 formatsCount = 0;
-		const translation_format* formats = translator.InputFormats(
-			&formatsCount);
-		const translation_format* format = _CheckHints(formats, formatsCount,
-			hintType, hintMIME);
+			BTranslator& translator = *item.translator;
 
-		translator_info info;
-		if (translator.Identify(source, format, ioExtension, &info, wantType)
-				== B_OK) {
-			info.translator = iterator->first;
-			array[count++] = info;
-		}
+			off_t pos = headerSource.Seek(0, SEEK_SET);
+			if (pos != 0) {
+				delete[] array;
+				return pos < 0 ? status_t(pos) : B_IO_ERROR;
+			}
 
-		iterator++;
+			int32 formatsCount = 0;
+			const translation_format* formats = translator.InputFormats(
+				&formatsCount);
+			const translation_format* format = _CheckHints(formats,
+				formatsCount, hintType, hintMIME);
+
+			translator_info info;
+			if (translator.Identify(&headerSource, format, ioExtension, &info,
+					wantType) == B_OK) {
+				info.translator = iterator->first;
+				array[count++] = info;
+			}
+		}
 	}
 
 	*_info = array;
@@ -927,6 +1135,60 @@ BTranslatorRoster::Private::_RescanChanged()
 }
 
 
+/*!
+	Collects the signatures of all input formats of the translator in \a item
+	from the ones the Translation Kit knows, and the ones its add-on exports.
+	If any input format is left without a signature, the translator cannot be
+	skipped for any data, and the list stays empty.
+*/
+void
+BTranslatorRoster::Private::_CollectSignatures(translator_item& item,
+	const translation_signature* signatures)
+{
+	int32 formatsCount = 0;
+	const translation_format* formats = item.translator->InputFormats(
+		&formatsCount);
+	if (formats == NULL || formatsCount <= 0)
+		return;
+
+	for (int32 i = 0; i < formatsCount && formats[i].type; i++) {
+		bool found = add_signatures(item.signatures, kKitSignatures,
+			formats[i].type);
+		if (add_signatures(item.signatures, signatures, formats[i].type))
+			found = true;
+
+		if (!found) {
+			item.signatures.clear();
+			return;
+		}
+	}
+}
+
+
+/*!
+	Returns whether the translator in \a item may be able to identify a
+	stream that starts with \a header, judging by its signatures.
+*/
+bool
+BTranslatorRoster::Private::_IsCandidate(const translator_item& item,
+	const uint8* header, size_t size) const
+{
+	if (item.signatures.empty())
+		return true;
+
+	for (size_t i = 0; i < item.signatures.size(); i++) {
+		const translation_signature& signature = *item.signatures[i];
+		if ((size_t)signature.offset + signature.length <= size
+			&& memcmp(header + signature.offset, signature.bytes,
+				signature.length) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
 /*!
 	Tests if the hints provided for a source stream are compatible to
 	the formats the translator exports.
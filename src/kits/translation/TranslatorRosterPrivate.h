@@ -16,17 +16,22 @@
 #include <Handler.h>
 #include <Locker.h>
 #include <Messenger.h>
+#include <Translator.h>
 #include <TranslatorRoster.h>
 
 
 struct translator_data;
 
+typedef std::vector<const translation_signature*> SignatureList;
+
 
 struct translator_item {
 	BTranslator*	translator;
 	entry_ref		ref;
 	ino_t			node;
 	image_id		image;
+	SignatureList	signatures;
+		// empty, if not all input formats have a known signature
 };
 
 typedef std::map<translator_id, translator_item> TranslatorMap;
@@ -85,6 +90,11 @@ private:
 
 			void				_RescanChanged();
 
+			void				_CollectSignatures(translator_item& item,
+									const translation_signature* signatures);
+			bool				_IsCandidate(const translator_item& item,
+									const uint8* header, size_t size) const;
+
 			const translation_format* _CheckHints(
 									const translation_format* formats,
 									int32 formatsCount, uint32 hintType,
@@ -184,8 +184,10 @@ SharedSolver::ValidatePreferredSize()
 ResultType
 SharedSolver::ValidateLayout(BLayoutContext* context)
 {
-	if (fLayoutValid && fLayoutContext == context)
+	if (fLayoutValid
+		&& (fLayoutContext == context || !_LayoutSizeChanged())) {
 		return fLayoutResult;
+	}
 
 	_SetContext(context);
 	_ValidateConstraints();
@@ -465,6 +467,29 @@ SharedSolver::_SetContext(BLayoutContext* context)
 }
 
 
+/*!	The constraints don't depend on the layout context, so the solution of
+	the previous layout remains valid in a new context, as long as none of the
+	layouts changed its size. Their sizes are still pinned to the ranges of
+	their right and bottom tabs.
+*/
+bool
+SharedSolver::_LayoutSizeChanged()
+{
+	for (int32 i = fLayouts.CountItems() - 1; i >= 0; i--) {
+		BALMLayout* layout = fLayouts.ItemAt(i);
+		BSize size(layout->LayoutArea().Size());
+		if (layout->Right()->Min() != size.width
+			|| layout->Right()->Max() != size.width
+			|| layout->Bottom()->Min() != size.height
+			|| layout->Bottom()->Max() != size.height) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
 void
 SharedSolver::_ValidateConstraints()
 {
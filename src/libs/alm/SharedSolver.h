@@ -90,6 +90,7 @@ private:
 			bool				_IsMinSet();
 			bool				_IsMaxSet();
 			void				_ValidateConstraints();
+			bool				_LayoutSizeChanged();
 
 			template <class Validator>
 			void				_Validate(bool& isValid, ResultType& result);
@@ -123,6 +123,73 @@ static const char* kDrawingModeMap[] = {
 #	define GTRACE(x) ;
 #endif
 
+//#define RECORD_DRAWING_TRACE
+#ifdef RECORD_DRAWING_TRACE
+#	include <stdarg.h>
+#	include <stdio.h>
+// The trace format is documented in
+// src/tests/servers/app/drawing_benchmark/DrawingTrace.h, which is also
+// used to replay it.
+static FILE*
+drawing_trace_file()
+{
+	static FILE* sTraceFile = fopen("/var/log/app_server_drawing.trace", "a");
+	return sTraceFile;
+}
+
+
+static void
+write_drawing_state(FILE* file, const DrawState* state)
+{
+	rgb_color high = state->HighColor();
+	rgb_color low = state->LowColor();
+	fprintf(file, " %d %g %u %u %u %u %u %u %u %u %g\n",
+		state->GetDrawingMode(), state->PenSize(), high.red, high.green,
+		high.blue, high.alpha, low.red, low.green, low.blue, low.alpha,
+		state->Font().Size());
+}
+
+
+static void
+record_drawing_command(const DrawState* state, const char* format, ...)
+{
+	FILE* file = drawing_trace_file();
+	if (file == NULL)
+		return;
+
+	flockfile(file);
+	va_list args;
+	va_start(args, format);
+	vfprintf(file, format, args);
+	va_end(args);
+	write_drawing_state(file, state);
+	funlockfile(file);
+}
+
+
+static void
+record_drawing_string(const DrawState* state, const char* string,
+	int32 length, const BPoint& location)
+{
+	FILE* file = drawing_trace_file();
+	if (file == NULL)
+		return;
+
+	flockfile(file);
+	fprintf(file, "draw_string %g %g %" B_PRId32, location.x, location.y,
+		length);
+	write_drawing_state(file, state);
+	fwrite(string, 1, length, file);
+	fputc('\n', file);
+	funlockfile(file);
+}
+#	define RECORD_DRAWING(x) record_drawing_command x
+#	define RECORD_DRAWING_STRING(x) record_drawing_string x
+#else
+#	define RECORD_DRAWING(x) ;
+#	define RECORD_DRAWING_STRING(x) ;
+#endif
+
 //#define PROFILE_MESSAGE_LOOP
 #ifdef PROFILE_MESSAGE_LOOP
 struct profile { int32 code; int32 count; bigtime_t time; };
@@ -2547,6 +2614,9 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 				fCurrentView->PenToScreenTransform();
 			transform.Apply(&info.startPoint);
 			transform.Apply(&info.endPoint);
+			RECORD_DRAWING((fCurrentView->CurrentState(),
+				"stroke_line %g %g %g %g", info.startPoint.x,
+				info.startPoint.y, info.endPoint.x, info.endPoint.y));
 			drawingEngine->StrokeLine(info.startPoint, info.endPoint);
 
 			// We update the pen here because many DrawingEngine calls which
@@ -2571,6 +2641,9 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 				rect.bottom));
 
 			fCurrentView->PenToScreenTransform().Apply(&rect);
+			RECORD_DRAWING((fCurrentView->CurrentState(),
+				"invert_rect %g %g %g %g", rect.left, rect.top, rect.right,
+				rect.bottom));
 			drawingEngine->InvertRect(rect);
 			break;
 		}
@@ -2586,6 +2659,9 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 				rect.bottom));
 
 			fCurrentView->PenToScreenTransform().Apply(&rect);
+			RECORD_DRAWING((fCurrentView->CurrentState(),
+				"stroke_rect %g %g %g %g", rect.left, rect.top, rect.right,
+				rect.bottom));
 			drawingEngine->StrokeRect(rect);
 			break;
 		}
@@ -2601,6 +2677,9 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 				rect.bottom));
 
 			fCurrentView->PenToScreenTransform().Apply(&rect);
+			RECORD_DRAWING((fCurrentView->CurrentState(),
+				"fill_rect %g %g %g %g", rect.left, rect.top, rect.right,
+				rect.bottom));
 			drawingEngine->FillRect(rect);
 			break;
 		}
@@ -2749,6 +2828,10 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 				break;
 
 			fCurrentView->PenToScreenTransform().Apply(&rect);
+			RECORD_DRAWING((fCurrentView->CurrentState(),
+				"%s %g %g %g %g", code == AS_FILL_ELLIPSE
+					? "fill_ellipse" : "stroke_ellipse",
+				rect.left, rect.top, rect.right, rect.bottom));
 			drawingEngine->DrawEllipse(rect, code == AS_FILL_ELLIPSE);
 			break;
 		}
@@ -3106,6 +3189,8 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 				"-> %s\n", Title(), fCurrentView->Name(), string));
 
 			fCurrentView->PenToScreenTransform().Apply(&info.location);
+			RECORD_DRAWING_STRING((fCurrentView->CurrentState(), string,
+				info.stringLength, info.location));
 			BPoint penLocation = drawingEngine->DrawString(string,
 				info.stringLength, info.location, delta);
 
@@ -968,7 +968,11 @@ CommitTransactionHandler::_AddGlobalWritableFileRecurse(Package* package,
 			targetName);
 		FSTransaction::CreateOperation copyOperation(&fFSTransaction,
 			FSUtils::Entry(targetDirectory, targetName));
+		// A writable directory can hold a whole tree of settings or data
+		// files; let workers copy those while this thread walks the tree.
+		// Without a controller, the threading doesn't concern us.
 		status_t error = BCopyEngine(BCopyEngine::COPY_RECURSIVELY)
+			.SetThreadCount(4)
 			.CopyEntry(
 				FSUtils::Entry(sourceDirectory, relativeSourcePath.Leaf()),
 				FSUtils::Entry(targetDirectory, targetName));
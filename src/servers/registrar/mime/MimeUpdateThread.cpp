@@ -104,7 +104,7 @@ MimeUpdateThread::ThreadFunction()
 	try {
 		// Do the updates
 		if (!err)
-			err = UpdateEntry(&fRoot);
+			err = UpdateTree(&fRoot);
 	} catch (...) {
 		err = B_ERROR;
 	}
@@ -135,6 +135,19 @@ MimeUpdateThread::ThreadFunction()
 }
 
 
+/*! \brief Updates the given root entry, and everything below it if
+	\c fRecursive is true.
+
+	The default implementation calls DoMimeUpdate() for one entry after the
+	other.
+*/
+status_t
+MimeUpdateThread::UpdateTree(const entry_ref *root)
+{
+	return UpdateEntry(root);
+}
+
+
 /*! \brief Returns true if the given device supports attributes, false
 	if not (or if an error occurs while determining).
 
@@ -38,6 +38,7 @@ public:
 	
 protected:
 	virtual status_t ThreadFunction();
+	virtual status_t UpdateTree(const entry_ref *root);
 	virtual status_t DoMimeUpdate(const entry_ref *entry, bool *entryIsDir) = 0;
 
 	Database* fDatabase;
@@ -16,12 +16,54 @@
 
 #include "UpdateMimeInfoThread.h"
 
+#include <syslog.h>
+
+#include <Mime.h>
+
+#include <mime/ParallelMimeInfoUpdater.h>
+
 
 namespace BPrivate {
 namespace Storage {
 namespace Mime {
 
 
+/*!	Lets the parallel update be canceled along with the thread, and logs the
+	progress of long updates.
+*/
+class UpdateMimeInfoThread::ProgressListener
+	: public ParallelMimeInfoUpdater::ProgressListener {
+public:
+	ProgressListener(const bool& shouldExit)
+		:
+		fShouldExit(shouldExit),
+		fReported(false)
+	{
+	}
+
+	virtual bool UpdateProgress(
+		const ParallelMimeInfoUpdater::Progress& progress)
+	{
+		if (!progress.done || fReported) {
+			syslog(LOG_INFO, "update_mime_info: %" B_PRId64 " entries, %"
+				B_PRId64 " updated, %" B_PRId64 " skipped, %" B_PRId64
+				" failed%s\n", progress.entries, progress.updated,
+				progress.skipped, progress.failed,
+				progress.done ? ", done" : "");
+			fReported = true;
+		}
+		return !fShouldExit;
+	}
+
+private:
+	const bool&	fShouldExit;
+	bool		fReported;
+};
+
+
+// #pragma mark - UpdateMimeInfoThread
+
+
 //! Creates a new UpdateMimeInfoThread object
 UpdateMimeInfoThread::UpdateMimeInfoThread(const char* name, int32 priority,
 	Database* database, MimeEntryProcessor::DatabaseLocker* databaseLocker,
@@ -30,11 +72,29 @@ UpdateMimeInfoThread::UpdateMimeInfoThread(const char* name, int32 priority,
 	:
 	MimeUpdateThread(name, priority, database, managerMessenger, root,
 		recursive, force, replyee),
+	fDatabaseLocker(databaseLocker),
 	fUpdater(database, databaseLocker, force)
 {
 }
 
 
+/*!	Uses a ParallelMimeInfoUpdater if \c B_UPDATE_MIME_INFO_PARALLEL was
+	passed along with the force level, otherwise updates one entry after the
+	other.
+*/
+status_t
+UpdateMimeInfoThread::UpdateTree(const entry_ref* root)
+{
+	if ((fForce & B_UPDATE_MIME_INFO_PARALLEL) == 0)
+		return MimeUpdateThread::UpdateTree(root);
+
+	ProgressListener listener(fShouldExit);
+	ParallelMimeInfoUpdater updater(fDatabase, fDatabaseLocker, fForce);
+	updater.SetProgressListener(&listener, 10000000);
+	return updater.Update(*root, fRecursive);
+}
+
+
 /*! \brief Performs an update_mime_info() update on the given entry
 
 	If the entry has no \c BEOS:TYPE attribute, or if \c fForce is true, the
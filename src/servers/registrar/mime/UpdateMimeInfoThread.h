@@ -34,7 +34,13 @@ public:
 	virtual	status_t			DoMimeUpdate(const entry_ref* entry,
 									bool* _entryIsDir);
 
+protected:
+	virtual	status_t			UpdateTree(const entry_ref* root);
+
 private:
+			class ProgressListener;
+
+			MimeEntryProcessor::DatabaseLocker* fDatabaseLocker;
 			MimeInfoUpdater		fUpdater;
 };
 
@@ -11,9 +11,12 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <AppDefs.h>
+#include <KernelExport.h>
 #include <NodeMonitor.h>
+#include <OS.h>
 
 #include <fd.h>
 #include <lock.h>
@@ -68,6 +71,52 @@ struct interested_monitor_listener_list {
 	uint32				flags;
 };
 
+// An event waiting in a batch, see B_WATCH_BATCHED.
+struct batched_event : DoublyLinkedListLinkImpl<batched_event> {
+	int32				opcode;
+	dev_t				device;
+	ino_t				node;
+	KMessage			message;
+};
+
+typedef DoublyLinkedList<batched_event> BatchedEventList;
+
+// The events for a user listener that are not yet delivered.
+struct event_batch : DoublyLinkedListLinkImpl<event_batch> {
+	event_batch(port_id port, int32 token)
+		:
+		port(port),
+		token(token),
+		count(0),
+		size(0),
+		serial(0),
+		overflow(false)
+	{
+	}
+
+	~event_batch()
+	{
+		while (batched_event* event = events.RemoveHead())
+			delete event;
+	}
+
+	port_id				port;
+	int32				token;
+	BatchedEventList	events;
+	int32				count;
+	int32				size;
+	uint32				serial;
+	bool				overflow;
+};
+
+typedef DoublyLinkedList<event_batch> EventBatchList;
+
+static const int32 kMaxBatchedEvents = 128;
+static const int32 kMaxBatchSize = 8 * 1024;
+	// the batch message must fit into the messaging area
+static const int kBatchFlushInterval = 1;
+	// in 1/10 s
+
 static UserMessagingMessageSender sNodeMonitorSender;
 
 class UserNodeListener : public UserMessagingListener {
@@ -127,6 +176,8 @@ class NodeMonitorService : public NotificationService {
 
 		virtual const char* Name() { return "node monitor"; }
 
+		void FlushBatches();
+
 	private:
 		void _RemoveMonitor(node_monitor *monitor, uint32 flags);
 		status_t _RemoveListener(io_context *context, dev_t device, ino_t node,
@@ -157,6 +208,13 @@ class NodeMonitorService : public NotificationService {
 		void _ResolveMountPoint(dev_t device, ino_t directory,
 			dev_t& parentDevice, ino_t& parentDirectory);
 
+		status_t _AddToBatch(UserNodeListener* listener,
+			const KMessage& message);
+		bool _CoalesceEvent(event_batch* batch, const KMessage& message,
+			int32 opcode, dev_t device, ino_t node);
+		event_batch* _BatchFor(port_id port, int32 token);
+		status_t _SendBatch(event_batch* batch);
+
 		struct monitor_hash_key {
 			dev_t	device;
 			ino_t	node;
@@ -216,6 +274,9 @@ class NodeMonitorService : public NotificationService {
 		MonitorHash	fMonitors;
 		VolumeMonitorHash fVolumeMonitors;
 		recursive_lock fRecursiveLock;
+
+		EventBatchList fBatches;
+		uint32		fEventSerial;
 };
 
 static NodeMonitorService sNodeMonitorService;
@@ -265,6 +326,8 @@ notify_query_entry_event(int32 opcode, port_id port, int32 token,
 
 
 NodeMonitorService::NodeMonitorService()
+	:
+	fEventSerial(0)
 {
 	recursive_lock_init(&fRecursiveLock, "node monitor");
 }
@@ -272,6 +335,9 @@ NodeMonitorService::NodeMonitorService()
 
 NodeMonitorService::~NodeMonitorService()
 {
+	while (event_batch* batch = fBatches.RemoveHead())
+		delete batch;
+
 	recursive_lock_destroy(&fRecursiveLock);
 }
 
@@ -600,6 +666,10 @@ NodeMonitorService::_SendNotificationMessage(KMessage &message,
 	interested_monitor_listener_list *interestedListeners,
 	int32 interestedListenerCount)
 {
+	// identifies the event in the batches, in case a listener is interested
+	// in it via more than one list
+	fEventSerial++;
+
 	// iterate through the lists
 	interested_monitor_listener_list *list = interestedListeners;
 	for (int32 i = 0; i < interestedListenerCount; i++, list++) {
@@ -607,8 +677,19 @@ NodeMonitorService::_SendNotificationMessage(KMessage &message,
 		MonitorListenerList::Iterator iterator = list->iterator;
 		do {
 			monitor_listener *listener = iterator.Current();
-			if (listener->flags & list->flags)
-				listener->listener->EventOccurred(*this, &message);
+			if ((listener->flags & list->flags) == 0)
+				continue;
+
+			if ((listener->flags & B_WATCH_BATCHED) != 0) {
+				UserNodeListener* userListener
+					= dynamic_cast<UserNodeListener*>(listener->listener);
+				if (userListener != NULL
+					&& _AddToBatch(userListener, message) == B_OK) {
+					continue;
+				}
+			}
+
+			listener->listener->EventOccurred(*this, &message);
 		} while (iterator.Next() != NULL);
 	}
 
@@ -647,6 +728,238 @@ NodeMonitorService::_ResolveMountPoint(dev_t device, ino_t directory,
 }
 
 
+/*!	\brief Returns the batch of pending events for the given user listener,
+		   creating it if necessary.
+	Must be called with monitors lock hold.
+*/
+event_batch*
+NodeMonitorService::_BatchFor(port_id port, int32 token)
+{
+	EventBatchList::Iterator iterator = fBatches.GetIterator();
+	while (event_batch* batch = iterator.Next()) {
+		if (batch->port == port && batch->token == token)
+			return batch;
+	}
+
+	event_batch* batch = new(std::nothrow) event_batch(port, token);
+	if (batch == NULL)
+		return NULL;
+
+	fBatches.Add(batch);
+	return batch;
+}
+
+
+/*!	\brief Tries to merge a stat or attribute change into an event that is
+		   already waiting in the batch.
+
+	A change to a node that has just been created is dropped, as the listener
+	will read the current state of the node anyway. Stat changes of the same
+	node are merged into one with the union of their fields, and changes of
+	the same attribute are merged into one with the resulting cause. The
+	search stops at the removal or move of the node.
+
+	Must be called with monitors lock hold.
+
+	\return \c true, if the event has been merged, \c false otherwise.
+*/
+bool
+NodeMonitorService::_CoalesceEvent(event_batch* batch, const KMessage& message,
+	int32 opcode, dev_t device, ino_t node)
+{
+	if (opcode != B_STAT_CHANGED && opcode != B_ATTR_CHANGED)
+		return false;
+
+	const char* attribute = NULL;
+	if (opcode == B_ATTR_CHANGED
+		&& message.FindString("attr", &attribute) != B_OK) {
+		return false;
+	}
+
+	BatchedEventList::ReverseIterator iterator
+		= batch->events.GetReverseIterator();
+	while (batched_event* event = iterator.Next()) {
+		if (event->device != device || event->node != node)
+			continue;
+
+		if (event->opcode == B_ENTRY_CREATED)
+			return true;
+		if (event->opcode == B_ENTRY_REMOVED || event->opcode == B_ENTRY_MOVED)
+			return false;
+		if (event->opcode != opcode)
+			continue;
+
+		if (opcode == B_STAT_CHANGED) {
+			int32 oldFields = 0;
+			int32 newFields = 0;
+			event->message.FindInt32("fields", &oldFields);
+			message.FindInt32("fields", &newFields);
+
+			// the result is only an interim update if both were
+			int32 fields = (oldFields | newFields) & ~B_STAT_INTERIM_UPDATE;
+			fields |= oldFields & newFields & B_STAT_INTERIM_UPDATE;
+
+			return event->message.SetInt32("fields", fields) == B_OK;
+		}
+
+		const char* eventAttribute;
+		if (event->message.FindString("attr", &eventAttribute) != B_OK
+			|| strcmp(eventAttribute, attribute) != 0) {
+			continue;
+		}
+
+		int32 oldCause = B_ATTR_CHANGED;
+		int32 newCause = B_ATTR_CHANGED;
+		event->message.FindInt32("cause", &oldCause);
+		message.FindInt32("cause", &newCause);
+
+		int32 cause = newCause;
+		if (newCause != B_ATTR_REMOVED) {
+			if (oldCause == B_ATTR_CREATED)
+				cause = B_ATTR_CREATED;
+			else if (oldCause == B_ATTR_REMOVED)
+				cause = B_ATTR_CHANGED;
+		}
+
+		return event->message.SetInt32("cause", cause) == B_OK;
+	}
+
+	return false;
+}
+
+
+/*!	\brief Queues the event for the given user listener, that watches with
+		   \c B_WATCH_BATCHED, instead of delivering it right away.
+
+	If the batch is full, it is sent immediately. If an event cannot be
+	queued, it is lost, and the batch is marked to tell the listener that it
+	has to rescan.
+
+	Must be called with monitors lock hold.
+	\return
+	- \c B_OK, if the event has been taken care of,
+	- another error code, if it should be delivered directly instead.
+*/
+status_t
+NodeMonitorService::_AddToBatch(UserNodeListener* listener,
+	const KMessage& message)
+{
+	event_batch* batch = _BatchFor(listener->Port(), listener->Token());
+	if (batch == NULL)
+		return B_NO_MEMORY;
+
+	// the listener might be interested in the event via more than one list
+	if (batch->serial == fEventSerial)
+		return B_OK;
+	batch->serial = fEventSerial;
+
+	int32 opcode;
+	int32 device;
+	int64 node;
+	if (message.FindInt32("opcode", &opcode) != B_OK
+		|| message.FindInt32("device", &device) != B_OK
+		|| message.FindInt64("node", &node) != B_OK) {
+		return B_BAD_VALUE;
+	}
+
+	if (_CoalesceEvent(batch, message, opcode, device, node))
+		return B_OK;
+
+	// leave some room for the field headers
+	int32 size = message.ContentSize() + 16;
+	if (batch->count >= kMaxBatchedEvents
+		|| batch->size + size > kMaxBatchSize) {
+		_SendBatch(batch);
+	}
+
+	batched_event* event = new(std::nothrow) batched_event;
+	if (event == NULL
+		|| event->message.SetTo(message.Buffer(), message.ContentSize(),
+			KMESSAGE_CLONE_BUFFER) != B_OK) {
+		delete event;
+		batch->overflow = true;
+		return B_OK;
+	}
+
+	event->opcode = opcode;
+	event->device = device;
+	event->node = node;
+
+	batch->events.Add(event);
+	batch->count++;
+	batch->size += size;
+
+	return B_OK;
+}
+
+
+/*!	\brief Sends the events of the batch to its listener in a single
+		   message, and empties the batch.
+
+	If the message cannot be sent, the batch stays marked as overflowed, so
+	that the listener learns about the lost events with the next delivery.
+*/
+status_t
+NodeMonitorService::_SendBatch(event_batch* batch)
+{
+	KMessage message(B_NODE_MONITOR);
+	status_t status = message.AddInt32("opcode", B_BATCHED_EVENTS);
+
+	while (batched_event* event = batch->events.RemoveHead()) {
+		if (status == B_OK) {
+			status = message.AddData("event", B_MESSAGE_TYPE,
+				event->message.Buffer(), event->message.ContentSize(), false);
+		}
+		delete event;
+	}
+
+	if (status != B_OK)
+		batch->overflow = true;
+	if (batch->overflow)
+		message.AddBool("overflow", true);
+
+	batch->count = 0;
+	batch->size = 0;
+
+	messaging_target target;
+	target.port = batch->port;
+	target.token = batch->token;
+
+	status = send_message(&message, &target, 1);
+	batch->overflow = status != B_OK;
+
+	return status;
+}
+
+
+/*!	\brief Delivers all pending batches. Called periodically by the kernel
+		   daemon.
+
+	The batches are sent with the monitors lock held, just like the full
+	ones _AddToBatch() sends, so that a listener gets its events in order,
+	and none after it has been removed. Sending doesn't block.
+*/
+void
+NodeMonitorService::FlushBatches()
+{
+	RecursiveLocker locker(fRecursiveLock);
+
+	EventBatchList::Iterator iterator = fBatches.GetIterator();
+	while (event_batch* batch = iterator.Next()) {
+		if (batch->count > 0 || batch->overflow) {
+			if (_SendBatch(batch) != B_OK && port_count(batch->port) >= 0) {
+				// keep the batch to remember the lost events, unless the
+				// port is gone
+				continue;
+			}
+		}
+
+		iterator.Remove();
+		delete batch;
+	}
+}
+
+
 /*!	\brief Notifies all interested listeners that an entry has been created
 		   or removed.
 	\param opcode \c B_ENTRY_CREATED or \c B_ENTRY_REMOVED.
@@ -1040,6 +1353,16 @@ NodeMonitorService::RemoveUserListeners(struct io_context *context,
 		count++;
 	}
 
+	// drop the events that have not been delivered yet
+	EventBatchList::Iterator iterator = fBatches.GetIterator();
+	while (event_batch* batch = iterator.Next()) {
+		if (batch->port == port && batch->token == (int32)token) {
+			iterator.Remove();
+			delete batch;
+			break;
+		}
+	}
+
 	return count > 0 ? B_OK : B_ENTRY_NOT_FOUND;
 }
 
@@ -1086,6 +1409,13 @@ NodeMonitorService::UpdateUserListener(io_context *context, dev_t device,
 //	#pragma mark - private kernel API
 
 
+static void
+flush_node_monitor_batches(void* /*data*/, int /*iteration*/)
+{
+	sNodeMonitorService.FlushBatches();
+}
+
+
 status_t
 remove_node_monitors(struct io_context *context)
 {
@@ -1102,6 +1432,9 @@ node_monitor_init(void)
 	if (sNodeMonitorService.InitCheck() < B_OK)
 		panic("initializing node monitor failed\n");
 
+	register_kernel_daemon(&flush_node_monitor_batches, NULL,
+		kBatchFlushInterval);
+
 	return B_OK;
 }
 
@@ -5843,8 +5843,8 @@ file_seek(struct file_descriptor* descriptor, off_t pos, int seekType)
 					seekType == SEEK_DATA ? FIOSEEKDATA : FIOSEEKHOLE,
 					&offset, sizeof(offset));
 				if (status == B_OK) {
-					if (offset > pos)
-						offset -= pos;
+					// the file system returns the new absolute position
+					offset -= pos;
 					break;
 				}
 			}
@@ -7,6 +7,7 @@
 #include "malloc_debug_api.h"
 
 #include <malloc.h>
+#include <malloc_private.h>
 #include <string.h>
 
 #include <stdio.h>
@@ -330,3 +331,11 @@ malloc_usable_size(void *ptr)
 
 	return size;
 }
+
+
+extern "C" status_t
+get_malloc_size_class_info(malloc_size_class_info* infos, size_t* _count)
+{
+	// the debug heaps don't use size classes
+	return B_NOT_SUPPORTED;
+}
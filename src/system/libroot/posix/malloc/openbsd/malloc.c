@@ -1122,6 +1122,10 @@ omalloc_make_chunks(struct dir_info *d, u_int bucket, u_int listnum)
 	if (insert(d, (void *)((uintptr_t)pp | (bucket + 1)), (uintptr_t)bp,
 	    ff))
 		goto err;
+#ifdef __HAIKU__
+	if (bucket > 0)
+		page_map_set(pp, bucket);
+#endif
 	LIST_INSERT_HEAD(&d->chunk_dir[bucket][listnum], bp, entries);
 
 	if (bucket > 0 && d->malloc_junk != 0)
@@ -1283,6 +1287,9 @@ malloc_bytes(struct dir_info *d, size_t size)
 		validate_junk(d, p, B2SIZE(bucket));
 		if (mopts.chunk_canaries)
 			fill_canary(p, size, B2SIZE(bucket));
+#ifdef __HAIKU__
+		thread_cache_chunk_allocated(p, bucket);
+#endif
 	}
 	return p;
 }
@@ -1360,6 +1367,9 @@ free_bytes(struct dir_info *d, struct region_info *r, void *ptr)
 
 	LIST_REMOVE(info, entries);
 
+#ifdef __HAIKU__
+	page_map_set(info->page, 0);
+#endif
 	if (info->bucket == 0 && !mopts.malloc_freeunmap)
 		mprotect(info->page, MALLOC_PAGESIZE, PROT_READ | PROT_WRITE);
 	unmap(d, info->page, MALLOC_PAGESIZE, 0);
@@ -1592,6 +1602,12 @@ malloc(size_t size)
 	struct dir_info *d;
 	int saved_errno = errno;
 
+#ifdef __HAIKU__
+	r = thread_cache_malloc(size);
+	if (r != NULL)
+		return r;
+#endif
+
 	PROLOGUE(getpool(), "malloc")
 	SET_CALLER(d, caller(d));
 	r = omalloc(d, size, 0);
@@ -1775,6 +1791,9 @@ ofree(struct dir_info **argpool, void *p, int clear, int check, size_t argsz)
 		if (clear && argsz > 0)
 			explicit_bzero(p, argsz);
 		junk_free(pool->malloc_junk, p, sz);
+#ifdef __HAIKU__
+		thread_cache_chunk_freed(p, info->bucket);
+#endif
 
 		i = getrbyte(pool) & MALLOC_DELAYED_CHUNK_MASK;
 		tmp = p;
@@ -1811,6 +1830,11 @@ free(void *ptr)
 	if (ptr == NULL)
 		return;
 
+#ifdef __HAIKU__
+	if (thread_cache_free(ptr))
+		return;
+#endif
+
 	d = getpool();
 	if (d == NULL)
 		wrterror(d, "free() called before allocation");
@@ -1827,6 +1851,10 @@ free(void *ptr)
 }
 DEF_STRONG(free);
 
+#ifdef __HAIKU__
+#include "thread_cache.c"
+#endif
+
 static void
 freezero_p(void *ptr, size_t sz)
 {
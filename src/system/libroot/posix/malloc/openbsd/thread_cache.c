@@ -0,0 +1,432 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/* Per-thread caches of small chunks in front of the pools, included by
+ * malloc.c.
+ *
+ * Allocating and freeing a chunk of a cached size only touches the cache of
+ * the calling thread. The pools are only locked to refill an empty cache
+ * bucket, or to return half of a full one, in batches. As far as their pools
+ * are concerned, the chunks in a cache are still allocated; they are only
+ * given back when the cache is drained or its thread exits.
+ *
+ * The caches are bypassed when chunk canaries, junking or extended free
+ * checks are enabled, as those need to see every allocation and free.
+ *
+ * Since the pools consider cached chunks as allocated, their double free
+ * check cannot see a chunk that is freed again while it is in a cache.
+ * Instead, the second word of every free chunk of a cached size holds a
+ * cookie that tells whether it is in a cache, or has been freed to its pool.
+ * Freeing a cached chunk again is fatal right away, while a chunk that looks
+ * like it has been freed to its pool is passed on to it, so that the pool
+ * can check it. */
+
+
+#define THREAD_CACHE_MAX_SIZE		512
+#define THREAD_CACHE_BUCKETS		(THREAD_CACHE_MAX_SIZE / MALLOC_MINSIZE)
+#define THREAD_CACHE_BUCKET_BYTES	4096
+#define THREAD_CACHE_MAX_CHUNKS		64
+
+#define THREAD_CACHE_ENABLED()		(mopts.chunk_canaries == 0 \
+	&& mopts.def_malloc_junk == 0 && mopts.malloc_freecheck == 0)
+
+struct thread_cache_bucket {
+	void	*chunks;		/* free list, linked through the chunks */
+	u_int	count;
+	uint64	hits;
+	uint64	refills;
+	uint64	drains;
+};
+
+struct thread_cache {
+	struct thread_cache	*next;
+	struct thread_cache	*previous;
+	volatile int		busy;		/* protects against signal handlers */
+	struct thread_cache_bucket buckets[THREAD_CACHE_BUCKETS + 1];
+};
+
+static mutex sThreadCacheLock = MUTEX_INITIALIZER("thread caches");
+static struct thread_cache *sThreadCaches;
+static struct thread_cache_bucket sExitedThreadCaches[THREAD_CACHE_BUCKETS + 1];
+	/* statistics of the caches of exited threads */
+
+
+static inline uintptr_t
+thread_cache_cookie(const void *chunk, int cached)
+{
+	uintptr_t cookie = (uintptr_t)chunk ^ mopts.malloc_canary;
+	return cached ? cookie : ~cookie;
+}
+
+
+static inline void
+thread_cache_set_cookie(void *chunk, uintptr_t cookie)
+{
+	((uintptr_t *)chunk)[1] = cookie;
+}
+
+
+/* Called by malloc_bytes() for every chunk it hands out. */
+static void
+thread_cache_chunk_allocated(void *chunk, u_int bucket)
+{
+	if (bucket <= THREAD_CACHE_BUCKETS && THREAD_CACHE_ENABLED())
+		thread_cache_set_cookie(chunk, 0);
+}
+
+
+/* Called by ofree() for every chunk that is freed to its pool. */
+static void
+thread_cache_chunk_freed(void *chunk, u_int bucket)
+{
+	if (bucket > 0 && bucket <= THREAD_CACHE_BUCKETS
+		&& THREAD_CACHE_ENABLED())
+		thread_cache_set_cookie(chunk, thread_cache_cookie(chunk, 0));
+}
+
+
+static inline u_int
+thread_cache_limit(u_int bucket)
+{
+	u_int limit = THREAD_CACHE_BUCKET_BYTES / B2SIZE(bucket);
+	return limit > THREAD_CACHE_MAX_CHUNKS ? THREAD_CACHE_MAX_CHUNKS : limit;
+}
+
+
+static inline void
+thread_cache_enter(struct thread_cache *cache)
+{
+	cache->busy = 1;
+	__asm__ __volatile__("" : : : "memory");
+}
+
+
+static inline void
+thread_cache_leave(struct thread_cache *cache)
+{
+	__asm__ __volatile__("" : : : "memory");
+	cache->busy = 0;
+}
+
+
+/* Must be called with the lock of \a d held. */
+static struct thread_cache *
+thread_cache_create(struct dir_info *d)
+{
+	struct thread_cache *cache = omalloc(d, sizeof(struct thread_cache), 1);
+	if (cache == NULL)
+		return NULL;
+
+	/* the caller is about to use it */
+	cache->busy = 1;
+
+	mutex_lock(&sThreadCacheLock);
+	cache->next = sThreadCaches;
+	if (sThreadCaches != NULL)
+		sThreadCaches->previous = cache;
+	sThreadCaches = cache;
+	mutex_unlock(&sThreadCacheLock);
+
+	tls_set(TLS_MALLOC_CACHE_SLOT, cache);
+	return cache;
+}
+
+
+/* Fills the \a index bucket of the \a cache with half as many chunks as it
+ * can hold. If there is no cache yet, it is created, and returned already
+ * entered. */
+static struct thread_cache *
+thread_cache_refill(struct thread_cache *cache, u_int index, size_t size)
+{
+	struct thread_cache_bucket *bucket;
+	struct dir_info *d;
+	int saved_errno = errno;
+	u_int i, count;
+
+	d = getpool();
+	if (d == NULL)
+		return NULL;
+	_MALLOC_LOCK(d->mutex);
+	d->func = "malloc";
+	if (d->active++) {
+		malloc_recurse(d);
+		return NULL;
+	}
+
+	if (cache == NULL)
+		cache = thread_cache_create(d);
+	if (cache != NULL) {
+		bucket = &cache->buckets[index];
+		count = thread_cache_limit(index) / 2;
+		for (i = 0; i < count; i++) {
+			void *p = omalloc(d, size, 0);
+			if (p == NULL)
+				break;
+			thread_cache_set_cookie(p, thread_cache_cookie(p, 1));
+			*(void **)p = bucket->chunks;
+			bucket->chunks = p;
+			bucket->count++;
+		}
+		if (i > 0)
+			bucket->refills++;
+	}
+
+	d->active--;
+	_MALLOC_UNLOCK(d->mutex);
+	errno = saved_errno;
+	return cache;
+}
+
+
+/* Returns up to \a count chunks of the \a bucket to their pools. */
+static void
+thread_cache_drain(struct thread_cache_bucket *bucket, u_int count)
+{
+	struct dir_info *d;
+	int saved_errno = errno;
+
+	d = getpool();
+	_MALLOC_LOCK(d->mutex);
+	d->func = "free";
+	if (d->active++) {
+		malloc_recurse(d);
+		return;
+	}
+
+	while (count-- > 0 && bucket->chunks != NULL) {
+		void *p = bucket->chunks;
+		bucket->chunks = *(void **)p;
+		bucket->count--;
+		ofree(&d, p, 0, 0, 0);
+	}
+	bucket->drains++;
+
+	d->active--;
+	_MALLOC_UNLOCK(d->mutex);
+	errno = saved_errno;
+}
+
+
+static void *
+thread_cache_malloc(size_t size)
+{
+	struct thread_cache *cache;
+	struct thread_cache_bucket *bucket;
+	u_int index;
+	void *p;
+
+	if (size == 0 || size > THREAD_CACHE_MAX_SIZE || !THREAD_CACHE_ENABLED())
+		return NULL;
+
+	cache = tls_get(TLS_MALLOC_CACHE_SLOT);
+	if (cache != NULL && cache->busy)
+		return NULL;
+
+	index = find_bucket(size);
+	if (cache == NULL) {
+		cache = thread_cache_refill(NULL, index, size);
+		if (cache == NULL)
+			return NULL;
+	} else {
+		thread_cache_enter(cache);
+		if (cache->buckets[index].chunks == NULL)
+			thread_cache_refill(cache, index, size);
+	}
+
+	bucket = &cache->buckets[index];
+	p = bucket->chunks;
+	if (p != NULL) {
+		bucket->chunks = *(void **)p;
+		bucket->count--;
+		bucket->hits++;
+		thread_cache_set_cookie(p, 0);
+	}
+	thread_cache_leave(cache);
+	return p;
+}
+
+
+/* Returns whether the chunk has been put into the cache. */
+static int
+thread_cache_free(void *ptr)
+{
+	struct thread_cache *cache;
+	struct thread_cache_bucket *bucket;
+	uintptr_t cookie;
+	u_int index, limit;
+
+	if (!THREAD_CACHE_ENABLED())
+		return 0;
+
+	index = page_map_get(ptr);
+	if (index == 0 || index > THREAD_CACHE_BUCKETS
+		|| ((uintptr_t)ptr & MALLOC_PAGEMASK) % B2ALLOC(index) != 0) {
+		/* not a cached size, or a bogus pointer the pool will complain
+		 * about */
+		return 0;
+	}
+
+	/* already in the cache of this, or of any other thread */
+	cookie = ((uintptr_t *)ptr)[1];
+	if (cookie == thread_cache_cookie(ptr, 1))
+		wrterror(NULL, "double free %p", ptr);
+
+	cache = tls_get(TLS_MALLOC_CACHE_SLOT);
+	if (cache == NULL || cache->busy
+		|| cookie == thread_cache_cookie(ptr, 0)) {
+		/* let the pool check if it has already been freed */
+		return 0;
+	}
+
+	thread_cache_enter(cache);
+	bucket = &cache->buckets[index];
+
+	limit = thread_cache_limit(index);
+	if (bucket->count >= limit)
+		thread_cache_drain(bucket, limit / 2);
+
+	thread_cache_set_cookie(ptr, thread_cache_cookie(ptr, 1));
+	*(void **)ptr = bucket->chunks;
+	bucket->chunks = ptr;
+	bucket->count++;
+	thread_cache_leave(cache);
+	return 1;
+}
+
+
+static void
+thread_cache_init()
+{
+	tls_set(TLS_MALLOC_CACHE_SLOT, NULL);
+}
+
+
+/* Gives all chunks of the calling thread's cache back to the pools. */
+static void
+thread_cache_exit()
+{
+	struct thread_cache *cache = tls_get(TLS_MALLOC_CACHE_SLOT);
+	struct dir_info *d;
+	u_int i;
+
+	if (cache == NULL)
+		return;
+
+	/* from now on, this thread goes to the pools directly */
+	tls_set(TLS_MALLOC_CACHE_SLOT, NULL);
+
+	for (i = 1; i <= THREAD_CACHE_BUCKETS; i++) {
+		if (cache->buckets[i].count > 0)
+			thread_cache_drain(&cache->buckets[i], cache->buckets[i].count);
+	}
+
+	mutex_lock(&sThreadCacheLock);
+	if (cache->next != NULL)
+		cache->next->previous = cache->previous;
+	if (cache->previous != NULL)
+		cache->previous->next = cache->next;
+	else
+		sThreadCaches = cache->next;
+
+	for (i = 1; i <= THREAD_CACHE_BUCKETS; i++) {
+		sExitedThreadCaches[i].hits += cache->buckets[i].hits;
+		sExitedThreadCaches[i].refills += cache->buckets[i].refills;
+		sExitedThreadCaches[i].drains += cache->buckets[i].drains;
+	}
+	mutex_unlock(&sThreadCacheLock);
+
+	d = getpool();
+	_MALLOC_LOCK(d->mutex);
+	d->func = "free";
+	if (d->active++) {
+		malloc_recurse(d);
+		return;
+	}
+	ofree(&d, cache, 0, 0, 0);
+	d->active--;
+	_MALLOC_UNLOCK(d->mutex);
+}
+
+
+static void
+thread_cache_after_fork_child()
+{
+	struct thread_cache *cache = tls_get(TLS_MALLOC_CACHE_SLOT);
+
+	/* The other threads are gone, and so are their caches; the chunks in
+	 * them stay allocated. */
+	mutex_init(&sThreadCacheLock, "thread caches");
+	sThreadCaches = cache;
+	if (cache != NULL)
+		cache->next = cache->previous = NULL;
+}
+
+
+status_t
+get_malloc_size_class_info(struct malloc_size_class_info *infos,
+	size_t *_count)
+{
+	struct thread_cache *cache;
+	size_t count, i, j;
+	u_int nmutexes;
+
+	if (_count == NULL || (infos == NULL && *_count > 0))
+		return B_BAD_VALUE;
+
+	count = *_count;
+	if (count > BUCKETS + 1)
+		count = BUCKETS + 1;
+	*_count = BUCKETS + 1;
+
+	for (i = 0; i < count; i++) {
+		memset(&infos[i], 0, sizeof(struct malloc_size_class_info));
+		infos[i].size = B2SIZE(i);
+	}
+
+	if (mopts.malloc_pool[1] == NULL)
+		return B_OK;
+
+	nmutexes = mopts_nmutexes();
+	for (i = 1; i < nmutexes; i++) {
+		struct dir_info *d = mopts.malloc_pool[i];
+
+		_MALLOC_LOCK(d->mutex);
+		for (j = 0; j < d->regions_total; j++) {
+			struct region_info *r = &d->r[j];
+			struct chunk_info *info;
+
+			/* only chunk pages have the bucket in the low bits */
+			if (r->p == NULL || ((uintptr_t)r->p & MALLOC_PAGEMASK) == 0)
+				continue;
+
+			info = (struct chunk_info *)r->size;
+			if (info->bucket >= count)
+				continue;
+
+			infos[info->bucket].pages++;
+			infos[info->bucket].chunks += info->total;
+			infos[info->bucket].used += info->total - info->free;
+		}
+		_MALLOC_UNLOCK(d->mutex);
+	}
+
+	mutex_lock(&sThreadCacheLock);
+	for (i = 1; i <= THREAD_CACHE_BUCKETS && i < count; i++) {
+		infos[i].cache_hits = sExitedThreadCaches[i].hits;
+		infos[i].cache_refills = sExitedThreadCaches[i].refills;
+		infos[i].cache_drains = sExitedThreadCaches[i].drains;
+
+		/* the other threads keep going, so this is only a snapshot */
+		for (cache = sThreadCaches; cache != NULL; cache = cache->next) {
+			infos[i].cached += cache->buckets[i].count;
+			infos[i].cache_hits += cache->buckets[i].hits;
+			infos[i].cache_refills += cache->buckets[i].refills;
+			infos[i].cache_drains += cache->buckets[i].drains;
+		}
+	}
+	mutex_unlock(&sThreadCacheLock);
+
+	return B_OK;
+}
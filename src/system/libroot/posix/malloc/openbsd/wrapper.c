@@ -10,6 +10,7 @@
 
 #include <errno_private.h>
 #include <libroot_private.h>
+#include <malloc_private.h>
 #include <shared/locks.h>
 #include <system/tls.h>
 
@@ -131,6 +132,121 @@ malloc_munmap(void* address, size_t length)
 #define munmap malloc_munmap
 
 
+/* chunk page map */
+
+/* Maps every page that is split into chunks to the bucket of its chunks, so
+ * that the thread caches can find the size of a chunk without having to look
+ * it up in the region table of its pool, which needs the pool's lock. The map
+ * is only written with the lock of the pool owning the page held, and entries
+ * of pages with allocated chunks on them never change, so looking up a valid
+ * pointer is safe without a lock. 0 means "not a chunk page". */
+
+#ifdef B_HAIKU_64_BIT
+#define PAGE_MAP_ADDRESS_BITS	48
+#else
+#define PAGE_MAP_ADDRESS_BITS	32
+#endif
+#define PAGE_MAP_LEAF_BITS		12
+#define PAGE_MAP_MIDDLE_BITS	((PAGE_MAP_ADDRESS_BITS - _MAX_PAGE_SHIFT \
+	- PAGE_MAP_LEAF_BITS) / 2)
+#define PAGE_MAP_ROOT_BITS		(PAGE_MAP_ADDRESS_BITS - _MAX_PAGE_SHIFT \
+	- PAGE_MAP_LEAF_BITS - PAGE_MAP_MIDDLE_BITS)
+
+typedef uint8 page_map_leaf[1 << PAGE_MAP_LEAF_BITS];
+typedef page_map_leaf* page_map_middle[1 << PAGE_MAP_MIDDLE_BITS];
+
+static page_map_middle* sPageMap[1 << PAGE_MAP_ROOT_BITS];
+
+
+static void*
+page_map_get_node(void** _node, size_t size)
+{
+	void* node = __atomic_load_n(_node, __ATOMIC_ACQUIRE);
+	void* expected = NULL;
+	if (node != NULL)
+		return node;
+
+	node = malloc_mmap(NULL, size, PROT_READ | PROT_WRITE,
+		MAP_ANON | MAP_PRIVATE, -1, 0);
+	if (node == MAP_FAILED)
+		return NULL;
+
+	// the pages of different pools might share this node
+	if (!__atomic_compare_exchange_n(_node, &expected, node, false,
+			__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		malloc_munmap(node, size);
+		return expected;
+	}
+	return node;
+}
+
+
+static uint8*
+page_map_entry(void* page, bool create)
+{
+	const uintptr_t pageNumber = (uintptr_t)page >> _MAX_PAGE_SHIFT;
+	const uintptr_t rootIndex
+		= pageNumber >> (PAGE_MAP_LEAF_BITS + PAGE_MAP_MIDDLE_BITS);
+	const uintptr_t middleIndex = (pageNumber >> PAGE_MAP_LEAF_BITS)
+		& ((1 << PAGE_MAP_MIDDLE_BITS) - 1);
+	page_map_middle* middle;
+	page_map_leaf* leaf;
+
+	if (rootIndex >= (1 << PAGE_MAP_ROOT_BITS))
+		return NULL;
+
+	if (create) {
+		middle = (page_map_middle*)page_map_get_node(
+			(void**)&sPageMap[rootIndex], sizeof(page_map_middle));
+		if (middle == NULL)
+			return NULL;
+		leaf = (page_map_leaf*)page_map_get_node(
+			(void**)&(*middle)[middleIndex], sizeof(page_map_leaf));
+	} else {
+		middle = __atomic_load_n(&sPageMap[rootIndex], __ATOMIC_ACQUIRE);
+		if (middle == NULL)
+			return NULL;
+		leaf = __atomic_load_n(&(*middle)[middleIndex], __ATOMIC_ACQUIRE);
+	}
+	if (leaf == NULL)
+		return NULL;
+
+	return &(*leaf)[pageNumber & ((1 << PAGE_MAP_LEAF_BITS) - 1)];
+}
+
+
+static void
+page_map_set(void* page, u_int bucket)
+{
+	uint8* entry = page_map_entry(page, bucket != 0);
+	if (entry != NULL)
+		__atomic_store_n(entry, (uint8)bucket, __ATOMIC_RELAXED);
+	// If the map could not be extended, the page is simply not known to be
+	// a chunk page, and its chunks bypass the thread caches.
+}
+
+
+static u_int
+page_map_get(const void* address)
+{
+	uint8* entry = page_map_entry((void*)address, false);
+	if (entry == NULL)
+		return 0;
+	return __atomic_load_n(entry, __ATOMIC_RELAXED);
+}
+
+
+/* thread caches, see thread_cache.c */
+
+static void* thread_cache_malloc(size_t size);
+static int thread_cache_free(void* ptr);
+static void thread_cache_init();
+static void thread_cache_exit();
+static void thread_cache_after_fork_child();
+static void thread_cache_chunk_allocated(void* chunk, u_int bucket);
+static void thread_cache_chunk_freed(void* chunk, u_int bucket);
+
+
 /* public methods */
 
 void*
@@ -201,6 +317,7 @@ status_t
 __init_heap()
 {
 	tls_set(TLS_MALLOC_SLOT, (void*)0);
+	thread_cache_init();
 	__init_pages_allocator();
 	mutex_init(&sMallocMutexes[0], "heap mutex");
 	mutex_init(&sMallocMutexes[1], "heap mutex");
@@ -227,6 +344,7 @@ __heap_thread_init()
 {
 	pthread_once(&sThreadedMallocInitOnce, &init_threaded_malloc);
 	tls_set(TLS_MALLOC_SLOT, (void*)(intptr_t)-1);
+	thread_cache_init();
 }
 
 
@@ -234,6 +352,9 @@ void
 __heap_thread_exit()
 {
 	const int32 id = (int32)(intptr_t)tls_get(TLS_MALLOC_SLOT);
+
+	thread_cache_exit();
+
 	if (id != -1 && id == (sNextMallocThreadID - 1)) {
 		// Try to "de-allocate" this thread's ID.
 		atomic_test_and_set(&sNextMallocThreadID, id, id + 1);
@@ -261,6 +382,7 @@ __heap_after_fork_child()
 	for (i = 0; i < nmutexes; i++)
 		mutex_init(&sMallocMutexes[i], "heap mutex");
 
+	thread_cache_after_fork_child();
 	__pages_allocator_after_fork(0);
 }
 
@@ -1796,6 +1796,7 @@ void get_driver_settings() {}
 void get_driver_settings_string() {}
 void get_image_symbol() {}
 void get_image_symbol_etc() {}
+void get_malloc_size_class_info() {}
 void get_memory_properties() {}
 void get_nth_image_symbol() {}
 void get_path_for_dirent() {}
@@ -1777,6 +1777,7 @@ void get_image_symbol() {}
 void get_image_symbol_etc() {}
 void get_launch_daemon_port__8BPrivatev() {}
 void get_launch_data__8BPrivatePCcRQ28BPrivate8KMessage() {}
+void get_malloc_size_class_info() {}
 void get_memory_properties() {}
 void get_nth_image_symbol() {}
 void get_nth_pci_info() {}
@@ -157,3 +157,10 @@ image_event(image_t* image, uint32 event)
 			function(image);
 	}
 }
+
+
+bool
+have_add_ons()
+{
+	return !sAddOns.IsEmpty();
+}
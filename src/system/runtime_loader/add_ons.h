@@ -54,6 +54,7 @@ struct RuntimeLoaderSymbolPatcher {
 void		init_add_ons();
 status_t	add_add_on(image_t* image, runtime_loader_add_on* addOnStruct);
 void		image_event(image_t* image, uint32 event);
+bool		have_add_ons();
 
 
 #endif	// ADD_ONS_H
@@ -13,6 +13,9 @@
 #include <stdlib.h>
 
 
+extern "C" void x86_64_lazy_bind_trampoline();
+
+
 static status_t
 relocate_rela(image_t* rootImage, image_t* image, Elf64_Rela* rel,
 	size_t relLength, SymbolLookupCache* cache)
@@ -80,6 +83,76 @@ relocate_rela(image_t* rootImage, image_t* image, Elf64_Rela* rel,
 }
 
 
+static status_t
+relocate_plt_lazily(image_t* rootImage, image_t* image,
+	SymbolLookupCache* cache)
+{
+	Elf64_Addr* got = NULL;
+	elf_dyn* dynamic = (elf_dyn*)image->dynamic_ptr;
+	for (int i = 0; dynamic[i].d_tag != DT_NULL; i++) {
+		if (dynamic[i].d_tag == DT_PLTGOT) {
+			got = (Elf64_Addr*)(image->regions[0].delta
+				+ dynamic[i].d_un.d_ptr);
+			break;
+		}
+	}
+
+	Elf64_Rela* rel = (Elf64_Rela*)image->pltrel;
+	size_t count = image->pltrel_len / sizeof(Elf64_Rela);
+
+	if (got == NULL) {
+		return relocate_rela(rootImage, image, rel, image->pltrel_len,
+			cache);
+	}
+
+	// The first PLT entry pushes GOT[1] and jumps to GOT[2].
+	got[1] = (Elf64_Addr)image;
+	got[2] = (Elf64_Addr)&x86_64_lazy_bind_trampoline;
+
+	for (size_t i = 0; i < count; i++) {
+		int symIndex = ELF64_R_SYM(rel[i].r_info);
+
+		// Weak symbols are bound right away, so that their resolution doesn't
+		// depend on when they are called first; symbols that have been
+		// resolved already anyway don't need to be deferred either.
+		if (ELF64_R_TYPE(rel[i].r_info) != R_X86_64_JUMP_SLOT || symIndex == 0
+			|| ELF64_ST_BIND(SYMBOL(image, symIndex)->st_info) == STB_WEAK
+			|| cache->IsSymbolValueCached(symIndex)) {
+			status_t status = relocate_rela(rootImage, image, rel + i,
+				sizeof(Elf64_Rela), cache);
+			if (status != B_OK)
+				return status;
+			continue;
+		}
+
+		// The GOT entry initially points back to the instruction following
+		// the jump in the PLT entry, which pushes the relocation index and
+		// enters the first PLT entry.
+		*(Elf64_Addr*)(image->regions[0].delta + rel[i].r_offset)
+			+= image->regions[0].delta;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Called by x86_64_lazy_bind_trampoline() on the first call through a
+	lazily bound PLT entry of \a image. Binds the entry and returns the
+	address of its target.
+*/
+extern "C" addr_t
+x86_64_bind_lazy_plt_entry(image_t* image, uint64 relocationIndex)
+{
+	Elf64_Rela* rel = (Elf64_Rela*)image->pltrel + relocationIndex;
+	Elf64_Sym* sym = SYMBOL(image, ELF64_R_SYM(rel->r_info));
+
+	Elf64_Addr address = resolve_lazy_symbol(image, sym) + rel->r_addend;
+	*(Elf64_Addr*)(image->regions[0].delta + rel->r_offset) = address;
+
+	return address;
+}
+
+
 status_t
 arch_relocate_image(image_t* rootImage, image_t* image,
 	SymbolLookupCache* cache)
@@ -98,8 +171,12 @@ arch_relocate_image(image_t* rootImage, image_t* image,
 
 	// PLT relocations (they are RELA on x86_64).
 	if (image->pltrel) {
-		status = relocate_rela(rootImage, image, (Elf64_Rela*)image->pltrel,
-			image->pltrel_len, cache);
+		if (lazy_binding_enabled(rootImage, image))
+			status = relocate_plt_lazily(rootImage, image, cache);
+		else {
+			status = relocate_rela(rootImage, image, (Elf64_Rela*)image->pltrel,
+				image->pltrel_len, cache);
+		}
 		if (status != B_OK)
 			return status;
 	}
@@ -30,6 +30,7 @@
 #include "elf_versioning.h"
 #include "errors.h"
 #include "images.h"
+#include "relocation_cache.h"
 
 
 // TODO: implement better locking strategy
@@ -279,9 +280,12 @@ load_dependencies(image_t* image, bool preload = false)
 
 
 static status_t
-relocate_image(image_t *rootImage, image_t *image)
+relocate_image(image_t *rootImage, image_t *image,
+	RelocationCache* relocationCache)
 {
 	SymbolLookupCache cache(image);
+	if (relocationCache != NULL)
+		relocationCache->Restore(image, cache);
 
 	status_t status = arch_relocate_image(rootImage, image, &cache);
 	if (status < B_OK) {
@@ -289,6 +293,9 @@ relocate_image(image_t *rootImage, image_t *image)
 		return status;
 	}
 
+	if (relocationCache != NULL)
+		relocationCache->Record(image, cache);
+
 	_kern_image_relocated(image->id);
 	image_event(image, IMAGE_EVENT_RELOCATED);
 	return B_OK;
@@ -296,7 +303,7 @@ relocate_image(image_t *rootImage, image_t *image)
 
 
 static status_t
-relocate_dependencies(image_t *image)
+relocate_dependencies(image_t *image, RelocationCache* relocationCache = NULL)
 {
 	// get the images that still have to be relocated
 	image_t **list;
@@ -306,7 +313,7 @@ relocate_dependencies(image_t *image)
 
 	// relocate
 	for (ssize_t i = 0; i < count; i++) {
-		status_t status = relocate_image(image, list[i]);
+		status_t status = relocate_image(image, list[i], relocationCache);
 		if (status < B_OK) {
 			free(list);
 			return status;
@@ -532,6 +539,70 @@ preload_addons()
 }
 
 
+//	#pragma mark - lazy binding
+
+
+/*!	Returns whether the PLT relocations of \a image, which is being relocated
+	on behalf of \a rootImage, may be bound lazily.
+
+	Only the images loaded together with the program are bound lazily: they
+	stay loaded as long as the team exists, and the program image remains the
+	root image for resolving their symbols. Images loaded later via dlopen()
+	or load_add_on() are always bound immediately, as are all images, if
+	LD_BIND_NOW is set or runtime loader add-ons might want to patch symbols.
+*/
+bool
+lazy_binding_enabled(image_t* rootImage, image_t* image)
+{
+	if (rootImage != gProgramImage || gProgramLoaded || have_add_ons())
+		return false;
+
+	const char* bindNow = getenv("LD_BIND_NOW");
+	if (bindNow != NULL && bindNow[0] != '\0')
+		return false;
+
+	elf_dyn* dynamic = (elf_dyn*)image->dynamic_ptr;
+	for (int i = 0; dynamic[i].d_tag != DT_NULL; i++) {
+		switch (dynamic[i].d_tag) {
+			case DT_BIND_NOW:
+				return false;
+			case DT_FLAGS:
+				if ((dynamic[i].d_un.d_val & DF_BIND_NOW) != 0)
+					return false;
+				break;
+			case DT_FLAGS_1:
+				if ((dynamic[i].d_un.d_val & DF_1_NOW) != 0)
+					return false;
+				break;
+		}
+	}
+
+	return true;
+}
+
+
+/*!	Resolves the symbol \a sym referenced by a PLT entry of \a image on its
+	first call. Called by the architecture specific lazy binding trampoline,
+	possibly by several threads at the same time. Does not return, if the
+	symbol cannot be resolved.
+*/
+addr_t
+resolve_lazy_symbol(image_t* image, elf_sym* sym)
+{
+	RecursiveLocker _(sLock);
+
+	SymbolLookupCache cache;
+	addr_t address;
+	if (resolve_symbol(gProgramImage, image, sym, &cache, &address) != B_OK) {
+		printf(RLD_PREFIX "%s: Could not resolve symbol '%s'\n", image->path,
+			SYMNAME(image, sym));
+		_kern_exit_team(1);
+	}
+
+	return address;
+}
+
+
 //	#pragma mark - libroot.so exported functions
 
 
@@ -565,9 +636,19 @@ load_program(char const *path, void **_entry)
 	// This results in the desired symbol resolution for dlopen()ed libraries.
 	set_image_flags_recursively(gProgramImage, RTLD_GLOBAL);
 
-	status = relocate_dependencies(gProgramImage);
-	if (status < B_OK)
-		goto err;
+	{
+		// use the persistent relocation cache, if enabled
+		RelocationCache relocationCache;
+		bool useRelocationCache = relocationCache.Init(gProgramImage) == B_OK;
+
+		status = relocate_dependencies(gProgramImage,
+			useRelocationCache ? &relocationCache : NULL);
+		if (status < B_OK)
+			goto err;
+
+		if (useRelocationCache)
+			relocationCache.Store();
+	}
 
 	inject_runtime_loader_api(gProgramImage);
 
@@ -45,6 +45,15 @@ struct SymbolLookupInfo {
 
 
 struct SymbolLookupCache {
+	SymbolLookupCache()
+		:
+		fTableSize(0),
+		fValues(NULL),
+		fDSOs(NULL),
+		fValuesResolved(NULL)
+	{
+	}
+
 	SymbolLookupCache(image_t* image)
 		:
 		fTableSize(image->symhash != NULL ? image->symhash[1] : 0),
@@ -80,6 +89,11 @@ struct SymbolLookupCache {
 		free(fDSOs);
 	}
 
+	size_t TableSize() const
+	{
+		return fTableSize;
+	}
+
 	bool IsSymbolValueCached(size_t index) const
 	{
 		return index < fTableSize
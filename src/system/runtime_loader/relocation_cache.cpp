@@ -0,0 +1,461 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Persistent cache of the symbol resolutions done while relocating a program
+	and its dependencies.
+
+	The symbol lookups are the most expensive part of relocating the images
+	of a program, yet as long as the very same images are loaded in the same
+	order, they always yield the same results. When enabled via the
+	LD_RELOCATION_CACHE environment variable, the resolutions are stored in
+	a file per program in the user's cache directory. A resolution is stored
+	as the index of the image that defines the symbol and the symbol's offset
+	in it, so that the cache stays valid when the images are loaded at
+	different addresses. On the next launch the SymbolLookupCache of every
+	image is filled from the file before the image is relocated, and the
+	actual relocation code only falls back to looking up symbols that are
+	missing from it.
+
+	The file is only used when device, node, modification time, and size of
+	all loaded images match the ones recorded. Symbol patchers could change
+	the resolutions behind our back, so no cache is used when runtime loader
+	add-ons are loaded.
+*/
+
+
+#include "relocation_cache.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <find_directory_private.h>
+#include <syscalls.h>
+
+#include "add_ons.h"
+#include "elf_symbol_lookup.h"
+#include "images.h"
+#include "runtime_loader_private.h"
+
+
+static const char* const kEnableVariable = "LD_RELOCATION_CACHE";
+static const char* const kCacheSubDirectory = "runtime_loader";
+static const uint32 kFileMagic = 'rlcc';
+static const uint32 kFileVersion = 1;
+static const uint32 kNoImage = 0xffffffff;
+static const size_t kMaxFileSize = 16 * 1024 * 1024;
+
+
+struct RelocationCache::FileHeader {
+	uint32	magic;
+	uint32	version;
+	uint32	imageCount;
+	uint32	tableCount;
+};
+
+
+struct RelocationCache::ImageRecord {
+	int64	device;
+	int64	node;
+	int64	modifiedSeconds;
+	int64	modifiedNanoseconds;
+	int64	size;
+
+	bool operator==(const ImageRecord& other) const
+	{
+		return device == other.device && node == other.node
+			&& modifiedSeconds == other.modifiedSeconds
+			&& modifiedNanoseconds == other.modifiedNanoseconds
+			&& size == other.size;
+	}
+
+	bool operator!=(const ImageRecord& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+
+struct RelocationCache::TableHeader {
+	uint32	image;
+	uint32	entryCount;
+};
+
+
+struct RelocationCache::Entry {
+	uint32	symbol;
+		// index in the symbol table of the image the table belongs to
+	uint32	image;
+		// index of the image defining the symbol, or kNoImage
+	uint64	offset;
+		// symbol value relative to the defining image
+};
+
+
+RelocationCache::RelocationCache()
+	:
+	fImages(NULL),
+	fImageRecords(NULL),
+	fImageCount(0),
+	fData(NULL),
+	fDataSize(0),
+	fTableOffsets(NULL),
+	fRecorded(NULL),
+	fRecordedSize(0),
+	fRecordedCapacity(0),
+	fRecordingFailed(false)
+{
+	fPath[0] = '\0';
+}
+
+
+RelocationCache::~RelocationCache()
+{
+	free(fImages);
+	free(fImageRecords);
+	free(fData);
+	free(fTableOffsets);
+	free(fRecorded);
+}
+
+
+/*!	Prepares the cache for relocating \a programImage and all images loaded
+	so far. Returns an error, if the cache is disabled or cannot be used; the
+	object must not be used then. Otherwise it has been read, if it matches
+	the loaded images.
+*/
+status_t
+RelocationCache::Init(image_t* programImage)
+{
+	const char* enable = getenv(kEnableVariable);
+	if (enable == NULL || enable[0] == '\0' || strcmp(enable, "0") == 0)
+		return B_NOT_SUPPORTED;
+
+	if (have_add_ons())
+		return B_NOT_SUPPORTED;
+
+	fImageCount = count_loaded_images();
+	fImages = (image_t**)malloc(sizeof(image_t*) * fImageCount);
+	fImageRecords = (ImageRecord*)malloc(sizeof(ImageRecord) * fImageCount);
+	fTableOffsets = (size_t*)calloc(fImageCount, sizeof(size_t));
+	if (fImages == NULL || fImageRecords == NULL || fTableOffsets == NULL)
+		return B_NO_MEMORY;
+
+	int32 index = 0;
+	for (image_t* image = get_loaded_images().head; image != NULL;
+			image = image->next) {
+		if (index == fImageCount)
+			return B_ERROR;
+
+		if (image->defined_symbol_patchers != NULL
+			|| image->undefined_symbol_patchers != NULL) {
+			return B_NOT_SUPPORTED;
+		}
+
+		struct stat stat;
+		status_t status = _kern_read_stat(-1, image->path, true, &stat,
+			sizeof(struct stat));
+		if (status != B_OK)
+			return status;
+
+		ImageRecord& record = fImageRecords[index];
+		memset(&record, 0, sizeof(record));
+		record.device = stat.st_dev;
+		record.node = stat.st_ino;
+		record.modifiedSeconds = stat.st_mtim.tv_sec;
+		record.modifiedNanoseconds = stat.st_mtim.tv_nsec;
+		record.size = stat.st_size;
+
+		fImages[index++] = image;
+	}
+	if (index != fImageCount)
+		return B_ERROR;
+
+	int32 programIndex = _IndexOf(programImage);
+	if (programIndex < 0)
+		return B_BAD_VALUE;
+
+	status_t status = __find_directory(B_USER_CACHE_DIRECTORY, -1, false,
+		fPath, sizeof(fPath));
+	if (status != B_OK)
+		return status;
+
+	const ImageRecord& program = fImageRecords[programIndex];
+	size_t length = strlen(fPath);
+	if (snprintf(fPath + length, sizeof(fPath) - length,
+			"/%s/%" B_PRIx64 "-%" B_PRIx64, kCacheSubDirectory,
+			program.device, program.node)
+			>= (int)(sizeof(fPath) - length)) {
+		return B_NAME_TOO_LONG;
+	}
+
+	if (_Read() != B_OK) {
+		free(fData);
+		fData = NULL;
+		fDataSize = 0;
+		memset(fTableOffsets, 0, sizeof(size_t) * fImageCount);
+	}
+
+	return B_OK;
+}
+
+
+//!	Fills \a cache with the cached resolutions of \a image's symbols.
+void
+RelocationCache::Restore(image_t* image, SymbolLookupCache& cache) const
+{
+	if (fData == NULL)
+		return;
+
+	int32 index = _IndexOf(image);
+	if (index < 0 || fTableOffsets[index] == 0)
+		return;
+
+	const TableHeader* header
+		= (const TableHeader*)(fData + fTableOffsets[index]);
+	const Entry* entries = (const Entry*)(header + 1);
+	for (uint32 i = 0; i < header->entryCount; i++) {
+		const Entry& entry = entries[i];
+		if (entry.symbol >= cache.TableSize())
+			continue;
+
+		if (entry.image == kNoImage) {
+			cache.SetSymbolValueAt(entry.symbol, (addr_t)entry.offset, NULL);
+			continue;
+		}
+
+		// TLS symbol values are offsets into the TLS block anyway
+		image_t* definingImage = fImages[entry.image];
+		addr_t value = (addr_t)entry.offset;
+		if (image->syms[entry.symbol].Type() != STT_TLS)
+			value += definingImage->regions[0].delta;
+		cache.SetSymbolValueAt(entry.symbol, value, definingImage);
+	}
+}
+
+
+//!	Records the resolutions of \a image's symbols after relocating it.
+void
+RelocationCache::Record(image_t* image, const SymbolLookupCache& cache)
+{
+	if (fData != NULL || fRecordingFailed)
+		return;
+
+	int32 index = _IndexOf(image);
+	if (index < 0) {
+		fRecordingFailed = true;
+		return;
+	}
+
+	TableHeader header;
+	header.image = index;
+	header.entryCount = 0;
+	size_t headerOffset = fRecordedSize;
+	if (!_Append(&header, sizeof(header)))
+		return;
+
+	uint32 entryCount = 0;
+	for (size_t i = 0; i < cache.TableSize(); i++) {
+		if (!cache.IsSymbolValueCached(i))
+			continue;
+
+		image_t* definingImage;
+		addr_t value = cache.SymbolValueAt(i, &definingImage);
+
+		Entry entry;
+		entry.symbol = i;
+		entry.image = kNoImage;
+		entry.offset = value;
+		if (definingImage != NULL) {
+			int32 definingIndex = _IndexOf(definingImage);
+			if (definingIndex < 0) {
+				fRecordingFailed = true;
+				return;
+			}
+
+			entry.image = definingIndex;
+			if (image->syms[i].Type() != STT_TLS)
+				entry.offset = value - definingImage->regions[0].delta;
+		}
+
+		if (!_Append(&entry, sizeof(entry)))
+			return;
+		entryCount++;
+	}
+
+	((TableHeader*)(fRecorded + headerOffset))->entryCount = entryCount;
+}
+
+
+/*!	Writes the recorded resolutions to the cache file, unless the file was
+	up to date already.
+*/
+void
+RelocationCache::Store()
+{
+	if (fData != NULL || fRecordingFailed || fRecorded == NULL)
+		return;
+
+	// make sure the cache directory exists
+	char* lastSlash = strrchr(fPath, '/');
+	*lastSlash = '\0';
+	_kern_create_dir(-1, fPath, 0755);
+	*lastSlash = '/';
+
+	// write to a temporary file first, so that concurrently launched teams
+	// never see an incomplete file
+	char tempPath[B_PATH_NAME_LENGTH];
+	if (snprintf(tempPath, sizeof(tempPath), "%s.%" B_PRId32, fPath,
+			find_thread(NULL)) >= (int)sizeof(tempPath)) {
+		return;
+	}
+
+	int fd = _kern_open(-1, tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return;
+
+	uint32 tableCount = 0;
+	for (size_t offset = 0; offset < fRecordedSize;) {
+		const TableHeader* header = (const TableHeader*)(fRecorded + offset);
+		offset += sizeof(TableHeader) + header->entryCount * sizeof(Entry);
+		tableCount++;
+	}
+
+	FileHeader header;
+	header.magic = kFileMagic;
+	header.version = kFileVersion;
+	header.imageCount = fImageCount;
+	header.tableCount = tableCount;
+
+	size_t recordsSize = sizeof(ImageRecord) * fImageCount;
+	bool success = _kern_write(fd, -1, &header, sizeof(header))
+			== (ssize_t)sizeof(header)
+		&& _kern_write(fd, -1, fImageRecords, recordsSize)
+			== (ssize_t)recordsSize
+		&& _kern_write(fd, -1, fRecorded, fRecordedSize)
+			== (ssize_t)fRecordedSize;
+	_kern_close(fd);
+
+	if (!success || _kern_rename(-1, tempPath, -1, fPath) != B_OK)
+		_kern_unlink(-1, tempPath);
+}
+
+
+int32
+RelocationCache::_IndexOf(const image_t* image) const
+{
+	for (int32 i = 0; i < fImageCount; i++) {
+		if (fImages[i] == image)
+			return i;
+	}
+
+	return -1;
+}
+
+
+status_t
+RelocationCache::_Read()
+{
+	int fd = _kern_open(-1, fPath, O_RDONLY, 0);
+	if (fd < 0)
+		return fd;
+
+	struct stat stat;
+	status_t status = _kern_read_stat(fd, NULL, false, &stat,
+		sizeof(struct stat));
+	if (status != B_OK) {
+		_kern_close(fd);
+		return status;
+	}
+
+	if (stat.st_size < (off_t)sizeof(FileHeader)
+		|| stat.st_size > (off_t)kMaxFileSize) {
+		_kern_close(fd);
+		return B_BAD_DATA;
+	}
+
+	fDataSize = stat.st_size;
+	fData = (uint8*)malloc(fDataSize);
+	if (fData == NULL) {
+		_kern_close(fd);
+		return B_NO_MEMORY;
+	}
+
+	ssize_t bytesRead = _kern_read(fd, 0, fData, fDataSize);
+	_kern_close(fd);
+	if (bytesRead != (ssize_t)fDataSize)
+		return B_IO_ERROR;
+
+	// check whether the file belongs to the images we have loaded
+	const FileHeader* header = (const FileHeader*)fData;
+	if (header->magic != kFileMagic || header->version != kFileVersion
+		|| header->imageCount != (uint32)fImageCount) {
+		return B_BAD_DATA;
+	}
+
+	size_t offset = sizeof(FileHeader);
+	if (offset + sizeof(ImageRecord) * fImageCount > fDataSize)
+		return B_BAD_DATA;
+
+	const ImageRecord* records = (const ImageRecord*)(fData + offset);
+	for (int32 i = 0; i < fImageCount; i++) {
+		if (records[i] != fImageRecords[i])
+			return B_BAD_DATA;
+	}
+	offset += sizeof(ImageRecord) * fImageCount;
+
+	// locate and validate the tables
+	for (uint32 i = 0; i < header->tableCount; i++) {
+		if (offset + sizeof(TableHeader) > fDataSize)
+			return B_BAD_DATA;
+
+		const TableHeader* table = (const TableHeader*)(fData + offset);
+		if (table->image >= (uint32)fImageCount
+			|| table->entryCount > (fDataSize - offset - sizeof(TableHeader))
+				/ sizeof(Entry)) {
+			return B_BAD_DATA;
+		}
+
+		const Entry* entries = (const Entry*)(table + 1);
+		for (uint32 k = 0; k < table->entryCount; k++) {
+			if (entries[k].image != kNoImage
+				&& entries[k].image >= (uint32)fImageCount) {
+				return B_BAD_DATA;
+			}
+		}
+
+		fTableOffsets[table->image] = offset;
+		offset += sizeof(TableHeader) + table->entryCount * sizeof(Entry);
+	}
+
+	return offset == fDataSize ? B_OK : B_BAD_DATA;
+}
+
+
+bool
+RelocationCache::_Append(const void* data, size_t size)
+{
+	if (fRecordedSize + size > fRecordedCapacity) {
+		size_t capacity = fRecordedCapacity > 0 ? fRecordedCapacity * 2 : 4096;
+		while (capacity < fRecordedSize + size)
+			capacity *= 2;
+
+		uint8* recorded = (uint8*)realloc(fRecorded, capacity);
+		if (recorded == NULL) {
+			fRecordingFailed = true;
+			return false;
+		}
+
+		fRecorded = recorded;
+		fRecordedCapacity = capacity;
+	}
+
+	memcpy(fRecorded + fRecordedSize, data, size);
+	fRecordedSize += size;
+	return true;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef RELOCATION_CACHE_H
+#define RELOCATION_CACHE_H
+
+
+#include <runtime_loader.h>
+
+
+struct SymbolLookupCache;
+
+
+class RelocationCache {
+public:
+								RelocationCache();
+								~RelocationCache();
+
+			status_t			Init(image_t* programImage);
+
+			void				Restore(image_t* image,
+									SymbolLookupCache& cache) const;
+			void				Record(image_t* image,
+									const SymbolLookupCache& cache);
+			void				Store();
+
+private:
+			struct FileHeader;
+			struct ImageRecord;
+			struct TableHeader;
+			struct Entry;
+
+private:
+			int32				_IndexOf(const image_t* image) const;
+			status_t			_Read();
+			bool				_Append(const void* data, size_t size);
+
+private:
+			image_t**			fImages;
+			ImageRecord*		fImageRecords;
+			int32				fImageCount;
+			char				fPath[B_PATH_NAME_LENGTH];
+
+			// the cache file read, if it matched
+			uint8*				fData;
+			size_t				fDataSize;
+			size_t*				fTableOffsets;
+									// per image, 0 if it has no table
+
+			// the tables recorded while relocating, if it didn't
+			uint8*				fRecorded;
+			size_t				fRecordedSize;
+			size_t				fRecordedCapacity;
+			bool				fRecordingFailed;
+};
+
+
+#endif	// RELOCATION_CACHE_H
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Mounts a ramfs, and checks that SEEK_DATA and SEEK_HOLE, which the VFS
+	passes on as the FIOSEEKDATA and FIOSEEKHOLE ioctls, find the data and
+	holes DataContainer::SeekDataOrHole() knows about: in a small file, in a
+	sparse file, in a file that is one big hole, and at or past the end of
+	the file, where they must fail with ENXIO.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fs_volume.h>
+#include <OS.h>
+
+
+static const char* kMountPoint = "/tmp/ramfs_seek_data_test";
+static const off_t kSecondDataOffset = 1024 * 1024;
+static const off_t kSparseFileSize = 3 * 1024 * 1024;
+
+static int sFailures = 0;
+
+
+static void
+check_seek(int fd, off_t offset, int whence, off_t expected,
+	int expectedError, int line)
+{
+	errno = 0;
+	off_t result = lseek(fd, offset, whence);
+	int error = result < 0 ? errno : 0;
+
+	if (result == expected && error == expectedError)
+		return;
+
+	fprintf(stderr, "line %d: seeking to %s from %" B_PRIdOFF " returned %"
+		B_PRIdOFF " (%s), expected %" B_PRIdOFF " (%s)\n", line,
+		whence == SEEK_DATA ? "data" : "hole", offset, result,
+		strerror(error), expected, strerror(expectedError));
+	sFailures++;
+}
+
+
+#define CHECK_DATA(fd, offset, expected) \
+	check_seek(fd, offset, SEEK_DATA, expected, 0, __LINE__)
+#define CHECK_HOLE(fd, offset, expected) \
+	check_seek(fd, offset, SEEK_HOLE, expected, 0, __LINE__)
+#define CHECK_DATA_FAILS(fd, offset) \
+	check_seek(fd, offset, SEEK_DATA, -1, ENXIO, __LINE__)
+#define CHECK_HOLE_FAILS(fd, offset) \
+	check_seek(fd, offset, SEEK_HOLE, -1, ENXIO, __LINE__)
+
+
+static int
+create_file(const char* name)
+{
+	char path[B_PATH_NAME_LENGTH];
+	snprintf(path, sizeof(path), "%s/%s", kMountPoint, name);
+
+	int fd = open(path, O_CREAT | O_TRUNC | O_RDWR, 0644);
+	if (fd < 0) {
+		fprintf(stderr, "could not create %s: %s\n", path, strerror(errno));
+		sFailures++;
+	}
+	return fd;
+}
+
+
+static void
+write_at(int fd, off_t offset, size_t size)
+{
+	char buffer[B_PAGE_SIZE];
+	memset(buffer, 'x', sizeof(buffer));
+
+	while (size > 0) {
+		size_t toWrite = size < sizeof(buffer) ? size : sizeof(buffer);
+		if (pwrite(fd, buffer, toWrite, offset) != (ssize_t)toWrite) {
+			fprintf(stderr, "writing at %" B_PRIdOFF " failed: %s\n", offset,
+				strerror(errno));
+			sFailures++;
+			return;
+		}
+		offset += toWrite;
+		size -= toWrite;
+	}
+}
+
+
+static void
+test_small_file()
+{
+	// A small file is kept in a buffer of its own, without any holes
+	int fd = create_file("small");
+	if (fd < 0)
+		return;
+
+	write_at(fd, 0, 100);
+
+	CHECK_DATA(fd, 0, 0);
+	CHECK_DATA(fd, 50, 50);
+	CHECK_HOLE(fd, 0, 100);
+	CHECK_HOLE(fd, 99, 100);
+	CHECK_DATA_FAILS(fd, 100);
+	CHECK_HOLE_FAILS(fd, 100);
+
+	close(fd);
+}
+
+
+static void
+test_sparse_file()
+{
+	// data in the first page, one more page at 1 MB, and then a hole up to
+	// the end of the file
+	int fd = create_file("sparse");
+	if (fd < 0)
+		return;
+
+	write_at(fd, 0, 100);
+	write_at(fd, kSecondDataOffset, B_PAGE_SIZE);
+	if (ftruncate(fd, kSparseFileSize) != 0) {
+		fprintf(stderr, "resizing failed: %s\n", strerror(errno));
+		sFailures++;
+	}
+
+	CHECK_DATA(fd, 0, 0);
+	CHECK_HOLE(fd, 0, B_PAGE_SIZE);
+	CHECK_DATA(fd, 50, 50);
+	CHECK_DATA(fd, B_PAGE_SIZE, kSecondDataOffset);
+	CHECK_HOLE(fd, B_PAGE_SIZE + 10, B_PAGE_SIZE + 10);
+	CHECK_DATA(fd, kSecondDataOffset + 10, kSecondDataOffset + 10);
+	CHECK_HOLE(fd, kSecondDataOffset, kSecondDataOffset + B_PAGE_SIZE);
+
+	// there is no data after the second page, but the hole goes on to the
+	// end of the file
+	CHECK_DATA_FAILS(fd, kSecondDataOffset + B_PAGE_SIZE);
+	CHECK_HOLE(fd, kSparseFileSize - 1, kSparseFileSize - 1);
+
+	CHECK_DATA_FAILS(fd, kSparseFileSize);
+	CHECK_HOLE_FAILS(fd, kSparseFileSize);
+	CHECK_DATA_FAILS(fd, kSparseFileSize + B_PAGE_SIZE);
+	CHECK_HOLE_FAILS(fd, kSparseFileSize + B_PAGE_SIZE);
+
+	close(fd);
+}
+
+
+static void
+test_hole_only_file()
+{
+	// a file that has only been resized doesn't have any data at all
+	int fd = create_file("holes");
+	if (fd < 0)
+		return;
+
+	if (ftruncate(fd, kSparseFileSize) != 0) {
+		fprintf(stderr, "resizing failed: %s\n", strerror(errno));
+		sFailures++;
+	}
+
+	CHECK_DATA_FAILS(fd, 0);
+	CHECK_DATA_FAILS(fd, kSparseFileSize / 2);
+	CHECK_HOLE(fd, 0, 0);
+	CHECK_HOLE(fd, kSparseFileSize / 2, kSparseFileSize / 2);
+	CHECK_DATA_FAILS(fd, kSparseFileSize);
+	CHECK_HOLE_FAILS(fd, kSparseFileSize);
+
+	close(fd);
+}
+
+
+static void
+test_empty_file()
+{
+	int fd = create_file("empty");
+	if (fd < 0)
+		return;
+
+	CHECK_DATA_FAILS(fd, 0);
+	CHECK_HOLE_FAILS(fd, 0);
+
+	close(fd);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	if (mkdir(kMountPoint, 0755) != 0 && errno != EEXIST) {
+		fprintf(stderr, "could not create %s: %s\n", kMountPoint,
+			strerror(errno));
+		return 1;
+	}
+
+	dev_t volume = fs_mount_volume(kMountPoint, NULL, "ramfs", 0, NULL);
+	if (volume < 0) {
+		fprintf(stderr, "could not mount ramfs: %s\n", strerror(volume));
+		rmdir(kMountPoint);
+		return 1;
+	}
+
+	test_small_file();
+	test_sparse_file();
+	test_hole_only_file();
+	test_empty_file();
+
+	status_t status = fs_unmount_volume(kMountPoint, 0);
+	if (status != B_OK)
+		fprintf(stderr, "could not unmount ramfs: %s\n", strerror(status));
+	else
+		rmdir(kMountPoint);
+
+	if (sFailures > 0) {
+		fprintf(stderr, "%d checks failed\n", sFailures);
+		return 1;
+	}
+
+	printf("all tests passed\n");
+	return 0;
+}
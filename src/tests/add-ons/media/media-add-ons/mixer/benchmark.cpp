@@ -0,0 +1,177 @@
+/* Copyright 2026 Haiku, Inc.
+ * Distributed under the terms of the MIT license.
+ */
+
+
+/*!	Runs the processing chain of the mixer's MixerCore/MixerInput offline:
+	every synthetic input is resampled into its planar ring buffer, all of
+	them are mixed into the output channels, and the result is converted
+	into the output format, just like MixerCore::_MixThread() does it.
+*/
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <MediaDefs.h>
+#include <OS.h>
+
+#include <Interpolate.h>
+#include <MixerKernels.h>
+#include <MixerSettings.h>
+#include <Polyphase.h>
+#include <Resampler.h>
+
+
+static const int32 kChannels = 2;
+static const int32 kOutputRate = 48000;
+static const int32 kOutputFrames = 512;
+static const int32 kIterations = 2000;
+
+
+struct Input {
+	int16*		data;
+	int32		frames;
+	float*		mixBuffer;
+	Resampler*	resampler[kChannels];
+};
+
+
+static Resampler*
+create_resampler(int algorithm, uint32 sourceFormat, uint32 destFormat)
+{
+	switch (algorithm) {
+		case RESAMPLING_INTERPOLATE:
+			return new Interpolate(sourceFormat, destFormat);
+		case RESAMPLING_POLYPHASE_SINC:
+			return new Polyphase(sourceFormat, destFormat);
+		default:
+			return new Resampler(sourceFormat, destFormat);
+	}
+}
+
+
+static bigtime_t
+run(int algorithm, int32 inputCount, int32 inputRate)
+{
+	Input* inputs = new Input[inputCount];
+	for (int32 i = 0; i < inputCount; i++) {
+		Input& input = inputs[i];
+		input.frames = (int64)kOutputFrames * inputRate / kOutputRate;
+		input.data = new int16[input.frames * kChannels];
+		for (int32 frame = 0; frame < input.frames; frame++) {
+			for (int32 channel = 0; channel < kChannels; channel++) {
+				input.data[frame * kChannels + channel] = (int16)(8000
+					* sin(2 * M_PI * (440 + 110 * i) * frame / inputRate
+						+ channel));
+			}
+		}
+		input.mixBuffer = new float[kOutputFrames * kChannels];
+		for (int32 channel = 0; channel < kChannels; channel++) {
+			input.resampler[channel] = create_resampler(algorithm,
+				media_raw_audio_format::B_AUDIO_SHORT,
+				media_raw_audio_format::B_AUDIO_FLOAT);
+		}
+	}
+
+	float* mixBuffer = new float[kOutputFrames * kChannels];
+	int16* output = new int16[kOutputFrames * kChannels];
+	Resampler* outputResampler[kChannels];
+	for (int32 channel = 0; channel < kChannels; channel++) {
+		outputResampler[channel] = create_resampler(algorithm,
+			media_raw_audio_format::B_AUDIO_FLOAT,
+			media_raw_audio_format::B_AUDIO_SHORT);
+	}
+
+	bigtime_t start = system_time();
+
+	for (int32 iteration = 0; iteration < kIterations; iteration++) {
+		// MixerInput::BufferReceived()
+		for (int32 i = 0; i < inputCount; i++) {
+			Input& input = inputs[i];
+			for (int32 channel = 0; channel < kChannels; channel++) {
+				input.resampler[channel]->Resample(input.data + channel,
+					kChannels * sizeof(int16), input.frames,
+					input.mixBuffer + channel * kOutputFrames, sizeof(float),
+					kOutputFrames, 1.0f);
+			}
+		}
+
+		// MixerCore::_MixThread()
+		memset(mixBuffer, 0, kOutputFrames * kChannels * sizeof(float));
+		for (int32 channel = 0; channel < kChannels; channel++) {
+			for (int32 i = 0; i < inputCount; i++) {
+				mix_samples(mixBuffer + channel * kOutputFrames,
+					inputs[i].mixBuffer + channel * kOutputFrames,
+					1.0f / inputCount, kOutputFrames);
+			}
+		}
+		for (int32 channel = 0; channel < kChannels; channel++) {
+			outputResampler[channel]->Resample(
+				mixBuffer + channel * kOutputFrames, sizeof(float),
+				kOutputFrames, output + channel, kChannels * sizeof(int16),
+				kOutputFrames, 1.0f);
+		}
+	}
+
+	bigtime_t duration = system_time() - start;
+
+	for (int32 channel = 0; channel < kChannels; channel++)
+		delete outputResampler[channel];
+	delete[] output;
+	delete[] mixBuffer;
+	for (int32 i = 0; i < inputCount; i++) {
+		for (int32 channel = 0; channel < kChannels; channel++)
+			delete inputs[i].resampler[channel];
+		delete[] inputs[i].mixBuffer;
+		delete[] inputs[i].data;
+	}
+	delete[] inputs;
+
+	return duration;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 inputCount = 16;
+	if (argc > 1)
+		inputCount = atoi(argv[1]);
+	if (inputCount < 1) {
+		fprintf(stderr, "usage: %s [input count]\n", argv[0]);
+		return 1;
+	}
+
+	static const struct {
+		int			algorithm;
+		const char*	name;
+	} kAlgorithms[] = {
+		{ RESAMPLING_DROP_REPEAT, "drop/repeat" },
+		{ RESAMPLING_INTERPOLATE, "linear interpolation" },
+		{ RESAMPLING_POLYPHASE_SINC, "windowed sinc" },
+	};
+	static const int32 kInputRates[] = { 48000, 44100, 22050 };
+
+	bigtime_t bufferDuration = (bigtime_t)kOutputFrames * 1000000
+		/ kOutputRate;
+	printf("%" B_PRId32 " stereo inputs, %" B_PRId32 " frames at %" B_PRId32
+		" Hz per buffer (%" B_PRIdBIGTIME " us)\n", inputCount, kOutputFrames,
+		kOutputRate, bufferDuration);
+
+	for (size_t i = 0; i < sizeof(kAlgorithms) / sizeof(kAlgorithms[0]); i++) {
+		for (size_t j = 0; j < sizeof(kInputRates) / sizeof(kInputRates[0]);
+				j++) {
+			bigtime_t duration = run(kAlgorithms[i].algorithm, inputCount,
+				kInputRates[j]);
+			double perBuffer = double(duration) / kIterations;
+			printf("%-22s %6" B_PRId32 " Hz: %8.2f us per buffer, %5.2f%% "
+				"of real time\n", kAlgorithms[i].name, kInputRates[j],
+				perBuffer, 100.0 * perBuffer / bufferDuration);
+		}
+	}
+
+	return 0;
+}
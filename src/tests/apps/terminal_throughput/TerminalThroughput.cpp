@@ -0,0 +1,224 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures how fast Terminal's parser gets data into the terminal buffer,
+	without any view attached to it.
+
+	The data is written to one end of a socket pair, while TermParse reads from
+	the other one like it would from a pty. Once all of it has been written, a
+	device status report is requested; the parser answers it only after it has
+	processed everything before it, so the data itself must not contain one.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+#include "TermApp.h"
+#include "TerminalBuffer.h"
+#include "TermParse.h"
+
+
+rgb_color TermApp::fDefaultPalette[kTermColorCount];
+
+
+static const size_t kDefaultSize = 64 * 1024 * 1024;
+static const char* const kStatusRequest = "\033[5n";
+static const char* const kStatusReply = "\033[0n";
+
+
+struct write_data {
+	int			fd;
+	const char*	data;
+	size_t		size;
+};
+
+
+static char*
+make_text(size_t size)
+{
+	char* text = (char*)malloc(size);
+	if (text == NULL)
+		return NULL;
+
+	// lines of varying length, with the occasional colored word
+	size_t offset = 0;
+	int32 line = 0;
+	while (offset < size) {
+		char buffer[256];
+		int length = snprintf(buffer, sizeof(buffer),
+			"-rw-r--r-- 1 user users %8" B_PRId32 " Oct 19 12:00 "
+			"\033[01;34mdirectory_%" B_PRId32 "\033[0m/%.*s\r\n",
+			line * 37, line, (int)(line % 40),
+			"some_file_name_with_a_long_extension.txt");
+		if (length > (int)(size - offset))
+			length = size - offset;
+
+		memcpy(text + offset, buffer, length);
+		offset += length;
+		line++;
+	}
+
+	return text;
+}
+
+
+static char*
+read_file(const char* path, size_t& _size)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return NULL;
+	}
+
+	char* data = (char*)malloc(st.st_size);
+	if (data == NULL) {
+		close(fd);
+		return NULL;
+	}
+
+	ssize_t bytesRead = read(fd, data, st.st_size);
+	close(fd);
+
+	if (bytesRead != st.st_size) {
+		free(data);
+		return NULL;
+	}
+
+	_size = st.st_size;
+	return data;
+}
+
+
+static status_t
+write_all(int fd, const char* data, size_t size)
+{
+	while (size > 0) {
+		ssize_t bytesWritten = write(fd, data, size);
+		if (bytesWritten < 0) {
+			if (errno == EINTR)
+				continue;
+			return errno;
+		}
+
+		data += bytesWritten;
+		size -= bytesWritten;
+	}
+
+	return B_OK;
+}
+
+
+static status_t
+writer_thread(void* _data)
+{
+	write_data* data = (write_data*)_data;
+
+	status_t status = write_all(data->fd, data->data, data->size);
+	if (status == B_OK)
+		status = write_all(data->fd, kStatusRequest, strlen(kStatusRequest));
+
+	return status;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	size_t size = kDefaultSize;
+	char* data;
+	if (argc > 1) {
+		data = read_file(argv[1], size);
+		if (data == NULL) {
+			fprintf(stderr, "Could not read \"%s\": %s\n", argv[1],
+				strerror(errno));
+			return 1;
+		}
+	} else
+		data = make_text(size);
+
+	if (data == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	int sockets[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+		fprintf(stderr, "Could not create sockets: %s\n", strerror(errno));
+		return 1;
+	}
+
+	TerminalBuffer buffer;
+	status_t status = buffer.Init(80, 25, 10000);
+	if (status != B_OK) {
+		fprintf(stderr, "Could not init buffer: %s\n", strerror(status));
+		return 1;
+	}
+
+	TermParse parser(sockets[0]);
+	status = parser.StartThreads(&buffer);
+	if (status != B_OK) {
+		fprintf(stderr, "Could not start parser: %s\n", strerror(status));
+		return 1;
+	}
+
+	write_data writeData = { sockets[1], data, size };
+
+	bigtime_t start = system_time();
+
+	thread_id writer = spawn_thread(writer_thread, "writer",
+		B_NORMAL_PRIORITY, &writeData);
+	resume_thread(writer);
+
+	// wait for the status reply
+	size_t replyLength = strlen(kStatusReply);
+	char reply[16];
+	size_t received = 0;
+	while (received < replyLength) {
+		ssize_t bytesRead = read(sockets[1], reply + received,
+			replyLength - received);
+		if (bytesRead <= 0) {
+			if (bytesRead < 0 && errno == EINTR)
+				continue;
+			fprintf(stderr, "Reading the reply failed\n");
+			return 1;
+		}
+		received += bytesRead;
+	}
+
+	bigtime_t time = system_time() - start;
+
+	wait_for_thread(writer, &status);
+	if (status != B_OK)
+		fprintf(stderr, "Writing failed: %s\n", strerror(status));
+
+	close(sockets[1]);
+	parser.StopThreads();
+	close(sockets[0]);
+
+	if (memcmp(reply, kStatusReply, replyLength) != 0) {
+		fprintf(stderr, "Unexpected reply\n");
+		return 1;
+	}
+
+	printf("%" B_PRIuSIZE " bytes in %" B_PRId64 " us, %.1f MB/s\n", size,
+		time, size / (time / 1000000.0) / (1024 * 1024));
+
+	free(data);
+	return 0;
+}
@@ -0,0 +1,310 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures the cost of the hot BMessage operations for two typical message
+	shapes, a small input event and a larger notification with strings:
+	building the message with and without reserving its space up front,
+	flattening it, unflattening it by copying and in place, and looking up
+	its fields.
+*/
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <AppDefs.h>
+#include <Message.h>
+#include <OS.h>
+
+#include <MessagePrivate.h>
+
+
+static const message_field_schema kMouseMovedSchema[] = {
+	{ "when", 1, sizeof(int64), true },
+	{ "where", 1, sizeof(BPoint), true },
+	{ "buttons", 1, sizeof(int32), true },
+	{ "modifiers", 1, sizeof(int32), true },
+	{ "be:transit", 1, sizeof(int32), true },
+	{ "be:view_where", 1, sizeof(BPoint), true }
+};
+
+static const message_field_schema kNotificationSchema[] = {
+	{ "be:node", 1, 64, false },
+	{ "be:time_source", 1, sizeof(int32), true },
+	{ "be:format", 1, 64, false },
+	{ "be:name", 1, 32, false },
+	{ "be:start_time", 1, sizeof(int64), true },
+	{ "be:performance_time", 1, sizeof(int64), true },
+	{ "be:latency", 1, sizeof(int64), true },
+	{ "be:buffer_ids", 16, sizeof(int32), true },
+	{ "be:parameter", 4, sizeof(float), true },
+	{ "be:what", 1, sizeof(int32), true }
+};
+
+
+struct benchmark_result {
+	const char*	name;
+	bigtime_t	time;
+};
+
+
+static void
+build_mouse_moved(BMessage& message, bool reserve)
+{
+	message.what = B_MOUSE_MOVED;
+	if (reserve) {
+		BMessage::Private(message).Reserve(kMouseMovedSchema,
+			B_COUNT_OF(kMouseMovedSchema));
+	}
+
+	message.AddInt64("when", 123456789LL);
+	message.AddPoint("where", BPoint(320, 240));
+	message.AddInt32("buttons", 1);
+	message.AddInt32("modifiers", 0);
+	message.AddInt32("be:transit", 1);
+	message.AddPoint("be:view_where", BPoint(20, 40));
+}
+
+
+static void
+build_notification(BMessage& message, bool reserve)
+{
+	message.what = 'mntf';
+	if (reserve) {
+		BMessage::Private(message).Reserve(kNotificationSchema,
+			B_COUNT_OF(kNotificationSchema));
+	}
+
+	message.AddData("be:node", B_RAW_TYPE,
+		"node data that is about as large as a media_node", 48, false);
+	message.AddInt32("be:time_source", 7);
+	message.AddData("be:format", B_RAW_TYPE,
+		"a raw audio format with a couple of fields in it", 48, false);
+	message.AddString("be:name", "System Mixer");
+	message.AddInt64("be:start_time", 1000000LL);
+	message.AddInt64("be:performance_time", 2000000LL);
+	message.AddInt64("be:latency", 5000LL);
+	for (int32 i = 0; i < 16; i++)
+		message.AddInt32("be:buffer_ids", i);
+	for (int32 i = 0; i < 4; i++)
+		message.AddFloat("be:parameter", i * 0.25f);
+	message.AddInt32("be:what", 42);
+}
+
+
+static void
+look_up_mouse_moved(const BMessage& message)
+{
+	int64 when;
+	BPoint where;
+	int32 buttons;
+	int32 modifiers;
+	int32 transit;
+	message.FindInt64("when", &when);
+	message.FindPoint("where", &where);
+	message.FindInt32("buttons", &buttons);
+	message.FindInt32("modifiers", &modifiers);
+	message.FindInt32("be:transit", &transit);
+}
+
+
+static void
+look_up_notification(const BMessage& message)
+{
+	const char* name;
+	int64 time;
+	int32 id;
+	message.FindString("be:name", &name);
+	message.FindInt64("be:start_time", &time);
+	message.FindInt64("be:performance_time", &time);
+	for (int32 i = 0; i < 16; i++)
+		message.FindInt32("be:buffer_ids", i, &id);
+	message.FindInt32("be:what", &id);
+}
+
+
+/*!	Simulates reading the flattened message from a port: the port buffer is
+	always freshly allocated.
+*/
+static void*
+read_port_buffer(const char* flat, ssize_t size)
+{
+	void* buffer = malloc(size);
+	if (buffer != NULL)
+		memcpy(buffer, flat, size);
+	return buffer;
+}
+
+
+static bool
+check_in_place(const BMessage& original, const char* flat, ssize_t size)
+{
+	BMessage copy;
+	if (copy.Unflatten(flat) != B_OK)
+		return false;
+
+	BMessage inPlace;
+	void* buffer = read_port_buffer(flat, size);
+	if (BMessage::Private(inPlace).UnflattenInPlace(buffer, size) != B_OK)
+		return false;
+
+	if (!inPlace.HasSameData(original) || !inPlace.HasSameData(copy)
+		|| inPlace.what != original.what) {
+		return false;
+	}
+
+	// changing the message must detach it from the port buffer
+	if (inPlace.AddInt32("added", 1) != B_OK
+		|| inPlace.RemoveName("added") != B_OK
+		|| !inPlace.HasSameData(original)) {
+		return false;
+	}
+
+	// a truncated buffer must be rejected
+	buffer = read_port_buffer(flat, size);
+	return BMessage::Private(inPlace).UnflattenInPlace(buffer, size - 1)
+		!= B_OK;
+}
+
+
+static int32
+run_benchmarks(const char* name, void (*build)(BMessage&, bool),
+	void (*lookUp)(const BMessage&), int32 iterations)
+{
+	BMessage original;
+	build(original, false);
+
+	ssize_t size = original.FlattenedSize();
+	char* flat = (char*)malloc(size);
+	if (flat == NULL || original.Flatten(flat, size) != B_OK) {
+		free(flat);
+		fprintf(stderr, "%s: could not flatten message\n", name);
+		return 1;
+	}
+
+	if (!check_in_place(original, flat, size)) {
+		fprintf(stderr, "%s: in place unflattening is broken\n", name);
+		free(flat);
+		return 1;
+	}
+
+	benchmark_result results[6];
+	int32 resultCount = 0;
+
+	bigtime_t start = system_time();
+	for (int32 i = 0; i < iterations; i++) {
+		BMessage message;
+		build(message, false);
+	}
+	results[resultCount].name = "build";
+	results[resultCount++].time = system_time() - start;
+
+	start = system_time();
+	for (int32 i = 0; i < iterations; i++) {
+		BMessage message;
+		build(message, true);
+	}
+	results[resultCount].name = "build reserved";
+	results[resultCount++].time = system_time() - start;
+
+	char* buffer = (char*)malloc(size);
+	start = system_time();
+	for (int32 i = 0; i < iterations; i++)
+		original.Flatten(buffer, size);
+	results[resultCount].name = "flatten";
+	results[resultCount++].time = system_time() - start;
+	free(buffer);
+
+	start = system_time();
+	for (int32 i = 0; i < iterations; i++) {
+		void* portBuffer = read_port_buffer(flat, size);
+		BMessage message;
+		message.Unflatten((const char*)portBuffer);
+		free(portBuffer);
+	}
+	results[resultCount].name = "unflatten copy";
+	results[resultCount++].time = system_time() - start;
+
+	start = system_time();
+	for (int32 i = 0; i < iterations; i++) {
+		void* portBuffer = read_port_buffer(flat, size);
+		BMessage message;
+		BMessage::Private(message).UnflattenInPlace(portBuffer, size);
+	}
+	results[resultCount].name = "unflatten in place";
+	results[resultCount++].time = system_time() - start;
+
+	start = system_time();
+	for (int32 i = 0; i < iterations; i++)
+		lookUp(original);
+	results[resultCount].name = "find fields";
+	results[resultCount++].time = system_time() - start;
+
+	free(flat);
+
+	printf("%s (%" B_PRIdSSIZE " bytes flattened, %" B_PRId32 " fields):\n",
+		name, size, original.CountNames(B_ANY_TYPE));
+	for (int32 i = 0; i < resultCount; i++) {
+		printf("  %-20s %10.1f ns\n", results[i].name,
+			results[i].time * 1000.0 / iterations);
+	}
+	putchar('\n');
+
+	return 0;
+}
+
+
+static void
+print_usage(const char* name, bool error)
+{
+	fprintf(error ? stderr : stdout,
+		"Usage: %s [options]\n"
+		"Measures building, flattening, unflattening and querying typical\n"
+		"messages.\n"
+		"\n"
+		"Options:\n"
+		"  -i <iterations>  number of iterations (default 200000)\n"
+		"  -h, --help       print this help\n", name);
+	exit(error ? 1 : 0);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 iterations = 200000;
+
+	const struct option kLongOptions[] = {
+		{ "help", no_argument, 0, 'h' },
+		{ 0, 0, 0, 0 }
+	};
+
+	int c;
+	while ((c = getopt_long(argc, argv, "i:h", kLongOptions, NULL)) != -1) {
+		switch (c) {
+			case 'i':
+				iterations = atol(optarg);
+				break;
+			case 'h':
+				print_usage(argv[0], false);
+				break;
+			default:
+				print_usage(argv[0], true);
+				break;
+		}
+	}
+
+	if (iterations <= 0)
+		print_usage(argv[0], true);
+
+	int32 failures = run_benchmarks("mouse moved", build_mouse_moved,
+		look_up_mouse_moved, iterations);
+	failures += run_benchmarks("media notification", build_notification,
+		look_up_notification, iterations);
+
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Checks that the dedicated color space converters produce exactly the same
+	output as the generic conversion, and compares their speed on a large
+	frame.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+#include <ColorConversion.h>
+
+
+using BPrivate::ConvertBits;
+using BPrivate::SetFastColorConversionEnabled;
+
+
+struct conversion_pair {
+	color_space	source;
+	color_space	dest;
+	const char*	name;
+};
+
+
+static const conversion_pair kPairs[] = {
+	{ B_RGB24, B_RGB32, "RGB24 -> RGB32" },
+	{ B_RGB24, B_RGBA32, "RGB24 -> RGBA32" },
+	{ B_RGB32, B_RGB24, "RGB32 -> RGB24" },
+	{ B_RGBA32, B_RGB24, "RGBA32 -> RGB24" },
+	{ B_RGB32, B_RGBA32, "RGB32 -> RGBA32" },
+	{ B_RGBA32, B_RGB32, "RGBA32 -> RGB32" },
+	{ B_RGB32, B_RGB16, "RGB32 -> RGB16" },
+	{ B_RGBA32, B_RGB16, "RGBA32 -> RGB16" },
+	{ B_RGB32, B_RGB15, "RGB32 -> RGB15" },
+	{ B_RGBA32, B_RGB15, "RGBA32 -> RGB15" },
+	{ B_RGB32, B_RGBA15, "RGB32 -> RGBA15" },
+	{ B_RGBA32, B_RGBA15, "RGBA32 -> RGBA15" },
+	{ B_RGB16, B_RGB32, "RGB16 -> RGB32" },
+	{ B_RGB16, B_RGBA32, "RGB16 -> RGBA32" },
+	{ B_RGB15, B_RGB32, "RGB15 -> RGB32" },
+	{ B_RGB15, B_RGBA32, "RGB15 -> RGBA32" },
+	{ B_RGBA15, B_RGB32, "RGBA15 -> RGB32" },
+	{ B_RGBA15, B_RGBA32, "RGBA15 -> RGBA32" },
+	{ B_CMAP8, B_RGB32, "CMAP8 -> RGB32" },
+	{ B_CMAP8, B_RGBA32, "CMAP8 -> RGBA32" }
+};
+
+static const int32 kBenchmarkWidth = 3840;
+static const int32 kBenchmarkHeight = 2160;
+
+
+static int32
+bytes_per_pixel(color_space space)
+{
+	switch (space) {
+		case B_CMAP8:
+			return 1;
+		case B_RGB15:
+		case B_RGBA15:
+		case B_RGB16:
+			return 2;
+		case B_RGB24:
+			return 3;
+		default:
+			return 4;
+	}
+}
+
+
+/*!	Converts a \a width x \a height frame with both the generic and the fast
+	conversion, and returns whether the results are identical.
+*/
+static bool
+compare(const conversion_pair& pair, int32 width, int32 height,
+	bigtime_t* _genericTime, bigtime_t* _fastTime)
+{
+	// make the source rows a bit larger than needed to catch padding bugs
+	int32 sourceBytesPerRow = (width * bytes_per_pixel(pair.source) + 7) & ~3;
+	int32 destBytesPerRow = (width * bytes_per_pixel(pair.dest) + 3) & ~3;
+	int32 sourceLength = sourceBytesPerRow * height;
+	int32 destLength = destBytesPerRow * height;
+
+	uint8* source = (uint8*)malloc(sourceLength);
+	uint8* generic = (uint8*)malloc(destLength);
+	uint8* fast = (uint8*)malloc(destLength);
+	if (source == NULL || generic == NULL || fast == NULL) {
+		free(source);
+		free(generic);
+		free(fast);
+		return false;
+	}
+
+	for (int32 i = 0; i < sourceLength; i++)
+		source[i] = rand();
+	memset(generic, 0x5a, destLength);
+	memset(fast, 0x5a, destLength);
+
+	SetFastColorConversionEnabled(false);
+	bigtime_t start = system_time();
+	ConvertBits(source, generic, sourceLength, destLength, sourceBytesPerRow,
+		destBytesPerRow, pair.source, pair.dest, width, height);
+	bigtime_t genericTime = system_time() - start;
+
+	SetFastColorConversionEnabled(true);
+	start = system_time();
+	ConvertBits(source, fast, sourceLength, destLength, sourceBytesPerRow,
+		destBytesPerRow, pair.source, pair.dest, width, height);
+	bigtime_t fastTime = system_time() - start;
+
+	bool identical = memcmp(generic, fast, destLength) == 0;
+
+	free(source);
+	free(generic);
+	free(fast);
+
+	if (_genericTime != NULL)
+		*_genericTime = genericTime;
+	if (_fastTime != NULL)
+		*_fastTime = fastTime;
+	return identical;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	static const int32 kWidths[] = { 1, 3, 5, 7, 8, 9, 13, 16, 17, 31 };
+
+	int32 failures = 0;
+
+	for (size_t i = 0; i < B_COUNT_OF(kPairs); i++) {
+		for (size_t j = 0; j < B_COUNT_OF(kWidths); j++) {
+			if (!compare(kPairs[i], kWidths[j], 5, NULL, NULL)) {
+				printf("%s: results differ at width %" B_PRId32 "\n",
+					kPairs[i].name, kWidths[j]);
+				failures++;
+			}
+		}
+	}
+
+	printf("%-18s %12s %12s %8s\n", "conversion", "generic us", "fast us",
+		"speedup");
+	for (size_t i = 0; i < B_COUNT_OF(kPairs); i++) {
+		bigtime_t genericTime;
+		bigtime_t fastTime;
+		if (!compare(kPairs[i], kBenchmarkWidth, kBenchmarkHeight,
+				&genericTime, &fastTime)) {
+			printf("%s: results differ on the large frame\n", kPairs[i].name);
+			failures++;
+			continue;
+		}
+
+		printf("%-18s %12" B_PRId64 " %12" B_PRId64 " %7.1fx\n",
+			kPairs[i].name, genericTime, fastTime,
+			fastTime > 0 ? (double)genericTime / fastTime : 0.0);
+	}
+
+	if (failures > 0) {
+		printf("%" B_PRId32 " failures\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures how fast the ComplexLayouter can follow an interactive resize,
+	ie. a layout for every size between the minimum and some larger size, in
+	pixel steps. The constraints resemble a grid with spanning and fixed size
+	items, so that the optimizer is actually needed. Every size is laid out
+	once by a fresh clone of the layouter, which has to start from scratch,
+	and once by the same layouter in sequence, which can start from its
+	previous solution; both must yield the same layout.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include <OS.h>
+#include <Size.h>
+
+#include "ComplexLayouter.h"
+
+
+static const int32 kColumnCount = 24;
+static const float kSpacing = 5;
+
+
+/*!	Adds constraints that are all satisfied by some random column widths, so
+	they don't contradict each other.
+*/
+static void
+add_constraints(Layouter* layouter)
+{
+	srand(kColumnCount);
+
+	int32 widths[kColumnCount];
+	for (int32 i = 0; i < kColumnCount; i++) {
+		widths[i] = 20 + rand() % 80;
+		if (i % 5 == 0) {
+			// fixed size, like a check box or an icon
+			layouter->AddConstraints(i, 1, widths[i], widths[i], widths[i]);
+		} else {
+			layouter->AddConstraints(i, 1, widths[i] - rand() % 20,
+				widths[i] + rand() % 200, widths[i]);
+		}
+		layouter->SetWeight(i, 1 + rand() % 3);
+	}
+
+	// items spanning several columns, like labels and text controls
+	for (int32 i = 0; i < kColumnCount; i++) {
+		int32 length = 2 + rand() % 4;
+		int32 element = rand() % (kColumnCount - length + 1);
+		float width = (length - 1) * kSpacing;
+		for (int32 j = element; j < element + length; j++)
+			width += widths[j];
+
+		float max = rand() % 3 == 0
+			? B_SIZE_UNLIMITED : width + rand() % 300;
+		layouter->AddConstraints(element, length, width, max, width);
+	}
+}
+
+
+static bool
+same_layout(LayoutInfo* a, LayoutInfo* b)
+{
+	for (int32 i = 0; i < kColumnCount; i++) {
+		// both are optimal, but might round a tiny bit differently
+		if (abs(int32(a->ElementLocation(i) - b->ElementLocation(i))) > 1)
+			return false;
+	}
+	return true;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 steps = argc > 1 ? atol(argv[1]) : 2000;
+
+	ComplexLayouter layouter(kColumnCount, kSpacing);
+	if (layouter.InitCheck() != B_OK) {
+		fprintf(stderr, "Could not create the layouter\n");
+		return 1;
+	}
+
+	add_constraints(&layouter);
+
+	float min = layouter.MinSize();
+	float max = std::min(layouter.MaxSize(), min + steps);
+	printf("min %g, max %g, laying out %d sizes\n", min, layouter.MaxSize(),
+		int(max - min + 1));
+
+	LayoutInfo* coldInfo = layouter.CreateLayoutInfo();
+	LayoutInfo* warmInfo = layouter.CreateLayoutInfo();
+
+	bigtime_t coldTime = 0;
+	bigtime_t warmTime = 0;
+	int32 failures = 0;
+
+	for (float size = min; size <= max; size++) {
+		Layouter* clone = layouter.CloneLayouter();
+		if (clone == NULL) {
+			fprintf(stderr, "Could not clone the layouter\n");
+			return 1;
+		}
+
+		bigtime_t start = system_time();
+		clone->Layout(coldInfo, size);
+		coldTime += system_time() - start;
+		delete clone;
+
+		start = system_time();
+		layouter.Layout(warmInfo, size);
+		warmTime += system_time() - start;
+
+		if (!same_layout(coldInfo, warmInfo)) {
+			if (failures++ < 10)
+				printf("layouts differ for size %g\n", size);
+		}
+	}
+
+	int32 count = int32(max - min + 1);
+	printf("%-12s %12s %14s\n", "start", "total us", "layouts/sec");
+	printf("%-12s %12" B_PRId64 " %14.0f\n", "minimum", coldTime,
+		coldTime > 0 ? count * 1000000.0 / coldTime : 0.0);
+	printf("%-12s %12" B_PRId64 " %14.0f\n", "previous", warmTime,
+		warmTime > 0 ? count * 1000000.0 / warmTime : 0.0);
+
+	delete coldInfo;
+	delete warmInfo;
+
+	if (failures > 0) {
+		printf("%" B_PRId32 " failures\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
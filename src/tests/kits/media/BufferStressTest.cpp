@@ -0,0 +1,306 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under terms of the MIT license.
+ */
+
+
+/*!	Passes buffers from many producer threads to many consumer threads, and
+	measures how long BBufferGroup::RequestBuffer() and BBuffer::Recycle()
+	take while they are all competing for the shared buffer list.
+	Meanwhile, churn threads keep creating and deleting buffer groups, so that
+	entries of the list are added, removed and reused under the claims.
+	Needs a running media_server.
+*/
+
+
+#include <Buffer.h>
+#include <BufferGroup.h>
+#include <OS.h>
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static const size_t kBufferSize = 256;
+static const int32 kMaxSamples = 1 << 20;
+
+
+struct latency_stats {
+	bigtime_t*	samples;
+	int32		count;
+	int32		failures;
+
+	void Init()
+	{
+		samples = new bigtime_t[kMaxSamples];
+		count = 0;
+		failures = 0;
+	}
+
+	void Add(bigtime_t latency)
+	{
+		if (count < kMaxSamples)
+			samples[count++] = latency;
+	}
+};
+
+
+struct producer {
+	BBufferGroup*	group;
+	port_id*		ports;
+	int32			portCount;
+	latency_stats	stats;
+};
+
+struct consumer {
+	port_id			port;
+	latency_stats	stats;
+};
+
+struct churner {
+	int32			groups;
+	int32			failures;
+};
+
+
+static int32 sQuit = 0;
+
+
+static status_t
+produce(void* data)
+{
+	producer& self = *(producer*)data;
+	int32 next = 0;
+
+	while (atomic_get(&sQuit) == 0) {
+		bigtime_t start = system_time();
+		BBuffer* buffer = self.group->RequestBuffer(kBufferSize, 100000);
+		bigtime_t latency = system_time() - start;
+		if (buffer == NULL) {
+			self.stats.failures++;
+			continue;
+		}
+		self.stats.Add(latency);
+
+		if (write_port(self.ports[next], 0, &buffer, sizeof(buffer)) != B_OK) {
+			buffer->Recycle();
+			break;
+		}
+		next = (next + 1) % self.portCount;
+	}
+	return B_OK;
+}
+
+
+static status_t
+consume(void* data)
+{
+	consumer& self = *(consumer*)data;
+
+	while (true) {
+		BBuffer* buffer;
+		int32 code;
+		if (read_port(self.port, &code, &buffer, sizeof(buffer))
+				!= sizeof(buffer)) {
+			break;
+		}
+
+		bigtime_t start = system_time();
+		buffer->Recycle();
+		self.stats.Add(system_time() - start);
+	}
+	return B_OK;
+}
+
+
+static status_t
+churn(void* data)
+{
+	churner& self = *(churner*)data;
+
+	while (atomic_get(&sQuit) == 0) {
+		// The producers scan past the entries of these groups while they
+		// are added, claimed, and removed again
+		BBufferGroup* group = new BBufferGroup(kBufferSize,
+			1 + self.groups % 4);
+		if (group->InitCheck() != B_OK) {
+			self.failures++;
+			delete group;
+			continue;
+		}
+
+		BBuffer* buffer = group->RequestBuffer(kBufferSize, 100000);
+		if (buffer != NULL)
+			buffer->Recycle();
+		else
+			self.failures++;
+
+		delete group;
+		self.groups++;
+	}
+	return B_OK;
+}
+
+
+static void
+print_stats(const char* name, latency_stats* stats, int32 count)
+{
+	int32 total = 0;
+	int32 failures = 0;
+	for (int32 i = 0; i < count; i++) {
+		total += stats[i].count;
+		failures += stats[i].failures;
+	}
+
+	bigtime_t* samples = new bigtime_t[total];
+	int32 index = 0;
+	for (int32 i = 0; i < count; i++) {
+		memcpy(samples + index, stats[i].samples,
+			stats[i].count * sizeof(bigtime_t));
+		index += stats[i].count;
+	}
+	std::sort(samples, samples + total);
+
+	double sum = 0;
+	for (int32 i = 0; i < total; i++)
+		sum += samples[i];
+
+	if (total > 0) {
+		printf("%-8s %9" B_PRId32 " calls, average %6.2f us, 99%% %4"
+			B_PRIdBIGTIME " us, 99.99%% %5" B_PRIdBIGTIME " us, max %6"
+			B_PRIdBIGTIME " us, %" B_PRId32 " failed\n", name, total,
+			sum / total, samples[int32(total * 0.99)],
+			samples[int32(total * 0.9999)], samples[total - 1], failures);
+	} else
+		printf("%-8s no calls, %" B_PRId32 " failed\n", name, failures);
+
+	delete[] samples;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 producerCount = 8;
+	int32 consumerCount = 8;
+	int32 buffersPerGroup = 16;
+	bigtime_t duration = 5000000;
+	int32 churnerCount = 2;
+
+	if (argc > 1)
+		producerCount = atoi(argv[1]);
+	if (argc > 2)
+		consumerCount = atoi(argv[2]);
+	if (argc > 3)
+		buffersPerGroup = atoi(argv[3]);
+	if (argc > 4)
+		duration = atoi(argv[4]) * 1000000LL;
+	if (argc > 5)
+		churnerCount = atoi(argv[5]);
+
+	if (producerCount < 1 || consumerCount < 1 || buffersPerGroup < 1
+		|| duration <= 0 || churnerCount < 0) {
+		fprintf(stderr, "usage: %s [producers] [consumers] "
+			"[buffers per group] [seconds] [churners]\n", argv[0]);
+		return 1;
+	}
+
+	printf("%" B_PRId32 " producers, %" B_PRId32 " consumers, %" B_PRId32
+		" buffers per group, %" B_PRId32 " churners, %g s\n", producerCount,
+		consumerCount, buffersPerGroup, churnerCount, duration / 1000000.0);
+
+	consumer* consumers = new consumer[consumerCount];
+	port_id* ports = new port_id[consumerCount];
+	thread_id* consumerThreads = new thread_id[consumerCount];
+	for (int32 i = 0; i < consumerCount; i++) {
+		ports[i] = create_port(buffersPerGroup * producerCount,
+			"buffer stress consumer");
+		consumers[i].port = ports[i];
+		consumers[i].stats.Init();
+		consumerThreads[i] = spawn_thread(consume, "consumer",
+			B_REAL_TIME_PRIORITY, &consumers[i]);
+	}
+
+	producer* producers = new producer[producerCount];
+	thread_id* producerThreads = new thread_id[producerCount];
+	for (int32 i = 0; i < producerCount; i++) {
+		producers[i].group = new BBufferGroup(kBufferSize, buffersPerGroup);
+		if (producers[i].group->InitCheck() != B_OK) {
+			fprintf(stderr, "could not create buffer group: %s\n",
+				strerror(producers[i].group->InitCheck()));
+			return 1;
+		}
+		producers[i].ports = ports;
+		producers[i].portCount = consumerCount;
+		producers[i].stats.Init();
+		producerThreads[i] = spawn_thread(produce, "producer",
+			B_REAL_TIME_PRIORITY, &producers[i]);
+	}
+
+	churner* churners = new churner[churnerCount];
+	thread_id* churnerThreads = new thread_id[churnerCount];
+	for (int32 i = 0; i < churnerCount; i++) {
+		churners[i].groups = 0;
+		churners[i].failures = 0;
+		churnerThreads[i] = spawn_thread(churn, "churner", B_NORMAL_PRIORITY,
+			&churners[i]);
+	}
+
+	for (int32 i = 0; i < consumerCount; i++)
+		resume_thread(consumerThreads[i]);
+	for (int32 i = 0; i < producerCount; i++)
+		resume_thread(producerThreads[i]);
+	for (int32 i = 0; i < churnerCount; i++)
+		resume_thread(churnerThreads[i]);
+
+	snooze(duration);
+	atomic_set(&sQuit, 1);
+
+	status_t status;
+	for (int32 i = 0; i < producerCount; i++)
+		wait_for_thread(producerThreads[i], &status);
+	for (int32 i = 0; i < churnerCount; i++)
+		wait_for_thread(churnerThreads[i], &status);
+
+	// let the consumers drain their ports before they quit
+	for (int32 i = 0; i < consumerCount; i++) {
+		while (port_count(ports[i]) > 0)
+			snooze(1000);
+		delete_port(ports[i]);
+		wait_for_thread(consumerThreads[i], &status);
+	}
+
+	latency_stats* stats = new latency_stats[max_c(producerCount,
+		consumerCount)];
+	for (int32 i = 0; i < producerCount; i++)
+		stats[i] = producers[i].stats;
+	print_stats("request", stats, producerCount);
+	for (int32 i = 0; i < consumerCount; i++)
+		stats[i] = consumers[i].stats;
+	print_stats("recycle", stats, consumerCount);
+
+	int32 result = 0;
+	int32 churnedGroups = 0;
+	int32 churnFailures = 0;
+	for (int32 i = 0; i < churnerCount; i++) {
+		churnedGroups += churners[i].groups;
+		churnFailures += churners[i].failures;
+	}
+	printf("churn    %9" B_PRId32 " groups, %" B_PRId32 " failed\n",
+		churnedGroups, churnFailures);
+	if (churnFailures > 0)
+		result = 1;
+
+	for (int32 i = 0; i < producerCount; i++) {
+		// all buffers must have found their way back
+		if (producers[i].group->ReclaimAllBuffers() != B_OK) {
+			fprintf(stderr, "group %" B_PRId32 " lost buffers\n", i);
+			result = 1;
+		}
+		delete producers[i].group;
+	}
+
+	return result;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under terms of the MIT license.
+ */
+
+
+/*!	Measures the decoding throughput of the video tracks of the given files,
+	with different numbers of decoding threads. After decoding, it seeks back
+	to the middle of the track and checks that the decoder resumes with
+	frames at or after the seek position.
+*/
+
+
+#include <File.h>
+#include <MediaFile.h>
+#include <MediaTrack.h>
+#include <OS.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static bool
+benchmark_track(BMediaTrack* track, int32 threadCount, int64 maxFrames)
+{
+	status_t status = track->SetDecodingThreadCount(threadCount);
+	if (status != B_OK) {
+		printf("  decoder doesn't support threads: %s\n", strerror(status));
+		return false;
+	}
+
+	media_format format;
+	format.type = B_MEDIA_RAW_VIDEO;
+	format.u.raw_video = media_raw_video_format::wildcard;
+	format.u.raw_video.display.format = B_RGB32;
+	status = track->DecodedFormat(&format);
+	if (status != B_OK) {
+		printf("  could not negotiate decoded format: %s\n", strerror(status));
+		return false;
+	}
+
+	int64 frame = 0;
+	track->SeekToFrame(&frame);
+
+	size_t bufferSize = format.u.raw_video.display.bytes_per_row
+		* format.u.raw_video.display.line_count;
+	uint8* buffer = new uint8[bufferSize];
+
+	int64 frames = 0;
+	bigtime_t start = system_time();
+	while (frames < maxFrames) {
+		int64 count = 1;
+		media_header header;
+		if (track->ReadFrames(buffer, &count, &header) != B_OK || count == 0)
+			break;
+		frames++;
+	}
+	bigtime_t duration = system_time() - start;
+
+	printf("  %2" B_PRId32 " threads: %6" B_PRId64 " frames in %7.3f s, "
+		"%8.2f fps\n", threadCount, frames, duration / 1000000.0,
+		frames * 1000000.0 / (duration > 0 ? duration : 1));
+
+	// seek to the middle and check the first frame we get
+	bigtime_t seekTime = track->Duration() / 2;
+	bigtime_t time = seekTime;
+	if (track->SeekToTime(&time) == B_OK) {
+		int64 count = 1;
+		media_header header;
+		if (track->ReadFrames(buffer, &count, &header) == B_OK && count > 0) {
+			printf("             seek to %.3f s, key frame at %.3f s, first "
+				"frame at %.3f s%s\n", seekTime / 1000000.0, time / 1000000.0,
+				header.start_time / 1000000.0,
+				header.start_time < time ? " (too early!)" : "");
+		}
+	}
+
+	delete[] buffer;
+	return true;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int64 maxFrames = 1000;
+	int32 maxThreads = 0;
+
+	int i = 1;
+	for (; i < argc && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "-f") && i + 1 < argc)
+			maxFrames = atoll(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+			maxThreads = atoi(argv[++i]);
+		else
+			break;
+	}
+
+	if (i >= argc) {
+		fprintf(stderr, "usage: %s [-f <max frames>] [-t <max threads>] "
+			"<file> ...\n", argv[0]);
+		return 1;
+	}
+
+	if (maxThreads <= 0) {
+		system_info info;
+		get_system_info(&info);
+		maxThreads = info.cpu_count;
+	}
+
+	for (; i < argc; i++) {
+		BFile file(argv[i], B_READ_ONLY);
+		BMediaFile mediaFile(&file);
+		if (mediaFile.InitCheck() != B_OK) {
+			printf("%s: %s\n", argv[i], strerror(mediaFile.InitCheck()));
+			continue;
+		}
+
+		for (int32 index = 0; index < mediaFile.CountTracks(); index++) {
+			BMediaTrack* track = mediaFile.TrackAt(index);
+			media_format format;
+			track->EncodedFormat(&format);
+			if (!format.IsVideo()) {
+				mediaFile.ReleaseTrack(track);
+				continue;
+			}
+
+			media_codec_info info;
+			track->GetCodecInfo(&info);
+			printf("%s, track %" B_PRId32 ": %s, %" B_PRId32 " x %" B_PRId32
+				"\n", argv[i], index, info.pretty_name, format.Width(),
+				format.Height());
+
+			int32 threads = 1;
+			while (benchmark_track(track, threads, maxFrames)
+				&& threads < maxThreads) {
+				threads = min_c(threads * 2, maxThreads);
+			}
+
+			mediaFile.ReleaseTrack(track);
+		}
+	}
+
+	return 0;
+}
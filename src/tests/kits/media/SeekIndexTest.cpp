@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under terms of the MIT license.
+ */
+
+
+/*!	Checks that the SeekIndex of the MediaExtractor only answers key frame
+	requests it can be sure about.
+*/
+
+
+#include <MediaTrack.h>
+
+#include <SeekIndex.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+static int sFailures = 0;
+
+
+static void
+check(const SeekIndex& index, uint32 flags, bigtime_t time, bool found,
+	bigtime_t expected, int line)
+{
+	bigtime_t result = time;
+	bool success = index.FindKeyFrame(flags, &result);
+	if (success != found || (found && result != expected)) {
+		printf("line %d: %s %" B_PRIdBIGTIME ": got %s %" B_PRIdBIGTIME
+			", expected %s %" B_PRIdBIGTIME "\n", line,
+			(flags & B_MEDIA_SEEK_CLOSEST_FORWARD) != 0
+				? "forward" : "backward",
+			time, success ? "found" : "unknown", result,
+			found ? "found" : "unknown", expected);
+		sFailures++;
+	}
+}
+
+
+#define CHECK_FOUND(index, flags, time, expected) \
+	check(index, flags, time, true, expected, __LINE__)
+#define CHECK_UNKNOWN(index, flags, time) \
+	check(index, flags, time, false, 0, __LINE__)
+
+
+static const uint32 kBackward = B_MEDIA_SEEK_CLOSEST_BACKWARD;
+static const uint32 kForward = B_MEDIA_SEEK_CLOSEST_FORWARD;
+
+
+static void
+test_sequential()
+{
+	SeekIndex index;
+	CHECK_UNKNOWN(index, kBackward, 0);
+
+	// read the stream from the start: key frames every second
+	for (bigtime_t time = 0; time <= 5000000; time += 1000000)
+		index.AddKeyFrame(time);
+
+	CHECK_FOUND(index, kBackward, 2500000, 2000000);
+	CHECK_FOUND(index, kForward, 2500000, 3000000);
+	CHECK_FOUND(index, kBackward, 3000000, 3000000);
+	CHECK_FOUND(index, kForward, 3000000, 3000000);
+
+	// the stream may continue after the last key frame we have seen
+	CHECK_UNKNOWN(index, kBackward, 5500000);
+	CHECK_UNKNOWN(index, kForward, 5500000);
+
+	index.SetEndOfStream();
+	CHECK_FOUND(index, kBackward, 5500000, 5000000);
+	CHECK_UNKNOWN(index, kForward, 5500000);
+	CHECK_UNKNOWN(index, kBackward, -1);
+	CHECK_UNKNOWN(index, kForward, -1);
+}
+
+
+static void
+test_seeking()
+{
+	SeekIndex index;
+
+	index.AddKeyFrame(0);
+	index.AddKeyFrame(1000000);
+
+	// seek forward, leaving a gap
+	index.Interrupt();
+	index.AddKeyFrame(10000000);
+	index.AddKeyFrame(11000000);
+
+	CHECK_FOUND(index, kBackward, 500000, 0);
+	CHECK_UNKNOWN(index, kBackward, 5000000);
+	CHECK_UNKNOWN(index, kForward, 5000000);
+	CHECK_FOUND(index, kBackward, 10500000, 10000000);
+
+	// fill the gap
+	index.Interrupt();
+	index.AddKeyFrame(1000000);
+	index.AddKeyFrame(4000000);
+	CHECK_FOUND(index, kBackward, 3000000, 1000000);
+	CHECK_FOUND(index, kForward, 3000000, 4000000);
+	CHECK_UNKNOWN(index, kBackward, 5000000);
+
+	index.AddKeyFrame(10000000);
+	CHECK_FOUND(index, kBackward, 5000000, 4000000);
+	CHECK_FOUND(index, kForward, 5000000, 10000000);
+
+	// a key frame that turns up between two linked ones breaks the link
+	index.Interrupt();
+	index.AddKeyFrame(7000000);
+	CHECK_UNKNOWN(index, kBackward, 5000000);
+	CHECK_UNKNOWN(index, kForward, 5000000);
+	CHECK_FOUND(index, kBackward, 0, 0);
+}
+
+
+static void
+test_flatten()
+{
+	SeekIndex index;
+	index.AddKeyFrame(-40000);
+	index.AddKeyFrame(960000);
+	index.AddKeyFrame(1960000);
+	index.SetEndOfStream();
+
+	if (!index.IsModified()) {
+		printf("index not marked modified\n");
+		sFailures++;
+	}
+
+	int64 buffer[3];
+	if (index.FlattenedSize() != sizeof(buffer)) {
+		printf("unexpected flattened size %zu\n", index.FlattenedSize());
+		sFailures++;
+		return;
+	}
+	index.Flatten(buffer);
+
+	SeekIndex copy;
+	if (copy.Unflatten(buffer, 3) != B_OK || copy.CountEntries() != 3
+		|| copy.IsModified()) {
+		printf("unflattening failed\n");
+		sFailures++;
+		return;
+	}
+
+	CHECK_FOUND(copy, kBackward, 0, -40000);
+	CHECK_FOUND(copy, kForward, 0, 960000);
+	CHECK_FOUND(copy, kBackward, 3000000, 1960000);
+
+	// entries must be sorted
+	int64 broken[2] = { buffer[1], buffer[0] };
+	if (copy.Unflatten(broken, 2) == B_OK) {
+		printf("accepted unsorted entries\n");
+		sFailures++;
+	}
+}
+
+
+int
+main()
+{
+	test_sequential();
+	test_seeking();
+	test_flatten();
+
+	if (sFailures > 0) {
+		printf("%d checks failed\n", sFailures);
+		return 1;
+	}
+
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under terms of the MIT license.
+ */
+
+
+/*!	Measures BTimedEventQueue with different mixes of adding and removing
+	events, with few and with many pending events.
+*/
+
+
+#include <OS.h>
+#include <TimedEventQueue.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+static const int32 kOperations = 1000000;
+
+
+static inline bigtime_t
+random_time(bigtime_t base, bigtime_t range)
+{
+	return base + (rand() % range);
+}
+
+
+static void
+print_result(const char* name, int32 pending, int32 operations,
+	bigtime_t duration)
+{
+	printf("%-24s %6" B_PRId32 " pending: %8.1f ns per operation\n", name,
+		pending, duration * 1000.0 / operations);
+}
+
+
+/*!	Adds \a pending events in random order, and removes them all again.
+*/
+static void
+fill_and_drain(int32 pending)
+{
+	BTimedEventQueue queue;
+	int32 rounds = max_c(1, kOperations / (2 * pending));
+
+	bigtime_t start = system_time();
+	for (int32 round = 0; round < rounds; round++) {
+		for (int32 i = 0; i < pending; i++) {
+			queue.AddEvent(media_timed_event(random_time(0, 1000000),
+				BTimedEventQueue::B_HANDLE_BUFFER));
+		}
+
+		media_timed_event event;
+		while (queue.RemoveFirstEvent(&event) == B_OK)
+			;
+	}
+
+	print_result("fill and drain", pending, rounds * 2 * pending,
+		system_time() - start);
+}
+
+
+/*!	Keeps \a pending events in the queue, and adds a new one for each one
+	that is removed, like a node that has scheduled some time ahead.
+*/
+static void
+steady_state(int32 pending)
+{
+	BTimedEventQueue queue;
+	bigtime_t now = 0;
+	for (int32 i = 0; i < pending; i++) {
+		queue.AddEvent(media_timed_event(random_time(now, 100000),
+			BTimedEventQueue::B_HANDLE_BUFFER));
+	}
+
+	bigtime_t start = system_time();
+	for (int32 i = 0; i < kOperations / 2; i++) {
+		media_timed_event event;
+		queue.RemoveFirstEvent(&event);
+		now = event.event_time;
+
+		queue.AddEvent(media_timed_event(random_time(now, 100000),
+			BTimedEventQueue::B_HANDLE_BUFFER));
+	}
+
+	print_result("steady state", pending, kOperations,
+		system_time() - start);
+}
+
+
+/*!	Like steady_state(), but removes all events that are due at once.
+*/
+static void
+batched(int32 pending)
+{
+	BTimedEventQueue queue;
+	bigtime_t now = 0;
+	for (int32 i = 0; i < pending; i++) {
+		queue.AddEvent(media_timed_event(random_time(now, 100000),
+			BTimedEventQueue::B_HANDLE_BUFFER));
+	}
+
+	media_timed_event* events = new media_timed_event[pending];
+	int32 operations = 0;
+
+	bigtime_t start = system_time();
+	while (operations < kOperations) {
+		now += 1000;
+
+		int32 count = pending;
+		queue.RemoveFirstEvents(now, events, &count);
+
+		for (int32 i = 0; i < count; i++) {
+			queue.AddEvent(media_timed_event(random_time(now, 100000),
+				BTimedEventQueue::B_HANDLE_BUFFER));
+		}
+		operations += 2 * count + 1;
+	}
+
+	print_result("batched", pending, operations, system_time() - start);
+	delete[] events;
+}
+
+
+struct contended_info {
+	BTimedEventQueue*	queue;
+	int32				count;
+	int32				quit;
+};
+
+
+static status_t
+add_events(void* data)
+{
+	contended_info* info = (contended_info*)data;
+	for (int32 i = 0; i < info->count; i++) {
+		info->queue->AddEvent(media_timed_event(random_time(0, 1000000),
+			BTimedEventQueue::B_HANDLE_BUFFER));
+	}
+	atomic_set(&info->quit, 1);
+	return B_OK;
+}
+
+
+/*!	One thread adds events, while another one handles them the same way
+	BMediaEventLooper::ControlLoop() does.
+*/
+static void
+contended()
+{
+	BTimedEventQueue queue;
+	contended_info info = { &queue, kOperations / 2, 0 };
+
+	bigtime_t start = system_time();
+
+	thread_id thread = spawn_thread(add_events, "add events",
+		B_NORMAL_PRIORITY, &info);
+	resume_thread(thread);
+
+	int32 removed = 0;
+	while (true) {
+		if (!queue.HasEvents()) {
+			if (atomic_get(&info.quit) != 0 && !queue.HasEvents())
+				break;
+			continue;
+		}
+
+		queue.FirstEventTime();
+
+		media_timed_event event;
+		if (queue.RemoveFirstEvent(&event) == B_OK)
+			removed++;
+	}
+
+	status_t status;
+	wait_for_thread(thread, &status);
+
+	print_result("contended", 0, info.count + removed, system_time() - start);
+}
+
+
+int
+main()
+{
+	static const int32 kPending[] = { 8, 64, 512, 4096 };
+	static const int32 kPendingCount = sizeof(kPending) / sizeof(kPending[0]);
+
+	srand(0);
+
+	for (int32 i = 0; i < kPendingCount; i++)
+		fill_and_drain(kPending[i]);
+	for (int32 i = 0; i < kPendingCount; i++)
+		steady_state(kPending[i]);
+	for (int32 i = 0; i < kPendingCount; i++)
+		batched(kPending[i]);
+	contended();
+
+	return 0;
+}
@@ -11,6 +11,7 @@ void InsertRemoveTest();
 void DoForEachTest();
 void MatchTest();
 void FlushTest();
+void BatchTest();
 
 void DumpEvent(const media_timed_event & e)
 {
@@ -386,11 +387,44 @@ void FlushTest()
 }	
 
 
+void BatchTest()
+{
+	BTimedEventQueue *q =new BTimedEventQueue;
+	q->AddEvent(media_timed_event(0x1003,BTimedEventQueue::B_START));
+	q->AddEvent(media_timed_event(0x1001,BTimedEventQueue::B_START));
+	q->AddEvent(media_timed_event(0x1002,BTimedEventQueue::B_START));
+	q->AddEvent(media_timed_event(0x1002,BTimedEventQueue::B_STOP));
+	q->AddEvent(media_timed_event(0x1005,BTimedEventQueue::B_START));
+
+	media_timed_event events[4];
+	int32 count = 4;
+	ASSERT(q->RemoveFirstEvents(0x1002, events, &count, false) == B_OK);
+	ASSERT(count == 1);
+	ASSERT(events[0].event_time == 0x1001);
+
+	count = 2;
+	ASSERT(q->RemoveFirstEvents(0x1004, events, &count) == B_OK);
+	ASSERT(count == 2);
+	ASSERT(events[0].event_time == 0x1002 && events[0].type == BTimedEventQueue::B_START);
+	ASSERT(events[1].event_time == 0x1002 && events[1].type == BTimedEventQueue::B_STOP);
+	ASSERT(q->EventCount() == 2);
+
+	count = 4;
+	ASSERT(q->RemoveFirstEvents(0x1004, events, &count) == B_OK);
+	ASSERT(count == 1);
+	ASSERT(events[0].event_time == 0x1003);
+	ASSERT(q->FirstEventTime() == 0x1005);
+
+	delete q;
+}
+
+
 int main()
 {
 	InsertRemoveTest();
 	DoForEachTest();
 	MatchTest();
 	FlushTest();
+	BatchTest();
 	return 0;
 }
@@ -0,0 +1,321 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures how fast BJson parses a document shaped like the package data
+	HaikuDepot downloads: from a stream in one go, from a stream that only
+	hands out small chunks (like a network connection), and in situ from a
+	writable buffer. All modes must deliver the same events.
+
+	Builds for the libbe_test platform as well, so that the numbers can be
+	taken on the build host.
+*/
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <DataIO.h>
+#include <OS.h>
+#include <String.h>
+
+#include <Json.h>
+#include <JsonEventListener.h>
+
+
+using BPrivate::BJson;
+using BPrivate::BJsonEvent;
+using BPrivate::BJsonEventListener;
+
+
+static const int32 kDefaultPackageCount = 30000;
+static const int32 kDefaultIterations = 5;
+static const size_t kChunkSize = 1500;
+	// about what a network read delivers
+
+
+/*!	A stream that returns at most kChunkSize bytes per read.
+*/
+class ChunkedMemoryIO : public BDataIO {
+public:
+	ChunkedMemoryIO(const char* data, size_t size)
+		:
+		fData(data),
+		fSize(size),
+		fOffset(0)
+	{
+	}
+
+	virtual ssize_t Read(void* buffer, size_t size)
+	{
+		size = min_c(min_c(size, kChunkSize), fSize - fOffset);
+		memcpy(buffer, fData + fOffset, size);
+		fOffset += size;
+		return size;
+	}
+
+private:
+	const char*	fData;
+	size_t		fSize;
+	size_t		fOffset;
+};
+
+
+/*!	Sums up the events, so that the modes can be compared, and the parser
+	can't take any shortcuts.
+*/
+class ChecksumListener : public BJsonEventListener {
+public:
+	ChecksumListener()
+		:
+		fChecksum(0),
+		fEventCount(0),
+		fError(B_OK)
+	{
+	}
+
+	virtual bool Handle(const BJsonEvent& event)
+	{
+		fEventCount++;
+		fChecksum = fChecksum * 31 + event.EventType();
+		if (const char* content = event.Content()) {
+			for (; *content != '\0'; content++)
+				fChecksum = fChecksum * 131 + (uint8)*content;
+		}
+		return true;
+	}
+
+	virtual void HandleError(status_t status, int32 line, const char* message)
+	{
+		fprintf(stderr, "parse error in line %" B_PRId32 ": %s\n", line,
+			message != NULL ? message : strerror(status));
+		fError = status;
+	}
+
+	virtual void Complete()
+	{
+	}
+
+	uint64		fChecksum;
+	uint64		fEventCount;
+	status_t	fError;
+};
+
+
+static void
+append_indent(BString& json, bool pretty, int32 depth)
+{
+	if (!pretty)
+		return;
+
+	json << "\n";
+	for (int32 i = 0; i < depth; i++)
+		json << "  ";
+}
+
+
+/*!	Generates the document package by package; appending everything to a
+	single BString would reallocate it all the time.
+*/
+static status_t
+generate_document(BMallocIO& document, int32 packageCount, bool pretty)
+{
+	const char* separator = pretty ? ": " : ":";
+
+	document.SetBlockSize(1024 * 1024);
+
+	BString json;
+	json << "{";
+	append_indent(json, pretty, 1);
+	json << "\"items\"" << separator << "[";
+
+	for (int32 i = 0; i < packageCount; i++) {
+		if (i > 0)
+			json << ",";
+		append_indent(json, pretty, 2);
+		json << "{";
+
+		append_indent(json, pretty, 3);
+		json << "\"name\"" << separator << "\"package_" << i << "\",";
+		append_indent(json, pretty, 3);
+		json << "\"version\"" << separator << "{\"major\"" << separator
+			<< "\"" << i % 10 << "\",\"minor\"" << separator << "\""
+			<< i % 7 << "\",\"revision\"" << separator << i % 5 << "},";
+		append_indent(json, pretty, 3);
+		json << "\"summary\"" << separator
+			<< "\"A package that does something useful with number " << i
+			<< "\",";
+		append_indent(json, pretty, 3);
+		json << "\"description\"" << separator
+			<< "\"It comes with a longer description, that spans several "
+			"sentences and even lines.\\nSome of them are \\\"quoted\\\", and "
+			"some contain non-ASCII characters like \\u00e4 or \\u2026.\",";
+		append_indent(json, pretty, 3);
+		json << "\"size\"" << separator << 1024 * (i % 4096) + 17 << ",";
+		append_indent(json, pretty, 3);
+		json << "\"rating\"" << separator;
+		if (i % 3 == 0)
+			json << "null,";
+		else
+			json << (i % 50) / 10.0 << ",";
+		append_indent(json, pretty, 3);
+		json << "\"active\"" << separator << (i % 2 == 0 ? "true" : "false")
+			<< ",";
+		append_indent(json, pretty, 3);
+		json << "\"categories\"" << separator
+			<< "[\"development\",\"internet\",\"utilities\"]";
+
+		append_indent(json, pretty, 2);
+		json << "}";
+
+		status_t status = document.WriteExactly(json.String(), json.Length());
+		if (status != B_OK)
+			return status;
+		json.Truncate(0);
+	}
+
+	append_indent(json, pretty, 1);
+	json << "]";
+	append_indent(json, pretty, 0);
+	json << "}";
+
+	return document.WriteExactly(json.String(), json.Length());
+}
+
+
+static ChecksumListener
+parse(const char* mode, const char* data, size_t size, char* buffer)
+{
+	ChecksumListener listener;
+
+	if (strcmp(mode, "stream") == 0) {
+		BMemoryIO io(data, size);
+		BJson::Parse(&io, &listener);
+	} else if (strcmp(mode, "chunked") == 0) {
+		ChunkedMemoryIO io(data, size);
+		BJson::Parse(&io, &listener);
+	} else {
+		// in situ parsing destroys its input, the caller copies it first
+		BJson::ParseInSitu(buffer, size, &listener);
+	}
+
+	return listener;
+}
+
+
+static int32
+run_benchmarks(const char* name, const BMallocIO& document, int32 iterations)
+{
+	static const char* kModes[] = { "stream", "chunked", "in situ" };
+
+	const char* json = (const char*)document.Buffer();
+	size_t size = document.BufferLength();
+	char* buffer = (char*)malloc(size);
+	if (buffer == NULL) {
+		fprintf(stderr, "%s: out of memory\n", name);
+		return 1;
+	}
+
+	printf("%s document, %.1f MB:\n", name, size / 1000000.0);
+
+	ChecksumListener expected;
+	int32 result = 0;
+	for (size_t mode = 0; mode < B_COUNT_OF(kModes); mode++) {
+		bigtime_t best = B_INFINITE_TIMEOUT;
+		ChecksumListener listener;
+		for (int32 i = 0; i < iterations; i++) {
+			// only parsing is timed, the copy for the in situ mode is not
+			if (strcmp(kModes[mode], "in situ") == 0)
+				memcpy(buffer, json, size);
+
+			bigtime_t start = system_time();
+			listener = parse(kModes[mode], json, size, buffer);
+			best = min_c(best, system_time() - start);
+		}
+
+		if (mode == 0)
+			expected = listener;
+
+		bool matches = listener.fError == B_OK
+			&& listener.fEventCount == expected.fEventCount
+			&& listener.fChecksum == expected.fChecksum;
+		if (!matches)
+			result = 1;
+
+		printf("  %-8s %8.1f ms %8.1f MB/s %10" B_PRIu64 " events%s\n",
+			kModes[mode], best / 1000.0,
+			best > 0 ? size / (double)best : 0.0, listener.fEventCount,
+			matches ? "" : "  MISMATCH");
+	}
+
+	free(buffer);
+	return result;
+}
+
+
+static void
+print_usage(const char* program, bool error)
+{
+	fprintf(error ? stderr : stdout,
+		"Usage: %s [options]\n"
+		"Parses a generated package data document with BJson.\n\n"
+		"  -c, --count <n>        number of packages (default %" B_PRId32
+			")\n"
+		"  -i, --iterations <n>   runs per mode, the best counts (default %"
+			B_PRId32 ")\n"
+		"  -h, --help             show this help\n", program,
+		kDefaultPackageCount, kDefaultIterations);
+	exit(error ? 1 : 0);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	static const struct option kLongOptions[] = {
+		{ "count", required_argument, NULL, 'c' },
+		{ "iterations", required_argument, NULL, 'i' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	int32 packageCount = kDefaultPackageCount;
+	int32 iterations = kDefaultIterations;
+
+	int c;
+	while ((c = getopt_long(argc, argv, "c:i:h", kLongOptions, NULL)) != -1) {
+		switch (c) {
+			case 'c':
+				packageCount = atol(optarg);
+				break;
+			case 'i':
+				iterations = atol(optarg);
+				break;
+			case 'h':
+				print_usage(argv[0], false);
+				break;
+			default:
+				print_usage(argv[0], true);
+				break;
+		}
+	}
+
+	if (packageCount <= 0 || iterations <= 0)
+		print_usage(argv[0], true);
+
+	BMallocIO compact;
+	BMallocIO pretty;
+	if (generate_document(compact, packageCount, false) != B_OK
+		|| generate_document(pretty, packageCount, true) != B_OK) {
+		fprintf(stderr, "could not generate the documents\n");
+		return 1;
+	}
+
+	int32 result = run_benchmarks("compact", compact, iterations);
+	result |= run_benchmarks("indented", pretty, iterations);
+
+	return result;
+}
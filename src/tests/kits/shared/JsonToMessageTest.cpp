@@ -133,6 +133,36 @@ JsonToMessageTest::TestObjectA()
 }
 
 
+void
+JsonToMessageTest::TestObjectAInSitu()
+{
+	BMessage message;
+	BMessage subMessage;
+	BString stringValue;
+	char input[] = JSON_SAMPLE_OBJECT_A_IN;
+
+	// ----------------------
+	status_t result = BJson::ParseInSitu(input, strlen(input), message);
+	// ----------------------
+
+	CPPUNIT_ASSERT_EQUAL(B_OK, result);
+
+	CPPUNIT_ASSERT_EQUAL(B_OK, message.FindString("weather", &stringValue));
+	CPPUNIT_ASSERT_EQUAL(BString("raining"), stringValue);
+
+	CPPUNIT_ASSERT_EQUAL(B_OK, message.FindString("humidity", &stringValue));
+	CPPUNIT_ASSERT_EQUAL(BString("too-high"), stringValue);
+
+	CPPUNIT_ASSERT_EQUAL(B_OK, message.FindMessage("daysOfWeek", &subMessage));
+
+	CPPUNIT_ASSERT_EQUAL(B_OK, subMessage.FindString("0", &stringValue));
+	CPPUNIT_ASSERT_EQUAL(BString("MON"), stringValue);
+
+	CPPUNIT_ASSERT_EQUAL(B_OK, subMessage.FindString("4", &stringValue));
+	CPPUNIT_ASSERT_EQUAL(BString("FRI"), stringValue);
+}
+
+
 /*! This is not a real test, but is a convenient point at which to implement a
     performance test.
 */
@@ -264,6 +294,10 @@ JsonToMessageTest::AddTests(BTestSuite& parent)
 		"JsonToMessageTest::TestObjectA",
 		&JsonToMessageTest::TestObjectA));
 
+	suite.addTest(new CppUnit::TestCaller<JsonToMessageTest>(
+		"JsonToMessageTest::TestObjectAInSitu",
+		&JsonToMessageTest::TestObjectAInSitu));
+
 	suite.addTest(new CppUnit::TestCaller<JsonToMessageTest>(
 		"JsonToMessageTest::TestObjectB",
 		&JsonToMessageTest::TestObjectB));
@@ -23,6 +23,7 @@ public:
 			void				TestArrayB();
 			void				TestObjectAForPerformance();
 			void				TestObjectA();
+			void				TestObjectAInSitu();
 			void				TestObjectB();
 			void				TestObjectC();
 			void				TestUnterminatedObject();
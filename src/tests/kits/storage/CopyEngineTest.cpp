@@ -0,0 +1,358 @@
+// CopyEngineTest.cpp
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+using std::string;
+
+#include <CopyEngine.h>
+#include <Directory.h>
+#include <Entry.h>
+#include <File.h>
+#include <Node.h>
+#include <fs_attr.h>
+
+#include <TestShell.h>
+
+#include "CopyEngineTest.h"
+
+
+static const char* kTestDir = "/tmp/copy-engine-test";
+static const char* kSourceDir = "/tmp/copy-engine-test/source";
+static const char* kSequentialDir = "/tmp/copy-engine-test/sequential";
+static const char* kParallelDir = "/tmp/copy-engine-test/parallel";
+
+static const char* kFailing = "/sub/small42";
+
+static const int32 kWorkerCount = 4;
+
+
+// Records what the engine reports; the engine never calls it concurrently.
+class TestController : public BCopyEngine::BController {
+public:
+	TestController()
+		:
+		fErrorCount(0),
+		fLastError(B_OK),
+		fFailedEntryError(B_OK),
+		fBytesCopied(0)
+	{
+	}
+
+	virtual bool EntryFinished(const char* path, status_t error)
+	{
+		if (error != B_OK && fFailedEntry.empty()) {
+			fFailedEntry = path;
+			fFailedEntryError = error;
+		}
+		return false;
+	}
+
+	virtual void ErrorOccurred(const char* message, status_t error)
+	{
+		fErrorCount++;
+		fLastError = error;
+	}
+
+	virtual void ProgressChanged(off_t bytesCopied, off_t bytesPerSecond)
+	{
+		fBytesCopied = bytesCopied;
+	}
+
+	int32		fErrorCount;
+	status_t	fLastError;
+	string		fFailedEntry;
+	status_t	fFailedEntryError;
+	off_t		fBytesCopied;
+};
+
+
+static void
+write_test_file(const string& path, off_t size, uint8 seed)
+{
+	BFile file(path.c_str(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	CPPUNIT_ASSERT(file.InitCheck() == B_OK);
+
+	char buffer[4096];
+	off_t offset = 0;
+	while (offset < size) {
+		size_t toWrite = min_c((off_t)sizeof(buffer), size - offset);
+		for (size_t i = 0; i < toWrite; i++)
+			buffer[i] = (char)((offset + i) * 31 + seed);
+		CPPUNIT_ASSERT(file.Write(buffer, toWrite) == (ssize_t)toWrite);
+		offset += toWrite;
+	}
+
+	// give every other file an attribute to carry along
+	if (seed % 2 == 0) {
+		CPPUNIT_ASSERT(file.WriteAttr("test:seed", B_UINT8_TYPE, 0, &seed,
+			sizeof(seed)) == (ssize_t)sizeof(seed));
+	}
+}
+
+
+// Suite
+CppUnit::Test*
+CopyEngineTest::Suite()
+{
+	CppUnit::TestSuite *suite = new CppUnit::TestSuite();
+	typedef CppUnit::TestCaller<CopyEngineTest> TC;
+
+	suite->addTest(new TC("BCopyEngine::Worker Copy Test",
+		&CopyEngineTest::WorkerCopyTest));
+	suite->addTest(new TC("BCopyEngine::Error Test",
+		&CopyEngineTest::ErrorTest));
+
+	return suite;
+}
+
+
+// setUp
+void
+CopyEngineTest::setUp()
+{
+	BasicTest::setUp();
+	execCommand(string("rm -rf ") + kTestDir);
+	CPPUNIT_ASSERT(create_directory(kTestDir, 0755) == B_OK);
+	CreateTree();
+}
+
+
+// tearDown
+void
+CopyEngineTest::tearDown()
+{
+	execCommand(string("rm -rf ") + kTestDir);
+	BasicTest::tearDown();
+}
+
+
+// CreateTree
+void
+CopyEngineTest::CreateTree()
+{
+	// sizes around the engine's 64 KiB and 1 MiB buffer sizes
+	static const off_t kSizes[] = {
+		0, 1, 100, 64 * 1024 - 1, 64 * 1024, 64 * 1024 + 1,
+		1024 * 1024 + 17, 3 * 1024 * 1024 + 5
+	};
+
+	string source = kSourceDir;
+	CPPUNIT_ASSERT(create_directory((source + "/sub/deeper").c_str(), 0755)
+		== B_OK);
+	CPPUNIT_ASSERT(create_directory((source + "/empty-dir").c_str(), 0755)
+		== B_OK);
+
+	uint8 seed = 0;
+	for (size_t i = 0; i < sizeof(kSizes) / sizeof(kSizes[0]); i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "/file%02d", (int)i);
+		write_test_file(source + name, kSizes[i], seed++);
+		write_test_file(source + "/sub/deeper" + name, kSizes[i], seed++);
+	}
+
+	// many small files, so that the job queue actually has work queued up
+	for (int32 i = 0; i < 64; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "/sub/small%02" B_PRId32, i);
+		write_test_file(source + name, i * 997, seed++);
+	}
+
+	CPPUNIT_ASSERT(symlink("file02", (source + "/link").c_str()) == 0);
+	CPPUNIT_ASSERT(symlink("../file06", (source + "/sub/link").c_str()) == 0);
+}
+
+
+// CompareTrees
+void
+CopyEngineTest::CompareTrees(const char* sourcePath, const char* destPath)
+{
+	struct stat sourceStat;
+	struct stat destStat;
+	CPPUNIT_ASSERT(lstat(sourcePath, &sourceStat) == 0);
+	CPPUNIT_ASSERT(lstat(destPath, &destStat) == 0);
+	CPPUNIT_ASSERT((sourceStat.st_mode & S_IFMT)
+		== (destStat.st_mode & S_IFMT));
+
+	if (S_ISLNK(sourceStat.st_mode)) {
+		char sourceLink[B_PATH_NAME_LENGTH];
+		char destLink[B_PATH_NAME_LENGTH];
+		ssize_t sourceLength = readlink(sourcePath, sourceLink,
+			sizeof(sourceLink));
+		ssize_t destLength = readlink(destPath, destLink, sizeof(destLink));
+		CPPUNIT_ASSERT(sourceLength >= 0);
+		CPPUNIT_ASSERT(sourceLength == destLength);
+		CPPUNIT_ASSERT(memcmp(sourceLink, destLink, sourceLength) == 0);
+		return;
+	}
+
+	// attributes
+	BNode sourceNode(sourcePath);
+	BNode destNode(destPath);
+	CPPUNIT_ASSERT(sourceNode.InitCheck() == B_OK);
+	CPPUNIT_ASSERT(destNode.InitCheck() == B_OK);
+
+	int32 sourceAttributes = 0;
+	char attribute[B_ATTR_NAME_LENGTH];
+	while (sourceNode.GetNextAttrName(attribute) == B_OK) {
+		attr_info sourceInfo;
+		attr_info destInfo;
+		CPPUNIT_ASSERT(sourceNode.GetAttrInfo(attribute, &sourceInfo) == B_OK);
+		CPPUNIT_ASSERT(destNode.GetAttrInfo(attribute, &destInfo) == B_OK);
+		CPPUNIT_ASSERT(sourceInfo.type == destInfo.type);
+		CPPUNIT_ASSERT(sourceInfo.size == destInfo.size);
+
+		char sourceValue[256];
+		char destValue[256];
+		size_t size = min_c(sourceInfo.size, (off_t)sizeof(sourceValue));
+		CPPUNIT_ASSERT(sourceNode.ReadAttr(attribute, sourceInfo.type, 0,
+			sourceValue, size) == (ssize_t)size);
+		CPPUNIT_ASSERT(destNode.ReadAttr(attribute, destInfo.type, 0,
+			destValue, size) == (ssize_t)size);
+		CPPUNIT_ASSERT(memcmp(sourceValue, destValue, size) == 0);
+		sourceAttributes++;
+	}
+
+	int32 destAttributes = 0;
+	while (destNode.GetNextAttrName(attribute) == B_OK)
+		destAttributes++;
+	CPPUNIT_ASSERT(sourceAttributes == destAttributes);
+
+	if (S_ISREG(sourceStat.st_mode)) {
+		CPPUNIT_ASSERT(sourceStat.st_size == destStat.st_size);
+
+		BFile sourceFile(sourcePath, B_READ_ONLY);
+		BFile destFile(destPath, B_READ_ONLY);
+		CPPUNIT_ASSERT(sourceFile.InitCheck() == B_OK);
+		CPPUNIT_ASSERT(destFile.InitCheck() == B_OK);
+
+		char sourceBuffer[16 * 1024];
+		char destBuffer[16 * 1024];
+		while (true) {
+			ssize_t sourceRead = sourceFile.Read(sourceBuffer,
+				sizeof(sourceBuffer));
+			ssize_t destRead = destFile.Read(destBuffer, sizeof(destBuffer));
+			CPPUNIT_ASSERT(sourceRead >= 0);
+			CPPUNIT_ASSERT(sourceRead == destRead);
+			if (sourceRead == 0)
+				break;
+			CPPUNIT_ASSERT(memcmp(sourceBuffer, destBuffer, sourceRead) == 0);
+		}
+		return;
+	}
+
+	CPPUNIT_ASSERT(S_ISDIR(sourceStat.st_mode));
+
+	// every entry of the source must have been copied, and nothing else
+	BDirectory sourceDirectory(sourcePath);
+	BDirectory destDirectory(destPath);
+	CPPUNIT_ASSERT(sourceDirectory.CountEntries()
+		== destDirectory.CountEntries());
+
+	BEntry entry;
+	while (sourceDirectory.GetNextEntry(&entry) == B_OK) {
+		char name[B_FILE_NAME_LENGTH];
+		CPPUNIT_ASSERT(entry.GetName(name) == B_OK);
+		CompareTrees((string(sourcePath) + "/" + name).c_str(),
+			(string(destPath) + "/" + name).c_str());
+	}
+}
+
+
+// WorkerCopyTest
+void
+CopyEngineTest::WorkerCopyTest()
+{
+	// sequential copy
+	NextSubTest();
+	{
+		TestController controller;
+		BCopyEngine engine(BCopyEngine::COPY_RECURSIVELY);
+		engine.SetController(&controller);
+		CPPUNIT_ASSERT(engine.ThreadCount() == 0);
+		CPPUNIT_ASSERT(engine.CopyEntry(kSourceDir, kSequentialDir) == B_OK);
+		CPPUNIT_ASSERT(controller.fErrorCount == 0);
+		CPPUNIT_ASSERT(controller.fFailedEntry.empty());
+		CompareTrees(kSourceDir, kSequentialDir);
+	}
+
+	// copy by workers; the result must match the sequential copy
+	NextSubTest();
+	{
+		TestController controller;
+		BCopyEngine engine(BCopyEngine::COPY_RECURSIVELY);
+		engine.SetController(&controller);
+		engine.SetThreadCount(kWorkerCount);
+		CPPUNIT_ASSERT(engine.ThreadCount() == kWorkerCount);
+		CPPUNIT_ASSERT(engine.CopyEntry(kSourceDir, kParallelDir) == B_OK);
+		CPPUNIT_ASSERT(controller.fErrorCount == 0);
+		CPPUNIT_ASSERT(controller.fFailedEntry.empty());
+		CPPUNIT_ASSERT(controller.fBytesCopied > 0);
+		CompareTrees(kSourceDir, kParallelDir);
+		CompareTrees(kSequentialDir, kParallelDir);
+	}
+
+	// the engine can be reused for another tree
+	NextSubTest();
+	{
+		string again = string(kTestDir) + "/again";
+		BCopyEngine engine(BCopyEngine::COPY_RECURSIVELY);
+		engine.SetThreadCount(kWorkerCount);
+		CPPUNIT_ASSERT(engine.CopyEntry(kSourceDir, kParallelDir)
+			== B_FILE_EXISTS);
+		CPPUNIT_ASSERT(engine.CopyEntry(kSourceDir, again.c_str()) == B_OK);
+		CompareTrees(kSourceDir, again.c_str());
+	}
+}
+
+
+// ErrorTest
+void
+CopyEngineTest::ErrorTest()
+{
+	// A directory in the way of a file fails that entry. With workers busy
+	// copying its siblings, the copy must still be aborted, and the error
+	// be reported and returned.
+	string dest = kParallelDir;
+	CPPUNIT_ASSERT(create_directory((dest + kFailing).c_str(), 0755)
+		== B_OK);
+
+	NextSubTest();
+	{
+		TestController controller;
+		BCopyEngine engine(BCopyEngine::COPY_RECURSIVELY
+			| BCopyEngine::MERGE_EXISTING_DIRECTORIES);
+		engine.SetController(&controller);
+		engine.SetThreadCount(kWorkerCount);
+		CPPUNIT_ASSERT(engine.CopyEntry(kSourceDir, dest.c_str())
+			== B_FILE_EXISTS);
+		CPPUNIT_ASSERT(controller.fErrorCount > 0);
+		CPPUNIT_ASSERT(controller.fLastError == B_FILE_EXISTS);
+		CPPUNIT_ASSERT(controller.fFailedEntry.length() > strlen(kFailing));
+		CPPUNIT_ASSERT(controller.fFailedEntry.compare(
+			controller.fFailedEntry.length() - strlen(kFailing),
+			strlen(kFailing), kFailing) == 0);
+		CPPUNIT_ASSERT(controller.fFailedEntryError == B_FILE_EXISTS);
+
+		// the entry in the way is left alone
+		struct stat st;
+		CPPUNIT_ASSERT(lstat((dest + kFailing).c_str(), &st) == 0);
+		CPPUNIT_ASSERT(S_ISDIR(st.st_mode));
+	}
+
+	// without a controller, the error is returned just the same, even when
+	// the files copied before are replaced
+	NextSubTest();
+	{
+		BCopyEngine engine(BCopyEngine::COPY_RECURSIVELY
+			| BCopyEngine::MERGE_EXISTING_DIRECTORIES
+			| BCopyEngine::UNLINK_DESTINATION);
+		engine.SetThreadCount(kWorkerCount);
+		CPPUNIT_ASSERT(engine.CopyEntry(kSourceDir, dest.c_str())
+			== B_FILE_EXISTS);
+	}
+}
@@ -0,0 +1,34 @@
+// CopyEngineTest.h
+
+#ifndef __sk_copy_engine_test_h__
+#define __sk_copy_engine_test_h__
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+
+#include <StorageDefs.h>
+#include <SupportDefs.h>
+
+#include "BasicTest.h"
+
+class CopyEngineTest : public BasicTest
+{
+public:
+	static CppUnit::Test* Suite();
+
+	// This function called before *each* test added in Suite()
+	void setUp();
+
+	// This function called after *each* test added in Suite()
+	void tearDown();
+
+	void WorkerCopyTest();
+	void ErrorTest();
+
+private:
+	void CreateTree();
+	void CompareTrees(const char* sourcePath, const char* destPath);
+};
+
+
+#endif	// __sk_copy_engine_test_h__
@@ -3,6 +3,7 @@
 
 // ##### Include headers for your tests here #####
 #include "AppFileInfoTest.h"
+#include "CopyEngineTest.h"
 #include "DirectoryTest.h"
 #include "DataIOTest.h"
 #include "EntryTest.h"
@@ -24,6 +25,7 @@ BTestSuite* getTestSuite() {
 
 	// ##### Add test suites here #####
 	suite->addTest("BAppFileInfo", AppFileInfoTest::Suite());
+	suite->addTest("BCopyEngine", CopyEngineTest::Suite());
 	suite->addTest("BDirectory", DirectoryTest::Suite());
 	suite->addTest("BDataIO", DataIOTest::Suite());
 	suite->addTest("BEntry", EntryTest::Suite());
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Sniffs the beginning of every file of a corpus with the installed sniffer
+	rules of the MIME database, once rule by rule and once with all rules
+	compiled into a single pattern matcher. Both must guess the same types.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include <Directory.h>
+#include <Entry.h>
+#include <File.h>
+#include <OS.h>
+#include <String.h>
+
+#include <mime/database_support.h>
+#include <mime/SnifferRules.h>
+
+
+using BPrivate::Storage::Mime::SnifferRules;
+
+
+static const size_t kHeaderSize = 4096;
+static const int32 kMaxFiles = 20000;
+
+
+static void
+add_files(BDirectory& directory, std::vector<std::string>& headers)
+{
+	BEntry entry;
+	while ((int32)headers.size() < kMaxFiles
+		&& directory.GetNextEntry(&entry) == B_OK) {
+		if (entry.IsDirectory()) {
+			BDirectory subDirectory(&entry);
+			if (subDirectory.InitCheck() == B_OK)
+				add_files(subDirectory, headers);
+			continue;
+		}
+
+		BFile file(&entry, B_READ_ONLY);
+		if (file.InitCheck() != B_OK)
+			continue;
+
+		std::string header(kHeaderSize, '\0');
+		ssize_t bytesRead = file.Read(&header[0], kHeaderSize);
+		if (bytesRead < 0)
+			continue;
+		header.resize(bytesRead);
+		headers.push_back(header);
+	}
+}
+
+
+static bigtime_t
+guess_types(SnifferRules& rules, const std::vector<std::string>& headers,
+	std::vector<BString>& types)
+{
+	types.resize(headers.size());
+
+	bigtime_t start = system_time();
+	for (size_t i = 0; i < headers.size(); i++) {
+		if (rules.GuessMimeType(headers[i].data(), headers[i].size(),
+				&types[i]) != B_OK) {
+			types[i] = "";
+		}
+	}
+	return system_time() - start;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	const char* corpus = argc > 1 ? argv[1] : "/boot/system";
+	int32 rounds = argc > 2 ? atol(argv[2]) : 5;
+	if (rounds <= 0) {
+		fprintf(stderr, "Usage: %s [<corpus directory> [<rounds>]]\n",
+			argv[0]);
+		return 1;
+	}
+
+	BDirectory directory(corpus);
+	if (directory.InitCheck() != B_OK) {
+		fprintf(stderr, "Could not open %s\n", corpus);
+		return 1;
+	}
+
+	std::vector<std::string> headers;
+	add_files(directory, headers);
+	if (headers.empty()) {
+		fprintf(stderr, "No files found in %s\n", corpus);
+		return 1;
+	}
+
+	SnifferRules rules(BPrivate::Storage::Mime::default_database_location(),
+		NULL);
+
+	// the first guess builds the rule list, and compiles it
+	std::vector<BString> sequentialTypes;
+	std::vector<BString> compiledTypes;
+	rules.SetCompiledMatching(false);
+	guess_types(rules, headers, sequentialTypes);
+	rules.SetCompiledMatching(true);
+	guess_types(rules, headers, compiledTypes);
+
+	bigtime_t sequentialTime = 0;
+	bigtime_t compiledTime = 0;
+	for (int32 round = 0; round < rounds; round++) {
+		rules.SetCompiledMatching(false);
+		sequentialTime += guess_types(rules, headers, sequentialTypes);
+		rules.SetCompiledMatching(true);
+		compiledTime += guess_types(rules, headers, compiledTypes);
+	}
+
+	int32 failures = 0;
+	int32 identified = 0;
+	for (size_t i = 0; i < headers.size(); i++) {
+		if (sequentialTypes[i] != compiledTypes[i]) {
+			if (failures++ < 10) {
+				printf("file %lu: '%s' rule by rule, '%s' compiled\n",
+					(unsigned long)i, sequentialTypes[i].String(),
+					compiledTypes[i].String());
+			}
+		}
+		if (sequentialTypes[i].Length() > 0)
+			identified++;
+	}
+
+	int64 count = (int64)headers.size() * rounds;
+	printf("%lu files, %" B_PRId32 " identified\n",
+		(unsigned long)headers.size(), identified);
+	printf("%-14s %12s %10s\n", "matching", "total us", "us/file");
+	printf("%-14s %12" B_PRId64 " %10.2f\n", "rule by rule", sequentialTime,
+		(double)sequentialTime / count);
+	printf("%-14s %12" B_PRId64 " %10.2f\n", "compiled", compiledTime,
+		(double)compiledTime / count);
+
+	if (failures > 0) {
+		printf("%" B_PRId32 " failures\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
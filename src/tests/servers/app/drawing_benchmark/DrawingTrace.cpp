@@ -0,0 +1,314 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "DrawingTrace.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+
+#include <AutoDeleter.h>
+#include <AutoDeleterPosix.h>
+
+#include "DrawingEngine.h"
+#include "ServerFont.h"
+
+
+static const char* kOpNames[] = {
+	"stroke_line",
+	"stroke_rect",
+	"fill_rect",
+	"invert_rect",
+	"stroke_ellipse",
+	"fill_ellipse",
+	"draw_string"
+};
+
+
+static bool
+read_number(const char*& position, float& value)
+{
+	char* end;
+	value = strtof(position, &end);
+	if (end == position)
+		return false;
+
+	position = end;
+	return true;
+}
+
+
+static bool
+read_color(const char*& position, rgb_color& color)
+{
+	float red, green, blue, alpha;
+	if (!read_number(position, red) || !read_number(position, green)
+		|| !read_number(position, blue) || !read_number(position, alpha)) {
+		return false;
+	}
+
+	color.set_to((uint8)red, (uint8)green, (uint8)blue, (uint8)alpha);
+	return true;
+}
+
+
+// #pragma mark -
+
+
+DrawingTrace::DrawingTrace()
+	:
+	fCommands(1024)
+{
+}
+
+
+DrawingTrace::~DrawingTrace()
+{
+}
+
+
+status_t
+DrawingTrace::Load(const char* path)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL)
+		return errno;
+	FileCloser fileCloser(file);
+
+	if (fseek(file, 0, SEEK_END) != 0)
+		return errno;
+	long size = ftell(file);
+	if (size < 0)
+		return errno;
+	rewind(file);
+
+	char* buffer = (char*)malloc(size + 1);
+	if (buffer == NULL)
+		return B_NO_MEMORY;
+	MemoryDeleter bufferDeleter(buffer);
+
+	if (fread(buffer, 1, size, file) != (size_t)size)
+		return B_IO_ERROR;
+	buffer[size] = '\0';
+
+	fCommands.MakeEmpty();
+	return _Parse(buffer, size);
+}
+
+
+/*!	Fills the trace with \a count pseudo random commands that roughly mimic
+	the mix of a typical window redraw: mostly background fills, frames and
+	labels, with a few lines, ellipses and inversions.
+*/
+void
+DrawingTrace::GenerateSynthetic(BRect bounds, int32 count)
+{
+	static const char* kLabels[] = {
+		"OK", "Cancel", "Name", "Size", "Modified", "Kind",
+		"The quick brown fox jumps over the lazy dog",
+		"Haiku/system/develop/headers/os/interface/View.h"
+	};
+	static const int32 kLabelCount = sizeof(kLabels) / sizeof(kLabels[0]);
+
+	fCommands.MakeEmpty();
+	srand(count);
+
+	// the number of pixel columns and rows, at least one each
+	int32 width = bounds.IntegerWidth() + 1;
+	int32 height = bounds.IntegerHeight() + 1;
+
+	for (int32 i = 0; i < count; i++) {
+		DrawingCommand* command = new(std::nothrow) DrawingCommand;
+		if (command == NULL || !fCommands.AddItem(command)) {
+			delete command;
+			return;
+		}
+
+		int32 kind = rand() % 100;
+		if (kind < 30)
+			command->op = TRACE_FILL_RECT;
+		else if (kind < 50)
+			command->op = TRACE_STROKE_RECT;
+		else if (kind < 80)
+			command->op = TRACE_DRAW_STRING;
+		else if (kind < 90)
+			command->op = TRACE_STROKE_LINE;
+		else if (kind < 95)
+			command->op = TRACE_FILL_ELLIPSE;
+		else if (kind < 98)
+			command->op = TRACE_STROKE_ELLIPSE;
+		else
+			command->op = TRACE_INVERT_RECT;
+
+		float left = bounds.left + rand() % width;
+		float top = bounds.top + rand() % height;
+		float right = std::min(bounds.right, left + 8 + rand() % 200);
+		float bottom = std::min(bounds.bottom, top + 8 + rand() % 40);
+
+		command->start.Set(left, top);
+		command->end.Set(right, bottom);
+		command->rect.Set(left, top, right, bottom);
+		if (command->op == TRACE_DRAW_STRING)
+			command->string = kLabels[rand() % kLabelCount];
+
+		command->drawingMode = (rand() % 4) == 0 ? B_OP_ALPHA : B_OP_COPY;
+		command->penSize = 1.0f;
+		command->highColor.set_to(rand() % 256, rand() % 256, rand() % 256,
+			command->drawingMode == B_OP_ALPHA ? 128 : 255);
+		command->lowColor.set_to(216, 216, 216, 255);
+		command->fontSize = 12.0f;
+	}
+}
+
+
+/*static*/ const char*
+DrawingTrace::OpName(trace_op op)
+{
+	if (op < 0 || op >= TRACE_OP_COUNT)
+		return "unknown";
+
+	return kOpNames[op];
+}
+
+
+/*static*/ void
+DrawingTrace::Replay(DrawingEngine* engine, ServerFont& font,
+	const DrawingCommand& command)
+{
+	engine->SetDrawingMode(command.drawingMode);
+	engine->SetPenSize(command.penSize);
+	engine->SetHighColor(command.highColor);
+	engine->SetLowColor(command.lowColor);
+
+	switch (command.op) {
+		case TRACE_STROKE_LINE:
+			engine->StrokeLine(command.start, command.end);
+			break;
+		case TRACE_STROKE_RECT:
+			engine->StrokeRect(command.rect);
+			break;
+		case TRACE_FILL_RECT:
+			engine->FillRect(command.rect);
+			break;
+		case TRACE_INVERT_RECT:
+			engine->InvertRect(command.rect);
+			break;
+		case TRACE_STROKE_ELLIPSE:
+		case TRACE_FILL_ELLIPSE:
+			engine->DrawEllipse(command.rect,
+				command.op == TRACE_FILL_ELLIPSE);
+			break;
+		case TRACE_DRAW_STRING:
+			if (font.Size() != command.fontSize) {
+				font.SetSize(command.fontSize);
+				engine->SetFont(font);
+			}
+			engine->DrawString(command.string.String(),
+				command.string.Length(), command.start);
+			break;
+
+		default:
+			break;
+	}
+}
+
+
+status_t
+DrawingTrace::_Parse(const char* buffer, size_t size)
+{
+	const char* position = buffer;
+	const char* end = buffer + size;
+	int32 line = 1;
+
+	while (position < end) {
+		while (position < end && isspace(*position)) {
+			if (*position == '\n')
+				line++;
+			position++;
+		}
+		if (position >= end)
+			break;
+
+		const char* word = position;
+		while (position < end && !isspace(*position))
+			position++;
+
+		int32 op = 0;
+		for (; op < TRACE_OP_COUNT; op++) {
+			if (strlen(kOpNames[op]) == (size_t)(position - word)
+				&& strncmp(kOpNames[op], word, position - word) == 0) {
+				break;
+			}
+		}
+		if (op == TRACE_OP_COUNT) {
+			fprintf(stderr, "line %" B_PRId32 ": unknown command\n", line);
+			return B_BAD_DATA;
+		}
+
+		DrawingCommand* command = new(std::nothrow) DrawingCommand;
+		if (command == NULL || !fCommands.AddItem(command)) {
+			delete command;
+			return B_NO_MEMORY;
+		}
+		command->op = (trace_op)op;
+
+		int32 argumentCount = command->op == TRACE_DRAW_STRING ? 3 : 4;
+		float arguments[4];
+		for (int32 i = 0; i < argumentCount; i++) {
+			if (!read_number(position, arguments[i])) {
+				fprintf(stderr, "line %" B_PRId32 ": missing argument\n",
+					line);
+				return B_BAD_DATA;
+			}
+		}
+
+		float drawingMode;
+		if (!read_number(position, drawingMode)
+			|| !read_number(position, command->penSize)
+			|| !read_color(position, command->highColor)
+			|| !read_color(position, command->lowColor)
+			|| !read_number(position, command->fontSize)) {
+			fprintf(stderr, "line %" B_PRId32 ": invalid drawing state\n",
+				line);
+			return B_BAD_DATA;
+		}
+		command->drawingMode = (drawing_mode)(int32)drawingMode;
+
+		while (position < end && *position != '\n')
+			position++;
+		position++;
+		line++;
+
+		if (command->op == TRACE_DRAW_STRING) {
+			command->start.Set(arguments[0], arguments[1]);
+			int32 length = (int32)arguments[2];
+			if (length < 0 || position + length > end) {
+				fprintf(stderr, "line %" B_PRId32 ": truncated string\n",
+					line);
+				return B_BAD_DATA;
+			}
+			command->string.SetTo(position, length);
+			for (int32 i = 0; i < length; i++) {
+				if (position[i] == '\n')
+					line++;
+			}
+			position += length + 1;
+			line++;
+		} else {
+			command->start.Set(arguments[0], arguments[1]);
+			command->end.Set(arguments[2], arguments[3]);
+			command->rect.Set(arguments[0], arguments[1], arguments[2],
+				arguments[3]);
+		}
+	}
+
+	return B_OK;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef DRAWING_TRACE_H
+#define DRAWING_TRACE_H
+
+
+#include <GraphicsDefs.h>
+#include <InterfaceDefs.h>
+#include <ObjectList.h>
+#include <Rect.h>
+#include <String.h>
+
+
+class DrawingEngine;
+class ServerFont;
+
+
+/*!	A drawing trace is a text file with one drawing command per line, all
+	coordinates already converted to screen space:
+
+		<op> <arguments> <drawing mode> <pen size> <high r g b a>
+			<low r g b a> <font size>
+
+	The rect based operations (stroke_rect, fill_rect, invert_rect,
+	stroke_ellipse, fill_ellipse) take "left top right bottom", stroke_line
+	takes "x1 y1 x2 y2". draw_string takes "x y length", and its line is
+	followed by exactly length bytes of UTF-8 text and a newline.
+
+	The app_server writes such traces when ServerWindow.cpp is compiled with
+	RECORD_DRAWING_TRACE defined. Clipping is not recorded, commands are
+	replayed against the full bitmap.
+*/
+
+
+enum trace_op {
+	TRACE_STROKE_LINE = 0,
+	TRACE_STROKE_RECT,
+	TRACE_FILL_RECT,
+	TRACE_INVERT_RECT,
+	TRACE_STROKE_ELLIPSE,
+	TRACE_FILL_ELLIPSE,
+	TRACE_DRAW_STRING,
+
+	TRACE_OP_COUNT
+};
+
+
+struct DrawingCommand {
+	trace_op		op;
+	BPoint			start;
+	BPoint			end;
+	BRect			rect;
+	BString			string;
+
+	drawing_mode	drawingMode;
+	float			penSize;
+	rgb_color		highColor;
+	rgb_color		lowColor;
+	float			fontSize;
+};
+
+
+class DrawingTrace {
+public:
+								DrawingTrace();
+								~DrawingTrace();
+
+			status_t			Load(const char* path);
+			void				GenerateSynthetic(BRect bounds,
+									int32 count);
+
+			int32				CountCommands() const
+									{ return fCommands.CountItems(); }
+			const DrawingCommand* CommandAt(int32 index) const
+									{ return fCommands.ItemAt(index); }
+
+	static	const char*			OpName(trace_op op);
+	static	void				Replay(DrawingEngine* engine,
+									ServerFont& font,
+									const DrawingCommand& command);
+
+private:
+			status_t			_Parse(const char* buffer, size_t size);
+
+private:
+			BObjectList<DrawingCommand, true> fCommands;
+};
+
+
+#endif	// DRAWING_TRACE_H
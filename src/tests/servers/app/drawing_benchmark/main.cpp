@@ -0,0 +1,236 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Replays a recorded (or synthetic) drawing trace through a
+	BitmapDrawingEngine, ie. the Painter and the font engine drawing into an
+	in-memory BitmapHWInterface, without needing a Desktop or a screen.
+	Reports the overall throughput and a latency histogram per operation.
+*/
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Application.h>
+#include <OS.h>
+
+#include "BitmapDrawingEngine.h"
+#include "DrawingTrace.h"
+#include "GlobalFontManager.h"
+#include "ServerFont.h"
+
+
+static const int32 kHistogramBuckets = 32;
+	// bucket i counts latencies in [2^i, 2^(i + 1)) nanoseconds
+
+
+struct op_statistics {
+	int64		count;
+	nanotime_t	total;
+	int64		histogram[kHistogramBuckets];
+};
+
+
+static int32
+histogram_bucket(nanotime_t latency)
+{
+	int32 bucket = 0;
+	while (latency > 1 && bucket < kHistogramBuckets - 1) {
+		latency >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+
+static nanotime_t
+histogram_percentile(const op_statistics& statistics, int32 percent)
+{
+	int64 threshold = (statistics.count * percent + 99) / 100;
+	int64 seen = 0;
+	for (int32 i = 0; i < kHistogramBuckets; i++) {
+		seen += statistics.histogram[i];
+		if (seen >= threshold)
+			return (nanotime_t)1 << (i + 1);
+	}
+	return (nanotime_t)1 << kHistogramBuckets;
+}
+
+
+static void
+print_usage(const char* name, bool error)
+{
+	fprintf(error ? stderr : stdout,
+		"Usage: %s [options] [trace file]\n"
+		"Replays a drawing trace into an offscreen bitmap and reports the\n"
+		"drawing throughput. Without a trace file, a synthetic one is used.\n"
+		"\n"
+		"Options:\n"
+		"  -c <count>       number of synthetic commands (default 10000)\n"
+		"  -i <iterations>  number of times to replay the trace (default 10)\n"
+		"  -s <w>x<h>       size of the bitmap (default 1920x1080)\n"
+		"  -H               print latency histograms\n"
+		"  -h, --help       print this help\n", name);
+	exit(error ? 1 : 0);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 syntheticCount = 10000;
+	int32 iterations = 10;
+	int32 width = 1920;
+	int32 height = 1080;
+	bool printHistograms = false;
+
+	const struct option kLongOptions[] = {
+		{ "help", no_argument, 0, 'h' },
+		{ 0, 0, 0, 0 }
+	};
+
+	int c;
+	while ((c = getopt_long(argc, argv, "c:i:s:Hh", kLongOptions, NULL))
+			!= -1) {
+		switch (c) {
+			case 'c':
+				syntheticCount = atol(optarg);
+				break;
+			case 'i':
+				iterations = atol(optarg);
+				break;
+			case 's':
+				if (sscanf(optarg, "%" B_SCNd32 "x%" B_SCNd32, &width,
+						&height) != 2) {
+					print_usage(argv[0], true);
+				}
+				break;
+			case 'H':
+				printHistograms = true;
+				break;
+			case 'h':
+				print_usage(argv[0], false);
+				break;
+			default:
+				print_usage(argv[0], true);
+				break;
+		}
+	}
+
+	if (iterations <= 0 || width <= 0 || height <= 0 || syntheticCount <= 0)
+		print_usage(argv[0], true);
+
+	BApplication application("application/x-vnd.Haiku-drawing_benchmark");
+
+	gFontManager = new GlobalFontManager;
+	if (gFontManager->InitCheck() != B_OK) {
+		fprintf(stderr, "Could not initialize the font manager.\n");
+		return 1;
+	}
+
+	BitmapDrawingEngine engine;
+	status_t status = engine.SetSize(width, height);
+	if (status != B_OK) {
+		fprintf(stderr, "Could not create the bitmap: %s\n", strerror(status));
+		return 1;
+	}
+
+	DrawingTrace trace;
+	if (optind < argc) {
+		status = trace.Load(argv[optind]);
+		if (status != B_OK) {
+			fprintf(stderr, "Could not load trace \"%s\": %s\n", argv[optind],
+				strerror(status));
+			return 1;
+		}
+	} else
+		trace.GenerateSynthetic(BRect(0, 0, width - 1, height - 1),
+			syntheticCount);
+
+	ServerFont font;
+	engine.SetFont(font);
+	engine.SetPattern(B_SOLID_HIGH);
+
+	op_statistics statistics[TRACE_OP_COUNT];
+	memset(statistics, 0, sizeof(statistics));
+
+	int32 commandCount = trace.CountCommands();
+
+	engine.LockParallelAccess();
+
+	// Warm up the font cache and the drawing mode setup once
+	for (int32 i = 0; i < commandCount; i++)
+		DrawingTrace::Replay(&engine, font, *trace.CommandAt(i));
+
+	nanotime_t start = system_time_nsecs();
+
+	for (int32 iteration = 0; iteration < iterations; iteration++) {
+		for (int32 i = 0; i < commandCount; i++) {
+			const DrawingCommand& command = *trace.CommandAt(i);
+
+			nanotime_t before = system_time_nsecs();
+			DrawingTrace::Replay(&engine, font, command);
+			nanotime_t latency = system_time_nsecs() - before;
+
+			op_statistics& opStatistics = statistics[command.op];
+			opStatistics.count++;
+			opStatistics.total += latency;
+			opStatistics.histogram[histogram_bucket(latency)]++;
+		}
+	}
+
+	nanotime_t elapsed = system_time_nsecs() - start;
+
+	engine.UnlockParallelAccess();
+
+	int64 totalCount = (int64)commandCount * iterations;
+	printf("%" B_PRId64 " commands in %g ms: %g ops/sec (%" B_PRId32 "x%"
+		B_PRId32 ")\n\n", totalCount, elapsed / 1000000.0,
+		elapsed > 0 ? totalCount * 1000000000.0 / elapsed : 0.0, width,
+		height);
+
+	printf("%-16s %10s %12s %10s %10s %10s\n", "operation", "count",
+		"ops/sec", "mean ns", "p50 ns", "p99 ns");
+	for (int32 op = 0; op < TRACE_OP_COUNT; op++) {
+		const op_statistics& opStatistics = statistics[op];
+		if (opStatistics.count == 0)
+			continue;
+
+		printf("%-16s %10" B_PRId64 " %12.0f %10" B_PRId64 " %10" B_PRId64
+			" %10" B_PRId64 "\n", DrawingTrace::OpName((trace_op)op),
+			opStatistics.count,
+			opStatistics.total > 0
+				? opStatistics.count * 1000000000.0 / opStatistics.total : 0.0,
+			opStatistics.total / opStatistics.count,
+			histogram_percentile(opStatistics, 50),
+			histogram_percentile(opStatistics, 99));
+	}
+
+	if (printHistograms) {
+		for (int32 op = 0; op < TRACE_OP_COUNT; op++) {
+			const op_statistics& opStatistics = statistics[op];
+			if (opStatistics.count == 0)
+				continue;
+
+			printf("\n%s:\n", DrawingTrace::OpName((trace_op)op));
+			for (int32 i = 0; i < kHistogramBuckets; i++) {
+				if (opStatistics.histogram[i] == 0)
+					continue;
+
+				int32 bar = (int32)(opStatistics.histogram[i] * 50
+					/ opStatistics.count);
+				printf("  < %10" B_PRId64 " ns %10" B_PRId64 " ",
+					(nanotime_t)1 << (i + 1), opStatistics.histogram[i]);
+				for (int32 j = 0; j < bar; j++)
+					putchar('#');
+				putchar('\n');
+			}
+		}
+	}
+
+	return 0;
+}
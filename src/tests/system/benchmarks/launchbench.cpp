@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures how long loading programs takes with and without the runtime
+	loader's relocation cache (LD_RELOCATION_CACHE).
+
+	load_image() returns as soon as the runtime loader has loaded and relocated
+	the program, before its main thread runs; the team is killed right away.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+#include <image.h>
+
+
+extern char** environ;
+
+
+static const char* const kDefaultPrograms[] = {
+	"/boot/system/apps/DeskCalc",
+	"/boot/system/apps/ShowImage",
+	"/boot/system/apps/StyledEdit",
+	"/boot/system/apps/Terminal",
+	"/boot/system/apps/WebPositive",
+	"/boot/system/preferences/Appearance",
+	"/boot/system/servers/mail_daemon",
+};
+
+
+static char**
+make_environment(bool useCache)
+{
+	int32 count = 0;
+	while (environ[count] != NULL)
+		count++;
+
+	char** environment = (char**)malloc(sizeof(char*) * (count + 2));
+	if (environment == NULL)
+		return NULL;
+
+	int32 index = 0;
+	for (int32 i = 0; i < count; i++) {
+		if (strncmp(environ[i], "LD_RELOCATION_CACHE=", 20) != 0)
+			environment[index++] = environ[i];
+	}
+	environment[index++] = (char*)(useCache
+		? "LD_RELOCATION_CACHE=1" : "LD_RELOCATION_CACHE=0");
+	environment[index] = NULL;
+
+	return environment;
+}
+
+
+static bigtime_t
+launch(const char* path, char** environment)
+{
+	const char* arguments[] = { path, NULL };
+
+	bigtime_t start = system_time();
+	thread_id thread = load_image(1, arguments, (const char**)environment);
+	bigtime_t time = system_time() - start;
+
+	if (thread < 0)
+		return thread;
+
+	kill_thread(thread);
+	status_t returnValue;
+	wait_for_thread(thread, &returnValue);
+	return time;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 rounds = 20;
+	int first = 1;
+	if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+		rounds = atol(argv[2]);
+		first = 3;
+	}
+
+	const char* const* programs = kDefaultPrograms;
+	int32 programCount = sizeof(kDefaultPrograms) / sizeof(kDefaultPrograms[0]);
+	if (argc > first) {
+		programs = argv + first;
+		programCount = argc - first;
+	}
+
+	if (rounds <= 0) {
+		fprintf(stderr, "Usage: %s [-n <rounds>] [<program> ...]\n", argv[0]);
+		return 1;
+	}
+
+	char** uncachedEnvironment = make_environment(false);
+	char** cachedEnvironment = make_environment(true);
+	if (uncachedEnvironment == NULL || cachedEnvironment == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	printf("%-40s %12s %12s\n", "program", "uncached us", "cached us");
+
+	for (int32 i = 0; i < programCount; i++) {
+		// warm up the file cache, and create the relocation cache
+		if (launch(programs[i], uncachedEnvironment) < 0
+			|| launch(programs[i], cachedEnvironment) < 0) {
+			printf("%-40s failed to load\n", programs[i]);
+			continue;
+		}
+
+		bigtime_t uncached = 0;
+		bigtime_t cached = 0;
+		for (int32 round = 0; round < rounds; round++) {
+			uncached += launch(programs[i], uncachedEnvironment);
+			cached += launch(programs[i], cachedEnvironment);
+		}
+
+		printf("%-40s %12" B_PRId64 " %12" B_PRId64 "\n", programs[i],
+			uncached / rounds, cached / rounds);
+	}
+
+	free(uncachedEnvironment);
+	free(cachedEnvironment);
+	return 0;
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Checks the delivery of node monitor events with B_WATCH_BATCHED: changes
+	to the same node are coalesced within a batch, a burst of events larger
+	than a batch is split into several messages without losing or reordering
+	any, and nothing is delivered after the listener stopped watching.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <Message.h>
+#include <NodeMonitor.h>
+#include <OS.h>
+#include <String.h>
+#include <fs_attr.h>
+
+#include <syscalls.h>
+
+
+static const char* kTestDirectory = "/tmp/node_monitor_batch_test";
+static const int32 kToken = 42;
+static const bigtime_t kQuietTime = 1000000;
+	// several flush intervals of the kernel
+static const int32 kChangeCount = 64;
+static const int32 kFileCount = 1000;
+static const int32 kMaxEventsPerBatch = 128;
+	// kMaxBatchedEvents of the kernel
+
+static port_id sPort;
+static int sFailures = 0;
+
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, \
+				__LINE__, #condition); \
+			sFailures++; \
+		} \
+	} while (false)
+
+
+/*!	Reads the next node monitor message from the port; waits at most
+	kQuietTime for it.
+*/
+static bool
+read_message(BMessage& message)
+{
+	ssize_t size = port_buffer_size_etc(sPort, B_RELATIVE_TIMEOUT,
+		kQuietTime);
+	if (size < 0)
+		return false;
+
+	char* buffer = (char*)malloc(size);
+	if (buffer == NULL)
+		return false;
+
+	int32 code;
+	ssize_t bytesRead = read_port(sPort, &code, buffer, size);
+	status_t status = bytesRead == size ? message.Unflatten(buffer) : B_ERROR;
+	free(buffer);
+
+	if (status != B_OK) {
+		fprintf(stderr, "could not read message: %s\n", strerror(status));
+		sFailures++;
+		return false;
+	}
+
+	return message.what == B_NODE_MONITOR;
+}
+
+
+static void
+drain_port()
+{
+	BMessage message;
+	while (read_message(message))
+		;
+}
+
+
+static status_t
+start_watching(const char* path, uint32 flags)
+{
+	struct stat st;
+	if (stat(path, &st) != 0)
+		return errno;
+
+	return _kern_start_watching(st.st_dev, st.st_ino, flags | B_WATCH_BATCHED,
+		sPort, kToken);
+}
+
+
+static void
+test_coalescing()
+{
+	BString path(kTestDirectory);
+	path << "/coalesce";
+
+	int fd = open(path.String(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+	CHECK(fd >= 0);
+	if (fd < 0)
+		return;
+
+	CHECK(start_watching(path.String(), B_WATCH_STAT | B_WATCH_ATTR)
+		== B_OK);
+
+	for (int32 i = 0; i < kChangeCount; i++) {
+		CHECK(fchmod(fd, (i % 2) != 0 ? 0600 : 0644) == 0);
+		CHECK(fs_write_attr(fd, "test:changed", B_INT32_TYPE, 0, &i,
+			sizeof(i)) == sizeof(i));
+	}
+	close(fd);
+
+	// Every batch may carry at most one event per node and attribute
+	int32 messages = 0;
+	int32 statEvents = 0;
+	int32 attrEvents = 0;
+	BMessage message;
+	while (read_message(message)) {
+		int32 opcode;
+		CHECK(message.FindInt32("opcode", &opcode) == B_OK);
+		CHECK(opcode == B_BATCHED_EVENTS);
+		CHECK(!node_monitor_rescan_needed(&message));
+		messages++;
+
+		int32 batchStatEvents = 0;
+		int32 batchAttrEvents = 0;
+		int32 count = count_node_monitor_events(&message);
+		for (int32 i = 0; i < count; i++) {
+			BMessage event;
+			CHECK(get_node_monitor_event(&message, i, &event) == B_OK);
+			if (event.FindInt32("opcode", &opcode) != B_OK)
+				continue;
+
+			if (opcode == B_STAT_CHANGED)
+				batchStatEvents++;
+			else if (opcode == B_ATTR_CHANGED) {
+				batchAttrEvents++;
+				// the first change created the attribute
+				if (attrEvents == 0)
+					CHECK(event.GetInt32("cause", 0) == B_ATTR_CREATED);
+			}
+		}
+
+		CHECK(batchStatEvents <= 1);
+		CHECK(batchAttrEvents <= 1);
+		statEvents += batchStatEvents;
+		attrEvents += batchAttrEvents;
+	}
+
+	CHECK(messages > 0);
+	CHECK(statEvents > 0 && statEvents < kChangeCount);
+	CHECK(attrEvents > 0 && attrEvents < kChangeCount);
+
+	printf("coalescing: %" B_PRId32 " changes each delivered as %" B_PRId32
+		" stat and %" B_PRId32 " attribute events in %" B_PRId32
+		" messages\n", kChangeCount, statEvents, attrEvents, messages);
+
+	_kern_stop_notifying(sPort, kToken);
+}
+
+
+static void
+test_overflow_and_ordering()
+{
+	BString path(kTestDirectory);
+	path << "/burst";
+	CHECK(mkdir(path.String(), 0755) == 0);
+	CHECK(start_watching(path.String(), B_WATCH_DIRECTORY) == B_OK);
+
+	// More events than fit into a batch: full batches are sent right away,
+	// the rest when the kernel flushes them, and all of them must arrive in
+	// the order the files were created.
+	for (int32 i = 0; i < kFileCount; i++) {
+		BString name(path);
+		name << "/" << i;
+		int fd = open(name.String(), O_CREAT | O_WRONLY, 0644);
+		CHECK(fd >= 0);
+		close(fd);
+	}
+
+	int32 messages = 0;
+	int32 next = 0;
+	BMessage message;
+	while (read_message(message)) {
+		int32 opcode;
+		CHECK(message.FindInt32("opcode", &opcode) == B_OK);
+		CHECK(opcode == B_BATCHED_EVENTS);
+		CHECK(!node_monitor_rescan_needed(&message));
+		messages++;
+
+		int32 count = count_node_monitor_events(&message);
+		CHECK(count > 0 && count <= kMaxEventsPerBatch);
+
+		for (int32 i = 0; i < count; i++) {
+			BMessage event;
+			CHECK(get_node_monitor_event(&message, i, &event) == B_OK);
+			CHECK(event.GetInt32("opcode", 0) == B_ENTRY_CREATED);
+
+			BString expected;
+			expected << next++;
+			CHECK(expected == event.GetString("name", ""));
+		}
+	}
+
+	CHECK(next == kFileCount);
+	CHECK(messages >= kFileCount / kMaxEventsPerBatch);
+
+	printf("ordering: %" B_PRId32 " of %" B_PRId32 " events delivered in %"
+		B_PRId32 " messages\n", next, kFileCount, messages);
+
+	// Nothing must be delivered once the listener is gone
+	_kern_stop_notifying(sPort, kToken);
+
+	BString name(path);
+	name << "/late";
+	int fd = open(name.String(), O_CREAT | O_WRONLY, 0644);
+	close(fd);
+
+	CHECK(!read_message(message));
+}
+
+
+int
+main(int argc, char** argv)
+{
+	system("rm -rf /tmp/node_monitor_batch_test");
+	if (mkdir(kTestDirectory, 0755) != 0) {
+		fprintf(stderr, "could not create %s: %s\n", kTestDirectory,
+			strerror(errno));
+		return 1;
+	}
+
+	sPort = create_port(kFileCount, "node monitor batch test");
+	if (sPort < 0) {
+		fprintf(stderr, "could not create port: %s\n", strerror(sPort));
+		return 1;
+	}
+
+	test_coalescing();
+	drain_port();
+	test_overflow_and_ordering();
+
+	delete_port(sPort);
+	system("rm -rf /tmp/node_monitor_batch_test");
+
+	if (sFailures > 0) {
+		fprintf(stderr, "%d checks failed\n", sFailures);
+		return 1;
+	}
+
+	printf("all tests passed\n");
+	return 0;
+}
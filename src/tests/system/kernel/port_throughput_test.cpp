@@ -0,0 +1,234 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures throughput and round trip latency of passing payloads of
+	different sizes either through a port, which copies the data into the
+	kernel and back out, or by transferring an area and only sending its ID
+	through the port, like BMessage and LinkSender do for large payloads.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <OS.h>
+
+#include <syscalls.h>
+
+
+#define MESSAGE_COUNT	2000
+#define MAX_BYTES		(256 * 1024 * 1024)
+	// limits the number of messages for the large sizes
+#define AREA_MESSAGE	'area'
+#define PORT_MESSAGE	'port'
+#define QUIT_MESSAGE	'quit'
+
+
+struct reader_args {
+	port_id		port;
+	port_id		replyPort;
+	bool		reply;
+};
+
+
+static const size_t kPortSizes[] = {
+	64, 1024, 4096, 16 * 1024, 64 * 1024, 256 * 1024
+};
+
+static const size_t kAreaSizes[] = {
+	16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024, 16 * 1024 * 1024
+};
+
+static uint8* sPayload;
+static uint8* sReadBuffer;
+
+
+static size_t
+round_to_pages(size_t size)
+{
+	return (size + B_PAGE_SIZE - 1) & ~(B_PAGE_SIZE - 1);
+}
+
+
+/*!	Reads the payload like a receiver would, so that all of its pages are
+	actually mapped.
+*/
+static uint32
+touch(const uint8* data, size_t size)
+{
+	uint32 sum = 0;
+	for (size_t offset = 0; offset < size; offset += 64)
+		sum += data[offset];
+	return sum;
+}
+
+
+static status_t
+reader_thread(void* _args)
+{
+	reader_args* args = (reader_args*)_args;
+	uint32 sum = 0;
+
+	while (true) {
+		int32 code;
+		ssize_t bytes = read_port(args->port, &code, sReadBuffer,
+			256 * 1024);
+		if (bytes < 0 || code == QUIT_MESSAGE)
+			break;
+
+		if (code == AREA_MESSAGE) {
+			area_id area = *(area_id*)sReadBuffer;
+			size_t size = *(size_t*)(sReadBuffer + sizeof(area_id));
+			area_info info;
+			if (get_area_info(area, &info) == B_OK)
+				sum += touch((uint8*)info.address, size);
+			delete_area(area);
+		} else
+			sum += touch(sReadBuffer, bytes);
+
+		if (args->reply)
+			write_port(args->replyPort, code, NULL, 0);
+	}
+
+	return sum;
+}
+
+
+static status_t
+send_by_port(port_id port, size_t size)
+{
+	return write_port(port, PORT_MESSAGE, sPayload, size);
+}
+
+
+static status_t
+send_by_area(port_id port, size_t size)
+{
+	void* address;
+	area_id area = create_area("port throughput payload", &address,
+		B_ANY_ADDRESS, round_to_pages(size), B_NO_LOCK,
+		B_READ_AREA | B_WRITE_AREA);
+	if (area < 0)
+		return area;
+
+	memcpy(address, sPayload, size);
+
+	// the reader lives in the same team, but the transfer still goes
+	// through the same cloning of the pages as it would for another team
+	area_id transferred = _kern_transfer_area(area, &address, B_ANY_ADDRESS,
+		getpid());
+	if (transferred < 0) {
+		delete_area(area);
+		return transferred;
+	}
+
+	uint8 message[sizeof(area_id) + sizeof(size_t)];
+	memcpy(message, &transferred, sizeof(area_id));
+	memcpy(message + sizeof(area_id), &size, sizeof(size_t));
+	return write_port(port, AREA_MESSAGE, message, sizeof(message));
+}
+
+
+static void
+run(const char* name, status_t (*send)(port_id, size_t), size_t size)
+{
+	int32 count = std::min((size_t)MESSAGE_COUNT, MAX_BYTES / size);
+
+	reader_args args;
+	args.port = create_port(100, "port throughput");
+	args.replyPort = create_port(1, "port throughput reply");
+
+	// throughput: the reader drains the port while we keep it full
+
+	args.reply = false;
+	thread_id reader = spawn_thread(reader_thread, "reader",
+		B_NORMAL_PRIORITY, &args);
+	resume_thread(reader);
+
+	bigtime_t start = system_time();
+	int32 sent = 0;
+	for (; sent < count; sent++) {
+		status_t status = send(args.port, size);
+		if (status != B_OK) {
+			fprintf(stderr, "%s: sending %lu bytes failed: %s\n", name,
+				(unsigned long)size, strerror(status));
+			break;
+		}
+	}
+	write_port(args.port, QUIT_MESSAGE, NULL, 0);
+
+	status_t result;
+	wait_for_thread(reader, &result);
+	bigtime_t throughputTime = system_time() - start;
+
+	// latency: wait for the reader to process each message
+
+	args.reply = true;
+	reader = spawn_thread(reader_thread, "reader", B_NORMAL_PRIORITY, &args);
+	resume_thread(reader);
+
+	bigtime_t* latencies = new bigtime_t[count];
+	int32 samples = 0;
+	for (; samples < count; samples++) {
+		bigtime_t before = system_time();
+		if (send(args.port, size) != B_OK)
+			break;
+
+		int32 code;
+		read_port(args.replyPort, &code, NULL, 0);
+		latencies[samples] = system_time() - before;
+	}
+	write_port(args.port, QUIT_MESSAGE, NULL, 0);
+	wait_for_thread(reader, &result);
+
+	double throughput = throughputTime > 0
+		? (double)size * sent / throughputTime : 0.0;
+
+	if (samples == 0) {
+		printf("%-5s %10lu %12.1f %21s\n", name, (unsigned long)size,
+			throughput, "no samples");
+	} else {
+		std::sort(latencies, latencies + samples);
+
+		printf("%-5s %10lu %12.1f %10" B_PRId64 " %10" B_PRId64 "\n", name,
+			(unsigned long)size, throughput, latencies[samples / 2],
+			latencies[samples * 99 / 100]);
+	}
+
+	delete[] latencies;
+	delete_port(args.port);
+	delete_port(args.replyPort);
+}
+
+
+int
+main()
+{
+	sPayload = (uint8*)malloc(kAreaSizes[B_COUNT_OF(kAreaSizes) - 1]);
+	sReadBuffer = (uint8*)malloc(256 * 1024);
+	if (sPayload == NULL || sReadBuffer == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	for (size_t i = 0; i < kAreaSizes[B_COUNT_OF(kAreaSizes) - 1]; i++)
+		sPayload[i] = (uint8)i;
+
+	printf("%-5s %10s %12s %10s %10s\n", "path", "bytes", "MB/s",
+		"p50 us", "p99 us");
+
+	for (size_t i = 0; i < B_COUNT_OF(kPortSizes); i++)
+		run("port", send_by_port, kPortSizes[i]);
+	for (size_t i = 0; i < B_COUNT_OF(kAreaSizes); i++)
+		run("area", send_by_area, kAreaSizes[i]);
+
+	free(sPayload);
+	free(sReadBuffer);
+	return 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	A multi-threaded allocation benchmark in the style of larson and xmalloc:
+	every thread keeps replacing random objects of a set with new ones of
+	random size, and after every round hands its set over to the next thread,
+	so that a good part of the objects is freed by another thread than the one
+	that allocated it. Reports the throughput and the allocator's per size
+	class statistics.
+*/
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+#include <malloc_private.h>
+
+
+static const int32 kMaxThreads = 64;
+
+
+struct object_set {
+	uint8**	objects;
+	int32	count;
+};
+
+
+static int32 sThreadCount = 4;
+static int32 sRoundCount = 20;
+static int32 sIterationCount = 100000;
+static int32 sObjectCount = 1000;
+static size_t sMinSize = 16;
+static size_t sMaxSize = 512;
+
+static object_set sSets[kMaxThreads];
+static sem_id sRoundDone;
+static sem_id sRoundStart[kMaxThreads];
+static int32 sFailures;
+
+
+static inline uint32
+next_random(uint32& seed)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+
+static void
+replace_object(uint8** _object, size_t size)
+{
+	uint8* object = *_object;
+	if (object != NULL) {
+		size_t oldSize;
+		memcpy(&oldSize, object, sizeof(size_t));
+		if (object[oldSize - 1] != (uint8)oldSize)
+			atomic_add(&sFailures, 1);
+		free(object);
+	}
+
+	object = (uint8*)malloc(size);
+	if (object == NULL) {
+		atomic_add(&sFailures, 1);
+		*_object = NULL;
+		return;
+	}
+
+	memcpy(object, &size, sizeof(size_t));
+	object[size - 1] = (uint8)size;
+	*_object = object;
+}
+
+
+static status_t
+allocation_thread(void* data)
+{
+	int32 index = (int32)(addr_t)data;
+	uint32 seed = index + 1;
+
+	for (int32 round = 0; round < sRoundCount; round++) {
+		if (acquire_sem(sRoundStart[index]) != B_OK)
+			return B_ERROR;
+
+		// in every round, work on the objects of another thread
+		object_set& set = sSets[(index + round) % sThreadCount];
+		for (int32 i = 0; i < sIterationCount; i++) {
+			size_t size = sMinSize
+				+ next_random(seed) % (sMaxSize - sMinSize + 1);
+			replace_object(&set.objects[next_random(seed) % set.count], size);
+		}
+
+		release_sem(sRoundDone);
+	}
+
+	return B_OK;
+}
+
+
+static void
+print_statistics()
+{
+	size_t count = 0;
+	if (get_malloc_size_class_info(NULL, &count) != B_OK)
+		return;
+
+	malloc_size_class_info* infos = new malloc_size_class_info[count];
+	if (get_malloc_size_class_info(infos, &count) != B_OK) {
+		delete[] infos;
+		return;
+	}
+
+	printf("\n%6s %8s %8s %8s %8s %12s %10s %10s\n", "size", "pages", "chunks",
+		"used", "cached", "cache hits", "refills", "drains");
+	for (size_t i = 0; i < count; i++) {
+		const malloc_size_class_info& info = infos[i];
+		if (info.pages == 0 && info.cache_hits == 0)
+			continue;
+
+		printf("%6lu %8lu %8lu %8lu %8lu %12" B_PRIu64 " %10" B_PRIu64
+			" %10" B_PRIu64 "\n", (unsigned long)info.size,
+			(unsigned long)info.pages, (unsigned long)info.chunks,
+			(unsigned long)info.used, (unsigned long)info.cached,
+			info.cache_hits, info.cache_refills, info.cache_drains);
+	}
+
+	delete[] infos;
+}
+
+
+static void
+print_usage(const char* name, bool error)
+{
+	fprintf(error ? stderr : stdout,
+		"Usage: %s [options]\n"
+		"Measures malloc() and free() throughput of several threads that\n"
+		"free each other's allocations.\n"
+		"\n"
+		"Options:\n"
+		"  -t <threads>     number of threads (default 4)\n"
+		"  -r <rounds>      number of rounds (default 20)\n"
+		"  -i <iterations>  replacements per thread and round (default 100000)\n"
+		"  -o <objects>     objects per thread (default 1000)\n"
+		"  -s <min>-<max>   range of the object sizes (default 16-512)\n"
+		"  -S               print the per size class statistics\n"
+		"  -h, --help       print this help\n", name);
+	exit(error ? 1 : 0);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	bool printStatistics = false;
+
+	const struct option kLongOptions[] = {
+		{ "help", no_argument, 0, 'h' },
+		{ 0, 0, 0, 0 }
+	};
+
+	int c;
+	while ((c = getopt_long(argc, argv, "t:r:i:o:s:Sh", kLongOptions, NULL))
+			!= -1) {
+		switch (c) {
+			case 't':
+				sThreadCount = atol(optarg);
+				break;
+			case 'r':
+				sRoundCount = atol(optarg);
+				break;
+			case 'i':
+				sIterationCount = atol(optarg);
+				break;
+			case 'o':
+				sObjectCount = atol(optarg);
+				break;
+			case 's':
+			{
+				unsigned long minSize;
+				unsigned long maxSize;
+				if (sscanf(optarg, "%lu-%lu", &minSize, &maxSize) != 2)
+					print_usage(argv[0], true);
+				sMinSize = minSize;
+				sMaxSize = maxSize;
+				break;
+			}
+			case 'S':
+				printStatistics = true;
+				break;
+			case 'h':
+				print_usage(argv[0], false);
+				break;
+			default:
+				print_usage(argv[0], true);
+				break;
+		}
+	}
+
+	if (sThreadCount <= 0 || sThreadCount > kMaxThreads || sRoundCount <= 0
+		|| sIterationCount <= 0 || sObjectCount <= 0
+		|| sMinSize < sizeof(size_t) + 1 || sMaxSize < sMinSize) {
+		print_usage(argv[0], true);
+	}
+
+	sRoundDone = create_sem(0, "round done");
+
+	thread_id threads[kMaxThreads];
+	for (int32 i = 0; i < sThreadCount; i++) {
+		sSets[i].objects = (uint8**)calloc(sObjectCount, sizeof(uint8*));
+		sSets[i].count = sObjectCount;
+		sRoundStart[i] = create_sem(0, "round start");
+		threads[i] = spawn_thread(allocation_thread, "allocation thread",
+			B_NORMAL_PRIORITY, (void*)(addr_t)i);
+		resume_thread(threads[i]);
+	}
+
+	bigtime_t start = system_time();
+
+	for (int32 round = 0; round < sRoundCount; round++) {
+		// the sets only change hands between rounds
+		for (int32 i = 0; i < sThreadCount; i++)
+			release_sem(sRoundStart[i]);
+		acquire_sem_etc(sRoundDone, sThreadCount, 0, 0);
+	}
+
+	bigtime_t elapsed = system_time() - start;
+
+	for (int32 i = 0; i < sThreadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+		delete_sem(sRoundStart[i]);
+	}
+	delete_sem(sRoundDone);
+
+	int64 operations = (int64)sThreadCount * sRoundCount * sIterationCount;
+	printf("%" B_PRId32 " threads, %lu-%lu bytes: %" B_PRId64 " replacements "
+		"in %g ms, %g per second\n", sThreadCount, (unsigned long)sMinSize,
+		(unsigned long)sMaxSize, operations, elapsed / 1000.0,
+		elapsed > 0 ? operations * 1000000.0 / elapsed : 0.0);
+
+	if (printStatistics)
+		print_statistics();
+
+	for (int32 i = 0; i < sThreadCount; i++) {
+		for (int32 j = 0; j < sSets[i].count; j++)
+			free(sSets[i].objects[j]);
+		free(sSets[i].objects);
+	}
+
+	if (sFailures > 0) {
+		printf("%" B_PRId32 " failures\n", sFailures);
+		return 1;
+	}
+
+	return 0;
+}